@@ -402,8 +402,9 @@ bool AApplication::ParseXML()
     assert(context >= 0);
     bool publicAccess = wrapper.IsPublicAccess();
     int bitfield = wrapper.IsBitfield();
+    int offset = wrapper.GetOffset();
     const std::string& idStr = GET_ID_STR(id);
-    TClassMember* member = xmlElementsFactory->CreateClassMember(name, idStr, publicAccess, bitfield);
+    TClassMember* member = xmlElementsFactory->CreateClassMember(name, idStr, publicAccess, bitfield, offset);
     member->SetParent(elements[context]);
     static_cast<TClass*>(elements[context])->AddMember(member);
 
@@ -561,6 +562,18 @@ bool AApplication::ParseXML()
       assert(context >= 0);
       static_cast<TClass*>(elements[context])->SetSerializeMethod(methodType);
       }
+    else if (wrapper.GetName() == LOAD_CONSTRUCTOR_MARKER)
+      {
+      int context = wrapper.GetContextId();
+      assert(context >= 0);
+      static_cast<TClass*>(elements[context])->SetLoadConstructor();
+      }
+    else if (wrapper.GetName() == DIFF_MARKER)
+      {
+      int context = wrapper.GetContextId();
+      assert(context >= 0);
+      static_cast<TClass*>(elements[context])->SetDiff();
+      }
     };
 
   const THandleXmlItemIndex handleXmlItemIndex =
@@ -36,6 +36,7 @@ const char ATTRIBUTE_ABSTRACT[] = "abstract";
 const char ATTRIBUTE_VIRTUAL[] = "virtual";
 const char ATTRIBUTE_BITS[] = "bits";
 const char ATTRIBUTE_SIZE[] = "size";
+const char ATTRIBUTE_OFFSET[] = "offset";
 const char ATTRIBUTE_INCOMPLETE[] = "incomplete";
 const char ATTRIBUTE_MIN[] = "min";
 const char ATTRIBUTE_MAX[] = "max";
@@ -61,6 +62,8 @@ const char MANUAL_BUILD_SERIALIZE_MARKER[] = STRINGIZE(MANUAL_BUILD_SERIALIZE_MA
 const char MANUAL_OBJECT_SERIALIZE_MARKER[] = STRINGIZE(MANUAL_OBJECT_SERIALIZE_MARKER_NAME);
 const char MANUAL_FULL_MARKER[] = STRINGIZE(MANUAL_FULL_MARKER_NAME);
 const char DO_NOT_SERIALIZE_MARKER[] = STRINGIZE(DO_NOT_SERIALIZE_MARKER_NAME);
+const char LOAD_CONSTRUCTOR_MARKER[] = STRINGIZE(LOAD_CONSTRUCTOR_MARKER_NAME);
+const char DIFF_MARKER[] = STRINGIZE(DIFF_MARKER_NAME);
 
 
 //IVAN Used to exchange type of serializable object between 
@@ -0,0 +1,247 @@
+/**\file serialize_cursor.h
+
+    Streaming load of sequence container (vector, deque, list) element by element, so
+    containers bigger than memory may be processed:
+      TDirectFileLoader loader("snapshot.bin");  //or TMemoryLoader over TMappedFile
+      LoadSnapshotHeader(loader, LAYOUT_FINGERPRINT);
+      ...                                        //load members dumped before the container
+      TLoadCursor<std::vector<TRecord>> cursor(loader);
+      for (const TRecord& record : cursor)
+        ...
+      if (cursor.HasError())
+        ...
+
+    Elements are loaded by operator& of their type (generated Load or loading constructor),
+    only current element or batch (see NextBatch) is held in memory. When all elements are
+    read, loader is positioned after the container, so following members may be loaded.
+    ForEachLoaded calls function for each element instead.
+
+    \warning Containers encoded as a whole can't be streamed (vectors of integers or floating
+             point values in snapshots with packed integers, adaptive or XOR float encoding,
+             vectors of columnar classes in columnar snapshots unless they are stored with raw
+             layout), cursor sets LOAD_BAD_ENCODING.
+*/
+#pragma once
+
+#include <serialize3/h/gen_code/loadertemplates.h>
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/** Checks if elements of container are dumped one by one with current encodings of loader.
+    Encodings are checked in order of operator& of loadertemplates: vectors of classes with raw
+    layout are dumped object by object even in columnar snapshots.
+*/
+template <class T, class Alloc>
+bool IsElementStreamed(const ASerializeLoader& loader, const std::vector<T, Alloc>*)
+  {
+  if (serialized_raw_layout<T>::value && std::is_trivially_copyable<T>::value && loader.IsRawLayout())
+    return true;
+
+  return (is_adaptive_encodable<T>::value && loader.IsAdaptive()) == false &&
+    (is_packable_integer<T>::value && loader.IsPackedIntegers()) == false &&
+    (is_xor_float<T>::value && loader.IsXorFloats()) == false &&
+    (serialized_columnar<T>::value && loader.IsColumnar()) == false;
+  }
+
+template <class T, class Alloc>
+bool IsElementStreamed(const ASerializeLoader& loader, const std::deque<T, Alloc>*)
+  {
+  return (is_xor_float<T>::value && loader.IsXorFloats()) == false;
+  }
+
+template <class T, class Alloc>
+bool IsElementStreamed(const ASerializeLoader& loader, const std::list<T, Alloc>*)
+  {
+  return true;
+  }
+
+#if defined(SERIALIZABLE_BOOST_CONTAINERS)
+template <class T, class Alloc>
+bool IsElementStreamed(const ASerializeLoader& loader, const bc::vector<T, Alloc>*)
+  {
+  if (serialized_raw_layout<T>::value && std::is_trivially_copyable<T>::value && loader.IsRawLayout())
+    return true;
+
+  return (is_adaptive_encodable<T>::value && loader.IsAdaptive()) == false &&
+    (is_packable_integer<T>::value && loader.IsPackedIntegers()) == false &&
+    (is_xor_float<T>::value && loader.IsXorFloats()) == false &&
+    (serialized_columnar<T>::value && loader.IsColumnar()) == false;
+  }
+
+template <class T, class Alloc>
+bool IsElementStreamed(const ASerializeLoader& loader, const bc::deque<T, Alloc>*)
+  {
+  return (is_xor_float<T>::value && loader.IsXorFloats()) == false;
+  }
+
+template <class T, class Alloc>
+bool IsElementStreamed(const ASerializeLoader& loader, const bc::list<T, Alloc>*)
+  {
+  return true;
+  }
+#endif // #if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+template <typename TContainer, typename = void>
+struct is_ordered_container : public std::false_type {};
+
+template <typename TContainer>
+struct is_ordered_container<TContainer, decltype(void(std::declval<typename TContainer::key_compare>()))>
+  : public std::true_type {};
+
+template <class TContainer>
+bool IsKeyStreamed(const ASerializeLoader& loader, std::true_type /*is_ordered_container*/)
+  {
+  typedef typename TContainer::key_type Key;
+  return (is_packable_integer<Key>::value && loader.IsPackedIntegers()) == false &&
+    (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings()) == false;
+  }
+
+template <class TContainer>
+bool IsKeyStreamed(const ASerializeLoader&, std::false_type /*is_ordered_container*/)
+  {
+  return true;
+  }
+
+/** Other containers are dumped element by element, except of ordered sets and maps with keys
+    of integers or strings, which are packed or front coded as a whole.
+*/
+template <class TContainer>
+bool IsElementStreamed(const ASerializeLoader& loader, const TContainer*)
+  {
+  return IsKeyStreamed<TContainer>(loader, is_ordered_container<TContainer>());
+  }
+
+template <class TContainer>
+class TLoadCursor;
+
+/// Input iterator over TLoadCursor, element is valid until next increment.
+template <class TContainer>
+class TLoadCursorIterator
+  {
+  public:
+    typedef std::input_iterator_tag              iterator_category;
+    typedef typename TContainer::value_type      value_type;
+    typedef std::ptrdiff_t                       difference_type;
+    typedef const value_type*                    pointer;
+    typedef const value_type&                    reference;
+
+    explicit TLoadCursorIterator(TLoadCursor<TContainer>* cursor) : Cursor(cursor)
+      {
+      Advance();
+      }
+
+    reference operator*() const { return Element; }
+    pointer operator->() const { return &Element; }
+
+    TLoadCursorIterator& operator++()
+      {
+      Advance();
+      return *this;
+      }
+
+    /// Only end iterator (without cursor) is compared.
+    bool operator==(const TLoadCursorIterator& other) const { return Cursor == other.Cursor; }
+    bool operator!=(const TLoadCursorIterator& other) const { return Cursor != other.Cursor; }
+
+  private:
+    void Advance()
+      {
+      if (Cursor != nullptr && Cursor->Next(Element) == false)
+        Cursor = nullptr;
+      }
+
+    TLoadCursor<TContainer>* Cursor;
+    value_type               Element;
+  };
+
+//---------- TLoadCursor
+//Loads elements of container dumped at current position of loader one by one.
+template <class TContainer>
+class TLoadCursor
+  {
+  public:
+    typedef typename TContainer::value_type   value_type;
+    typedef TLoadCursorIterator<TContainer>   iterator;
+
+    /// Reads element count, sets LOAD_BAD_ENCODING if container can't be streamed.
+    explicit TLoadCursor(ASerializeLoader& loader) : Loader(loader), Count(0), Index(0)
+      {
+      if (IsElementStreamed(loader, static_cast<const TContainer*>(nullptr)) == false)
+        {
+        loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+        return;
+        }
+
+      loader.LoadLength(Count);
+      if (loader.HasError())
+        Count = 0;
+      }
+
+    TLoadCursor(const TLoadCursor&) = delete;
+    TLoadCursor& operator=(const TLoadCursor&) = delete;
+
+    size_t GetCount() const { return Count; }
+    size_t GetRemaining() const { return Count - Index; }
+    bool HasError() const { return Loader.HasError(); }
+
+    /// Loads next element, returns false at the end or on error.
+    bool Next(value_type& element) SERIALIZE_LOAD_NOEXCEPT
+      {
+      if (Index == Count || Loader.HasError())
+        return false;
+
+      //element is replaced, loading into it would append to its containers
+      element = ConstructLoaded<value_type>(Loader);
+      ++Index;
+      return Loader.HasError() == false;
+      }
+
+    /** Loads at most maxCount next elements into batch (its content is replaced, capacity is
+        kept), returns their count.
+    */
+    template <class TBatch>
+    size_t NextBatch(TBatch& batch, size_t maxCount) SERIALIZE_LOAD_NOEXCEPT
+      {
+      batch.clear();
+      for (; batch.size() < maxCount && Index < Count && Loader.HasError() == false; ++Index)
+        batch.push_back(ConstructLoaded<value_type>(Loader));
+      if (Loader.HasError())
+        batch.clear();
+      return batch.size();
+      }
+
+    /// Loads and drops remaining elements, so loader is positioned after the container.
+    void SkipRemaining() SERIALIZE_LOAD_NOEXCEPT
+      {
+      for (; Index < Count && Loader.HasError() == false; ++Index)
+        ConstructLoaded<value_type>(Loader);
+      }
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(nullptr); }
+
+  /// Class attributes:
+  private:
+    ASerializeLoader& Loader;
+    size_t            Count;
+    size_t            Index; //elements read
+  }; //TLoadCursor
+
+/// Calls function(value_type&&) for each element of container, returns false on error.
+template <class TContainer, class TFunction>
+bool ForEachLoaded(ASerializeLoader& loader, TFunction function) SERIALIZE_LOAD_NOEXCEPT
+  {
+  TLoadCursor<TContainer> cursor(loader);
+  typename TContainer::value_type element;
+
+  while (cursor.Next(element))
+    function(std::move(element));
+  return cursor.HasError() == false;
+  }
@@ -0,0 +1,338 @@
+/**\file serialize_forksnapshot.h
+
+    Background snapshot of process state by fork (POSIX):
+      TForkSnapshot snapshot;
+      snapshot.Start("registry.bin", [&registry] (ASerializeDumper& dumper) { dumper & registry; });
+      ...                    //parent keeps mutating registry
+      snapshot.Poll();       //progress: GetWritten, GetMemoryOverhead
+      snapshot.Wait();
+
+    Child process dumps frozen copy-on-write image of parent memory taken at the moment of fork
+    into temporary file, which is renamed to the snapshot file on success (and the rename is
+    synced to its directory), so readers never see partial snapshot. Parent is blocked only by
+    fork itself (copying of page tables, see GetForkSeconds). Child reports progress and result
+    to parent by pipe.
+
+    Pages modified by parent while child runs are copied by kernel, GetMemoryOverhead reports
+    memory held by child this way (Linux only).
+
+    \warning Only the thread calling Start exists in child. Objects being dumped must not be
+             guarded by locks held by other threads at the moment of fork.
+    \warning Child allocates memory after fork (dumper buffers, whatever dump allocates). POSIX
+             allows only async-signal-safe calls there in multi-threaded parent, malloc is safe
+             only if no other thread holds the malloc lock at the moment of fork, else child
+             deadlocks. Allocators taking their locks around fork (f.e. glibc) guarantee it.
+*/
+#pragma once
+
+#if defined(_WIN32)
+  #error Fork snapshot is supported on POSIX systems only
+#endif
+
+#include <serialize3/h/storage/fddumper.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/// Message of snapshot child process.
+struct TForkSnapshotMessage
+  {
+  unsigned long long Written;   //bytes dumped so far
+  int                Done;      //final message
+  int                Succeeded; //valid in final message
+  };
+
+//---------- TForkSnapshotDumper
+//Dumps into snapshot file in child process, reports progress to parent each progressStep bytes.
+//Progress is dropped when parent doesn't read pipe, so dump never waits for parent.
+class TForkSnapshotDumper : public TFdDumper
+  {
+  public:
+    TForkSnapshotDumper(int fd, int pipeFd, size_t progressStep) :
+      TFdDumper(fd), PipeFd(pipeFd), ProgressStep(progressStep), NextProgress(progressStep) {}
+
+    /// Sends final message, waits for free space in pipe.
+    void ReportDone(bool succeeded)
+      {
+      fcntl(PipeFd, F_SETFL, fcntl(PipeFd, F_GETFL) & ~O_NONBLOCK);
+      Report(1, succeeded);
+      }
+
+  /// ASerializeDumper reimplementation:
+    virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) override
+      {
+      TFdDumper::WriteBuffer(buffer, bufferLen);
+      ReportProgress();
+      }
+
+    virtual void WriteBufferReferenced(const unsigned char* buffer, size_t bufferLen) override
+      {
+      TFdDumper::WriteBufferReferenced(buffer, bufferLen);
+      ReportProgress();
+      }
+
+  private:
+    void ReportProgress()
+      {
+      if (GetPosition() >= NextProgress)
+        {
+        Report(0, 0);
+        NextProgress = GetPosition() + ProgressStep;
+        }
+      }
+
+    void Report(int done, int succeeded)
+      {
+      TForkSnapshotMessage message = { GetPosition(), done, succeeded };
+      //message is smaller than PIPE_BUF, so it is written whole or not at all
+      while (write(PipeFd, &message, sizeof(message)) < 0 && errno == EINTR)
+        ;
+      }
+
+  /// Class attributes:
+  private:
+    int    PipeFd;
+    size_t ProgressStep;
+    size_t NextProgress;
+  }; //TForkSnapshotDumper
+
+//---------- TForkSnapshot
+class TForkSnapshot
+  {
+  public:
+    enum TState
+      {
+      SNAPSHOT_IDLE,
+      SNAPSHOT_RUNNING,
+      SNAPSHOT_SUCCEEDED,
+      SNAPSHOT_FAILED
+      };
+
+    explicit TForkSnapshot(size_t progressStep = 1 << 20) :
+      ProgressStep(progressStep), State(SNAPSHOT_IDLE), Child(-1), PipeFd(-1), Written(0),
+      Reported(false), ReportedSuccess(false), ExitStatus(0), ForkSeconds(0) {}
+
+    /// Waits for running snapshot, so child is never left as zombie.
+    ~TForkSnapshot()
+      {
+      Wait();
+      }
+
+    TForkSnapshot(const TForkSnapshot&) = delete;
+    TForkSnapshot& operator=(const TForkSnapshot&) = delete;
+
+    /** Forks child calling dump(ASerializeDumper&) to write snapshot to fileName. Returns false
+        if snapshot is already running or fork fails.
+    */
+    template <class TDump>
+    bool Start(const char* fileName, TDump dump)
+      {
+      int fds[2];
+
+      if (State == SNAPSHOT_RUNNING || pipe(fds) != 0)
+        return false;
+
+      std::string tempName = std::string(fileName) + ".tmp";
+      auto start = std::chrono::steady_clock::now();
+      pid_t child = fork();
+      if (child < 0)
+        {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+        }
+
+      if (child == 0)
+        {
+        //child: nothing of parent (atexit handlers, stdio buffers, its catch blocks) may run at exit
+        close(fds[0]);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+        try
+          {
+          _exit(RunChild(fileName, tempName.c_str(), fds[1], dump) ? 0 : 1);
+          }
+        catch (...)
+          {
+          unlink(tempName.c_str());
+          _exit(1);
+          }
+        }
+
+      ForkSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      Started = start;
+      close(fds[1]);
+      fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+      fcntl(fds[0], F_SETFL, O_NONBLOCK);
+      State = SNAPSHOT_RUNNING;
+      Child = child;
+      PipeFd = fds[0];
+      Written = 0;
+      Reported = false;
+      ReportedSuccess = false;
+      ExitStatus = 0;
+      return true;
+      }
+
+    /// Reads progress and checks if child finished, doesn't block.
+    TState Poll()
+      {
+      if (State != SNAPSHOT_RUNNING)
+        return State;
+
+      ReadMessages();
+      int status;
+      pid_t result = waitpid(Child, &status, WNOHANG);
+      if (result == Child || (result < 0 && errno != EINTR))
+        Finish(result == Child ? status : -1);
+      return State;
+      }
+
+    /// Waits until child finishes.
+    TState Wait()
+      {
+      if (State != SNAPSHOT_RUNNING)
+        return State;
+
+      //pipe is read until child closes it at exit, so its final message never blocks it
+      fcntl(PipeFd, F_SETFL, fcntl(PipeFd, F_GETFL) & ~O_NONBLOCK);
+      ReadMessages();
+
+      int status;
+      pid_t result;
+      while ((result = waitpid(Child, &status, 0)) < 0 && errno == EINTR)
+        ;
+      Finish(result == Child ? status : -1);
+      return State;
+      }
+
+    TState GetState() const { return State; }
+    /// Child process of running snapshot, -1 if none is running.
+    pid_t GetChildPid() const { return State == SNAPSHOT_RUNNING ? Child : -1; }
+    /// Bytes dumped by child according to last Poll or Wait.
+    size_t GetWritten() const { return Written; }
+    /// Status returned by waitpid for finished child (-1 if it was not available).
+    int GetExitStatus() const { return ExitStatus; }
+    /// Time parent was blocked by fork.
+    double GetForkSeconds() const { return ForkSeconds; }
+
+    /// Time since Start.
+    double GetElapsedSeconds() const
+      {
+      return State == SNAPSHOT_IDLE ? 0 :
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - Started).count();
+      }
+
+    /** Private memory of running child in bytes, mostly pages copied because parent modified
+        them since fork. Returns 0 if it is not available (not Linux, child not running).
+    */
+    size_t GetMemoryOverhead() const
+      {
+      size_t overhead = 0;
+#if defined(__linux__)
+      if (State != SNAPSHOT_RUNNING)
+        return 0;
+
+      char fileName[64];
+      snprintf(fileName, sizeof(fileName), "/proc/%d/smaps_rollup", static_cast<int>(Child));
+      FILE* file = fopen(fileName, "r");
+      if (file == nullptr)
+        return 0;
+
+      char line[256];
+      unsigned long long kb;
+      while (fgets(line, sizeof(line), file) != nullptr)
+        {
+        if (sscanf(line, "Private_Clean: %llu kB", &kb) == 1 || sscanf(line, "Private_Dirty: %llu kB", &kb) == 1)
+          overhead += static_cast<size_t>(kb) * 1024;
+        }
+      fclose(file);
+#endif
+      return overhead;
+      }
+
+  private:
+    template <class TDump>
+    bool RunChild(const char* fileName, const char* tempName, int pipeFd, TDump& dump)
+      {
+      int fd = open(tempName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if (fd < 0)
+        {
+        TForkSnapshotDumper(-1, pipeFd, ProgressStep).ReportDone(false);
+        return false;
+        }
+
+      TForkSnapshotDumper dumper(fd, pipeFd, ProgressStep);
+      dump(static_cast<ASerializeDumper&>(dumper));
+      bool succeeded = dumper.Flush() && fdatasync(fd) == 0;
+      succeeded = close(fd) == 0 && succeeded;
+      succeeded = succeeded && rename(tempName, fileName) == 0 && SyncDirectory(fileName);
+      if (succeeded == false)
+        unlink(tempName);
+      dumper.ReportDone(succeeded);
+      return succeeded;
+      }
+
+    /// Syncs directory of file, so its rename survives crash.
+    static bool SyncDirectory(const char* fileName)
+      {
+      std::string directory(fileName);
+      size_t slash = directory.rfind('/');
+      directory = slash == std::string::npos ? "." : slash == 0 ? "/" : directory.substr(0, slash);
+
+      int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+      if (fd < 0)
+        return false;
+      bool succeeded = fsync(fd) == 0;
+      return close(fd) == 0 && succeeded;
+      }
+
+    void ReadMessages()
+      {
+      TForkSnapshotMessage message;
+      ssize_t result;
+
+      while ((result = read(PipeFd, &message, sizeof(message))) == sizeof(message) ||
+             (result < 0 && errno == EINTR))
+        {
+        if (result < 0)
+          continue;
+        Written = static_cast<size_t>(message.Written);
+        if (message.Done)
+          {
+          Reported = true;
+          ReportedSuccess = message.Succeeded != 0;
+          }
+        }
+      }
+
+    void Finish(int status)
+      {
+      ReadMessages();
+      close(PipeFd);
+      PipeFd = -1;
+      ExitStatus = status;
+      State = Reported && ReportedSuccess && status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0 ?
+        SNAPSHOT_SUCCEEDED : SNAPSHOT_FAILED;
+      }
+
+  /// Class attributes:
+  private:
+    size_t                                ProgressStep;
+    TState                                State;
+    pid_t                                 Child;
+    int                                   PipeFd;  //read end of child's pipe
+    size_t                                Written;
+    bool                                  Reported; //final message was received
+    bool                                  ReportedSuccess;
+    int                                   ExitStatus;
+    double                                ForkSeconds;
+    std::chrono::steady_clock::time_point Started;
+  }; //TForkSnapshot
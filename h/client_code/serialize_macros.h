@@ -1,17 +1,34 @@
 #pragma once
 
+#include <cstddef>
+
 class ASerializeDumper;
 class ASerializeLoader;
+class AHandleVisitor;
+class TFixedSizeLoader;
+template <class TType> class TFlatView;
 
 /// Storage type used for each non-abstract class type-id.
 typedef int TTypeId;
 
+/// Selects loading constructor declared by SERIALIZABLE_LOAD_CONSTRUCTOR.
+struct TLoadTag {};
+
 // Macro to be used when nonpublic inheritance is needed for serializable class
 // it is redefined to public just for serializer generated code
 #ifndef SERIALIZER_INHERITANCE_SWITCH
 #define SERIALIZER_INHERITANCE_SWITCH(inhType) inhType
 #endif
 
+// Define SERIALIZE_NOEXCEPT_LOAD to make all generated and templated load functions noexcept.
+// Load errors are then reported only by sticky error of ASerializeLoader (see GetError),
+// manually written Load functions must be declared with SERIALIZE_LOAD_NOEXCEPT too.
+#if defined(SERIALIZE_NOEXCEPT_LOAD)
+  #define SERIALIZE_LOAD_NOEXCEPT noexcept
+#else
+  #define SERIALIZE_LOAD_NOEXCEPT
+#endif
+
 // INTERNAL MACROS: Do not use directly, only used for macros below.
 #define AUTOMATIC_SERIALIZE_MARKER_NAME         _AutofAkE_
 #define AUTOMATIC_OBJECT_SERIALIZE_MARKER_NAME  _AutoObjfAkE_
@@ -21,16 +38,25 @@ typedef int TTypeId;
 #define MANUAL_FULL_MARKER_NAME                 _ManFullfAkE_
 #define MANUAL_OBJECT_SERIALIZE_MARKER_NAME     _ManObjectfAkE_
 #define DO_NOT_SERIALIZE_MARKER_NAME            _DoNotfAkE_
+#define LOAD_CONSTRUCTOR_MARKER_NAME            _LoadCtorfAkE_
+#define DIFF_MARKER_NAME                        _DifffAkE_
 
 #define COMMON_OBJECT_SERIALIZABLE                                 \
   public:                                                          \
   void Dump(ASerializeDumper& dumper) const;                       \
-  void Load(ASerializeLoader& loader);
+  void Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT;     \
+  size_t SerializedSize() const;                                   \
+  void VisitHandles(AHandleVisitor& visitor);                      \
+  void DumpColumns(ASerializeDumper& dumper, size_t count) const;  \
+  void LoadColumns(ASerializeLoader& loader, size_t count, int column = -1) SERIALIZE_LOAD_NOEXCEPT; \
+  template <class> friend class ::TFlatView; //reads members in typeids file
            
 #define COMMON_SERIALIZABLE                                        \
   COMMON_OBJECT_SERIALIZABLE                                       \
   virtual void DumpPointer(ASerializeDumper& dumper) const;        \
-  static  void* LoadPointer(ASerializeLoader& loader);             \
+  virtual size_t SerializedPointerSize() const;                    \
+  virtual void VisitPointerHandles(AHandleVisitor& visitor);       \
+  static  void* LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT; \
   static  void* BuildForSerializer();                              \
 private:                                                           \
   virtual TTypeId GetTypeId() const;                          
@@ -38,7 +64,9 @@ private:                                                           \
 #define COMMON_SERIALIZABLE_1                                      \
   COMMON_OBJECT_SERIALIZABLE                                       \
   virtual void DumpPointer(ASerializeDumper& dumper) const;        \
-  static  void* LoadPointer(ASerializeLoader& loader);             \
+  virtual size_t SerializedPointerSize() const;                    \
+  virtual void VisitPointerHandles(AHandleVisitor& visitor);       \
+  static  void* LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT; \
   static  void* BuildForSerializer(ASerializeLoader& loader);      \
 private:                                                           \
   virtual TTypeId GetTypeId() const;
@@ -108,7 +136,7 @@ private:
   static void MANUAL_OBJECT_SERIALIZE_MARKER_NAME (void) {} \
 public:                                                     \
   void Dump(ASerializeDumper& dumper) const;                \
-  void Load(ASerializeLoader& loader);                      \
+  void Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT; \
 private:                                                           
 
 
@@ -116,3 +144,29 @@ private:
 //       class is a data member or base class of a serialized class.
 #define NOT_SERIALIZABLE                                           \
   static void DO_NOT_SERIALIZE_MARKER_NAME (void) {}
+
+//USAGE: Put in class definition after SERIALIZABLE or SERIALIZABLE_OBJECT to declare
+//       constructor which loads all members directly from loader, it is auto-generated.
+//       Containers and LoadPointer then construct objects from loader instead of default
+//       construction followed by Load. Default constructor must be declared explicitly.
+//       Fixed-size classes construct members from window of whole object (TFixedSizeLoader).
+//       Access scope after macro is private.
+#define SERIALIZABLE_LOAD_CONSTRUCTOR(_class_)                      \
+  static void LOAD_CONSTRUCTOR_MARKER_NAME (void) {}                 \
+public:                                                              \
+  _class_(TLoadTag, ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT; \
+private:                                                             \
+  _class_(TLoadTag, TFixedSizeLoader&& loader) SERIALIZE_LOAD_NOEXCEPT;
+
+//USAGE: Put in class definition after SERIALIZABLE or SERIALIZABLE_OBJECT to declare functions
+//       for delta replication, they are auto-generated (see difftemplates.h). DumpDiff dumps
+//       fields changed against base object, LoadPatch applies them to object equal to base,
+//       HasDiff checks if any field changed.
+//       Access scope after macro is private.
+#define SERIALIZABLE_DIFF(_class_)                                   \
+  static void DIFF_MARKER_NAME (void) {}                              \
+public:                                                               \
+  bool HasDiff(const _class_& base) const;                            \
+  void DumpDiff(const _class_& base, ASerializeDumper& dumper) const; \
+  void LoadPatch(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT;   \
+private:
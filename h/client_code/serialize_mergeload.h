@@ -0,0 +1,119 @@
+/**\file serialize_mergeload.h
+
+    Parallel loading of several snapshots (f.e. one per partition) into one registry. Each
+    snapshot is expected to be dumped as registry followed by its data:
+      dumper & registry;
+      dumper & data;
+
+    Sizes of registries are read from all snapshots first, so each snapshot gets disjoint range
+    of handles and registry storage is resized once. Snapshots are then loaded concurrently,
+    handles loaded by each thread are rebased by offset of its snapshot (see TContext).
+
+    Usage:
+      std::vector<TData> data(fileNames.size());
+      MergeLoadSnapshots(registry, fileNames,
+        [&data](ASerializeLoader& loader, size_t snapshot) { loader & data[snapshot]; });
+*/
+#pragma once
+
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/primitiveloader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Loads snapshots into registry (existing objects are kept), loadData is called for data
+    of each snapshot. TLoader is constructed from file name (f.e. TDirectFileLoader).
+    Returns error of the first failed snapshot, exception thrown by load is rethrown. Registry
+    storage then gets its previous size, objects of snapshots are dropped.
+    \warning Registry storage is resized before the load, so it must not be modified
+             by other threads.
+*/
+template <class TLoader = TPrimitiveLoader, class TRegistry, class TLoadData>
+ASerializeLoader::TLoadError MergeLoadSnapshots(TRegistry& registry,
+  const std::vector<std::string>& fileNames, TLoadData loadData, unsigned threadCount = 0)
+  {
+  typedef typename TRegistry::THandle THandle;
+  typedef typename TRegistry::TStorage::value_type TStored;
+
+  size_t snapshots = fileNames.size();
+  std::vector<std::unique_ptr<TLoader>> loaders(snapshots);
+  std::vector<THandle> offsets(snapshots + 1);
+  std::vector<ASerializeLoader::TLoadError> errors(snapshots, ASerializeLoader::LOAD_OK);
+
+  //read sizes of registries and assign handle ranges
+  offsets[0] = registry.GetStorage().size() - 1;
+  for (size_t i = 0; i < snapshots; ++i)
+    {
+    size_t size = 0;
+    loaders[i].reset(new TLoader(fileNames[i].c_str()));
+    loaders[i]->LoadLength(size);
+    //sizes are not trusted, their sum must not overflow handles
+    loaders[i]->CheckLoadCount(size, serialized_min_size<TStored>::value);
+    if (loaders[i]->HasError() == false && size > std::numeric_limits<THandle>::max() - 1 - offsets[i])
+      loaders[i]->SetError(ASerializeLoader::LOAD_OVERSIZED_LENGTH);
+    if (loaders[i]->HasError())
+      return loaders[i]->GetError();
+
+    offsets[i + 1] = offsets[i] + size;
+    }
+
+  registry.GetStorage().resize(offsets[snapshots] + 1);
+
+  std::atomic<size_t> next(0);
+  std::exception_ptr exception;
+  std::atomic_flag exceptionLock = ATOMIC_FLAG_INIT;
+
+  auto worker = [&]()
+    {
+    for (size_t i = next++; i < snapshots; i = next++)
+      {
+      TLoader& loader = *loaders[i];
+
+      try
+        {
+        typename TRegistry::TContext context(registry, offsets[i]);
+        typename TRegistry::TStorage& storage = registry.GetStorage();
+
+        for (THandle h = offsets[i] + 1; h <= offsets[i + 1] && loader.HasError() == false; ++h)
+          loader & storage[h];
+        if (loader.HasError() == false)
+          loadData(static_cast<ASerializeLoader&>(loader), i);
+        }
+      catch (...)
+        {
+        if (exceptionLock.test_and_set() == false)
+          exception = std::current_exception();
+        }
+
+      errors[i] = loader.GetError();
+      loaders[i].reset(); //close file
+      }
+    };
+
+  if (threadCount == 0)
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, snapshots));
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < threadCount; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads)
+    thread.join();
+
+  auto failed = std::find_if(errors.begin(), errors.end(),
+    [](ASerializeLoader::TLoadError error) { return error != ASerializeLoader::LOAD_OK; });
+  if (exception || failed != errors.end())
+    registry.GetStorage().resize(offsets[0] + 1);
+
+  if (exception)
+    std::rethrow_exception(exception);
+  return failed != errors.end() ? *failed : ASerializeLoader::LOAD_OK;
+  }
@@ -13,8 +13,10 @@
 #include <serialize3/h/client_code/serialize_macros.h>
 #include <serialize3/h/client_code/serialize_utils.h>
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <mutex>
 #include <vector>
 
 #ifndef OWNER_API
@@ -55,26 +57,153 @@ class OWNER_API_UNIXONLY TPtrHelper<TSingleRefPtr<T> >
   };
 
 
+/// Appends object to registry storage and returns its index.
+template <class TStored, class TAlloc>
+size_t AppendToStorage(std::vector<TStored, TAlloc>& storage, const TStored& object)
+  {
+  storage.push_back(object);
+  return storage.size() - 1;
+  }
+
+/** Swizzling support of TSerializePtrWrapper with SWIZZLED parameter: wrapper keeps also direct
+    pointer to referenced object, which is resolved once (by Swizzle or during load if registry
+    has SetSwizzleOnLoad) and used by dereferences instead of registry lookup. Handle is kept
+    for dump. Pointer remembers swizzle generation of registry type and it is dropped when
+    objects of some registry of the type may have moved (storage reallocated, Compact, Clear,
+    released handle, storage got for change by GetStorage), wrapper then falls back to lookup.
+*/
+template <class TRegistry, class TPtrType, bool SWIZZLED>
+class TSwizzledPointer
+  {
+  protected:
+    TSwizzledPointer() : Pointer(NULL), Generation(0) {}
+
+    TPtrType GetSwizzled() const
+      {
+      return Generation == TRegistry::GetSwizzleGeneration() ? Pointer : NULL;
+      }
+
+    void SetSwizzled(TPtrType pointer)
+      {
+      Pointer = pointer;
+      Generation = TRegistry::GetSwizzleGeneration();
+      }
+
+  private:
+    TPtrType Pointer;
+    size_t   Generation; //swizzle generation of registry type when Pointer was resolved
+  };
+
+/// Wrappers which are not swizzled keep only handle.
+template <class TRegistry, class TPtrType>
+class TSwizzledPointer<TRegistry, TPtrType, false>
+  {
+  protected:
+    TPtrType GetSwizzled() const
+      {
+      return NULL;
+      }
+
+    void SetSwizzled(TPtrType)
+      {
+      }
+  };
+
+/// Registry bound to current thread by TSerializedObjectRegistry::TContext.
+template <class TRegistry>
+struct TRegistryContext
+  {
+  TRegistry*    Registry;
+  const size_t* LoadOffset; //overrides load offset of Registry in current thread if not NULL
+  };
+
+template <class TRegistry>
+TRegistryContext<TRegistry>& GetRegistryContext()
+  {
+#if defined(__GNUC__)
+# pragma GCC visibility push(default)
+#endif
+  static thread_local TRegistryContext<TRegistry> Context = { NULL, NULL };
+#if defined(__GNUC__)
+#pragma GCC visibility pop
+#endif
+  return Context;
+  }
+
 /** To simplify serialization pointers to some object will be stored and
     registered here. Referencing members will contain THandle instead which is
     a primitive type.
     DLN Note: Objects as well as object pointers can be stored in the
     registry's vector. The type stored is generally dictated by TSerializePtrWrapper::TStoredType
     trait. TPtrHelper is used to convert any internally stored objects to pointers to those objects.
+    Storage can be replaced by TSegmentedStorage (see serialize_segmentedstorage.h) to keep
+    addresses of stored objects stable and to append concurrently.
+    Registry is either global instance of process (default) or context registry, which is used
+    only by threads it is bound to by TContext. Threads can so load independent snapshots
+    at the same time, each into its own context registry:
+      TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+      TRegistry::TContext context(registry);
+      loader & registry;
+      loader & data; //handles of data are resolved by registry while context exists
 */
-template <class TStored>
+template <class TStored, class TStorageCntr = std::vector<TStored> >
 class OWNER_API TSerializedObjectRegistry
   {
   public:
-    typedef TStored                            TStoredType; //trait for outside use    
-    typedef size_t                             THandle;     //index into registry
-    typedef TSerializedObjectRegistry<TStored> TRegistry;   //short alias for this class
-    typedef std::vector<TStored>               TStorage;    //storage for registered objects
+    typedef TStored                                          TStoredType; //trait for outside use    
+    typedef size_t                                           THandle;     //index into registry
+    typedef TSerializedObjectRegistry<TStored, TStorageCntr> TRegistry;   //short alias for this class
+    typedef TStorageCntr                                     TStorage;    //storage for registered objects
 
     typedef typename TPtrHelper<TStored>::TPtrType TPtrType; //pointer to "stored" object
+    typedef std::vector<THandle> THandleMap; //new handles indexed by old ones, 0 for released
 
+    enum TInstanceKind
+      {
+      GLOBAL_INSTANCE, //registry becomes global instance of process
+      CONTEXT_INSTANCE //registry is used only within TContext
+      };
+
+    /** Binds registry to current thread till end of scope, GetInstance returns it instead
+        of global instance. Contexts can be nested, previous one is restored in destructor.
+    */
+    class TContext
+      {
+      public:
+        explicit TContext(TRegistry& registry) : Previous(GetRegistryContext<TRegistry>()), LoadOffset(0)
+          {
+          TRegistryContext<TRegistry> context = { &registry, NULL };
+          GetRegistryContext<TRegistry>() = context;
+          }
+
+        /// Handles loaded by current thread are rebased by loadOffset instead of registry load offset.
+        TContext(TRegistry& registry, THandle loadOffset) : Previous(GetRegistryContext<TRegistry>()),
+          LoadOffset(loadOffset)
+          {
+          TRegistryContext<TRegistry> context = { &registry, &LoadOffset };
+          GetRegistryContext<TRegistry>() = context;
+          }
+
+        ~TContext()
+          {
+          GetRegistryContext<TRegistry>() = Previous;
+          }
+
+        TContext(const TContext&) = delete;
+        TContext& operator=(const TContext&) = delete;
+
+      private:
+        TRegistryContext<TRegistry> Previous;
+        THandle                     LoadOffset;
+      };
+
+    /// Returns registry bound to current thread or global instance if there is none.
     static TRegistry* GetInstance()
       {
+      TRegistry* context = GetRegistryContext<TRegistry>().Registry;
+      if(context != NULL)
+        return context;
+
       TRegistry** instancePlace = GetInstancePlace();
       return *instancePlace;
       }
@@ -89,24 +218,35 @@ class OWNER_API TSerializedObjectRegistry
       return oldInstance;
       }
 
-    TSerializedObjectRegistry() :
-      Storage(1), HandleOffset(0)
+    explicit TSerializedObjectRegistry(TInstanceKind kind = GLOBAL_INSTANCE) :
+      Storage(1), HasFreeHandles(false), HandleOffset(0), Global(kind == GLOBAL_INSTANCE),
+      SwizzleOnLoad(false), DumpedCount(0)
       {
-      TRegistry** instancePlace = GetInstancePlace();
-      *instancePlace = this;
+      if(Global)
+        {
+        TRegistry** instancePlace = GetInstancePlace();
+        *instancePlace = this;
+        }
       }
 
     /// Destructor must be public because of serialize purposes.
     virtual ~TSerializedObjectRegistry()
       {
-      TRegistry** instancePlace = GetInstancePlace();
-      assert(*instancePlace == NULL || *instancePlace == this);
-      *instancePlace = NULL;
+      assert(GetRegistryContext<TRegistry>().Registry != this);
+      if(Global)
+        {
+        TRegistry** instancePlace = GetInstancePlace();
+        assert(*instancePlace == NULL || *instancePlace == this);
+        *instancePlace = NULL;
+        }
       }
 
-    /// Returns a handle being associated with next registered object.
+    /** Returns a handle being associated with next registered object. If objects are added
+        concurrently, the handle may be taken by other thread.
+    */
     THandle GetNextHandle() const
       {
+      std::lock_guard<std::mutex> lock(FreeHandlesLock);
       if(FreeHandles.empty())
         return Storage.size();
       else
@@ -116,25 +256,42 @@ class OWNER_API TSerializedObjectRegistry
     void    ReleaseHandle(THandle h)
       {
       Storage[h] = TStored();
+      InvalidateSwizzled();
+      std::lock_guard<std::mutex> lock(FreeHandlesLock);
       FreeHandles.push_back(h);
+      HasFreeHandles.store(true, std::memory_order_release);
       }
 
+    /** Can be called concurrently with other AddToRegistry and ReleaseHandle calls if storage
+        is TSegmentedStorage. Released handles are reused under lock, otherwise object is
+        appended lock-free.
+    */
     THandle AddToRegistry(const TStored& object)
       {
-      THandle handle = 0;
-
-      if(FreeHandles.empty())
-        {
-        handle = Storage.size();
-        Storage.push_back(object);
-        }
-      else
+      if(HasFreeHandles.load(std::memory_order_acquire))
         {
-        handle = FreeHandles.back();
-        Storage[handle] = object;
-        FreeHandles.pop_back();
+        THandle handle = 0;
+          {
+          std::lock_guard<std::mutex> lock(FreeHandlesLock);
+          if(FreeHandles.empty() == false)
+            {
+            handle = FreeHandles.back();
+            FreeHandles.pop_back();
+            HasFreeHandles.store(FreeHandles.empty() == false, std::memory_order_release);
+            }
+          }
+
+        if(handle != 0)
+          {
+          Storage[handle] = object;
+          return handle;
+          }
         }
 
+      const TStored* first = &Storage[0];
+      THandle handle = AppendToStorage(Storage, object);
+      if(&Storage[0] != first)
+        InvalidateSwizzled(); //storage was reallocated
       return handle;
       }
 
@@ -148,13 +305,70 @@ class OWNER_API TSerializedObjectRegistry
     /// Clears all registered objects (but don't frees memory of the objects !!!).
     void Clear()
       {
-      Storage.clear();
-      Storage = TStorage(1);
+      TStorage(1).swap(Storage);
+      InvalidateSwizzled();
+      FreeHandles.clear();
+      HasFreeHandles.store(false, std::memory_order_release);
+      DumpHandles.clear();
+      }
+
+    /** Moves registered objects over released handles (keeping their order) and shrinks storage.
+        Returns new handles of objects, handles referencing the registry must be remapped by them
+        (see CompactRegistry in visitortemplates.h).
+    */
+    THandleMap Compact()
+      {
+      size_t count = 0;
+      THandleMap handles(GetCompactHandles(count));
+
+      for (THandle h = 1; h < handles.size(); ++h)
+        {
+        if (handles[h] != 0 && handles[h] != h)
+          Storage[handles[h]] = std::move(Storage[h]);
+        }
+
+      Storage.resize(count + 1);
+      InvalidateSwizzled();
       FreeHandles.clear();
+      HasFreeHandles.store(false, std::memory_order_release);
+      DumpHandles.clear();
+
+      return handles;
+      }
+
+    /** Registry and wrappers dumped after it are dumped like after Compact - objects of released
+        handles are dropped and handles are remapped. Registry must not change while it is set.
+    */
+    void SetCompactDump(bool compactDump)
+      {
+      DumpHandles.clear();
+      if (compactDump)
+        DumpHandles = GetCompactHandles(DumpedCount);
+      }
+
+    bool IsCompactDump() const
+      {
+      return DumpHandles.empty() == false;
+      }
+
+    /// Handle written by dump (0 for released object of compact dump).
+    THandle GetDumpHandle(THandle handle) const
+      {
+      return handle < DumpHandles.size() ? DumpHandles[handle] : handle;
+      }
+
+    /// Number of objects written by dump.
+    size_t GetDumpedCount() const
+      {
+      return IsCompactDump() ? DumpedCount : Storage.size() - 1;
       }
 
     THandle GetLoadOffset() const
       {
+      const TRegistryContext<TRegistry>& context = GetRegistryContext<TRegistry>();
+      if(context.Registry == this && context.LoadOffset != NULL)
+        return *context.LoadOffset;
+
       return HandleOffset;
       }
 
@@ -163,8 +377,21 @@ class OWNER_API TSerializedObjectRegistry
       HandleOffset = offset;
       }
 
+    /// Loaded SWIZZLED wrappers resolve pointers, registry must be loaded before them (see TSwizzledPointer).
+    bool IsSwizzleOnLoad() const
+      {
+      return SwizzleOnLoad;
+      }
+
+    void SetSwizzleOnLoad(bool swizzleOnLoad)
+      {
+      SwizzleOnLoad = swizzleOnLoad;
+      }
+
+    /// Storage may be changed by caller, so pointers of swizzled wrappers are dropped.
     TStorage& GetStorage()
       {
+      InvalidateSwizzled();
       return Storage;
       }
 
@@ -173,7 +400,36 @@ class OWNER_API TSerializedObjectRegistry
       return Storage;
       }
 
+    /// Changes whenever objects of some registry of this type may have moved.
+    static size_t GetSwizzleGeneration()
+      {
+      return GetSwizzleGenerationPlace().load(std::memory_order_relaxed);
+      }
+
+    /// Drops pointers of swizzled wrappers (f.e. when storage reference is kept and changed).
+    static void InvalidateSwizzled()
+      {
+      GetSwizzleGenerationPlace().fetch_add(1, std::memory_order_relaxed);
+      }
+
   protected:
+    THandleMap GetCompactHandles(size_t& count) const
+      {
+      THandleMap handles(Storage.size(), 1);
+      handles[0] = 0;
+      for (THandle h : FreeHandles)
+        handles[h] = 0;
+
+      count = 0;
+      for (THandle h = 1; h < handles.size(); ++h)
+        {
+        if (handles[h] != 0)
+          handles[h] = ++count;
+        }
+
+      return handles;
+      }
+
     static TRegistry** GetInstancePlace()
       {
 #if defined(__GNUC__)
@@ -186,13 +442,31 @@ class OWNER_API TSerializedObjectRegistry
       return &Instance;
       }
 
+    static std::atomic<size_t>& GetSwizzleGenerationPlace()
+      {
+#if defined(__GNUC__)
+# pragma GCC visibility push(default)
+#endif
+      static std::atomic<size_t> Generation(0);
+#if defined(__GNUC__)
+#pragma GCC visibility pop
+#endif
+      return Generation;
+      }
+
   /// Class attributes:
   private:
     typedef std::vector<THandle> THandleContainer;
 
-    TStorage         Storage;
-    THandleContainer FreeHandles;
-    THandle          HandleOffset;
+    TStorage           Storage;
+    THandleContainer   FreeHandles;
+    mutable std::mutex FreeHandlesLock; //guards FreeHandles against concurrent AddToRegistry
+    std::atomic<bool>  HasFreeHandles;  //checked without lock
+    THandle            HandleOffset;
+    bool               Global;
+    bool               SwizzleOnLoad;
+    THandleMap         DumpHandles; //handles of compact dump
+    size_t             DumpedCount; //objects of compact dump
   }; //TSerializedObjectRegistry
 
 /// Base class for TSerializePtrWrapper template class.
@@ -221,9 +495,11 @@ class OWNER_API APtrWrapper
     THandle Handle;
   };
 
+/// SWIZZLED wrappers keep also resolved pointer (see TSwizzledPointer), other ones only handle.
 template <class TType, class TStorageType,
-          class TRegistryType = TSerializedObjectRegistry<TStorageType> >
-class OWNER_API_UNIXONLY TSerializePtrWrapper : public APtrWrapper
+          class TRegistryType = TSerializedObjectRegistry<TStorageType>, bool SWIZZLED = false>
+class OWNER_API_UNIXONLY TSerializePtrWrapper : public APtrWrapper,
+  public TSwizzledPointer<TRegistryType, typename TPtrHelper<TType>::TPtrType, SWIZZLED>
   {
   public:
     typedef typename TPtrHelper<TType>::TPtrType   TPtrType;
@@ -231,22 +507,22 @@ class OWNER_API_UNIXONLY TSerializePtrWrapper : public APtrWrapper
     typedef TRegistryType                          TRegistry;
     typedef typename TRegistry::THandle            THandle;
 
-    static TSerializePtrWrapper<TType, TStorageType, TRegistryType> WrapNewObject(
+    static TSerializePtrWrapper<TType, TStorageType, TRegistryType, SWIZZLED> WrapNewObject(
       const TStoredType& object)
       {
       TRegistry* registry = GetRegistry();
       THandle handle = registry->AddToRegistry(object);
-      TSerializePtrWrapper<TType, TStorageType, TRegistryType> retVal;
+      TSerializePtrWrapper<TType, TStorageType, TRegistryType, SWIZZLED> retVal;
       retVal.SetHandle(handle);
       return retVal;
       }
 
-    static const TSerializePtrWrapper<TType, TStorageType, TRegistryType>& Null()
+    static const TSerializePtrWrapper<TType, TStorageType, TRegistryType, SWIZZLED>& Null()
       {
 #if defined(__GNUC__)
 # pragma GCC visibility push(default)
 #endif
-      static TSerializePtrWrapper<TType, TStorageType, TRegistryType> null;
+      static TSerializePtrWrapper<TType, TStorageType, TRegistryType, SWIZZLED> null;
 #if defined(__GNUC__)      
 #pragma GCC visibility pop
 #endif
@@ -263,6 +539,7 @@ class OWNER_API_UNIXONLY TSerializePtrWrapper : public APtrWrapper
     void     SetHandle(THandle h)
       {
       this->Handle = h;
+      this->SetSwizzled(NULL);
 #ifdef SERIALIZED_PTR_DEBUG
       Object = GetPointedObject();
 #endif
@@ -273,6 +550,24 @@ class OWNER_API_UNIXONLY TSerializePtrWrapper : public APtrWrapper
       return this->Handle;
       }
 
+    /// Resolves handle to direct pointer used by next dereferences (does nothing if not SWIZZLED).
+    void     Swizzle()
+      {
+      this->SetSwizzled(NULL);
+      this->SetSwizzled(GetPointedObject());
+      }
+
+    /// Returns to registry lookup.
+    void     Unswizzle()
+      {
+      this->SetSwizzled(NULL);
+      }
+
+    bool     IsSwizzled() const
+      {
+      return this->GetSwizzled() != NULL;
+      }
+
     const TPtrType operator -> () const
       {
       return GetPointedObject();
@@ -294,10 +589,12 @@ class OWNER_API_UNIXONLY TSerializePtrWrapper : public APtrWrapper
       }
 
     template <class TTarget>
-    operator TSerializePtrWrapper<TTarget, TStorageType, TRegistryType>() const
+    operator TSerializePtrWrapper<TTarget, TStorageType, TRegistryType, SWIZZLED>() const
       {
-      TSerializePtrWrapper<TTarget, TStorageType, TRegistryType> retVal;
+      TSerializePtrWrapper<TTarget, TStorageType, TRegistryType, SWIZZLED> retVal;
       retVal.SetHandle(GetHandle());
+      if(IsSwizzled())
+        retVal.Swizzle();
 
       /// \warning TType must be convertable to TTarget type.
       assert(static_cast<const TTarget*>(retVal.GetPointedObject()) == GetPointedObject());
@@ -305,16 +602,39 @@ class OWNER_API_UNIXONLY TSerializePtrWrapper : public APtrWrapper
       return retVal;
       }
 
-    void Load(ASerializeLoader& loader)
+    void Dump(ASerializeDumper& dumper) const
+      {
+      const TRegistryType* registry = TRegistryType::GetInstance();
+      if(this->Handle == 0 || registry == NULL || registry->IsCompactDump() == false)
+        {
+        APtrWrapper::Dump(dumper);
+        return;
+        }
+
+      APtrWrapper remapped(*this);
+      remapped = registry->GetDumpHandle(this->Handle);
+      remapped.Dump(dumper);
+      }
+
+    void Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
       {
       APtrWrapper::Load(loader);
+      this->SetSwizzled(NULL);
       if(this->Handle != 0)
-        this->Handle += GetRegistry()->GetLoadOffset();
+        {
+        const TRegistryType* registry = GetRegistry();
+        this->Handle += registry->GetLoadOffset();
+        if(SWIZZLED && registry->IsSwizzleOnLoad() && this->Handle < registry->GetStorage().size())
+          this->SetSwizzled(GetPointedObject());
+        }
       }
 
   protected:
     TPtrType GetPointedObject() const
       {
+      TPtrType swizzled = this->GetSwizzled();
+      if(swizzled != NULL)
+        return swizzled;
       /** Put Object updating also here, to simplify debugging runtime code.
           It helps to solve this problem after loading serialized data (Object
           cannot be updated just after reading a handle from serialization
@@ -0,0 +1,428 @@
+/**\file serialize_pushloader.h
+
+    Resumable loading of data arriving in chunks (f.e. from pipe or socket). Input is pushed
+    into loader, which decodes it as far as possible and reports whether it needs more input
+    or it has finished, so one thread can decode many streams without blocking in ReadBuffer.
+
+    Stream is loaded by single loader running in coroutine with its own stack. When read
+    needs more input than was pushed, coroutine is suspended and Push returns; next Push
+    resumes it exactly where it stopped. So items are never loaded twice, objects loaded
+    via pointers are kept, and encodings set on GetLoader (including string dictionary) apply
+    to the whole stream.
+
+    Exceptions thrown by loading are rethrown from Push. Push loader destroyed before the end
+    of stream finishes loading with LOAD_TRUNCATED_INPUT, so loaded objects are released.
+
+    \warning Loader must be pushed to by one thread at a time, loading runs on coroutine stack
+             (see PUSH_LOAD_STACK_SIZE), which must hold objects loaded as local variables.
+             Stack is followed by guard page, so its overflow crashes instead of overwriting
+             other memory.
+*/
+#pragma once
+
+#include <serialize3/h/client_code/serialize_cursor.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <ucontext.h>
+  #include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// Base class of push loaders, buffers input and runs LoadStream in coroutine.
+class APushLoader
+  {
+  public:
+    enum TStatus
+      {
+      PUSH_LOAD_NEED_MORE,
+      PUSH_LOAD_DONE,
+      PUSH_LOAD_FAILED //see GetError
+      };
+
+    static const size_t PUSH_LOAD_STACK_SIZE = 1 << 20;
+
+    /// Appends chunk of input and loads as much as possible.
+    TStatus Push(const unsigned char* data, size_t length)
+      {
+      Buffer.insert(Buffer.end(), data, data + length);
+      if (Status == PUSH_LOAD_NEED_MORE)
+        {
+        Resume();
+        if (Exception)
+          std::rethrow_exception(std::exchange(Exception, nullptr));
+        }
+
+      //drop consumed input when it is the bigger part of buffer
+      if (Status == PUSH_LOAD_NEED_MORE && Consumed * 2 >= Buffer.size())
+        {
+        Buffer.erase(Buffer.begin(), Buffer.begin() + Consumed);
+        Consumed = 0;
+        }
+      return Status;
+      }
+
+    TStatus GetStatus() const { return Status; }
+    ASerializeLoader::TLoadError GetError() const { return Loader.GetError(); }
+
+    /** Loader of the stream, its encodings (see ASerializeLoader) may be set before first
+        Push.
+    */
+    ASerializeLoader& GetLoader() { return Loader; }
+
+    /// Maximal accepted length of loaded strings and containers (see ASerializeLoader).
+    void SetLengthLimit(size_t lengthLimit) { Loader.SetLengthLimit(lengthLimit); }
+
+    /// Input pushed behind the end of loaded data (f.e. beginning of next message).
+    const unsigned char* GetUnconsumedData() const { return Buffer.data() + Consumed; }
+    size_t               GetUnconsumedSize() const { return Buffer.size() - Consumed; }
+
+  protected:
+    explicit APushLoader(size_t stackSize = PUSH_LOAD_STACK_SIZE) : Status(PUSH_LOAD_NEED_MORE),
+      Loader(*this), Consumed(0), StackSize(stackSize), Started(false), Finished(false),
+      Cancelled(false)
+#if defined(_WIN32)
+      , LoaderFiber(nullptr), CallerFiber(nullptr)
+#else
+      , Stack(nullptr), StackMapSize(0)
+#endif
+      {}
+
+    virtual ~APushLoader()
+      {
+      Cancel();
+#if defined(_WIN32)
+      if (LoaderFiber != nullptr)
+        DeleteFiber(LoaderFiber);
+#else
+      if (Stack != nullptr)
+        munmap(Stack, StackMapSize);
+#endif
+      }
+
+    /// Loads whole stream, reads of loader wait for pushed input.
+    virtual void LoadStream(ASerializeLoader& loader) = 0;
+
+    /** Finishes suspended loading with LOAD_TRUNCATED_INPUT. Called by destructors of
+        derived classes, because LoadStream may use their members.
+    */
+    void Cancel()
+      {
+      if (Started && Finished == false)
+        {
+        Cancelled = true;
+        Resume();
+        }
+      }
+
+  private:
+    //---------- TStreamLoader
+    //Reads pushed input, suspends coroutine till there is enough of it.
+    class TStreamLoader : public ASerializeLoader
+      {
+      public:
+        explicit TStreamLoader(APushLoader& owner) : Owner(owner) {}
+
+      /// ASerializeLoader reimplementation:
+        virtual void Log(const char* msg) override
+          {
+          std::cout << std::setw(10);
+          std::cout << Owner.Consumed << " ";
+          for (int i = IndentLevel; i > 0; --i)
+            std::cout << " ";
+          std::cout << msg << std::endl;
+          }
+
+        virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+          {
+          size_t readLen = Owner.WaitForInput(bufferLen);
+          memcpy(buffer, Owner.GetUnconsumedData(), readLen);
+          Owner.Consumed += readLen;
+          if (readLen != bufferLen)
+            {
+            SetError(LOAD_TRUNCATED_INPUT);
+            memset(buffer + readLen, 0, bufferLen - readLen);
+            }
+          }
+
+        virtual const unsigned char* AcquireBuffer(size_t bufferLen) override
+          {
+          //pushed input is not moved before next read
+          if (Owner.WaitForInput(bufferLen) != bufferLen)
+            return ASerializeLoader::AcquireBuffer(bufferLen);
+
+          const unsigned char* buffer = Owner.GetUnconsumedData();
+          Owner.Consumed += bufferLen;
+          return buffer;
+          }
+
+      /// Class attributes:
+      private:
+        APushLoader& Owner;
+      }; //TStreamLoader
+
+    /// Suspends coroutine till length bytes are pushed, returns available part of them.
+    size_t WaitForInput(size_t length)
+      {
+      while (GetUnconsumedSize() < length && Cancelled == false)
+        Suspend();
+      return GetUnconsumedSize() < length ? GetUnconsumedSize() : length;
+      }
+
+    /// Body of coroutine.
+    void Run()
+      {
+      try
+        {
+        LoadStream(Loader);
+        Status = Loader.HasError() ? PUSH_LOAD_FAILED : PUSH_LOAD_DONE;
+        }
+      catch (...)
+        {
+        Exception = std::current_exception();
+        Status = PUSH_LOAD_FAILED;
+        }
+      Finished = true;
+      }
+
+#if defined(_WIN32)
+    static void CALLBACK FiberEntry(void* self)
+      {
+      static_cast<APushLoader*>(self)->Run();
+      //finished fiber is never resumed
+      SwitchToFiber(static_cast<APushLoader*>(self)->CallerFiber);
+      }
+
+    /// Runs coroutine till it is suspended or finished.
+    void Resume()
+      {
+      if (Started == false)
+        {
+        LoaderFiber = CreateFiber(StackSize, &FiberEntry, this);
+        if (LoaderFiber == nullptr)
+          {
+          Exception = std::make_exception_ptr(std::bad_alloc());
+          Status = PUSH_LOAD_FAILED;
+          Finished = true;
+          return;
+          }
+        Started = true;
+        }
+
+      bool converted = IsThreadAFiber() == FALSE;
+      CallerFiber = converted ? ConvertThreadToFiber(nullptr) : GetCurrentFiber();
+      SwitchToFiber(LoaderFiber);
+      if (converted)
+        ConvertFiberToThread();
+      }
+
+    void Suspend()
+      {
+      SwitchToFiber(CallerFiber);
+      }
+#else
+    //makecontext passes only int arguments
+    static void ContextEntry(unsigned high, unsigned low)
+      {
+      uintptr_t self = static_cast<uintptr_t>(high) << 16 << 16 | low;
+      reinterpret_cast<APushLoader*>(self)->Run();
+      //returns to CallerContext by uc_link
+      }
+
+    /// Runs coroutine till it is suspended or finished.
+    void Resume()
+      {
+      if (Started == false)
+        {
+        //stack grows down to inaccessible guard page (CreateFiber adds it on Windows)
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t mapSize = (StackSize + page - 1) / page * page + page;
+        void* stack = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (stack == MAP_FAILED)
+          {
+          Exception = std::make_exception_ptr(std::bad_alloc());
+          Status = PUSH_LOAD_FAILED;
+          Finished = true;
+          return;
+          }
+        Stack = stack;
+        StackMapSize = mapSize;
+        mprotect(Stack, page, PROT_NONE);
+
+        getcontext(&LoaderContext);
+        LoaderContext.uc_stack.ss_sp = static_cast<char*>(Stack) + page;
+        LoaderContext.uc_stack.ss_size = mapSize - page;
+        LoaderContext.uc_link = &CallerContext;
+        uintptr_t self = reinterpret_cast<uintptr_t>(this);
+        makecontext(&LoaderContext, reinterpret_cast<void (*)()>(&ContextEntry), 2,
+          static_cast<unsigned>(self >> 16 >> 16), static_cast<unsigned>(self));
+        Started = true;
+        }
+
+      swapcontext(&CallerContext, &LoaderContext);
+      }
+
+    void Suspend()
+      {
+      swapcontext(&LoaderContext, &CallerContext);
+      }
+#endif
+
+  /// Class attributes:
+  private:
+    TStatus                    Status;
+    TStreamLoader              Loader;
+    std::vector<unsigned char> Buffer;
+    size_t                     Consumed;  //size of loaded part of Buffer
+    std::exception_ptr         Exception; //thrown by LoadStream, rethrown by Push
+    size_t                     StackSize;
+    bool                       Started;
+    bool                       Finished;
+    bool                       Cancelled; //reads fail instead of waiting for input
+
+#if defined(_WIN32)
+    void* LoaderFiber;
+    void* CallerFiber;
+#else
+    void*      Stack;        //mapped stack of coroutine, starts with guard page
+    size_t     StackMapSize;
+    ucontext_t LoaderContext;
+    ucontext_t CallerContext;
+#endif
+  };
+
+//Type of temporary item loaded from stream (keys of maps are const in value_type)
+template <typename TValue>
+struct push_loaded_value
+  {
+  typedef TValue type;
+  };
+
+template <typename TKey, typename TValue>
+struct push_loaded_value<std::pair<const TKey, TValue>>
+  {
+  typedef std::pair<TKey, TValue> type;
+  };
+
+/// Loads single object, it is assigned only after it was completely loaded.
+template <class TObject>
+class TObjectPushLoader : public APushLoader
+  {
+  public:
+    explicit TObjectPushLoader(TObject& object) : Object(object) {}
+
+    ~TObjectPushLoader()
+      {
+      Cancel();
+      }
+
+  protected:
+    virtual void LoadStream(ASerializeLoader& loader) override
+      {
+      TObject object;
+      loader & object;
+      if (loader.HasError() == false)
+        Object = std::move(object);
+      }
+
+  /// Class attributes:
+  private:
+    TObject& Object;
+  };
+
+/** Loads container dumped by dumpertemplates as size followed by elements, elements are
+    appended to the container one by one as they arrive. Containers encoded as a whole
+    (see encodings of ASerializeLoader and IsElementStreamed) fail with LOAD_BAD_ENCODING.
+*/
+template <class TCntr>
+class TContainerPushLoader : public APushLoader
+  {
+  public:
+    typedef typename push_loaded_value<typename TCntr::value_type>::type TValue;
+
+    explicit TContainerPushLoader(TCntr& c) : Container(c), ItemsLeft(0) {}
+
+    ~TContainerPushLoader()
+      {
+      Cancel();
+      }
+
+    /// Number of elements still to be loaded (valid when size was loaded).
+    size_t GetItemsLeft() const
+      {
+      return ItemsLeft;
+      }
+
+  protected:
+    virtual void LoadStream(ASerializeLoader& loader) override
+      {
+      if (IsStreamed(loader) == false)
+        {
+        loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+        return;
+        }
+
+      loader.LoadLength(ItemsLeft);
+      for (; ItemsLeft != 0 && loader.HasError() == false; --ItemsLeft)
+        {
+        TValue value;
+        loader & value;
+        if (loader.HasError())
+          break;
+
+        Container.insert(Container.end(), std::move(value));
+        OnInserted();
+        }
+      }
+
+    /// Checks if container is dumped element by element with encodings of loader.
+    virtual bool IsStreamed(const ASerializeLoader& loader) const
+      {
+      return IsElementStreamed(loader, static_cast<const TCntr*>(nullptr));
+      }
+
+    /// Called after each element is appended.
+    virtual void OnInserted() {}
+
+  /// Class attributes:
+  private:
+    TCntr& Container;
+    size_t ItemsLeft;
+  };
+
+/// Loads registry elements as they arrive (appended like by operator& of loadertemplates).
+template <class TStored, class TStorageCntr = std::vector<TStored> >
+class TRegistryPushLoader : public TContainerPushLoader<TStorageCntr>
+  {
+  public:
+    typedef TStorageCntr TStorage;
+
+    typedef TSerializedObjectRegistry<TStored, TStorageCntr> TRegistry;
+
+    explicit TRegistryPushLoader(TRegistry& registry) :
+      TContainerPushLoader<TStorage>(registry.GetStorage()) {}
+
+  protected:
+    /// Registry is dumped object by object with any encodings.
+    virtual bool IsStreamed(const ASerializeLoader&) const override
+      {
+      return true;
+      }
+
+    /// Appended element may reallocate storage kept by this loader.
+    virtual void OnInserted() override
+      {
+      TRegistry::InvalidateSwizzled();
+      }
+  };
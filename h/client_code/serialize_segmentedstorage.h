@@ -0,0 +1,280 @@
+/**\file serialize_segmentedstorage.h
+
+    Segmented storage for TSerializedObjectRegistry with stable addresses of stored objects:
+      typedef TSerializedObjectRegistry<TStored, TSegmentedStorage<TStored>> TRegistry;
+
+    Objects are kept in segments of growing size (each next segment is twice bigger), segments
+    are never moved, so growing the storage during load doesn't copy already loaded objects
+    and references to them stay valid. Directory of segments has fixed size, so:
+    - push_back (AddToRegistry) may be called from several threads, it reserves index,
+      allocates segment and assigns element lock-free, then marks it ready. size() covers only
+      ready elements, it is advanced over them by whichever append finds them, so appends don't
+      wait for each other and size() never covers element which is still being assigned,
+    - operator[] (GetRegisteredObject) is wait-free and may be called concurrently with appends
+      for any index below size() or returned by push_back (f.e. from loaded TSerializePtrWrapper).
+    Other methods (resize, clear, swap) must not be called concurrently with any other one.
+
+    \warning Elements are default constructed per whole segment, T must be default constructible.
+*/
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// Iterator over TSegmentedStorage (TValue is const for const_iterator).
+template <class TValue, class TOwner>
+class TSegmentedIterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_const<TValue>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef TValue* pointer;
+    typedef TValue& reference;
+
+    TSegmentedIterator(TOwner* owner, size_t index) : Owner(owner), Index(index) {}
+
+    /// Conversion of iterator to const_iterator.
+    template <class TOtherValue, class TOtherOwner>
+    TSegmentedIterator(const TSegmentedIterator<TOtherValue, TOtherOwner>& other) :
+      Owner(other.GetOwner()), Index(other.GetIndex()) {}
+
+    TValue& operator*() const { return (*Owner)[Index]; }
+    TValue* operator->() const { return &(*Owner)[Index]; }
+
+    TSegmentedIterator& operator++() { ++Index; return *this; }
+    TSegmentedIterator operator++(int) { TSegmentedIterator result(*this); ++Index; return result; }
+
+    difference_type operator-(const TSegmentedIterator& other) const
+      {
+      return static_cast<difference_type>(Index) - static_cast<difference_type>(other.Index);
+      }
+
+    bool operator==(const TSegmentedIterator& other) const { return Index == other.Index; }
+    bool operator!=(const TSegmentedIterator& other) const { return Index != other.Index; }
+
+    TOwner* GetOwner() const { return Owner; }
+    size_t  GetIndex() const { return Index; }
+
+  private:
+    TOwner* Owner;
+    size_t  Index;
+  };
+
+template <class T, size_t FIRST_SEGMENT_SIZE = 1024>
+class TSegmentedStorage
+  {
+  public:
+    static_assert((FIRST_SEGMENT_SIZE & (FIRST_SEGMENT_SIZE - 1)) == 0 && FIRST_SEGMENT_SIZE != 0,
+                  "Segment size must be power of 2");
+
+    typedef T                                                    value_type;
+    typedef size_t                                               size_type;
+    typedef TSegmentedIterator<T, TSegmentedStorage>             iterator;
+    typedef TSegmentedIterator<const T, const TSegmentedStorage> const_iterator;
+
+    explicit TSegmentedStorage(size_t size = 0) : Reserved(0), Size(0)
+      {
+      for (auto& segment : Segments)
+        segment.store(nullptr, std::memory_order_relaxed);
+      resize(size);
+      }
+
+    ~TSegmentedStorage()
+      {
+      clear();
+      }
+
+    TSegmentedStorage(const TSegmentedStorage&) = delete;
+    TSegmentedStorage& operator=(const TSegmentedStorage&) = delete;
+
+    size_t size() const { return Size.load(std::memory_order_acquire); }
+    bool   empty() const { return size() == 0; }
+
+    T& operator[](size_t index)
+      {
+      return const_cast<T&>(static_cast<const TSegmentedStorage&>(*this)[index]);
+      }
+
+    const T& operator[](size_t index) const
+      {
+      unsigned segment = GetSegmentIndex(index);
+      TSlot* data = Segments[segment].load(std::memory_order_acquire);
+      assert(data != nullptr);
+      return data[index - GetSegmentStart(segment)].Value;
+      }
+
+    /// Appends object and returns its index.
+    size_t push_back(const T& value)
+      {
+      size_t index = Reserved.fetch_add(1, std::memory_order_relaxed);
+      TSlot& slot = GetSlot(index);
+      slot.Value = value;
+      Publish(slot);
+      return index;
+      }
+
+    size_t push_back(T&& value)
+      {
+      size_t index = Reserved.fetch_add(1, std::memory_order_relaxed);
+      TSlot& slot = GetSlot(index);
+      slot.Value = std::move(value);
+      Publish(slot);
+      return index;
+      }
+
+    /// Only appending is supported (used by push loaders).
+    iterator insert(const_iterator position, T&& value)
+      {
+      assert(position.GetIndex() == size());
+      (void)position;
+      return iterator(this, push_back(std::move(value)));
+      }
+
+    void resize(size_t size)
+      {
+      size_t oldSize = Size.load(std::memory_order_relaxed);
+
+      //elements behind new end are reset, so they are default when storage grows again
+      for (size_t i = size; i < oldSize; ++i)
+        {
+        TSlot& slot = GetSlot(i);
+        slot.Value = T();
+        slot.Ready.store(false, std::memory_order_relaxed);
+        }
+      for (size_t i = oldSize; i < size; ++i)
+        GetSlot(i).Ready.store(true, std::memory_order_relaxed);
+
+      Reserved.store(size, std::memory_order_relaxed);
+      Size.store(size, std::memory_order_release);
+      }
+
+    /// Releases all segments.
+    void clear()
+      {
+      for (auto& segment : Segments)
+        delete[] segment.exchange(nullptr, std::memory_order_acq_rel);
+      Reserved.store(0, std::memory_order_relaxed);
+      Size.store(0, std::memory_order_release);
+      }
+
+    void swap(TSegmentedStorage& other)
+      {
+      for (unsigned i = 0; i < MAX_SEGMENTS; ++i)
+        {
+        TSlot* segment = Segments[i].load(std::memory_order_relaxed);
+        Segments[i].store(other.Segments[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.Segments[i].store(segment, std::memory_order_relaxed);
+        }
+
+      size_t size = Size.load(std::memory_order_relaxed);
+      Size.store(other.Size.load(std::memory_order_relaxed), std::memory_order_release);
+      other.Size.store(size, std::memory_order_release);
+      Reserved.store(Size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      other.Reserved.store(size, std::memory_order_relaxed);
+      }
+
+    iterator       begin() { return iterator(this, 0); }
+    iterator       end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+  private:
+    struct TSlot
+      {
+      TSlot() : Value(), Ready(false) {}
+
+      T                 Value;
+      std::atomic<bool> Ready; //assigned by push_back or resize, may be covered by size()
+      };
+
+    //segment i has FIRST_SEGMENT_SIZE << i elements, so directory covers whole address space
+    static const unsigned MAX_SEGMENTS = sizeof(size_t) * CHAR_BIT;
+
+    static unsigned HighestBit(size_t value)
+      {
+#if defined(_MSC_VER)
+      unsigned long index;
+  #if defined(_WIN64)
+      _BitScanReverse64(&index, value);
+  #else
+      _BitScanReverse(&index, value);
+  #endif
+      return static_cast<unsigned>(index);
+#else
+      return static_cast<unsigned>(sizeof(unsigned long long) * CHAR_BIT - 1 -
+        __builtin_clzll(static_cast<unsigned long long>(value)));
+#endif
+      }
+
+    static unsigned GetSegmentIndex(size_t index)
+      {
+      return HighestBit(index / FIRST_SEGMENT_SIZE + 1);
+      }
+
+    static size_t GetSegmentStart(unsigned segment)
+      {
+      return ((static_cast<size_t>(1) << segment) - 1) * FIRST_SEGMENT_SIZE;
+      }
+
+    static size_t GetSegmentSize(unsigned segment)
+      {
+      return FIRST_SEGMENT_SIZE << segment;
+      }
+
+    /** Marks assigned slot ready and advances size() over ready slots. Either this append sees
+        size() reaching its slot, or append which moved size() there sees it ready (both are
+        sequentially consistent), so no ready slot is left behind size().
+    */
+    void Publish(TSlot& slot)
+      {
+      slot.Ready.store(true);
+      size_t size = Size.load();
+      while (size < Reserved.load(std::memory_order_relaxed) && GetSlot(size).Ready.load())
+        {
+        if (Size.compare_exchange_weak(size, size + 1)) //on failure size is reloaded
+          ++size;
+        }
+      }
+
+    /// Returns slot at index, allocates its segment if needed (lock-free).
+    TSlot& GetSlot(size_t index)
+      {
+      unsigned segment = GetSegmentIndex(index);
+      TSlot* data = Segments[segment].load(std::memory_order_acquire);
+
+      if (data == nullptr)
+        {
+        TSlot* created = new TSlot[GetSegmentSize(segment)];
+        if (Segments[segment].compare_exchange_strong(data, created, std::memory_order_acq_rel,
+              std::memory_order_acquire))
+          data = created;
+        else
+          delete[] created; //other thread was faster, data points to its segment
+        }
+
+      return data[index - GetSegmentStart(segment)];
+      }
+
+  /// Class attributes:
+  private:
+    std::atomic<TSlot*> Segments[MAX_SEGMENTS];
+    std::atomic<size_t> Reserved; //indices taken by push_back
+    std::atomic<size_t> Size;     //ready elements before first one which is not, Size <= Reserved
+  }; //TSegmentedStorage
+
+/// Appends object to registry storage without waiting for other appends, returns its index.
+template <class TStored, size_t FIRST_SEGMENT_SIZE>
+size_t AppendToStorage(TSegmentedStorage<TStored, FIRST_SEGMENT_SIZE>& storage, const TStored& object)
+  {
+  return storage.push_back(object);
+  }
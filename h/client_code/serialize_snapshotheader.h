@@ -0,0 +1,236 @@
+/**\file serialize_snapshotheader.h
+
+    Optional header at the beginning of snapshot describing format of following data.
+
+    Snapshot with raw layout stores objects of classes marked by serialized_raw_layout as raw
+    memory (whole object and vectors of them are copied at once). Such data depend on layout
+    of classes, so header contains layout fingerprint computed by generator from sizes, offsets
+    and types of members (<prefix>_LAYOUT_FINGERPRINT in typeids file). Loader enables raw layout
+    if the fingerprint matches. Raw snapshot dumped with <prefix>_SNAPSHOT_LAYOUT contains also
+    offsets and sizes of fields of its classes, binary with different layout loads their objects
+    field by field (see rawlayouttemplates.h). Other raw snapshots with different layout are
+    rejected.
+    Snapshots without raw layout are dumped member by member and can be loaded by any binary.
+    Columnar snapshot stores vectors of classes marked by serialized_columnar column by column
+    (see columntemplates.h), it doesn't depend on layout. Snapshot with packed integers stores
+    vectors, sets and map keys of integers bit-packed or stream-vbyte encoded (see
+    packedtemplates.h). Snapshot with string dictionary stores repeated strings as references
+    to their first occurrence (see stringdictionary.h). Snapshot with front coded strings stores
+    sets and map keys of strings as prefixes shared with previous keys (see
+    frontcodingtemplates.h). Snapshot with XOR floats stores vectors and deques of float and
+    double XOR compressed (see xorfloattemplates.h). Adaptive snapshot samples each large vector
+    of primitive types and stores it by the cheapest encoding (see adaptivetemplates.h).
+
+    Usage:
+      DumpSnapshotHeader(dumper, test_SNAPSHOT_LAYOUT, TSnapshotHeader::SNAPSHOT_RAW_LAYOUT);
+      dumper & data;
+      ...
+      LoadSnapshotHeader(loader, test_LAYOUT_FINGERPRINT);
+      loader & data;
+*/
+#pragma once
+
+#include <serialize3/h/gen_code/rawlayouttemplates.h>
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+#include <serialize3/h/storage/stringdictionary.h>
+
+struct TSnapshotHeader
+  {
+  static const unsigned int   MAGIC = 0x4e533353; //"S3SN"
+  static const unsigned short VERSION = 1;
+
+  enum TFlags
+    {
+    SNAPSHOT_RAW_LAYOUT          = 0x0001, //classes with raw layout are stored as raw memory
+    SNAPSHOT_COLUMNAR            = 0x0002, //vectors of classes with columnar encoding are stored by columns
+    SNAPSHOT_PACKED_INTEGERS     = 0x0004, //vectors, sets and map keys of integers are stored packed
+    SNAPSHOT_STRING_DICTIONARY   = 0x0008, //repeated strings are stored as references
+    SNAPSHOT_FRONT_CODED_STRINGS = 0x0010, //sets and map keys of strings are stored front coded
+    SNAPSHOT_XOR_FLOATS          = 0x0020, //vectors and deques of float and double are XOR compressed
+    SNAPSHOT_ADAPTIVE            = 0x0040, //vectors of primitive types are stored by sampled encoding
+    SNAPSHOT_LAYOUT_DESCRIPTION  = 0x0080, //layouts of classes with raw layout follow the header
+
+    SNAPSHOT_KNOWN_FLAGS         = 0x00ff
+    };
+
+  unsigned int       Magic;
+  unsigned short     Version;
+  unsigned short     Flags;
+  unsigned long long LayoutFingerprint;
+  };
+
+/// Enables encodings of snapshot with the flags in dumper.
+inline void SetSnapshotEncodings(ASerializeDumper& dumper, unsigned short flags)
+  {
+  dumper.SetRawLayout((flags & TSnapshotHeader::SNAPSHOT_RAW_LAYOUT) != 0);
+  dumper.SetColumnar((flags & TSnapshotHeader::SNAPSHOT_COLUMNAR) != 0);
+  dumper.SetPackedIntegers((flags & TSnapshotHeader::SNAPSHOT_PACKED_INTEGERS) != 0);
+  dumper.SetStringDictionary((flags & TSnapshotHeader::SNAPSHOT_STRING_DICTIONARY) != 0 ?
+    std::make_shared<TDumpStringDictionary>() : nullptr);
+  dumper.SetFrontCodedStrings((flags & TSnapshotHeader::SNAPSHOT_FRONT_CODED_STRINGS) != 0);
+  dumper.SetXorFloats((flags & TSnapshotHeader::SNAPSHOT_XOR_FLOATS) != 0);
+  dumper.SetAdaptive((flags & TSnapshotHeader::SNAPSHOT_ADAPTIVE) != 0);
+  }
+
+inline void DumpSnapshotHeaderFields(ASerializeDumper& dumper, unsigned long long layoutFingerprint,
+  unsigned short flags)
+  {
+  dumper.Dump(static_cast<unsigned int>(TSnapshotHeader::MAGIC));
+  dumper.Dump(static_cast<unsigned short>(TSnapshotHeader::VERSION));
+  dumper.Dump(flags);
+  dumper.Dump(layoutFingerprint);
+  }
+
+/// Writes snapshot header and enables raw layout in dumper if it is requested by flags.
+inline void DumpSnapshotHeader(ASerializeDumper& dumper, unsigned long long layoutFingerprint,
+  unsigned short flags = 0)
+  {
+  //layouts are written only with TSnapshotLayout, unknown flags would make snapshot unreadable
+  flags &= TSnapshotHeader::SNAPSHOT_KNOWN_FLAGS & ~TSnapshotHeader::SNAPSHOT_LAYOUT_DESCRIPTION;
+  DumpSnapshotHeaderFields(dumper, layoutFingerprint, flags);
+  SetSnapshotEncodings(dumper, flags);
+  }
+
+/** Writes snapshot header, with raw layout followed by layouts of classes, so snapshot can be
+    loaded also by binary with different layout.
+*/
+inline void DumpSnapshotHeader(ASerializeDumper& dumper, const TSnapshotLayout& layout, unsigned short flags = 0)
+  {
+  flags &= TSnapshotHeader::SNAPSHOT_KNOWN_FLAGS & ~TSnapshotHeader::SNAPSHOT_LAYOUT_DESCRIPTION;
+  if ((flags & TSnapshotHeader::SNAPSHOT_RAW_LAYOUT) != 0)
+    flags |= TSnapshotHeader::SNAPSHOT_LAYOUT_DESCRIPTION;
+  DumpSnapshotHeaderFields(dumper, layout.Fingerprint, flags);
+
+  //written before encodings are enabled: count, then name, sizeof and fields of each class
+  if ((flags & TSnapshotHeader::SNAPSHOT_LAYOUT_DESCRIPTION) != 0)
+    {
+    SetSnapshotEncodings(dumper, 0);
+    dumper.DumpSizeT(layout.ClassCount);
+    for (size_t i = 0; i < layout.ClassCount; ++i)
+      {
+      const TRawLayoutDescription& description = *layout.Classes[i];
+      size_t nameLength = strlen(description.Name);
+
+      dumper.DumpSizeT(nameLength);
+      dumper.WriteBuffer(reinterpret_cast<const unsigned char*>(description.Name), nameLength);
+      dumper.DumpSizeT(description.Sizeof);
+      dumper.DumpSizeT(description.FieldCount);
+      for (size_t f = 0; f < description.FieldCount; ++f)
+        {
+        dumper.Dump(description.Fields[f].Offset);
+        dumper.Dump(description.Fields[f].Size);
+        }
+      }
+    }
+  SetSnapshotEncodings(dumper, flags);
+  }
+
+/// Loads layouts of classes written by DumpSnapshotHeader, sets LOAD_BAD_HEADER if they are invalid.
+inline std::shared_ptr<const TForeignRawLayouts> LoadSnapshotLayouts(ASerializeLoader& loader)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  std::shared_ptr<TForeignRawLayouts> layouts = std::make_shared<TForeignRawLayouts>();
+  size_t classCount = 0;
+
+  //each class takes at least its name length, sizeof and field count
+  loader.LoadLength(classCount);
+  if (loader.CheckLoadCount(classCount, 3 * sizeof(unsigned long long)) == false)
+    classCount = 0;
+
+  for (size_t i = 0; i < classCount && loader.HasError() == false; ++i)
+    {
+    std::string name;
+    TDumpedRawLayout layout;
+    size_t nameLength = 0, fieldCount = 0;
+
+    loader.LoadLength(nameLength);
+    if (loader.CheckLoadCount(nameLength, 1) == false)
+      break;
+    name.resize(nameLength);
+    if (nameLength != 0)
+      loader.ReadBuffer(reinterpret_cast<unsigned char*>(&name[0]), nameLength);
+    loader.LoadSizeT(layout.Sizeof);
+    loader.LoadLength(fieldCount);
+    if (loader.CheckLoadCount(fieldCount, 2 * sizeof(unsigned int)) == false)
+      break;
+
+    layout.Fields.resize(fieldCount);
+    for (TRawLayoutField& field : layout.Fields)
+      {
+      loader.Load(field.Offset);
+      loader.Load(field.Size);
+      if (field.Size > layout.Sizeof || field.Offset > layout.Sizeof - field.Size)
+        loader.SetError(ASerializeLoader::LOAD_BAD_HEADER);
+      }
+    if (layout.Sizeof == 0)
+      loader.SetError(ASerializeLoader::LOAD_BAD_HEADER);
+    layouts->Add(name, std::move(layout));
+    }
+
+  return layouts;
+  }
+
+/** Loads snapshot header and enables raw layout in loader if snapshot was dumped with raw layout
+    and the same layout fingerprint, or with layouts of classes (then objects are loaded field by
+    field). Sets LOAD_BAD_HEADER error for unknown magic, version or flags and
+    LOAD_LAYOUT_MISMATCH for raw layout snapshot with different fingerprint without layouts.
+*/
+inline TSnapshotHeader LoadSnapshotHeader(ASerializeLoader& loader, unsigned long long layoutFingerprint)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  TSnapshotHeader header;
+  loader.Load(header.Magic);
+  loader.Load(header.Version);
+  loader.Load(header.Flags);
+  loader.Load(header.LayoutFingerprint);
+  loader.SetRawLayout(false);
+  loader.SetForeignRawLayouts(nullptr);
+  loader.SetColumnar(false);
+  loader.SetPackedIntegers(false);
+  loader.SetStringDictionary(nullptr);
+  loader.SetFrontCodedStrings(false);
+  loader.SetXorFloats(false);
+  loader.SetAdaptive(false);
+
+  if (loader.HasError())
+    return header;
+
+  //flags of newer format would change meaning of following data
+  if (header.Magic != TSnapshotHeader::MAGIC || header.Version > TSnapshotHeader::VERSION ||
+      (header.Flags & ~TSnapshotHeader::SNAPSHOT_KNOWN_FLAGS) != 0)
+    {
+    loader.SetError(ASerializeLoader::LOAD_BAD_HEADER);
+    return header;
+    }
+
+  std::shared_ptr<const TForeignRawLayouts> layouts;
+  if ((header.Flags & TSnapshotHeader::SNAPSHOT_LAYOUT_DESCRIPTION) != 0)
+    layouts = LoadSnapshotLayouts(loader);
+
+  if ((header.Flags & TSnapshotHeader::SNAPSHOT_RAW_LAYOUT) != 0 && loader.HasError() == false)
+    {
+    if (header.LayoutFingerprint == layoutFingerprint)
+      loader.SetRawLayout(true);
+    else if (layouts != nullptr)
+      {
+      loader.SetRawLayout(true);
+      loader.SetForeignRawLayouts(layouts);
+      }
+    else
+      loader.SetError(ASerializeLoader::LOAD_LAYOUT_MISMATCH);
+    }
+
+  if (loader.HasError() == false)
+    {
+    loader.SetColumnar((header.Flags & TSnapshotHeader::SNAPSHOT_COLUMNAR) != 0);
+    loader.SetPackedIntegers((header.Flags & TSnapshotHeader::SNAPSHOT_PACKED_INTEGERS) != 0);
+    loader.SetFrontCodedStrings((header.Flags & TSnapshotHeader::SNAPSHOT_FRONT_CODED_STRINGS) != 0);
+    loader.SetXorFloats((header.Flags & TSnapshotHeader::SNAPSHOT_XOR_FLOATS) != 0);
+    loader.SetAdaptive((header.Flags & TSnapshotHeader::SNAPSHOT_ADAPTIVE) != 0);
+    if ((header.Flags & TSnapshotHeader::SNAPSHOT_STRING_DICTIONARY) != 0)
+      loader.SetStringDictionary(std::make_shared<TLoadStringDictionary>());
+    }
+
+  return header;
+  }
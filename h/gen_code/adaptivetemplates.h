@@ -0,0 +1,424 @@
+///\file adaptivetemplates.h
+#pragma once
+
+//Adaptive encoding of vectors of primitive types. If it is enabled in dumper (see
+//serialize_snapshotheader.h), each vector with at least ADAPTIVE_MIN_COUNT elements is sampled
+//and dumped by encoding with the smallest estimated size:
+//  count, encoding tag, encoded values
+//Smaller vectors are dumped raw without tag (count, values), so they keep zero overhead.
+//Sample consists of up to ADAPTIVE_SAMPLE_BLOCKS blocks of ADAPTIVE_SAMPLE_BLOCK_SIZE elements
+//spread over the vector, each supported encoding dumps them to size counter. First encoding of
+//the set (raw) is used unless other one saves at least 1/8 of its size.
+//Set of encodings is pluggable by specialization of adaptive_encodings for element type, tags
+//of user encodings should be >= 128. Encoding is class template with:
+//  static const bool SUPPORTED;     //whether element type is supported
+//  static const unsigned char TAG;  //unique tag written to stream
+//  static void Dump(ASerializeDumper& dumper, const TType* values, size_t count);
+//  template <class TVector>          //appends count values, false if corrupted
+//  static bool Load(ASerializeLoader& loader, TVector& c, size_t count);
+//Loaded count is not trusted, encodings grow vector only by values whose data were read
+//(raw values by GetLoadStep, runs one by one, packed values after their payload is checked).
+
+#include <serialize3/h/gen_code/packedtemplates.h>
+#include <serialize3/h/storage/packedintcodec.h>
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+#include <serialize3/h/storage/sizecountingdumper.h>
+#include <serialize3/h/storage/varuint.h>
+#include <serialize3/h/storage/xorfloatcodec.h>
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+const size_t ADAPTIVE_MIN_COUNT = 64;
+const size_t ADAPTIVE_SAMPLE_BLOCKS = 8;
+const size_t ADAPTIVE_SAMPLE_BLOCK_SIZE = 128;
+const size_t ADAPTIVE_MAX_RUN_LENGTH = 1 << 12;
+
+//---------- TRawEncoding
+template <typename TType>
+struct TRawEncoding
+  {
+  static const bool SUPPORTED = std::is_arithmetic<TType>::value;
+  static const unsigned char TAG = 0;
+
+  static void Dump(ASerializeDumper& dumper, const TType* values, size_t count)
+    {
+    dumper.WriteBuffer(reinterpret_cast<const unsigned char*>(values), count * sizeof(TType));
+    }
+
+  template <class TVector>
+  static bool Load(ASerializeLoader& loader, TVector& c, size_t count) SERIALIZE_LOAD_NOEXCEPT
+    {
+    size_t i = c.size();
+    count += i;
+    for (size_t step; (step = loader.GetLoadStep(count - i, sizeof(TType))) != 0; i += step)
+      {
+      c.resize(i + step);
+      loader.ReadBuffer(reinterpret_cast<unsigned char*>(c.data() + i), step * sizeof(TType));
+      }
+    return loader.HasError() == false;
+    }
+  };
+
+//---------- TRunLengthEncoding
+//Runs of bitwise equal values: { run length, value }, runs are at most ADAPTIVE_MAX_RUN_LENGTH
+template <typename TType>
+struct TRunLengthEncoding
+  {
+  static const bool SUPPORTED = std::is_arithmetic<TType>::value;
+  static const unsigned char TAG = 1;
+
+  static void Dump(ASerializeDumper& dumper, const TType* values, size_t count)
+    {
+    for (size_t i = 0; i < count; )
+      {
+      size_t run = 1;
+      while (i + run < count && run < ADAPTIVE_MAX_RUN_LENGTH &&
+             memcmp(&values[i], &values[i + run], sizeof(TType)) == 0)
+        ++run;
+      DumpVarUInt(dumper, run);
+      dumper.WriteBuffer(reinterpret_cast<const unsigned char*>(&values[i]), sizeof(TType));
+      i += run;
+      }
+    }
+
+  template <class TVector>
+  static bool Load(ASerializeLoader& loader, TVector& c, size_t count) SERIALIZE_LOAD_NOEXCEPT
+    {
+    for (size_t i = 0; i < count; )
+      {
+      unsigned long long run = 0;
+      TType value;
+      LoadVarUInt(loader, run);
+      loader.ReadBuffer(reinterpret_cast<unsigned char*>(&value), sizeof(TType));
+      if (loader.HasError() || run == 0 || run > count - i || run > ADAPTIVE_MAX_RUN_LENGTH)
+        return false;
+      c.resize(c.size() + static_cast<size_t>(run), value);
+      i += static_cast<size_t>(run);
+      }
+    return true;
+    }
+  };
+
+//Codes of integers are dumped by TPackedIntCodec: codec, payload size, payload
+inline void DumpAdaptiveCodes(ASerializeDumper& dumper, const std::vector<unsigned long long>& codes)
+  {
+  std::vector<unsigned char> payload;
+  unsigned char codec = TPackedIntCodec::Encode(codes.data(), codes.size(), payload);
+  dumper.Dump(codec);
+  dumper.DumpSizeT(payload.size());
+  dumper.WriteBuffer(payload.data(), payload.size());
+  }
+
+/// Loads count codes, they are allocated after payload was checked to hold them.
+inline bool LoadAdaptiveCodes(ASerializeLoader& loader, std::vector<unsigned long long>& codes, size_t count)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  unsigned char codec = 0;
+  size_t size = 0;
+  loader.Load(codec);
+  loader.LoadSizeT(size);
+  if (loader.HasError())
+    return false;
+
+  const unsigned char* payload = loader.AcquireLoadedBuffer(size);
+  TPackedIntCodec::TCodec packedCodec = static_cast<TPackedIntCodec::TCodec>(codec);
+  if (loader.HasError() || TPackedIntCodec::IsPlausible(packedCodec, payload, size, count) == false)
+    return false;
+
+  codes.resize(count);
+  return TPackedIntCodec::Decode(packedCodec, payload, size, count, codes.data());
+  }
+
+//---------- TDeltaEncoding
+//First value, zigzag mapped differences of next ones, packed
+template <typename TType>
+struct TDeltaEncoding
+  {
+  static const bool SUPPORTED = is_packable_integer<TType>::value;
+  static const unsigned char TAG = 2;
+
+  static void Dump(ASerializeDumper& dumper, const TType* values, size_t count)
+    {
+    std::vector<unsigned long long> codes(count);
+    for (size_t i = 1; i < count; ++i)
+      {
+      unsigned long long delta = static_cast<unsigned long long>(values[i]) - static_cast<unsigned long long>(values[i - 1]);
+      codes[i] = ZigZagEncode(static_cast<long long>(delta));
+      }
+    dumper.WriteBuffer(reinterpret_cast<const unsigned char*>(values), sizeof(TType));
+    DumpAdaptiveCodes(dumper, codes);
+    }
+
+  template <class TVector>
+  static bool Load(ASerializeLoader& loader, TVector& c, size_t count) SERIALIZE_LOAD_NOEXCEPT
+    {
+    std::vector<unsigned long long> codes;
+    TType first;
+    loader.ReadBuffer(reinterpret_cast<unsigned char*>(&first), sizeof(TType));
+    if (loader.HasError() || LoadAdaptiveCodes(loader, codes, count) == false)
+      return false;
+
+    size_t i = c.size();
+    unsigned long long previous = static_cast<unsigned long long>(first);
+    c.resize(i + count);
+    for (size_t j = 0; j < count; ++j)
+      {
+      previous += static_cast<unsigned long long>(ZigZagDecode<long long>(codes[j]));
+      c[i + j] = static_cast<TType>(previous);
+      }
+    return true;
+    }
+  };
+
+//---------- TPackedEncoding
+//Zigzag mapped integers, packed
+template <typename TType>
+struct TPackedEncoding
+  {
+  static const bool SUPPORTED = is_packable_integer<TType>::value;
+  static const unsigned char TAG = 3;
+
+  static void Dump(ASerializeDumper& dumper, const TType* values, size_t count)
+    {
+    std::vector<unsigned long long> codes(count);
+    for (size_t i = 0; i < count; ++i)
+      codes[i] = ZigZagEncode(values[i]);
+    DumpAdaptiveCodes(dumper, codes);
+    }
+
+  template <class TVector>
+  static bool Load(ASerializeLoader& loader, TVector& c, size_t count) SERIALIZE_LOAD_NOEXCEPT
+    {
+    std::vector<unsigned long long> codes;
+    if (LoadAdaptiveCodes(loader, codes, count) == false)
+      return false;
+
+    size_t i = c.size();
+    c.resize(i + count);
+    for (size_t j = 0; j < count; ++j)
+      c[i + j] = ZigZagDecode<TType>(codes[j]);
+    return true;
+    }
+  };
+
+//---------- TXorFloatEncoding
+//Floats XOR compressed by TXorFloatCodec: payload size, payload
+template <typename TType>
+struct TXorFloatEncoding
+  {
+  static const bool SUPPORTED = std::is_same<TType, float>::value || std::is_same<TType, double>::value;
+  static const unsigned char TAG = 4;
+
+  static void Dump(ASerializeDumper& dumper, const TType* values, size_t count)
+    {
+    std::vector<unsigned char> payload;
+    TXorFloatCodec<TType>::Encode(values, count, payload);
+    dumper.DumpSizeT(payload.size());
+    dumper.WriteBuffer(payload.data(), payload.size());
+    }
+
+  template <class TVector>
+  static bool Load(ASerializeLoader& loader, TVector& c, size_t count) SERIALIZE_LOAD_NOEXCEPT
+    {
+    size_t size = 0;
+    loader.LoadSizeT(size);
+    if (loader.HasError())
+      return false;
+
+    const unsigned char* payload = loader.AcquireLoadedBuffer(size);
+    //values after the first one take at least one bit
+    if (loader.HasError() || (count - 1) / 8 > size)
+      return false;
+
+    size_t i = c.size();
+    c.resize(i + count);
+    return TXorFloatCodec<TType>::Decode(payload, size, count, c.data() + i);
+    }
+  };
+
+template <template <typename> class... TEncodings>
+struct TAdaptiveEncodings {};
+
+//Encodings tried for vectors of given element type, the first one is the default.
+template <typename TType>
+struct adaptive_encodings
+  {
+  typedef TAdaptiveEncodings<TRawEncoding, TRunLengthEncoding, TDeltaEncoding, TPackedEncoding,
+    TXorFloatEncoding> type;
+  };
+
+template <typename TType>
+struct is_adaptive_encodable : public std::integral_constant<bool,
+  std::is_arithmetic<TType>::value && std::is_same<TType, bool>::value == false &&
+  (sizeof(TType) == sizeof(long long) ||
+   (std::is_same<TType, long>::value == false && std::is_same<TType, unsigned long>::value == false))> {};
+
+//---------- TAdaptiveSelector
+//Walks set of encodings, unsupported ones are skipped without instantiation.
+template <typename TType, class TEncodings>
+struct TAdaptiveSelector;
+
+template <typename TType>
+struct TAdaptiveSelector<TType, TAdaptiveEncodings<>>
+  {
+  static void Select(const TType*, size_t, size_t&, unsigned char&) {}
+  static void Dump(ASerializeDumper&, unsigned char, const TType*, size_t) {}
+  template <class TVector>
+  static bool Load(ASerializeLoader&, unsigned char, TVector&, size_t) SERIALIZE_LOAD_NOEXCEPT
+    {
+    return false;
+    }
+  };
+
+template <typename TType, template <typename> class TFirst, template <typename> class... TRest>
+struct TAdaptiveSelector<TType, TAdaptiveEncodings<TFirst, TRest...>>
+  {
+  typedef TFirst<TType>                                          TEncoding;
+  typedef TAdaptiveSelector<TType, TAdaptiveEncodings<TRest...>> TNext;
+  typedef std::integral_constant<bool, TEncoding::SUPPORTED>     TSupported;
+
+  /// Estimates size of sample blocks, keeps encoding with the smallest one.
+  static void Select(const TType* values, size_t count, size_t& bestSize, unsigned char& bestTag)
+    {
+    Select(values, count, bestSize, bestTag, TSupported());
+    TNext::Select(values, count, bestSize, bestTag);
+    }
+
+  static void Dump(ASerializeDumper& dumper, unsigned char tag, const TType* values, size_t count)
+    {
+    if (tag == TEncoding::TAG && TEncoding::SUPPORTED)
+      Dump(dumper, values, count, TSupported());
+    else
+      TNext::Dump(dumper, tag, values, count);
+    }
+
+  /// Appends count values loaded by encoding with tag, false for unknown tag.
+  template <class TVector>
+  static bool Load(ASerializeLoader& loader, unsigned char tag, TVector& c, size_t count) SERIALIZE_LOAD_NOEXCEPT
+    {
+    if (tag == TEncoding::TAG && TEncoding::SUPPORTED)
+      return Load(loader, c, count, TSupported());
+    return TNext::Load(loader, tag, c, count);
+    }
+
+  private:
+    static void Select(const TType* values, size_t count, size_t& bestSize, unsigned char& bestTag,
+      std::true_type)
+      {
+      TSizeCountingDumper counter;
+      size_t blocks = count / ADAPTIVE_SAMPLE_BLOCK_SIZE < ADAPTIVE_SAMPLE_BLOCKS ?
+        1 : ADAPTIVE_SAMPLE_BLOCKS;
+      size_t blockSize = blocks == 1 ? count : ADAPTIVE_SAMPLE_BLOCK_SIZE;
+      for (size_t b = 0; b < blocks; ++b)
+        TEncoding::Dump(counter, values + (count - blockSize) / (blocks == 1 ? 1 : blocks - 1) * b, blockSize);
+
+      if (bestSize == static_cast<size_t>(-1))
+        bestSize = counter.GetSize() - counter.GetSize() / 8; //default encoding is preferred
+      else if (counter.GetSize() >= bestSize)
+        return;
+      else
+        bestSize = counter.GetSize();
+      bestTag = TEncoding::TAG;
+      }
+
+    static void Select(const TType*, size_t, size_t&, unsigned char&, std::false_type)
+      {
+      }
+
+    static void Dump(ASerializeDumper& dumper, const TType* values, size_t count, std::true_type)
+      {
+      TEncoding::Dump(dumper, values, count);
+      }
+
+    static void Dump(ASerializeDumper&, const TType*, size_t, std::false_type)
+      {
+      }
+
+    template <class TVector>
+    static bool Load(ASerializeLoader& loader, TVector& c, size_t count, std::true_type) SERIALIZE_LOAD_NOEXCEPT
+      {
+      return TEncoding::template Load<TVector>(loader, c, count);
+      }
+
+    template <class TVector>
+    static bool Load(ASerializeLoader&, TVector&, size_t, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+      {
+      return false;
+      }
+  };
+
+/// Dumps values of vector (without count) by encoding selected by sample.
+template <class TVector>
+void DumpAdaptive(ASerializeDumper& dumper, const TVector& c, std::true_type)
+  {
+  typedef typename TVector::value_type TType;
+  typedef TAdaptiveSelector<TType, typename adaptive_encodings<TType>::type> TSelector;
+
+  if (c.empty())
+    return;
+  if (c.size() < ADAPTIVE_MIN_COUNT)
+    {
+    TRawEncoding<TType>::Dump(dumper, c.data(), c.size());
+    return;
+    }
+
+  size_t bestSize = static_cast<size_t>(-1);
+  unsigned char bestTag = 0;
+  TSelector::Select(c.data(), c.size(), bestSize, bestTag);
+  dumper.Dump(bestTag);
+  TSelector::Dump(dumper, bestTag, c.data(), c.size());
+  }
+
+template <class TVector>
+void DumpAdaptive(ASerializeDumper&, const TVector&, std::false_type)
+  {
+  }
+
+/** Appends count values dumped by DumpAdaptive to vector, sets LOAD_OVERSIZED_LENGTH for count
+    over length limit, LOAD_BAD_ENCODING for unknown tag or corrupted data. Vector grows only
+    as values are read, so untrusted count does not allocate memory for data which are not there.
+*/
+template <class TVector>
+void LoadAdaptive(ASerializeLoader& loader, TVector& c, size_t count, std::true_type)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  typedef typename TVector::value_type TType;
+  typedef TAdaptiveSelector<TType, typename adaptive_encodings<TType>::type> TSelector;
+  unsigned char tag = 0;
+  size_t i = c.size();
+
+  if (count == 0)
+    return;
+  if (count > loader.GetLengthLimit())
+    {
+    loader.SetError(ASerializeLoader::LOAD_OVERSIZED_LENGTH);
+    return;
+    }
+  if (count < ADAPTIVE_MIN_COUNT)
+    {
+    if (TRawEncoding<TType>::Load(loader, c, count) == false)
+      {
+      c.resize(i);
+      loader.SetError(ASerializeLoader::LOAD_TRUNCATED_INPUT);
+      }
+    return;
+    }
+
+  loader.Load(tag);
+  if (loader.HasError())
+    return;
+  if (TSelector::Load(loader, tag, c, count) == false)
+    {
+    c.resize(i);
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    }
+  }
+
+template <class TVector>
+void LoadAdaptive(ASerializeLoader&, TVector&, size_t, std::false_type)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
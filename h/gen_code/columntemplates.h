@@ -0,0 +1,224 @@
+///\file columntemplates.h
+#pragma once
+
+//Support for columnar (struct of arrays) encoding of vectors of object-serializable classes.
+//Generator emits DumpColumns/LoadColumns for named classes without hierarchy whose members are
+//all named, they dump or load each member of all elements as one column. Vectors of such
+//classes are dumped by columns if columnar encoding is enabled in dumper (see
+//serialize_snapshotheader.h), otherwise element by element:
+//  count, { column size, values of the member of all elements } for each member
+//Columns of primitive types are copied by blocks. Column size allows loader to skip columns,
+//so single column may be loaded on its own (see LoadVectorColumn). With string dictionary
+//skipped columns are loaded and dropped, because later strings may reference them.
+
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+#include <serialize3/h/storage/sizecountingdumper.h>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+//Specialized in generated typeids file for classes with DumpColumns/LoadColumns accessible
+//from namespace scope.
+template <typename TType>
+struct serialized_columnar : public std::false_type {};
+
+//Columns of primitive types whose memory is the same as their dumped form are copied by blocks
+//(enums are dumped as unsigned of the same size, long as 8 bytes).
+template <typename TType>
+struct is_raw_column : public std::integral_constant<bool,
+  std::is_enum<TType>::value || (std::is_arithmetic<TType>::value &&
+  (sizeof(TType) == sizeof(long long) ||
+   (std::is_same<TType, long>::value == false && std::is_same<TType, unsigned long>::value == false)))> {};
+
+const size_t COLUMN_BLOCK_SIZE = 4096;
+
+template <typename TType>
+void DumpColumnValue(ASerializeDumper& dumper, const TType& value)
+  {
+  dumper & value;
+  }
+
+template <typename TType, size_t N>
+void DumpColumnValue(ASerializeDumper& dumper, const TType (&value)[N])
+  {
+  for (auto& i : value)
+    DumpColumnValue(dumper, i);
+  }
+
+template <typename TType>
+void LoadColumnValue(ASerializeLoader& loader, TType& value) SERIALIZE_LOAD_NOEXCEPT
+  {
+  loader & value;
+  }
+
+template <typename TType, size_t N>
+void LoadColumnValue(ASerializeLoader& loader, TType (&value)[N]) SERIALIZE_LOAD_NOEXCEPT
+  {
+  for (auto& i : value)
+    LoadColumnValue(loader, i);
+  }
+
+template <class TObject, typename TField>
+typename std::enable_if<is_raw_column<TField>::value>::type
+DumpColumn(ASerializeDumper& dumper, const TObject* objects, size_t count, TField TObject::*field)
+  {
+  unsigned char block[COLUMN_BLOCK_SIZE];
+  const size_t valuesPerBlock = COLUMN_BLOCK_SIZE / sizeof(TField);
+
+  dumper.DumpSizeT(count * sizeof(TField));
+  for (size_t i = 0; i < count; i += valuesPerBlock)
+    {
+    size_t values = std::min(valuesPerBlock, count - i);
+    for (size_t j = 0; j < values; ++j)
+      memcpy(block + j * sizeof(TField), &(objects[i + j].*field), sizeof(TField));
+    dumper.WriteBuffer(block, values * sizeof(TField));
+    }
+  }
+
+template <class TObject, typename TField>
+typename std::enable_if<is_raw_column<TField>::value == false>::type
+DumpColumn(ASerializeDumper& dumper, const TObject* objects, size_t count, TField TObject::*field)
+  {
+  if (dumper.GetStringDictionary() != nullptr)
+    {
+    //strings dumped as references depend on dictionary, so column is dumped to buffer first
+    TMemoryDumper column;
+    column.CopyEncodings(dumper);
+    for (size_t i = 0; i < count; ++i)
+      DumpColumnValue(column, objects[i].*field);
+    dumper.DumpSizeT(column.GetBuffer().size());
+    dumper.WriteBuffer(column.GetBuffer().data(), column.GetBuffer().size());
+    return;
+    }
+
+  //size of column is counted first, nested vectors are counted in the same encoding
+  TSizeCountingDumper counter;
+  counter.CopyEncodings(dumper);
+  for (size_t i = 0; i < count; ++i)
+    DumpColumnValue(counter, objects[i].*field);
+
+  dumper.DumpSizeT(counter.GetSize());
+  for (size_t i = 0; i < count; ++i)
+    DumpColumnValue(dumper, objects[i].*field);
+  }
+
+/// Skips column of given size.
+inline void SkipColumn(ASerializeLoader& loader, size_t size) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (size > loader.GetAvailableSize())
+    {
+    loader.SetError(ASerializeLoader::LOAD_TRUNCATED_INPUT);
+    return;
+    }
+
+  for (size_t i = 0; i < size && loader.HasError() == false; i += COLUMN_BLOCK_SIZE)
+    loader.AcquireBuffer(std::min(COLUMN_BLOCK_SIZE, size - i));
+  }
+
+/// Loads column of member to count objects, column is only skipped if load is false.
+template <class TObject, typename TField>
+typename std::enable_if<is_raw_column<TField>::value>::type
+LoadColumn(ASerializeLoader& loader, TObject* objects, size_t count, TField TObject::*field, bool load)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  const size_t valuesPerBlock = COLUMN_BLOCK_SIZE / sizeof(TField);
+  size_t size = 0;
+
+  loader.LoadSizeT(size);
+  if (load == false)
+    {
+    SkipColumn(loader, size);
+    return;
+    }
+
+  //column of other size was dumped with different type of member
+  if (size != count * sizeof(TField))
+    {
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    return;
+    }
+
+  for (size_t i = 0; i < count && loader.HasError() == false; i += valuesPerBlock)
+    {
+    size_t values = std::min(valuesPerBlock, count - i);
+    const unsigned char* block = loader.AcquireBuffer(values * sizeof(TField));
+    for (size_t j = 0; j < values; ++j)
+      memcpy(&(objects[i + j].*field), block + j * sizeof(TField), sizeof(TField));
+    }
+  }
+
+template <class TObject, typename TField>
+typename std::enable_if<is_raw_column<TField>::value == false>::type
+LoadColumn(ASerializeLoader& loader, TObject* objects, size_t count, TField TObject::*field, bool load)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  size_t size = 0;
+
+  loader.LoadSizeT(size);
+  if (load == false && loader.GetStringDictionary() == nullptr)
+    {
+    SkipColumn(loader, size);
+    return;
+    }
+
+  for (size_t i = 0; i < count && loader.HasError() == false; ++i)
+    {
+    if (load)
+      LoadColumnValue(loader, objects[i].*field);
+    else
+      {
+      //strings of skipped column must be added to dictionary
+      TField value;
+      LoadColumnValue(loader, value);
+      }
+    }
+  }
+
+template <class TType>
+void DumpColumns(ASerializeDumper& dumper, const TType* objects, size_t count, std::true_type)
+  {
+  if (count != 0)
+    objects->DumpColumns(dumper, count);
+  }
+
+template <class TType>
+void DumpColumns(ASerializeDumper&, const TType*, size_t, std::false_type)
+  {
+  }
+
+template <class TType>
+void LoadColumns(ASerializeLoader& loader, TType* objects, size_t count, std::true_type)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (count != 0)
+    objects->LoadColumns(loader, count);
+  }
+
+template <class TType>
+void LoadColumns(ASerializeLoader&, TType*, size_t, std::false_type)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
+
+/** Loads only one column (index of member in class) of vector dumped with columnar encoding,
+    other members of loaded elements stay default constructed.
+*/
+template <class T, class Alloc>
+void LoadVectorColumn(ASerializeLoader& loader, std::vector<T, Alloc>& c, int column) SERIALIZE_LOAD_NOEXCEPT
+  {
+  static_assert(serialized_columnar<T>::value, "Class has no columnar encoding");
+
+  size_t size;
+  loader.LoadLength(size);
+  //each element takes at least one byte
+  if (loader.CheckLoadCount(size, 1) == false)
+    size = 0;
+  size_t i = c.size();
+  c.resize(i + size);
+  if (size != 0)
+    c[i].LoadColumns(loader, size, column);
+  }
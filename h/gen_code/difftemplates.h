@@ -0,0 +1,550 @@
+///\file difftemplates.h
+#pragma once
+
+//Support for delta replication of classes marked by SERIALIZABLE_DIFF. Generated DumpDiff
+//dumps bitmap of fields changed against base object followed by changed fields only:
+//  bitmap ((fields + 7) / 8 bytes, bit i % 8 of byte i / 8 for field i), { field } for each set bit
+//Serializable bases are fields too (before members). Changed field is dumped as:
+//  - nested diff if its class has DumpDiff (only its changed fields follow)
+//  - patch by index for vectors and deques (see DumpIndexPatch)
+//  - whole value otherwise
+//Generated LoadPatch applies diff to object equal to base, f.e. to replica of replicated object.
+//Fields of primitive types are compared bitwise, vectors and deques by elements, classes with
+//DumpDiff by generated HasDiff, other fields by operator == if they (and their elements) have
+//it, else by dumped bytes. Fields are compared once, changes found are passed to DumpDiffField.
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//---------- TDiffFields
+//Bitmap of changed fields of generated DumpDiff and LoadPatch.
+template <size_t COUNT>
+class TDiffFields
+  {
+  public:
+    static const size_t SIZE = (COUNT + 7) / 8;
+
+    TDiffFields() : Bits() {}
+
+    void Set(size_t i, bool changed)
+      {
+      if (changed)
+        Bits[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+      }
+
+    bool operator[](size_t i) const { return ((Bits[i / 8] >> (i % 8)) & 1) != 0; }
+
+    void Dump(ASerializeDumper& dumper) const
+      {
+      dumper.WriteBuffer(Bits, SIZE);
+      }
+
+    /// Returns false on error.
+    bool Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+      {
+      loader.ReadBuffer(Bits, SIZE);
+      return loader.HasError() == false;
+      }
+
+  private:
+    unsigned char Bits[SIZE != 0 ? SIZE : 1];
+  }; //TDiffFields
+
+template <typename TType, typename = void>
+struct has_serialize_diff : public std::false_type {};
+
+template <typename TType>
+struct has_serialize_diff<TType, decltype(std::declval<const TType&>().DumpDiff(std::declval<const TType&>(),
+  std::declval<ASerializeDumper&>()))> : public std::true_type {};
+
+//Random access containers patched by index (not vector<bool>, its elements are not objects)
+template <typename TType>
+struct is_index_diffable : public std::false_type {};
+
+template <class T, class Alloc>
+struct is_index_diffable<std::vector<T, Alloc>> : public std::integral_constant<bool,
+  std::is_same<T, bool>::value == false> {};
+
+template <class T, class Alloc>
+struct is_index_diffable<std::deque<T, Alloc>> : public std::true_type {};
+
+#if defined(SERIALIZABLE_BOOST_CONTAINERS)
+template <class T, class Alloc>
+struct is_index_diffable<boost::container::vector<T, Alloc>> : public std::true_type {};
+
+template <class T, class Alloc>
+struct is_index_diffable<boost::container::deque<T, Alloc>> : public std::true_type {};
+#endif // #if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+template <typename TType, typename = void>
+struct has_diff_equal;
+
+//Operators == of containers, pairs and tuples are declared regardless of their elements
+template <typename TType, typename = void>
+struct has_diff_equal_elements : public std::true_type {};
+
+template <typename TType>
+struct has_diff_equal_elements<TType, typename std::conditional<true, void, typename TType::value_type>::type> :
+  public has_diff_equal<typename std::remove_const<typename TType::value_type>::type> {};
+
+template <typename TFirst, typename TSecond>
+struct has_diff_equal_elements<std::pair<TFirst, TSecond>> : public std::integral_constant<bool,
+  has_diff_equal<typename std::remove_const<TFirst>::type>::value && has_diff_equal<TSecond>::value> {};
+
+template <>
+struct has_diff_equal_elements<std::tuple<>> : public std::true_type {};
+
+template <typename TFirst, typename... TRest>
+struct has_diff_equal_elements<std::tuple<TFirst, TRest...>> : public std::integral_constant<bool,
+  has_diff_equal<TFirst>::value && has_diff_equal_elements<std::tuple<TRest...>>::value> {};
+
+//Fields compared by operator ==
+template <typename TType, typename>
+struct has_diff_equal : public std::false_type {};
+
+template <typename TType>
+struct has_diff_equal<TType, typename std::enable_if<std::is_convertible<
+  decltype(std::declval<const TType&>() == std::declval<const TType&>()), bool>::value &&
+  has_diff_equal_elements<TType>::value>::type> : public std::true_type {};
+
+enum TDiffKind
+  {
+  DIFF_WHOLE,    //field is dumped whole
+  DIFF_NESTED,   //field has DumpDiff
+  DIFF_BY_INDEX  //field is patched by index
+  };
+
+template <typename TType>
+struct diff_kind : public std::integral_constant<TDiffKind,
+  has_serialize_diff<TType>::value ? DIFF_NESTED : is_index_diffable<TType>::value ? DIFF_BY_INDEX : DIFF_WHOLE> {};
+
+/// Modes of index patch.
+enum TDiffPatchMode
+  {
+  DIFF_PATCH_WHOLE,   //container dumped whole
+  DIFF_PATCH_INDEXES  //size, count, { index, field } for each changed element, appended elements
+  };
+
+/// Result of comparison of field with base, passed to DumpDiffField so each field is compared once.
+template <typename TType, TDiffKind KIND = diff_kind<TType>::value>
+struct TDiffChange
+  {
+  TDiffChange() : Changed(false) {}
+
+  bool Changed;
+  };
+
+template <typename TType>
+struct TDiffChange<TType, DIFF_BY_INDEX>
+  {
+  typedef TDiffChange<typename TType::value_type> TElementChange;
+
+  TDiffChange() : Changed(false) {}
+
+  bool                                          Changed;
+  std::vector<std::pair<size_t, TElementChange>> Elements; //changed elements common with base
+  };
+
+class TDiffComparer;
+
+template <typename TType>
+void GetDiffChange(const TType& o, const TType& base, TDiffChange<TType>& change, TDiffComparer& comparer);
+template <typename TType, size_t SIZE>
+void GetDiffChange(const TType (&o)[SIZE], const TType (&base)[SIZE], TDiffChange<TType[SIZE]>& change,
+  TDiffComparer& comparer);
+template <typename TType>
+void DumpDiffField(ASerializeDumper& dumper, const TType& o, const TType& base, const TDiffChange<TType>& change);
+template <typename TType, size_t SIZE>
+void DumpDiffField(ASerializeDumper& dumper, const TType (&o)[SIZE], const TType (&base)[SIZE],
+  const TDiffChange<TType[SIZE]>& change);
+template <typename TType>
+void LoadPatchField(ASerializeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT;
+template <typename TType, size_t SIZE>
+void LoadPatchField(ASerializeLoader& loader, TType (&o)[SIZE]) SERIALIZE_LOAD_NOEXCEPT;
+
+//-------------- comparison
+
+//---------- TDiffComparer
+//Compares values without operator == by dumped bytes. Base is dumped to buffer kept for next
+//comparisons, value is compared with it while it is dumped, so nothing is allocated per element.
+class TDiffComparer : public ASerializeDumper
+  {
+  public:
+    TDiffComparer() : Position(0), Changed(false) {}
+
+    template <typename TType>
+    bool IsChanged(const TType& o, const TType& base)
+      {
+      TBaseDumper baseDumper(Base);
+      baseDumper & base;
+      Position = 0;
+      Changed = false;
+      *this & o;
+      return Changed || Position != Base.size();
+      }
+
+  /// ASerializeDumper reimplementation:
+    virtual void Log(const char*) override {}
+
+    virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) override
+      {
+      if (Changed || bufferLen > Base.size() - Position ||
+          (bufferLen != 0 && memcmp(Base.data() + Position, buffer, bufferLen) != 0))
+        Changed = true;
+      else
+        Position += bufferLen;
+      }
+
+  private:
+    //---------- TBaseDumper
+    //Dumps base to buffer of comparer.
+    class TBaseDumper : public ASerializeDumper
+      {
+      public:
+        explicit TBaseDumper(std::vector<unsigned char>& buffer) : Buffer(buffer)
+          {
+          Buffer.clear();
+          }
+
+        virtual void Log(const char*) override {}
+
+        virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) override
+          {
+          Buffer.insert(Buffer.end(), buffer, buffer + bufferLen);
+          }
+
+      private:
+        std::vector<unsigned char>& Buffer;
+      };
+
+  /// Class attributes:
+  private:
+    std::vector<unsigned char> Base;
+    size_t                     Position; //bytes of Base equal to dumped value
+    bool                       Changed;
+  }; //TDiffComparer
+
+template <typename TType>
+bool IsDiffChangedValue(const TType& o, const TType& base, TDiffComparer&, std::true_type)
+  {
+  return (o == base) == false;
+  }
+
+template <typename TType>
+bool IsDiffChangedValue(const TType& o, const TType& base, TDiffComparer& comparer, std::false_type)
+  {
+  return comparer.IsChanged(o, base);
+  }
+
+template <typename TType>
+bool IsDiffChangedScalar(const TType& o, const TType& base, TDiffComparer&, std::true_type)
+  {
+  return memcmp(&o, &base, sizeof(TType)) != 0;
+  }
+
+template <typename TType>
+bool IsDiffChangedScalar(const TType& o, const TType& base, TDiffComparer& comparer, std::false_type)
+  {
+  return IsDiffChangedValue(o, base, comparer, has_diff_equal<TType>());
+  }
+
+/// Checks if value differs from base as whole, used for classes which are not diffed by fields.
+template <typename TType>
+bool IsDiffChangedValue(const TType& o, const TType& base, TDiffComparer& comparer)
+  {
+  return IsDiffChangedScalar(o, base, comparer, std::integral_constant<bool,
+    std::is_arithmetic<TType>::value || std::is_enum<TType>::value>());
+  }
+
+template <typename TType>
+bool IsDiffChangedValue(const TType& o, const TType& base)
+  {
+  TDiffComparer comparer;
+  return IsDiffChangedValue(o, base, comparer);
+  }
+
+template <typename TType>
+bool IsDiffChangedNested(const TType& o, const TType& base, std::true_type)
+  {
+  return (o == base) == false;
+  }
+
+template <typename TType>
+bool IsDiffChangedNested(const TType& o, const TType& base, std::false_type)
+  {
+  return o.HasDiff(base);
+  }
+
+template <typename TType>
+void GetDiffChange(const TType& o, const TType& base, TDiffChange<TType>& change, TDiffComparer& comparer,
+  std::integral_constant<TDiffKind, DIFF_WHOLE>)
+  {
+  change.Changed = IsDiffChangedValue(o, base, comparer);
+  }
+
+template <typename TType>
+void GetDiffChange(const TType& o, const TType& base, TDiffChange<TType>& change, TDiffComparer&,
+  std::integral_constant<TDiffKind, DIFF_NESTED>)
+  {
+  change.Changed = IsDiffChangedNested(o, base, has_diff_equal<TType>());
+  }
+
+template <typename TType>
+void GetDiffChange(const TType& o, const TType& base, TDiffChange<TType>& change, TDiffComparer& comparer,
+  std::integral_constant<TDiffKind, DIFF_BY_INDEX>)
+  {
+  size_t common = std::min(o.size(), base.size());
+  for (size_t i = 0; i < common; ++i)
+    {
+    typename TDiffChange<TType>::TElementChange element;
+    GetDiffChange(o[i], base[i], element, comparer);
+    if (element.Changed)
+      change.Elements.emplace_back(i, std::move(element));
+    }
+  change.Changed = o.size() != base.size() || change.Elements.empty() == false;
+  }
+
+/// Compares field with the same field of base object, elements of containers patched by index are
+/// compared once for both the bitmap and the patch.
+template <typename TType>
+void GetDiffChange(const TType& o, const TType& base, TDiffChange<TType>& change, TDiffComparer& comparer)
+  {
+  GetDiffChange(o, base, change, comparer, diff_kind<TType>());
+  }
+
+template <typename TType, size_t SIZE>
+void GetDiffChange(const TType (&o)[SIZE], const TType (&base)[SIZE], TDiffChange<TType[SIZE]>& change,
+  TDiffComparer& comparer)
+  {
+  for (size_t i = 0; i < SIZE && change.Changed == false; ++i)
+    {
+    TDiffChange<TType> element;
+    GetDiffChange(o[i], base[i], element, comparer);
+    change.Changed = element.Changed;
+    }
+  }
+
+template <typename TType>
+TDiffChange<TType> GetDiffChange(const TType& o, const TType& base, TDiffComparer& comparer)
+  {
+  TDiffChange<TType> change;
+  GetDiffChange(o, base, change, comparer);
+  return change;
+  }
+
+/// Checks if field differs from the same field of base object.
+template <typename TType>
+bool IsDiffChanged(const TType& o, const TType& base, TDiffComparer& comparer)
+  {
+  return GetDiffChange(o, base, comparer).Changed;
+  }
+
+template <typename TType>
+bool IsDiffChanged(const TType& o, const TType& base)
+  {
+  TDiffComparer comparer;
+  return IsDiffChanged(o, base, comparer);
+  }
+
+//-------------- whole fields
+
+template <typename TType>
+void DumpDiffWhole(ASerializeDumper& dumper, const TType& o)
+  {
+  dumper & o;
+  }
+
+template <typename TType, size_t SIZE>
+void DumpDiffWhole(ASerializeDumper& dumper, const TType (&o)[SIZE])
+  {
+  for (size_t i = 0; i < SIZE; ++i)
+    DumpDiffWhole(dumper, o[i]);
+  }
+
+template <typename TType>
+void LoadDiffWhole(ASerializeLoader& loader, TType& o, std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  //loaders of containers append, so object is replaced by newly loaded one
+  o = ConstructLoaded<TType>(loader);
+  }
+
+template <typename TType>
+void LoadDiffWhole(ASerializeLoader& loader, TType& o, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  loader & o;
+  }
+
+template <typename TType>
+void LoadDiffWhole(ASerializeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadDiffWhole(loader, o, std::is_class<TType>());
+  }
+
+template <typename TType, size_t SIZE>
+void LoadDiffWhole(ASerializeLoader& loader, TType (&o)[SIZE]) SERIALIZE_LOAD_NOEXCEPT
+  {
+  for (size_t i = 0; i < SIZE && loader.HasError() == false; ++i)
+    LoadDiffWhole(loader, o[i]);
+  }
+
+//-------------- index patches
+
+/// Dumps changed elements with their indexes, or whole container if most of them changed.
+template <class TContainer>
+void DumpIndexPatch(ASerializeDumper& dumper, const TContainer& c, const TContainer& base,
+  const TDiffChange<TContainer>& change)
+  {
+  size_t common = std::min(c.size(), base.size());
+
+  if (change.Elements.size() * 2 > common)
+    {
+    dumper.Dump(static_cast<unsigned char>(DIFF_PATCH_WHOLE));
+    dumper & c;
+    return;
+    }
+
+  dumper.Dump(static_cast<unsigned char>(DIFF_PATCH_INDEXES));
+  dumper.DumpSizeT(c.size());
+  dumper.DumpSizeT(change.Elements.size());
+  for (const auto& element : change.Elements)
+    {
+    dumper.DumpSizeT(element.first);
+    DumpDiffField(dumper, c[element.first], base[element.first], element.second);
+    }
+  for (size_t i = common; i < c.size(); ++i)
+    DumpDiffWhole(dumper, c[i]);
+  }
+
+/// Applies patch dumped by DumpIndexPatch to container equal to base.
+template <class TContainer>
+void LoadIndexPatch(ASerializeLoader& loader, TContainer& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  unsigned char mode = DIFF_PATCH_WHOLE;
+  size_t size = 0;
+  size_t count = 0;
+
+  loader.Load(mode);
+  if (loader.HasError())
+    return;
+  if (mode == DIFF_PATCH_WHOLE)
+    {
+    c.clear();
+    loader & c;
+    return;
+    }
+  if (mode != DIFF_PATCH_INDEXES)
+    {
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    return;
+    }
+
+  loader.LoadLength(size);
+  loader.LoadLength(count);
+  if (loader.HasError())
+    return;
+  size_t common = std::min(size, c.size());
+  if (count > common)
+    {
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    return;
+    }
+  if (size > c.size() && size - c.size() > loader.GetAvailableSize())
+    {
+    //don't allocate memory for appended elements which are not there
+    loader.SetError(ASerializeLoader::LOAD_TRUNCATED_INPUT);
+    return;
+    }
+
+  c.resize(size);
+  for (size_t n = 0; n < count && loader.HasError() == false; ++n)
+    {
+    size_t i = 0;
+    loader.LoadSizeT(i);
+    if (loader.HasError() == false && i >= common)
+      loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    if (loader.HasError())
+      return;
+    LoadPatchField(loader, c[i]);
+    }
+  for (size_t i = common; i < size && loader.HasError() == false; ++i)
+    LoadDiffWhole(loader, c[i]);
+  }
+
+//-------------- fields
+
+template <typename TType>
+void DumpDiffField(ASerializeDumper& dumper, const TType& o, const TType&, const TDiffChange<TType>&,
+  std::integral_constant<TDiffKind, DIFF_WHOLE>)
+  {
+  DumpDiffWhole(dumper, o);
+  }
+
+template <typename TType>
+void DumpDiffField(ASerializeDumper& dumper, const TType& o, const TType& base, const TDiffChange<TType>&,
+  std::integral_constant<TDiffKind, DIFF_NESTED>)
+  {
+  o.DumpDiff(base, dumper);
+  }
+
+template <typename TType>
+void DumpDiffField(ASerializeDumper& dumper, const TType& o, const TType& base, const TDiffChange<TType>& change,
+  std::integral_constant<TDiffKind, DIFF_BY_INDEX>)
+  {
+  DumpIndexPatch(dumper, o, base, change);
+  }
+
+/// Dumps field of generated DumpDiff changed according to GetDiffChange.
+template <typename TType>
+void DumpDiffField(ASerializeDumper& dumper, const TType& o, const TType& base, const TDiffChange<TType>& change)
+  {
+  DumpDiffField(dumper, o, base, change, diff_kind<TType>());
+  }
+
+template <typename TType, size_t SIZE>
+void DumpDiffField(ASerializeDumper& dumper, const TType (&o)[SIZE], const TType (&)[SIZE],
+  const TDiffChange<TType[SIZE]>&)
+  {
+  DumpDiffWhole(dumper, o);
+  }
+
+template <typename TType>
+void LoadPatchField(ASerializeLoader& loader, TType& o, std::integral_constant<TDiffKind, DIFF_WHOLE>)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadDiffWhole(loader, o);
+  }
+
+template <typename TType>
+void LoadPatchField(ASerializeLoader& loader, TType& o, std::integral_constant<TDiffKind, DIFF_NESTED>)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  o.LoadPatch(loader);
+  }
+
+template <typename TType>
+void LoadPatchField(ASerializeLoader& loader, TType& o, std::integral_constant<TDiffKind, DIFF_BY_INDEX>)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadIndexPatch(loader, o);
+  }
+
+/// Loads changed field of generated LoadPatch.
+template <typename TType>
+void LoadPatchField(ASerializeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadPatchField(loader, o, diff_kind<TType>());
+  }
+
+template <typename TType, size_t SIZE>
+void LoadPatchField(ASerializeLoader& loader, TType (&o)[SIZE]) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadDiffWhole(loader, o);
+  }
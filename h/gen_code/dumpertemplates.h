@@ -17,8 +17,15 @@
 #include <serialize3/h/client_code/serialize_macros.h>
 #include <serialize3/h/client_code/serialize_ptrwrapper.h>
 #include <serialize3/h/client_code/serialize_utils.h>
+#include <serialize3/h/gen_code/adaptivetemplates.h>
+#include <serialize3/h/gen_code/columntemplates.h>
+#include <serialize3/h/gen_code/frontcodingtemplates.h>
+#include <serialize3/h/gen_code/packedtemplates.h>
+#include <serialize3/h/gen_code/rawlayouttemplates.h>
+#include <serialize3/h/gen_code/xorfloattemplates.h>
 
 #include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/stringdictionary.h>
 
 #if defined(SERIALIZABLE_BOOST_CONTAINERS)
 #include <serialize3/h/gen_code/serializable_boost_cntrs_includes.h>
@@ -199,7 +206,10 @@ void operator&(ASerializeDumper& dumper, const std::string& s)
   {
   DPUSH_INDENT;
   DLOGMSG("Dump(std::string)");
-  dumper.Dump(s);
+  if (dumper.GetStringDictionary() != nullptr)
+    dumper.GetStringDictionary()->Dump(dumper, s);
+  else
+    dumper.Dump(s);
   DPOP_INDENT;
   }
 
@@ -213,13 +223,156 @@ void operator&(ASerializeDumper& dumper, const std::string& s)
   DPOP_INDENT; \
   }
 
+//Primitive types whose memory is the same as their dumped form (long is dumped as 8 bytes).
+template <typename TType>
+struct is_raw_dumpable : public std::integral_constant<bool,
+  std::is_arithmetic<TType>::value && std::is_same<TType, bool>::value == false &&
+  (sizeof(TType) == sizeof(long long) ||
+   (std::is_same<TType, long>::value == false && std::is_same<TType, unsigned long>::value == false))> {};
+
+//Contiguous elements of such types are written by one WriteBufferReferenced call, so dumper
+//can copy them at once or reference them without copying (see TFdDumper).
+#define DUMP_RAW_CNTR_BODY(CNTR_NAME) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  if (c.empty() == false) \
+    dumper.WriteBufferReferenced(reinterpret_cast<const unsigned char*>(c.data()), c.size() * sizeof(T)); \
+  DPOP_INDENT; \
+  }
+
+//Elements of classes with raw layout are written at once, padding zeroed (see rawlayouttemplates.h)
+#define DUMP_RAW_LAYOUT_CNTR_BODY(CNTR_NAME) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  DumpRawLayoutObjects(dumper, c.data(), c.size(), serialized_raw_layout<T>::GetDescription()); \
+  DPOP_INDENT; \
+  }
+
+//Elements of classes with columnar encoding are written by columns (see columntemplates.h)
+#define DUMP_COLUMNS_CNTR_BODY(CNTR_NAME) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  DumpColumns(dumper, c.data(), c.size(), serialized_columnar<T>()); \
+  DPOP_INDENT; \
+  }
+
+//Integers of vectors, sets and map keys are packed (see packedtemplates.h)
+#define DUMP_PACKED_CNTR_BODY(CNTR_NAME, DELTA) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  DumpPackedIntegers(dumper, c.begin(), c.size(), DELTA, TPackedElement()); \
+  DPOP_INDENT; \
+  }
+
+#define DUMP_PACKED_MAP_BODY(CNTR_NAME, DELTA) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  DumpPackedIntegers(dumper, c.begin(), c.size(), DELTA, TPackedKey()); \
+  for (auto& i : c) \
+    dumper & i.second; \
+  DPOP_INDENT; \
+  }
+
+//Elements of vectors of primitive types are dumped by sampled encoding (see adaptivetemplates.h)
+#define DUMP_ADAPTIVE_CNTR_BODY(CNTR_NAME) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  DumpAdaptive(dumper, c, is_adaptive_encodable<T>()); \
+  DPOP_INDENT; \
+  }
+
+//Floats of vectors and deques are XOR compressed (see xorfloattemplates.h)
+#define DUMP_XOR_FLOATS_CNTR_BODY(CNTR_NAME) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  DumpXorFloats(dumper, c); \
+  DPOP_INDENT; \
+  }
+
+//Strings of sets and map keys are front coded (see frontcodingtemplates.h)
+#define DUMP_FRONT_CODED_CNTR_BODY(CNTR_NAME) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  DumpFrontCodedStrings(dumper, c.begin(), c.size(), TPackedElement()); \
+  DPOP_INDENT; \
+  }
+
+#define DUMP_FRONT_CODED_MAP_BODY(CNTR_NAME) \
+  { \
+  DPUSH_INDENT; \
+  DLOGMSG(CNTR_NAME); \
+  dumper.DumpSizeT(c.size()); \
+  DumpFrontCodedStrings(dumper, c.begin(), c.size(), TPackedKey()); \
+  for (auto& i : c) \
+    dumper & i.second; \
+  DPOP_INDENT; \
+  }
+
+//Integers which are not raw dumpable (long of LLP64) are encoded like in loadertemplates
 template <class T,class Alloc>
-void operator&(ASerializeDumper& dumper, const std::vector<T,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(vector)")
+typename std::enable_if<is_raw_dumpable<T>::value == false && serialized_raw_layout<T>::value == false>::type
+operator&(ASerializeDumper& dumper, const std::vector<T,Alloc>& c)
+  {
+  if (is_adaptive_encodable<T>::value && dumper.IsAdaptive())
+    DUMP_ADAPTIVE_CNTR_BODY("Dump(vector)")
+  else if (is_packable_integer<T>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(vector)", false)
+  else if (serialized_columnar<T>::value && dumper.IsColumnar())
+    DUMP_COLUMNS_CNTR_BODY("Dump(vector)")
+  else
+    DUMP_CNTR_BODY("Dump(vector)")
+  }
+
+template <class T,class Alloc>
+typename std::enable_if<is_raw_dumpable<T>::value>::type
+operator&(ASerializeDumper& dumper, const std::vector<T,Alloc>& c)
+  {
+  if (is_adaptive_encodable<T>::value && dumper.IsAdaptive())
+    DUMP_ADAPTIVE_CNTR_BODY("Dump(vector)")
+  else if (is_packable_integer<T>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(vector)", false)
+  else if (is_xor_float<T>::value && dumper.IsXorFloats())
+    DUMP_XOR_FLOATS_CNTR_BODY("Dump(vector)")
+  else
+    DUMP_RAW_CNTR_BODY("Dump(vector)")
+  }
+
+//Vectors of classes with raw layout are written at once in snapshots with raw layout
+template <class T,class Alloc>
+typename std::enable_if<serialized_raw_layout<T>::value>::type
+operator&(ASerializeDumper& dumper, const std::vector<T,Alloc>& c)
+  {
+  if (dumper.IsRawLayout() && std::is_trivially_copyable<T>::value)
+    DUMP_RAW_LAYOUT_CNTR_BODY("Dump(vector)")
+  else if (serialized_columnar<T>::value && dumper.IsColumnar())
+    DUMP_COLUMNS_CNTR_BODY("Dump(vector)")
+  else
+    DUMP_CNTR_BODY("Dump(vector)")
+  }
    
 template <class T,class Alloc>
 void operator&(ASerializeDumper& dumper, const std::deque<T,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(deque)")
+  {
+  if (is_xor_float<T>::value && dumper.IsXorFloats())
+    DUMP_XOR_FLOATS_CNTR_BODY("Dump(deque)")
+  else
+    DUMP_CNTR_BODY("Dump(deque)")
+  }
    
 template <class T,class Alloc>
 void operator&(ASerializeDumper& dumper, const std::list<T,Alloc>& c)
@@ -227,19 +380,47 @@ void operator&(ASerializeDumper& dumper, const std::list<T,Alloc>& c)
    
 template <class T, class Compare, class Alloc>
 void operator&(ASerializeDumper& dumper, const std::set<T,Compare,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(set)")
+  {
+  if (is_packable_integer<T>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(set)", (is_ascending_order<Compare, T>::value))
+  else if (std::is_same<T, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_CNTR_BODY("Dump(set)")
+  else
+    DUMP_CNTR_BODY("Dump(set)")
+  }
 
 template <class T, class Compare, class Alloc>
 void operator&(ASerializeDumper& dumper, const std::multiset<T,Compare,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(multiset)")
+  {
+  if (is_packable_integer<T>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(multiset)", (is_ascending_order<Compare, T>::value))
+  else if (std::is_same<T, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_CNTR_BODY("Dump(multiset)")
+  else
+    DUMP_CNTR_BODY("Dump(multiset)")
+  }
 
 template <class Key, class Value, class Compare, class Alloc>
 void operator&(ASerializeDumper& dumper, const std::map<Key,Value,Compare,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(map)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_MAP_BODY("Dump(map)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_MAP_BODY("Dump(map)")
+  else
+    DUMP_CNTR_BODY("Dump(map)")
+  }
 
 template <class Key, class Value, class Compare, class Alloc>
 void operator&(ASerializeDumper& dumper, const std::multimap<Key,Value,Compare,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(multimap)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_MAP_BODY("Dump(multimap)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_MAP_BODY("Dump(multimap)")
+  else
+    DUMP_CNTR_BODY("Dump(multimap)")
+  }
 
 template <class Key, class HashFcn, class EqualKey, class Alloc> 
 void operator&(ASerializeDumper& dumper, const std::unordered_set<Key,HashFcn,EqualKey,Alloc>& c)
@@ -284,30 +465,29 @@ void operator&(ASerializeDumper&, const TNoSerializePtrWrapper<T>&)
   {
   }
 
-template <class T>
-void operator & (ASerializeDumper& dumper, const TSerializedObjectRegistry<T>& reg)
+template <class T, class TStorageCntr>
+void operator & (ASerializeDumper& dumper, const TSerializedObjectRegistry<T, TStorageCntr>& reg)
   {
   DPUSH_INDENT;
   DLOGMSG("Dump(TSerializedObjectRegistry)");
-  typedef typename TSerializedObjectRegistry<T>::TStorage TStorage;
+  typedef typename TSerializedObjectRegistry<T, TStorageCntr>::TStorage TStorage;
   const TStorage& storage = reg.GetStorage();
-  size_t size = storage.size();
-  assert(size > 0); //storage always has one nul element
-  --size;
-  dumper.DumpSizeT(size);
+  assert(storage.size() > 0); //storage always has one nul element
+  dumper.DumpSizeT(reg.GetDumpedCount());
   typename TStorage::const_iterator i = storage.begin();
   ++i; //skip first element and dump rest like regular vector
 #ifdef DEBUG_SERIALIZER
   char buffer[15] = "MI: ";
 #endif
-  while (i != storage.end())
+  for (size_t handle = 1; i != storage.end(); ++i, ++handle)
     {
+    if (reg.GetDumpHandle(handle) == 0)
+      continue; //released object dropped by compact dump
 #ifdef DEBUG_SERIALIZER
     itoa(i-storage.begin(),buffer+4,10);
     DLOGMSG(buffer);
 #endif
     dumper & *i;
-    ++i;
     }
   DPOP_INDENT;
   }
@@ -327,44 +507,141 @@ void operator & (ASerializeDumper& dumper, const bc::list<T, Allocator>& c)
   DUMP_CNTR_BODY("Dump(boost::list)")
 
 template <class T,class Alloc>
-void operator&(ASerializeDumper& dumper, const bc::vector<T,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(boost::vector)")
+typename std::enable_if<is_raw_dumpable<T>::value == false && serialized_raw_layout<T>::value == false>::type
+operator&(ASerializeDumper& dumper, const bc::vector<T,Alloc>& c)
+  {
+  if (is_adaptive_encodable<T>::value && dumper.IsAdaptive())
+    DUMP_ADAPTIVE_CNTR_BODY("Dump(boost::vector)")
+  else if (is_packable_integer<T>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(boost::vector)", false)
+  else if (serialized_columnar<T>::value && dumper.IsColumnar())
+    DUMP_COLUMNS_CNTR_BODY("Dump(boost::vector)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::vector)")
+  }
+
+template <class T,class Alloc>
+typename std::enable_if<is_raw_dumpable<T>::value>::type
+operator&(ASerializeDumper& dumper, const bc::vector<T,Alloc>& c)
+  {
+  if (is_adaptive_encodable<T>::value && dumper.IsAdaptive())
+    DUMP_ADAPTIVE_CNTR_BODY("Dump(boost::vector)")
+  else if (is_packable_integer<T>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(boost::vector)", false)
+  else if (is_xor_float<T>::value && dumper.IsXorFloats())
+    DUMP_XOR_FLOATS_CNTR_BODY("Dump(boost::vector)")
+  else
+    DUMP_RAW_CNTR_BODY("Dump(boost::vector)")
+  }
+
+template <class T,class Alloc>
+typename std::enable_if<serialized_raw_layout<T>::value>::type
+operator&(ASerializeDumper& dumper, const bc::vector<T,Alloc>& c)
+  {
+  if (dumper.IsRawLayout() && std::is_trivially_copyable<T>::value)
+    DUMP_RAW_LAYOUT_CNTR_BODY("Dump(boost::vector)")
+  else if (serialized_columnar<T>::value && dumper.IsColumnar())
+    DUMP_COLUMNS_CNTR_BODY("Dump(boost::vector)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::vector)")
+  }
    
 template <class T,class Alloc>
 void operator&(ASerializeDumper& dumper, const bc::deque<T,Alloc>& c)
-  DUMP_CNTR_BODY("Dump(boost::deque)")
+  {
+  if (is_xor_float<T>::value && dumper.IsXorFloats())
+    DUMP_XOR_FLOATS_CNTR_BODY("Dump(boost::deque)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::deque)")
+  }
    
 template <class Key, class Compare, class Allocator, class SetOptions>
 void operator&(ASerializeDumper& dumper, const bc::set<Key,Compare,Allocator,SetOptions>& c)
-  DUMP_CNTR_BODY("Dump(boost::set)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(boost::set)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_CNTR_BODY("Dump(boost::set)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::set)")
+  }
 
 template <class Key, class Compare, class Allocator>
 void operator&(ASerializeDumper& dumper, const bc::flat_set<Key,Compare,Allocator>& c)
-  DUMP_CNTR_BODY("Dump(boost::flat_set)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(boost::flat_set)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_CNTR_BODY("Dump(boost::flat_set)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::flat_set)")
+  }
 
 template <class Key, class Compare, class Allocator, class MultiSetOptions>
 void operator&(ASerializeDumper& dumper, const bc::multiset<Key,Compare,Allocator,MultiSetOptions>& c)
-  DUMP_CNTR_BODY("Dump(boost::multiset)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(boost::multiset)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_CNTR_BODY("Dump(boost::multiset)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::multiset)")
+  }
 
 template <class Key, class Compare, class Allocator>
 void operator&(ASerializeDumper& dumper, const bc::flat_multiset<Key,Compare,Allocator>& c)
-  DUMP_CNTR_BODY("Dump(boost::flat_multiset)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_CNTR_BODY("Dump(boost::flat_multiset)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_CNTR_BODY("Dump(boost::flat_multiset)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::flat_multiset)")
+  }
 
 template <class Key, class T, class Compare, class Allocator, class MapOptions>
 void operator&(ASerializeDumper& dumper, const bc::map<Key,T,Compare,Allocator,MapOptions>& c)
-  DUMP_CNTR_BODY("Dump(boost::map)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_MAP_BODY("Dump(boost::map)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_MAP_BODY("Dump(boost::map)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::map)")
+  }
 
 template <class Key, class T, class Compare, class Allocator>
 void operator&(ASerializeDumper& dumper, const bc::flat_map<Key,T,Compare,Allocator>& c)
-  DUMP_CNTR_BODY("Dump(boost::flat_map)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_MAP_BODY("Dump(boost::flat_map)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_MAP_BODY("Dump(boost::flat_map)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::flat_map)")
+  }
 
 template <class Key, class T, class Compare, class Allocator, class MultiMapOptions>
 void operator&(ASerializeDumper& dumper, const bc::multimap<Key,T,Compare,Allocator,MultiMapOptions>& c)
-  DUMP_CNTR_BODY("Dump(boost::multimap)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_MAP_BODY("Dump(boost::multimap)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_MAP_BODY("Dump(boost::multimap)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::multimap)")
+  }
 
 template <class Key, class T, class Compare, class Allocator>
 void operator&(ASerializeDumper& dumper, const bc::flat_multimap<Key,T,Compare,Allocator>& c)
-  DUMP_CNTR_BODY("Dump(boost::flat_multimap)")
+  {
+  if (is_packable_integer<Key>::value && dumper.IsPackedIntegers())
+    DUMP_PACKED_MAP_BODY("Dump(boost::flat_multimap)", (is_ascending_order<Compare, Key>::value))
+  else if (std::is_same<Key, std::string>::value && dumper.IsFrontCodedStrings())
+    DUMP_FRONT_CODED_MAP_BODY("Dump(boost::flat_multimap)")
+  else
+    DUMP_CNTR_BODY("Dump(boost::flat_multimap)")
+  }
 
 template <class T, class H, class P, class A>
 void operator&(ASerializeDumper& dumper, const bu::unordered_set<T,H,P,A>& c)
@@ -0,0 +1,658 @@
+///\file flattemplates.h
+#pragma once
+
+//Flat (zero-parse) format: object is stored as table of aligned fields, which are read directly
+//from memory (f.e. mapped file, see TMappedFile) by generated TFlatView accessors, nothing is loaded.
+//Generator emits TFlatView<T> into typeids file for named classes without hierarchy whose members
+//are all named. Fields are laid out in declaration order, each aligned to its natural alignment:
+//- fundamentals and enums are stored inline and read by value,
+//- arrays and classes with TFlatView are stored inline (arrays read as TFlatSpan/TFlatVector),
+//- strings and vectors are stored as TFlatRef pointing behind the table, vectors of scalars
+//  are read as TFlatSpan (contiguous aligned array), other vectors as TFlatVector.
+//Members of other types (maps, sets, pointers...) can't be stored, flat-building of class with
+//such member fails to compile. TNoSerializeWrapper members are skipped.
+//Tables are written breadth first: table with its strings, then arrays of its vectors, so
+//TFlatBuilder with dumper writes finished sections of the buffer while it builds the rest.
+//Note: data are stored in native byte order and alignment, the buffer must be 8-byte aligned.
+
+#include <serialize3/h/client_code/serialize_utils.h>
+#include <serialize3/h/storage/serializedumper.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class TFlatBuilder;
+class TFlatVerifier;
+
+/// Specialized in generated typeids file, accessor of table of class TType.
+template <class TType>
+class TFlatView;
+
+/// Slot of out-of-line data (string or vector), offset is relative to the slot.
+struct TFlatRef
+  {
+  unsigned long long Offset;
+  unsigned long long Count;
+  };
+
+struct TFlatHeader
+  {
+  static const unsigned int   MAGIC = 0x4c463353; //"S3FL"
+  static const unsigned short VERSION = 1;
+
+  unsigned int       Magic;
+  unsigned short     Version;
+  unsigned short     Flags;
+  unsigned long long Size;       //whole buffer including header
+  unsigned long long RootOffset; //root table
+  };
+
+/// Base of generated accessors, table is null for invalid view.
+class AFlatView
+  {
+  public:
+    explicit AFlatView(const unsigned char* table = nullptr) : Table(table) {}
+
+    bool IsNull() const { return Table == nullptr; }
+    const unsigned char* GetTable() const { return Table; }
+
+  protected:
+    const unsigned char* Table;
+  };
+
+constexpr size_t FlatAlign(size_t offset, size_t alignment)
+  {
+  return (offset + alignment - 1) / alignment * alignment;
+  }
+
+//--------------- field traits
+
+//Specialized in generated typeids file for classes with TFlatView before the views are defined,
+//so views may refer to each other regardless of order (f.e. by vector of other class).
+template <class TType>
+struct is_flat_table : public std::false_type {};
+
+/** Describes how type is stored in the flat format: SIZE and ALIGN of its slot, TView returned
+    by accessor, Get reads the slot, Build writes it and Verify checks its references against
+    buffer. SUPPORTED is false for other types.
+*/
+template <class TType, typename = void>
+struct flat_traits
+  {
+  static const bool   SUPPORTED = false;
+  static const size_t SIZE = 0;
+  static const size_t ALIGN = 1;
+  };
+
+/// Returns offset of field of TType placed behind previous field ending at offset.
+template <class TType>
+constexpr size_t FlatFieldOffset(size_t offset)
+  {
+  return FlatAlign(offset, flat_traits<TType>::ALIGN);
+  }
+
+/// Returns size of table ending by field ending at offset (tables are 8-byte aligned).
+constexpr size_t FlatTableSize(size_t offset)
+  {
+  return FlatAlign(offset, 8);
+  }
+
+template <class TType>
+using flat_view_t = typename flat_traits<TType>::TView;
+
+/// Contiguous array of scalars (inline array or vector of fundamentals or enums).
+template <class TType>
+class TFlatSpan
+  {
+  public:
+    typedef TType        value_type;
+    typedef const TType* const_iterator;
+
+    TFlatSpan(const TType* data = nullptr, size_t count = 0) : Data(data), Count(count) {}
+
+    const TType* data() const { return Data; }
+    size_t size() const { return Count; }
+    bool empty() const { return Count == 0; }
+
+    const TType& operator[](size_t index) const { return Data[index]; }
+
+    const TType* begin() const { return Data; }
+    const TType* end() const { return Data + Count; }
+
+  private:
+    const TType* Data;
+    size_t       Count;
+  };
+
+/** Array of fields of other types (tables, strings, vectors), elements are read by flat_traits.
+    Note: element traits are used only in member functions, so vector may be declared before
+    TFlatView of its elements is defined.
+*/
+template <class TType>
+class TFlatVector
+  {
+  public:
+    class const_iterator
+      {
+      public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef flat_view_t<TType>              value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const value_type*               pointer;
+        typedef value_type                      reference;
+
+        explicit const_iterator(const unsigned char* slot) : Slot(slot) {}
+
+        value_type operator*() const { return flat_traits<TType>::Get(Slot); }
+
+        const_iterator& operator++() { Slot += Stride(); return *this; }
+        const_iterator operator++(int) { const_iterator result(*this); Slot += Stride(); return result; }
+
+        difference_type operator-(const const_iterator& other) const
+          {
+          return (Slot - other.Slot) / static_cast<difference_type>(Stride());
+          }
+
+        bool operator==(const const_iterator& other) const { return Slot == other.Slot; }
+        bool operator!=(const const_iterator& other) const { return Slot != other.Slot; }
+
+      private:
+        const unsigned char* Slot;
+      };
+
+    TFlatVector(const unsigned char* data = nullptr, size_t count = 0) : Data(data), Count(count) {}
+
+    size_t size() const { return Count; }
+    bool empty() const { return Count == 0; }
+
+    flat_view_t<TType> operator[](size_t index) const { return flat_traits<TType>::Get(Data + index * Stride()); }
+
+    const_iterator begin() const { return const_iterator(Data); }
+    const_iterator end() const { return const_iterator(Data + Count * Stride()); }
+
+  private:
+    static size_t Stride() { return flat_traits<TType>::SIZE; }
+
+    const unsigned char* Data;
+    size_t               Count;
+  };
+
+/// Null-terminated string stored behind the table.
+class TFlatString
+  {
+  public:
+    TFlatString(const char* data = "", size_t length = 0) : Data(data), Length(length) {}
+
+    const char* data() const { return Data; }
+    const char* c_str() const { return Data; }
+    size_t size() const { return Length; }
+    bool empty() const { return Length == 0; }
+
+    const char* begin() const { return Data; }
+    const char* end() const { return Data + Length; }
+
+    std::string str() const { return std::string(Data, Length); }
+
+    bool operator==(const TFlatString& other) const
+      {
+      return Length == other.Length && memcmp(Data, other.Data, Length) == 0;
+      }
+    bool operator!=(const TFlatString& other) const { return !(*this == other); }
+
+    bool operator==(const std::string& s) const { return *this == TFlatString(s.data(), s.size()); }
+    bool operator!=(const std::string& s) const { return !(*this == s); }
+
+  private:
+    const char* Data;
+    size_t      Length;
+  };
+
+//Const members are stored as non-const ones.
+template <class TType>
+struct flat_traits<const TType, typename std::enable_if<std::is_array<TType>::value == false>::type> :
+  public flat_traits<TType> {};
+
+template <class TType>
+struct flat_traits<TType, typename std::enable_if<(std::is_arithmetic<TType>::value ||
+  std::is_enum<TType>::value) && std::is_const<TType>::value == false>::type>
+  {
+  static const bool   SUPPORTED = true;
+  static const size_t SIZE = sizeof(TType);
+  static const size_t ALIGN = alignof(TType);
+  typedef TType TView;
+
+  static TView Get(const unsigned char* slot)
+    {
+    TType value;
+    memcpy(&value, slot, sizeof(TType));
+    return value;
+    }
+
+  static void Build(TFlatBuilder& builder, size_t slot, const TType& value);
+  static bool Verify(TFlatVerifier&, size_t) { return true; }
+  };
+
+template <class TType>
+struct flat_traits<TType, typename std::enable_if<is_flat_table<TType>::value>::type>
+  {
+  static const bool   SUPPORTED = true;
+  static const size_t SIZE = TFlatView<TType>::SIZE;
+  static const size_t ALIGN = 8;
+  typedef TFlatView<TType> TView;
+
+  static TView Get(const unsigned char* slot) { return TView(slot); }
+
+  static void Build(TFlatBuilder& builder, size_t slot, const TType& o)
+    {
+    TFlatView<TType>::Build(builder, slot, o);
+    }
+
+  static bool Verify(TFlatVerifier& verifier, size_t slot)
+    {
+    return TFlatView<TType>::Verify(verifier, slot);
+    }
+  };
+
+template <class TType, size_t N>
+struct flat_traits<TType[N], typename std::enable_if<flat_traits<TType>::SUPPORTED>::type>
+  {
+  static const bool   SUPPORTED = true;
+  static const size_t SIZE = N * flat_traits<TType>::SIZE;
+  static const size_t ALIGN = flat_traits<TType>::ALIGN;
+  typedef typename std::conditional<std::is_scalar<TType>::value, TFlatSpan<TType>,
+    TFlatVector<TType>>::type TView;
+
+  static TView Get(const unsigned char* slot) { return GetArray<TView>(slot); }
+
+  static void Build(TFlatBuilder& builder, size_t slot, const TType (&a)[N])
+    {
+    for (size_t i = 0; i < N; ++i)
+      flat_traits<TType>::Build(builder, slot + i * flat_traits<TType>::SIZE, a[i]);
+    }
+
+  static bool Verify(TFlatVerifier& verifier, size_t slot)
+    {
+    bool valid = true;
+    for (size_t i = 0; i < N && valid && std::is_scalar<TType>::value == false; ++i)
+      valid = flat_traits<TType>::Verify(verifier, slot + i * flat_traits<TType>::SIZE);
+    return valid;
+    }
+
+  private:
+    template <class TArrayView>
+    static typename std::enable_if<std::is_scalar<TType>::value, TArrayView>::type
+    GetArray(const unsigned char* slot) { return TArrayView(reinterpret_cast<const TType*>(slot), N); }
+
+    template <class TArrayView>
+    static typename std::enable_if<std::is_scalar<TType>::value == false, TArrayView>::type
+    GetArray(const unsigned char* slot) { return TArrayView(slot, N); }
+  };
+
+template <class TChar, class TCharTraits, class TAlloc>
+struct flat_traits<std::basic_string<TChar, TCharTraits, TAlloc>,
+  typename std::enable_if<sizeof(TChar) == 1>::type>
+  {
+  static const bool   SUPPORTED = true;
+  static const size_t SIZE = sizeof(TFlatRef);
+  static const size_t ALIGN = 8;
+  typedef TFlatString TView;
+
+  static TView Get(const unsigned char* slot)
+    {
+    const TFlatRef* ref = reinterpret_cast<const TFlatRef*>(slot);
+    return TView(reinterpret_cast<const char*>(slot + ref->Offset), static_cast<size_t>(ref->Count));
+    }
+
+  static void Build(TFlatBuilder& builder, size_t slot, const std::basic_string<TChar, TCharTraits, TAlloc>& s);
+  static bool Verify(TFlatVerifier& verifier, size_t slot);
+  };
+
+//Slot doesn't depend on element type, elements are checked when vector is built.
+template <class TType, class TAlloc>
+struct flat_traits<std::vector<TType, TAlloc>>
+  {
+  static const bool   SUPPORTED = true;
+  static const size_t SIZE = sizeof(TFlatRef);
+  static const size_t ALIGN = 8;
+  typedef typename std::conditional<std::is_scalar<TType>::value, TFlatSpan<TType>,
+    TFlatVector<TType>>::type TView;
+
+  static TView Get(const unsigned char* slot)
+    {
+    const TFlatRef* ref = reinterpret_cast<const TFlatRef*>(slot);
+    return GetVector<TView>(slot + ref->Offset, static_cast<size_t>(ref->Count));
+    }
+
+  static void Build(TFlatBuilder& builder, size_t slot, const std::vector<TType, TAlloc>& v);
+  static bool Verify(TFlatVerifier& verifier, size_t slot);
+
+  private:
+    //elements of vectors of non-scalars are written after their table (see TFlatBuilder)
+    static void BuildElements(TFlatBuilder& builder, size_t offset, const void* v);
+
+    template <class TVectorView>
+    static typename std::enable_if<std::is_scalar<TType>::value, TVectorView>::type
+    GetVector(const unsigned char* data, size_t count) { return TVectorView(reinterpret_cast<const TType*>(data), count); }
+
+    template <class TVectorView>
+    static typename std::enable_if<std::is_scalar<TType>::value == false, TVectorView>::type
+    GetVector(const unsigned char* data, size_t count) { return TVectorView(data, count); }
+  };
+
+//Not serialized members take no space.
+template <class TType>
+struct flat_traits<TNoSerializeWrapper<TType>>
+  {
+  static const bool   SUPPORTED = true;
+  static const size_t SIZE = 0;
+  static const size_t ALIGN = 1;
+  typedef void TView;
+
+  static void Build(TFlatBuilder&, size_t, const TNoSerializeWrapper<TType>&) {}
+  static bool Verify(TFlatVerifier&, size_t) { return true; }
+  };
+
+template <class TType>
+struct flat_traits<TNoSerializePtrWrapper<TType>>
+  {
+  static const bool   SUPPORTED = true;
+  static const size_t SIZE = 0;
+  static const size_t ALIGN = 1;
+  typedef void TView;
+
+  static void Build(TFlatBuilder&, size_t, const TNoSerializePtrWrapper<TType>&) {}
+  static bool Verify(TFlatVerifier&, size_t) { return true; }
+  };
+
+//--------------- building
+
+//Size of finished part of buffer written to dumper at once by TFlatBuilder
+const size_t FLAT_SECTION_SIZE = 1 << 20;
+
+/** Builds flat buffer, root table follows the header. Without dumper the buffer is built in
+    memory (see GetBuffer). With dumper objects are traversed twice, first to count size of the
+    buffer for header, then finished sections are written to dumper as soon as they reach
+    sectionSize, so only part of buffer not finished yet is kept in memory.
+*/
+class TFlatBuilder
+  {
+  public:
+    explicit TFlatBuilder(ASerializeDumper* dumper = nullptr, size_t sectionSize = FLAT_SECTION_SIZE) :
+      Dumper(dumper), SectionSize(sectionSize), Counting(false), Start(0), End(0) {}
+
+    template <class TType>
+    void Build(const TType& root)
+      {
+      static_assert(is_flat_table<TType>::value, "Type has no TFlatView");
+
+      TFlatHeader header;
+      header.Magic = TFlatHeader::MAGIC;
+      header.Version = TFlatHeader::VERSION;
+      header.Flags = 0;
+      header.Size = 0;
+      if (Dumper != nullptr)
+        {
+        Counting = true;
+        BuildTables(root);
+        Counting = false;
+        header.Size = End;
+        }
+
+      header.RootOffset = BuildTables(root, &header);
+      if (Dumper != nullptr)
+        Flush(End);
+      else
+        {
+        header.Size = End;
+        Write(0, &header, sizeof(header));
+        }
+      }
+
+    /// Built buffer, only unwritten rest of it if it is built for dumper.
+    const std::vector<unsigned char>& GetBuffer() const { return Buffer; }
+
+    /// Appends zeroed block aligned to alignment, returns its offset.
+    size_t Allocate(size_t size, size_t alignment)
+      {
+      size_t offset = FlatAlign(End, alignment);
+      End = offset + size;
+      if (Counting == false)
+        Buffer.resize(End - Start);
+      return offset;
+      }
+
+    void Write(size_t offset, const void* data, size_t size)
+      {
+      if (size != 0 && Counting == false)
+        {
+        assert(offset >= Start);
+        memcpy(Buffer.data() + (offset - Start), data, size);
+        }
+      }
+
+    /// Writes field to its slot in table.
+    template <class TType>
+    void WriteField(size_t slot, const TType& value)
+      {
+      static_assert(flat_traits<TType>::SUPPORTED, "Type can't be stored in flat format");
+      flat_traits<TType>::Build(*this, slot, value);
+      }
+
+    /// Writes reference to out-of-line data at offset to slot.
+    void WriteRef(size_t slot, size_t offset, size_t count)
+      {
+      TFlatRef ref = { offset - slot, count };
+      Write(slot, &ref, sizeof(ref));
+      }
+
+    /// Elements of array at offset are built by buildElements(builder, offset, source) after current tables.
+    void AddPending(size_t offset, void (*buildElements)(TFlatBuilder&, size_t, const void*), const void* source)
+      {
+      TPending pending = { offset, buildElements, source };
+      Pending.push_back(pending);
+      }
+
+  private:
+    struct TPending
+      {
+      size_t      Offset;
+      void        (*BuildElements)(TFlatBuilder&, size_t, const void*);
+      const void* Source;
+      };
+
+    //Builds header (if given) and all tables breadth first, returns offset of root table
+    template <class TType>
+    size_t BuildTables(const TType& root, const TFlatHeader* header = nullptr)
+      {
+      Buffer.clear();
+      Pending.clear();
+      Start = 0;
+      End = 0;
+      Allocate(sizeof(TFlatHeader), 8);
+      if (header != nullptr)
+        Write(0, header, sizeof(TFlatHeader));
+      size_t rootOffset = Allocate(TFlatView<TType>::SIZE, 8);
+      if (header != nullptr)
+        Write(offsetof(TFlatHeader, RootOffset), &rootOffset, sizeof(header->RootOffset));
+      TFlatView<TType>::Build(*this, rootOffset, root);
+
+      //arrays are allocated in order, everything before the first unfinished one is final
+      while (Pending.empty() == false)
+        {
+        TPending pending = Pending.front();
+        pending.BuildElements(*this, pending.Offset, pending.Source);
+        Pending.pop_front();
+        if (Dumper != nullptr && Counting == false)
+          Flush(Pending.empty() ? End : Pending.front().Offset);
+        }
+      return rootOffset;
+      }
+
+    //Writes buffer before offset to dumper once it is at least one section
+    void Flush(size_t offset)
+      {
+      if (offset - Start < SectionSize && offset != End)
+        return;
+
+      Dumper->WriteBuffer(Buffer.data(), offset - Start);
+      Buffer.erase(Buffer.begin(), Buffer.begin() + (offset - Start));
+      Start = offset;
+      }
+
+  /// Class attributes:
+  private:
+    ASerializeDumper*          Dumper;
+    size_t                     SectionSize;
+    bool                       Counting; //only size is counted
+    std::vector<unsigned char> Buffer;   //part of buffer from Start to End
+    size_t                     Start;
+    size_t                     End;
+    std::deque<TPending>       Pending;  //arrays whose elements are not built yet
+  };
+
+template <class TType>
+void flat_traits<TType, typename std::enable_if<(std::is_arithmetic<TType>::value ||
+  std::is_enum<TType>::value) && std::is_const<TType>::value == false>::type>::Build(TFlatBuilder& builder, size_t slot, const TType& value)
+  {
+  builder.Write(slot, &value, sizeof(TType));
+  }
+
+template <class TChar, class TCharTraits, class TAlloc>
+void flat_traits<std::basic_string<TChar, TCharTraits, TAlloc>, typename std::enable_if<sizeof(TChar) == 1>::type>::
+  Build(TFlatBuilder& builder, size_t slot, const std::basic_string<TChar, TCharTraits, TAlloc>& s)
+  {
+  size_t offset = builder.Allocate(s.size() + 1, 1);
+  builder.Write(offset, s.data(), s.size());
+  builder.WriteRef(slot, offset, s.size());
+  }
+
+template <class TType, class TAlloc>
+void flat_traits<std::vector<TType, TAlloc>>::Build(TFlatBuilder& builder, size_t slot,
+  const std::vector<TType, TAlloc>& v)
+  {
+  static_assert(flat_traits<TType>::SUPPORTED, "Type of vector elements can't be stored in flat format");
+
+  size_t offset = builder.Allocate(v.size() * flat_traits<TType>::SIZE, 8);
+  builder.WriteRef(slot, offset, v.size());
+  if (std::is_scalar<TType>::value)
+    builder.Write(offset, v.data(), v.size() * flat_traits<TType>::SIZE);
+  else if (v.empty() == false)
+    builder.AddPending(offset, &BuildElements, &v);
+  }
+
+template <class TType, class TAlloc>
+void flat_traits<std::vector<TType, TAlloc>>::BuildElements(TFlatBuilder& builder, size_t offset, const void* v)
+  {
+  const std::vector<TType, TAlloc>& elements = *static_cast<const std::vector<TType, TAlloc>*>(v);
+  for (size_t i = 0; i < elements.size(); ++i)
+    flat_traits<TType>::Build(builder, offset + i * flat_traits<TType>::SIZE, elements[i]);
+  }
+
+/// Builds flat buffer with root object and writes it to dumper by sections.
+template <class TType>
+void DumpFlat(ASerializeDumper& dumper, const TType& root)
+  {
+  TFlatBuilder builder(&dumper);
+  builder.Build(root);
+  }
+
+//--------------- reading
+
+//---------- TFlatVerifier
+//Checks that references of fields point into the buffer. Each reference consumes its data from
+//budget of buffer size, so verification is linear even if references share data.
+class TFlatVerifier
+  {
+  public:
+    TFlatVerifier(const unsigned char* buffer, size_t size) : Buffer(buffer), Size(size), Budget(size) {}
+
+    const unsigned char* GetBuffer() const { return Buffer; }
+
+    template <class TType>
+    bool VerifyField(size_t slot)
+      {
+      return flat_traits<TType>::Verify(*this, slot);
+      }
+
+    /** Checks reference at slot to count elements of elementSize aligned to alignment followed
+        by extraSize bytes, returns offset of data and count.
+    */
+    bool VerifyRef(size_t slot, size_t elementSize, size_t alignment, size_t extraSize, size_t& offset, size_t& count)
+      {
+      TFlatRef ref;
+      memcpy(&ref, Buffer + slot, sizeof(ref));
+      if (ref.Offset > Size - slot)
+        return false;
+
+      offset = slot + static_cast<size_t>(ref.Offset);
+      size_t available = std::min(Size - offset, Budget);
+      if (offset % alignment != 0 || extraSize > available)
+        return false;
+      available -= extraSize;
+      if (ref.Count > (elementSize != 0 ? available / elementSize : Size))
+        return false;
+
+      count = static_cast<size_t>(ref.Count);
+      Budget -= count * elementSize + extraSize;
+      return true;
+      }
+
+  /// Class attributes:
+  private:
+    const unsigned char* Buffer;
+    size_t               Size;
+    size_t               Budget; //bytes of data which may still be referenced
+  }; //TFlatVerifier
+
+//Strings are null-terminated
+template <class TChar, class TCharTraits, class TAlloc>
+bool flat_traits<std::basic_string<TChar, TCharTraits, TAlloc>, typename std::enable_if<sizeof(TChar) == 1>::type>::
+  Verify(TFlatVerifier& verifier, size_t slot)
+  {
+  size_t offset, count;
+  return verifier.VerifyRef(slot, 1, 1, 1, offset, count) && verifier.GetBuffer()[offset + count] == 0;
+  }
+
+template <class TType, class TAlloc>
+bool flat_traits<std::vector<TType, TAlloc>>::Verify(TFlatVerifier& verifier, size_t slot)
+  {
+  size_t offset, count;
+  bool valid = verifier.VerifyRef(slot, flat_traits<TType>::SIZE, flat_traits<TType>::ALIGN, 0, offset, count);
+
+  for (size_t i = 0; i < count && valid && std::is_scalar<TType>::value == false; ++i)
+    valid = flat_traits<TType>::Verify(verifier, offset + i * flat_traits<TType>::SIZE);
+  return valid;
+  }
+
+/** Returns view of root table of flat buffer (f.e. mapped file), null view if buffer is not valid
+    flat buffer (bad header, truncated or unaligned, references of fields outside of buffer).
+    All tables reachable from root are checked, so views never read outside the buffer.
+*/
+template <class TType>
+TFlatView<TType> GetFlatRoot(const void* data, size_t size)
+  {
+  const unsigned char* buffer = static_cast<const unsigned char*>(data);
+  TFlatHeader header;
+
+  if (reinterpret_cast<size_t>(buffer) % 8 != 0 || size < sizeof(header))
+    return TFlatView<TType>();
+
+  memcpy(&header, buffer, sizeof(header));
+  if (header.Magic != TFlatHeader::MAGIC || header.Version > TFlatHeader::VERSION || header.Size > size ||
+      header.Size < sizeof(header) || header.RootOffset % 8 != 0 || header.RootOffset > header.Size ||
+      TFlatView<TType>::SIZE > header.Size - header.RootOffset)
+    return TFlatView<TType>();
+
+  TFlatVerifier verifier(buffer, static_cast<size_t>(header.Size));
+  if (TFlatView<TType>::Verify(verifier, static_cast<size_t>(header.RootOffset)) == false)
+    return TFlatView<TType>();
+
+  return TFlatView<TType>(buffer + header.RootOffset);
+  }
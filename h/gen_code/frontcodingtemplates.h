@@ -0,0 +1,116 @@
+///\file frontcodingtemplates.h
+#pragma once
+
+//Support for front coding of sorted strings. Sets and map keys of strings are dumped front
+//coded if it is enabled in dumper (see serialize_snapshotheader.h):
+//  count, restart interval, { [shared prefix length], suffix length, suffix } for each key,
+//  { value } for each map element
+//Shared prefix is the length of prefix common with previous key, it is omitted for every
+//restart interval-th key, which is dumped in full. Lengths are variable length integers.
+//Front coded keys are not added to string dictionary.
+
+#include <serialize3/h/gen_code/packedtemplates.h>
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+#include <serialize3/h/storage/varuint.h>
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+const size_t FRONT_CODING_RESTART_INTERVAL = 16;
+
+/// Dumps strings got by getter (see TPackedElement) from count elements starting at i.
+template <class TIterator, class TGetter>
+void DumpFrontCodedStrings(ASerializeDumper& dumper, TIterator i, size_t count, TGetter get,
+  std::true_type)
+  {
+  const std::string* previous = nullptr;
+
+  if (count == 0)
+    return;
+  DumpVarUInt(dumper, FRONT_CODING_RESTART_INTERVAL);
+  for (size_t n = 0; n < count; ++n, ++i)
+    {
+    const std::string& key = get(*i);
+    size_t prefix = 0;
+    if (n % FRONT_CODING_RESTART_INTERVAL != 0)
+      {
+      size_t length = std::min(key.size(), previous->size());
+      while (prefix < length && key[prefix] == (*previous)[prefix])
+        ++prefix;
+      DumpVarUInt(dumper, prefix);
+      }
+
+    DumpVarUInt(dumper, key.size() - prefix);
+    dumper.WriteBuffer(reinterpret_cast<const unsigned char*>(key.data()) + prefix, key.size() - prefix);
+    previous = &key;
+    }
+  }
+
+template <class TIterator, class TGetter>
+void DumpFrontCodedStrings(ASerializeDumper&, TIterator, size_t, TGetter, std::false_type)
+  {
+  }
+
+template <class TIterator, class TGetter>
+void DumpFrontCodedStrings(ASerializeDumper& dumper, TIterator i, size_t count, TGetter get)
+  {
+  typedef typename std::decay<decltype(get(*i))>::type TValue;
+  DumpFrontCodedStrings(dumper, i, count, get, std::is_same<TValue, std::string>());
+  }
+
+/** Loads count front coded strings and passes them to insert, which returns reference to
+    inserted string (valid till next insert). Each key is built once from stored previous key
+    and suffix read directly from loader. Lengths are not trusted, keys over length limit are
+    rejected and suffixes are read like strings (see AcquireLoadedBuffer).
+*/
+template <class TInserter>
+void LoadFrontCodedStrings(ASerializeLoader& loader, size_t count, TInserter insert,
+  std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  unsigned long long interval = 0;
+  const std::string* previous = nullptr;
+
+  if (count == 0)
+    return;
+  LoadVarUInt(loader, interval);
+  if (interval == 0 && loader.HasError() == false)
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+
+  for (size_t n = 0; n < count && loader.HasError() == false; ++n)
+    {
+    unsigned long long prefix = 0;
+    unsigned long long suffix = 0;
+    if (n % interval != 0)
+      LoadVarUInt(loader, prefix);
+    LoadVarUInt(loader, suffix);
+    if (loader.HasError())
+      return;
+    if ((previous == nullptr && prefix != 0) || (previous != nullptr && prefix > previous->size()))
+      {
+      loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+      return;
+      }
+    if (suffix > loader.GetLengthLimit() - prefix)
+      {
+      loader.SetError(ASerializeLoader::LOAD_OVERSIZED_LENGTH);
+      return;
+      }
+
+    const unsigned char* data = loader.AcquireLoadedBuffer(static_cast<size_t>(suffix));
+    if (loader.HasError())
+      return;
+    std::string key;
+    key.reserve(static_cast<size_t>(prefix + suffix));
+    if (prefix != 0)
+      key.assign(*previous, 0, static_cast<size_t>(prefix));
+    key.append(reinterpret_cast<const char*>(data), static_cast<size_t>(suffix));
+    previous = &insert(std::move(key));
+    }
+  }
+
+template <class TInserter>
+void LoadFrontCodedStrings(ASerializeLoader&, size_t, TInserter, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
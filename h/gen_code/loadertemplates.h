@@ -10,7 +10,15 @@
 
 #include <serialize3/h/client_code/serialize_utils.h>
 #include <serialize3/h/gen_code/serializable_std_type_includes.h>
+#include <serialize3/h/gen_code/adaptivetemplates.h>
+#include <serialize3/h/gen_code/columntemplates.h>
+#include <serialize3/h/gen_code/frontcodingtemplates.h>
+#include <serialize3/h/gen_code/packedtemplates.h>
+#include <serialize3/h/gen_code/rawlayouttemplates.h>
+#include <serialize3/h/gen_code/xorfloattemplates.h>
 #include <serialize3/h/storage/serializeloader.h>  
+#include <serialize3/h/storage/fixedsizeloader.h>
+#include <serialize3/h/storage/stringdictionary.h>
 
 #if defined(SERIALIZABLE_BOOST_CONTAINERS)
 #include <serialize3/h/gen_code/serializable_boost_cntrs_includes.h>
@@ -31,23 +39,25 @@ typename std::enable_if<std::is_class<TType>::value == false>::type
 typename std::enable_if<std::is_enum<TType>::value == false &&
                         std::is_class<TType>::value == false>::type
 #endif
-operator&(ASerializeLoader& loader, TType& o)
+operator&(ASerializeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 template <typename TType>
 typename std::enable_if<std::is_class<TType>::value>::type
-operator&(ASerializeLoader& loader, TType& o)
+operator&(ASerializeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT
   {
-  o.Load(loader);
+  //object boundary - don't continue loading after error
+  if (loader.HasError() == false)
+    o.Load(loader);
   }
 
 #if !defined(GENERATE_ENUM_OPERATORS)
 // Enum types
 template <typename TType>
 typename std::enable_if<std::is_enum<TType>::value>::type
-operator&(ASerializeLoader& loader, TType& o)
+operator&(ASerializeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT
   {
   static_assert(sizeof(TType) <= 8, "Too big size of enum type");
   switch (sizeof(TType))
@@ -64,75 +74,95 @@ operator&(ASerializeLoader& loader, TType& o)
 //-------------- load primitive types
   
 inline
-void operator&(ASerializeLoader& loader, bool& o)
+void operator&(ASerializeLoader& loader, bool& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, char& o)
+void operator&(ASerializeLoader& loader, char& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, unsigned char& o)
+void operator&(ASerializeLoader& loader, unsigned char& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, short& o)
+void operator&(ASerializeLoader& loader, short& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, unsigned short& o)
+void operator&(ASerializeLoader& loader, unsigned short& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, int& o)
+void operator&(ASerializeLoader& loader, int& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, unsigned int& o)
+void operator&(ASerializeLoader& loader, unsigned int& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, long long& o)
+void operator&(ASerializeLoader& loader, long long& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, unsigned long& o)
+void operator&(ASerializeLoader& loader, unsigned long& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, unsigned long long& o)
+void operator&(ASerializeLoader& loader, unsigned long long& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
 inline
-void operator&(ASerializeLoader& loader, double& o)
+void operator&(ASerializeLoader& loader, double& o) SERIALIZE_LOAD_NOEXCEPT
   {
   loader.Load(o);
   }
 
+//--------------- load members of fixed-size classes
+
+//Primitive types, enums and unions (all loaded as raw memory) are read without checks,
+//object was already checked as a whole in TFixedSizeLoader constructor.
+template <typename TType>
+typename std::enable_if<std::is_arithmetic<TType>::value || std::is_enum<TType>::value ||
+                        std::is_union<TType>::value>::type
+operator&(TFixedSizeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT
+  {
+  loader.Read(o);
+  }
+
+//Nested fixed-size objects acquire their part of already checked memory.
+template <typename TType>
+typename std::enable_if<std::is_class<TType>::value>::type
+operator&(TFixedSizeLoader& loader, TType& o) SERIALIZE_LOAD_NOEXCEPT
+  {
+  o.Load(loader);
+  }
+
 //--------------- load stl types
 
 template <class T1, class T2> 
-void operator&(ASerializeLoader& loader, std::pair<T1,T2>& p)
+void operator&(ASerializeLoader& loader, std::pair<T1,T2>& p) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load(pair)");
@@ -144,18 +174,18 @@ void operator&(ASerializeLoader& loader, std::pair<T1,T2>& p)
 #if !defined(_MSC_VER) || (_MSC_VER >= 1912)
 template <std::size_t I = 0, typename... TTypes>
 typename std::enable_if<I == sizeof...(TTypes)>::type
-Load(ASerializeLoader& loader, std::tuple<TTypes...>& t) {}
+Load(ASerializeLoader& loader, std::tuple<TTypes...>& t) SERIALIZE_LOAD_NOEXCEPT {}
 
 template <std::size_t I = 0, typename... TTypes>
 typename std::enable_if<I < sizeof...(TTypes)>::type
-Load(ASerializeLoader& loader, std::tuple<TTypes...>& t)
+Load(ASerializeLoader& loader, std::tuple<TTypes...>& t) SERIALIZE_LOAD_NOEXCEPT
   {
   loader & std::get<I>(t);
   Load<I + 1>(loader, t);
   }
 
 template <typename... TTypes>
-void operator&(ASerializeLoader& loader, std::tuple<TTypes...>& t)
+void operator&(ASerializeLoader& loader, std::tuple<TTypes...>& t) SERIALIZE_LOAD_NOEXCEPT
   {
   DPUSH_INDENT;
   DLOGMSG("Load(tuple)");
@@ -164,166 +194,503 @@ void operator&(ASerializeLoader& loader, std::tuple<TTypes...>& t)
   }
 #endif // !defined(_MSC_VER)
 
+//Classes with loading constructor (see SERIALIZABLE_LOAD_CONSTRUCTOR) are constructed in
+//containers directly from loader
 template <typename TType>
-void operator&(ASerializeLoader& loader, std::unique_ptr<TType>& o)
+struct is_load_constructible : public std::is_constructible<TType, TLoadTag, ASerializeLoader&> {};
+
+template <typename TType>
+TType* NewLoaded(ASerializeLoader& loader, std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  return new TType(TLoadTag(), loader);
+  }
+
+//Object is loaded by caller
+template <typename TType>
+TType* NewLoaded(ASerializeLoader&, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  return new TType;
+  }
+
+template <typename TType>
+void operator&(ASerializeLoader& loader, std::unique_ptr<TType>& o) SERIALIZE_LOAD_NOEXCEPT
   {
   DPUSH_INDENT;
   DLOGMSG("Load(std::unique_ptr)");
-  TType* _o = new TType;
-  loader & *_o;
+  TType* _o = NewLoaded<TType>(loader, is_load_constructible<TType>());
+  if (is_load_constructible<TType>::value == false)
+    loader & *_o;
   o.reset(_o);
   DPOP_INDENT;
   }
 
 template <typename TType>
-void operator&(ASerializeLoader& loader, std::shared_ptr<TType>& o)
+void operator&(ASerializeLoader& loader, std::shared_ptr<TType>& o) SERIALIZE_LOAD_NOEXCEPT
   {
   DPUSH_INDENT;
   DLOGMSG("Load(std::shared_ptr)");
-  TType* _o = new TType;
-  loader & *_o;
+  TType* _o = NewLoaded<TType>(loader, is_load_constructible<TType>());
+  if (is_load_constructible<TType>::value == false)
+    loader & *_o;
   o.reset(_o);
   DPOP_INDENT;
   }
 
 inline
-void operator&(ASerializeLoader& loader, std::string& s)
-  {
-  loader.Load(s);
-  }
-
-#define LOAD_CNTR_SEQ_BODY(CNTR_NAME) \
-  {                                   \
-  LPUSH_INDENT;                       \
-  LLOGMSG(CNTR_NAME);                 \
-  size_t size;                        \
-  loader.LoadSizeT(size);             \
-  size_t i = c.size();                \
-  size += i;                          \
-  c.resize(size);                     \
-  for (; i < size; ++i)               \
-    loader & c[i];                    \
-  LPOP_INDENT;                        \
-  }
-
-#define LOAD_LIST_BODY(CNTR_NAME)   \
-  {                                 \
-  LPUSH_INDENT;                     \
-  LLOGMSG(CNTR_NAME);               \
-  size_t size;                      \
-  loader.LoadSizeT(size);           \
-  for (size_t i = 0; i < size; ++i) \
-    {                               \
-    T t;                            \
-    loader & t;                     \
-    c.emplace_back(std::move(t));   \
-    }                               \
-  LPOP_INDENT;                      \
-  }
-
-#define LOAD_SET_BODY(CNTR_NAME)              \
-  {                                           \
-  LPUSH_INDENT;                               \
-  LLOGMSG(CNTR_NAME);                         \
-  size_t size;                                \
-  loader.LoadSizeT(size);                     \
-  if (c.empty())                              \
-    {                                         \
-    for (size_t i = 0; i < size; ++i)         \
-      {                                       \
-      Key t;                                  \
-      loader & t;                             \
-      c.emplace_hint(c.end(), std::move(t));  \
-      }                                       \
-    }                                         \
-  else                                        \
-    {                                         \
-    for (size_t i = 0; i < size; ++i)         \
-      {                                       \
-      Key t;                                  \
-      loader & t;                             \
-      c.emplace(std::move(t));                \
-      }                                       \
-    }                                         \
-  LPOP_INDENT;                                \
-  }
-
-#define LOAD_MAP_BODY(CNTR_NAME)                                        \
-  {                                                                     \
-  LPUSH_INDENT;                                                         \
-  LLOGMSG(CNTR_NAME);                                                   \
-  size_t size;                                                          \
-  loader.LoadSizeT(size);                                               \
-  if (c.empty())                                                        \
-    {                                                                   \
-    for (size_t i = 0; i < size; ++i)                                   \
-      {                                                                 \
-      std::pair<Key, Value> p;                                          \
-      loader & p;                                                       \
-      c.emplace_hint(c.end(), std::move(p.first), std::move(p.second)); \
-      }                                                                 \
-    }                                                                   \
-  else                                                                  \
-    {                                                                   \
-    for (size_t i = 0; i < size; ++i)                                   \
-      {                                                                 \
-      std::pair<Key, Value> p;                                          \
-      loader & p;                                                       \
-      c.emplace(std::move(p.first), std::move(p.second));               \
-      }                                                                 \
-    }                                                                   \
-  LPOP_INDENT;                                                          \
+void operator&(ASerializeLoader& loader, std::string& s) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (loader.GetStringDictionary() != nullptr)
+    {
+    TLoadStringDictionary::TString shared = loader.GetStringDictionary()->Load(loader);
+    if (shared)
+      s = *shared;
+    }
+  else
+    loader.Load(s);
+  }
+
+//Strings loaded with string dictionary share one string per dictionary entry
+inline
+void operator&(ASerializeLoader& loader, std::shared_ptr<const std::string>& s) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LPUSH_INDENT;
+  LLOGMSG("Load(std::shared_ptr<const std::string>)");
+  if (loader.GetStringDictionary() != nullptr)
+    s = loader.GetStringDictionary()->Load(loader);
+  else
+    {
+    std::shared_ptr<std::string> loaded = std::make_shared<std::string>();
+    loader.Load(*loaded);
+    s = std::move(loaded);
+    }
+  LPOP_INDENT;
+  }
+
+/** Minimal number of bytes taken by dumped element of container loaded one by one, 0 if it is
+    not known (classes may be empty).
+*/
+template <typename TType>
+struct serialized_min_size : std::integral_constant<size_t,
+  std::is_arithmetic<TType>::value || std::is_enum<TType>::value ? 1 : 0> {};
+
+template <class CharT, class Traits, class Allocator>
+struct serialized_min_size<std::basic_string<CharT, Traits, Allocator>> : std::integral_constant<size_t, 1> {};
+
+//type id of pointed object
+template <class T>
+struct serialized_min_size<TSingleRefPtr<T>> : std::integral_constant<size_t, sizeof(TTypeId)> {};
+
+template <class TContainer>
+void ReserveLoaded(TContainer& c, size_t size) {}
+
+template <class T, class Alloc>
+void ReserveLoaded(std::vector<T, Alloc>& c, size_t size) { c.reserve(c.size() + size); }
+
+#if defined(SERIALIZABLE_BOOST_CONTAINERS)
+template <class T, class Alloc>
+void ReserveLoaded(boost::container::vector<T, Alloc>& c, size_t size) { c.reserve(c.size() + size); }
+#endif // #if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+/// Appends count elements constructed from loader to sequence container.
+template <class TContainer>
+void LoadConstructedElements(ASerializeLoader& loader, TContainer& c, size_t count,
+  std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  ReserveLoaded(c, loader.GetLoadStep(count, serialized_min_size<typename TContainer::value_type>::value));
+  for (size_t i = 0; i < count && loader.HasError() == false; ++i)
+    c.emplace_back(TLoadTag(), loader);
+  }
+
+template <class TContainer>
+void LoadConstructedElements(ASerializeLoader&, TContainer&, size_t, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
+
+/// Inserts count keys constructed from loader to set.
+template <class TSet>
+void LoadConstructedKeys(ASerializeLoader& loader, TSet& c, size_t count,
+  std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  for (size_t i = 0; i < count && loader.HasError() == false; ++i)
+    c.emplace_hint(c.end(), TLoadTag(), loader);
+  }
+
+template <class TSet>
+void LoadConstructedKeys(ASerializeLoader&, TSet&, size_t, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
+
+/** Inserts key with value constructed from loader to map. Value is always constructed (so it is
+    consumed from loader) and dropped for present unique key.
+*/
+template <class TMap, class TKey>
+void EmplaceLoadConstructed(ASerializeLoader& loader, TMap& c, TKey&& key,
+  std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  c.emplace_hint(c.end(), std::piecewise_construct, std::forward_as_tuple(std::forward<TKey>(key)),
+    std::forward_as_tuple(TLoadTag(), loader));
+  }
+
+template <class TMap, class TKey>
+void EmplaceLoadConstructed(ASerializeLoader&, TMap&, TKey&&, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
+
+/** Inserts key with default constructed value to map, returns pointer to the value or nullptr
+    if unique key is present already. Sorted keys are appended at the end hint.
+*/
+template <class TMap, class TKey>
+typename TMap::mapped_type* EmplaceMapped(TMap& c, TKey&& key)
+  {
+  size_t size = c.size();
+  auto i = c.emplace_hint(c.end(), std::piecewise_construct, std::forward_as_tuple(std::forward<TKey>(key)),
+    std::forward_as_tuple());
+  return c.size() != size ? &i->second : nullptr;
+  }
+
+//Container grows by steps, so corrupted size doesn't allocate memory for data which are not there
+#define LOAD_CNTR_SEQ_BODY(CNTR_NAME)                                                      \
+  {                                                                                        \
+  LPUSH_INDENT;                                                                            \
+  LLOGMSG(CNTR_NAME);                                                                      \
+  typedef typename std::decay<decltype(c)>::type::value_type TElement;                     \
+  size_t size;                                                                             \
+  loader.LoadLength(size);                                                                 \
+  size_t i = c.size();                                                                     \
+  size += i;                                                                               \
+  size_t step;                                                                             \
+  while ((step = loader.GetLoadStep(size - i, serialized_min_size<TElement>::value)) != 0) \
+    {                                                                                      \
+    c.resize(i + step);                                                                    \
+    for (size_t end = i + step; i < end && loader.HasError() == false; ++i)                \
+      loader & c[i];                                                                       \
+    }                                                                                      \
+  LPOP_INDENT;                                                                             \
+  }
+
+//Elements with loading constructor are constructed from loader
+#define LOAD_CONSTRUCTED_CNTR_SEQ_BODY(CNTR_NAME)                         \
+  {                                                                       \
+  LPUSH_INDENT;                                                           \
+  LLOGMSG(CNTR_NAME);                                                     \
+  size_t size;                                                            \
+  loader.LoadLength(size);                                                \
+  LoadConstructedElements(loader, c, size, is_load_constructible<T>());   \
+  LPOP_INDENT;                                                            \
+  }
+
+//Elements of classes with raw layout are read at once (see rawlayouttemplates.h)
+#define LOAD_RAW_LAYOUT_CNTR_SEQ_BODY(CNTR_NAME) \
+  {                                              \
+  LPUSH_INDENT;                                  \
+  LLOGMSG(CNTR_NAME);                            \
+  size_t size;                                   \
+  loader.LoadLength(size);                       \
+  LoadRawLayoutElements(loader, c, size);        \
+  LPOP_INDENT;                                   \
+  }
+
+//Elements of classes with columnar encoding are read by columns (see columntemplates.h)
+#define LOAD_COLUMNS_CNTR_SEQ_BODY(CNTR_NAME)                                 \
+  {                                                                           \
+  LPUSH_INDENT;                                                               \
+  LLOGMSG(CNTR_NAME);                                                         \
+  size_t size;                                                                \
+  loader.LoadLength(size);                                                    \
+  /*columns are loaded at once, each element takes at least one byte*/        \
+  if (loader.CheckLoadCount(size, 1) == false)                                \
+    size = 0;                                                                 \
+  size_t i = c.size();                                                        \
+  c.resize(i + size);                                                         \
+  LoadColumns(loader, c.data() + i, size, serialized_columnar<T>());          \
+  LPOP_INDENT;                                                                \
+  }
+
+//Elements are constructed in list and loaded in place
+#define LOAD_LIST_BODY(CNTR_NAME)                                 \
+  {                                                               \
+  LPUSH_INDENT;                                                   \
+  LLOGMSG(CNTR_NAME);                                             \
+  size_t size;                                                    \
+  loader.LoadLength(size);                                        \
+  for (size_t i = 0; i < size && loader.HasError() == false; ++i) \
+    {                                                             \
+    c.emplace_back();                                             \
+    loader & c.back();                                            \
+    }                                                             \
+  LPOP_INDENT;                                                    \
+  }
+
+#define LOAD_SET_BODY(CNTR_NAME)                                    \
+  {                                                                 \
+  LPUSH_INDENT;                                                     \
+  LLOGMSG(CNTR_NAME);                                               \
+  size_t size;                                                      \
+  loader.LoadLength(size);                                          \
+  if (is_load_constructible<Key>::value)                            \
+    LoadConstructedKeys(loader, c, size, is_load_constructible<Key>()); \
+  else if (c.empty())                                               \
+    {                                                               \
+    for (size_t i = 0; i < size && loader.HasError() == false; ++i) \
+      {                                                             \
+      Key t;                                                        \
+      loader & t;                                                   \
+      c.emplace_hint(c.end(), std::move(t));                        \
+      }                                                             \
+    }                                                               \
+  else                                                              \
+    {                                                               \
+    for (size_t i = 0; i < size && loader.HasError() == false; ++i) \
+      {                                                             \
+      Key t;                                                        \
+      loader & t;                                                   \
+      c.emplace(std::move(t));                                      \
+      }                                                             \
+    }                                                               \
+  LPOP_INDENT;                                                      \
+  }
+
+//Value of loaded key is constructed from loader or loaded in place, value of duplicate key is
+//loaded and dropped
+#define LOAD_MAPPED_VALUE(KEY)                                               \
+  {                                                                          \
+  if (is_load_constructible<Value>::value)                                   \
+    EmplaceLoadConstructed(loader, c, KEY, is_load_constructible<Value>());  \
+  else                                                                       \
+    {                                                                        \
+    Value* v = EmplaceMapped(c, KEY);                                        \
+    if (v != nullptr)                                                        \
+      loader & *v;                                                           \
+    else                                                                     \
+      {                                                                      \
+      Value dropped;                                                         \
+      loader & dropped;                                                      \
+      }                                                                      \
+    }                                                                        \
+  }
+
+//Key is loaded to temporary, so container sees only complete keys
+#define LOAD_MAP_BODY(CNTR_NAME)                                    \
+  {                                                                 \
+  LPUSH_INDENT;                                                     \
+  LLOGMSG(CNTR_NAME);                                               \
+  size_t size;                                                      \
+  loader.LoadLength(size);                                          \
+  for (size_t i = 0; i < size && loader.HasError() == false; ++i)   \
+    {                                                               \
+    Key k;                                                          \
+    loader & k;                                                     \
+    LOAD_MAPPED_VALUE(std::move(k));                                \
+    }                                                               \
+  LPOP_INDENT;                                                      \
+  }
+
+//Integers of vectors, sets and map keys are packed (see packedtemplates.h)
+#define LOAD_PACKED_CNTR_SEQ_BODY(CNTR_NAME)                                              \
+  {                                                                                       \
+  LPUSH_INDENT;                                                                           \
+  LLOGMSG(CNTR_NAME);                                                                     \
+  size_t size;                                                                            \
+  loader.LoadLength(size);                                                                \
+  LoadPackedIntegers<T>(loader, size, [&c](T t) { c.push_back(std::move(t)); },           \
+    is_packable_integer<T>());                                                            \
+  LPOP_INDENT;                                                                            \
+  }
+
+#define LOAD_PACKED_SET_BODY(CNTR_NAME)                                                   \
+  {                                                                                       \
+  LPUSH_INDENT;                                                                           \
+  LLOGMSG(CNTR_NAME);                                                                     \
+  size_t size;                                                                            \
+  loader.LoadLength(size);                                                                \
+  bool hint = c.empty();                                                                  \
+  LoadPackedIntegers<Key>(loader, size, [&c, hint](Key t)                                 \
+    {                                                                                     \
+    if (hint)                                                                             \
+      c.emplace_hint(c.end(), std::move(t));                                              \
+    else                                                                                  \
+      c.emplace(std::move(t));                                                            \
+    }, is_packable_integer<Key>());                                                       \
+  LPOP_INDENT;                                                                            \
+  }
+
+//Elements of vectors of primitive types are loaded by dumped encoding (see adaptivetemplates.h)
+#define LOAD_ADAPTIVE_CNTR_SEQ_BODY(CNTR_NAME)                                            \
+  {                                                                                       \
+  LPUSH_INDENT;                                                                           \
+  LLOGMSG(CNTR_NAME);                                                                     \
+  size_t size;                                                                            \
+  loader.LoadLength(size);                                                                \
+  LoadAdaptive(loader, c, size, is_adaptive_encodable<T>());                              \
+  LPOP_INDENT;                                                                            \
+  }
+
+//Floats of vectors and deques are XOR compressed (see xorfloattemplates.h)
+#define LOAD_XOR_FLOATS_CNTR_SEQ_BODY(CNTR_NAME)                                          \
+  {                                                                                       \
+  LPUSH_INDENT;                                                                           \
+  LLOGMSG(CNTR_NAME);                                                                     \
+  LoadXorFloats(loader, c);                                                               \
+  LPOP_INDENT;                                                                            \
+  }
+
+//Keys of map are loaded first by LOAD_KEYS, then values
+#define LOAD_KEYS_MAP_BODY(CNTR_NAME, LOAD_KEYS)                                          \
+  {                                                                                       \
+  LPUSH_INDENT;                                                                           \
+  LLOGMSG(CNTR_NAME);                                                                     \
+  size_t size;                                                                            \
+  loader.LoadLength(size);                                                                \
+  std::vector<Key> keys;                                                                  \
+  keys.reserve(loader.GetLoadStep(size, serialized_min_size<Key>::value));               \
+  LOAD_KEYS;                                                                              \
+  for (size_t i = 0; i < keys.size() && loader.HasError() == false; ++i)                  \
+    LOAD_MAPPED_VALUE(std::move(keys[i]));                                                \
+  LPOP_INDENT;                                                                            \
+  }
+
+#define LOAD_PACKED_MAP_BODY(CNTR_NAME)                                                   \
+  LOAD_KEYS_MAP_BODY(CNTR_NAME,                                                           \
+    LoadPackedIntegers<Key>(loader, size, [&keys](Key t) { keys.push_back(std::move(t)); }, \
+      is_packable_integer<Key>()))
+
+//Strings of sets and map keys are front coded (see frontcodingtemplates.h)
+#define LOAD_FRONT_CODED_SET_BODY(CNTR_NAME)                                              \
+  {                                                                                       \
+  LPUSH_INDENT;                                                                           \
+  LLOGMSG(CNTR_NAME);                                                                     \
+  size_t size;                                                                            \
+  loader.LoadLength(size);                                                                \
+  LoadFrontCodedStrings(loader, size,                                                     \
+    [&c](Key&& t) -> const Key& { return *c.emplace_hint(c.end(), std::move(t)); },       \
+    std::is_same<Key, std::string>());                                                    \
+  LPOP_INDENT;                                                                            \
   }
 
+#define LOAD_FRONT_CODED_MAP_BODY(CNTR_NAME)                                              \
+  LOAD_KEYS_MAP_BODY(CNTR_NAME,                                                           \
+    LoadFrontCodedStrings(loader, size,                                                   \
+      [&keys](Key&& t) -> const Key& { keys.push_back(std::move(t)); return keys.back(); }, \
+      std::is_same<Key, std::string>()))
+
 template <class T,class Alloc>
-void operator&(ASerializeLoader& loader, std::vector<T,Alloc>& c)
-  LOAD_CNTR_SEQ_BODY("Load(vector)")
+typename std::enable_if<serialized_raw_layout<T>::value == false>::type
+operator&(ASerializeLoader& loader, std::vector<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_adaptive_encodable<T>::value && loader.IsAdaptive())
+    LOAD_ADAPTIVE_CNTR_SEQ_BODY("Load(vector)")
+  else if (is_packable_integer<T>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_CNTR_SEQ_BODY("Load(vector)")
+  else if (is_xor_float<T>::value && loader.IsXorFloats())
+    LOAD_XOR_FLOATS_CNTR_SEQ_BODY("Load(vector)")
+  else if (serialized_columnar<T>::value && loader.IsColumnar())
+    LOAD_COLUMNS_CNTR_SEQ_BODY("Load(vector)")
+  else if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(vector)")
+  else
+    LOAD_CNTR_SEQ_BODY("Load(vector)")
+  }
 
+//Vectors of classes with raw layout are read at once in snapshots with raw layout
 template <class T,class Alloc>
-void operator&(ASerializeLoader& loader, std::deque<T,Alloc>& c)
-  LOAD_CNTR_SEQ_BODY("Load(deque)")
+typename std::enable_if<serialized_raw_layout<T>::value>::type
+operator&(ASerializeLoader& loader, std::vector<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (loader.IsRawLayout() && std::is_trivially_copyable<T>::value)
+    LOAD_RAW_LAYOUT_CNTR_SEQ_BODY("Load(vector)")
+  else if (serialized_columnar<T>::value && loader.IsColumnar())
+    LOAD_COLUMNS_CNTR_SEQ_BODY("Load(vector)")
+  else if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(vector)")
+  else
+    LOAD_CNTR_SEQ_BODY("Load(vector)")
+  }
 
 template <class T,class Alloc>
-void operator&(ASerializeLoader& loader, std::list<T,Alloc>& c)
-  LOAD_LIST_BODY("Load(list)")
+void operator&(ASerializeLoader& loader, std::deque<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_xor_float<T>::value && loader.IsXorFloats())
+    LOAD_XOR_FLOATS_CNTR_SEQ_BODY("Load(deque)")
+  else if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(deque)")
+  else
+    LOAD_CNTR_SEQ_BODY("Load(deque)")
+  }
+
+template <class T,class Alloc>
+void operator&(ASerializeLoader& loader, std::list<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(list)")
+  else
+    LOAD_LIST_BODY("Load(list)")
+  }
 
 template <class Key, class Compare, class Alloc>
-void operator&(ASerializeLoader& loader, std::set<Key,Compare,Alloc>& c)
-  LOAD_SET_BODY("Load(set)")
+void operator&(ASerializeLoader& loader, std::set<Key,Compare,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_SET_BODY("Load(set)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_SET_BODY("Load(set)")
+  else
+    LOAD_SET_BODY("Load(set)")
+  }
 
 template <class Key, class Compare, class Alloc>
-void operator&(ASerializeLoader& loader, std::multiset<Key,Compare,Alloc>& c)
-  LOAD_SET_BODY("Load(multiset)")
+void operator&(ASerializeLoader& loader, std::multiset<Key,Compare,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_SET_BODY("Load(multiset)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_SET_BODY("Load(multiset)")
+  else
+    LOAD_SET_BODY("Load(multiset)")
+  }
 
 template <class Key, class Value, class Compare, class Alloc>
-void operator&(ASerializeLoader& loader, std::map<Key,Value,Compare,Alloc>& c)
-  LOAD_MAP_BODY("Load(map)")
+void operator&(ASerializeLoader& loader, std::map<Key,Value,Compare,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_MAP_BODY("Load(map)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_MAP_BODY("Load(map)")
+  else
+    LOAD_MAP_BODY("Load(map)")
+  }
 
 template <class Key, class Value, class Compare, class Alloc>
-void operator&(ASerializeLoader& loader, std::multimap<Key,Value,Compare,Alloc>& c)
-  LOAD_MAP_BODY("Load(multimap)")
+void operator&(ASerializeLoader& loader, std::multimap<Key,Value,Compare,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_MAP_BODY("Load(multimap)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_MAP_BODY("Load(multimap)")
+  else
+    LOAD_MAP_BODY("Load(multimap)")
+  }
 
 template <class Key, class HashFcn, class EqualKey, class Alloc> 
-void operator&(ASerializeLoader& loader, std::unordered_set<Key,HashFcn,EqualKey,Alloc>& c)
+void operator&(ASerializeLoader& loader, std::unordered_set<Key,HashFcn,EqualKey,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_SET_BODY("Load(unordered_set)")
 
 template <class Key, class HashFcn, class EqualKey, class Alloc> 
-void operator&(ASerializeLoader& loader, std::unordered_multiset<Key,HashFcn,EqualKey,Alloc>& c)
+void operator&(ASerializeLoader& loader, std::unordered_multiset<Key,HashFcn,EqualKey,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_SET_BODY("Load(unordered_multiset)")
 
 template <class Key, class Value, class HashFcn, class EqualKey, class Alloc> 
-void operator&(ASerializeLoader& loader, std::unordered_map<Key,Value,HashFcn,EqualKey,Alloc>& c)
+void operator&(ASerializeLoader& loader, std::unordered_map<Key,Value,HashFcn,EqualKey,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_MAP_BODY("Load(unordered_map)")
 
 template <class Key, class Value, class HashFcn, class EqualKey, class Alloc> 
-void operator&(ASerializeLoader& loader, std::unordered_multimap<Key,Value,HashFcn,EqualKey,Alloc>& c)
+void operator&(ASerializeLoader& loader, std::unordered_multimap<Key,Value,HashFcn,EqualKey,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_MAP_BODY("Load(unordered_multimap)")
 
 //--------------- load serialize_utils types
 
 //Loads "single-reference pointers" (actual object data is loaded)
 template <class T>
-void operator&(ASerializeLoader& loader, TSingleRefPtr<T>& ptr)
+void operator&(ASerializeLoader& loader, TSingleRefPtr<T>& ptr) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load(TSingleRefPtr<T>)");
@@ -333,20 +700,20 @@ void operator&(ASerializeLoader& loader, TSingleRefPtr<T>& ptr)
 
 //TNoSerializeWrapper is how we avoid serializing a data member
 template <class T>
-void operator&(ASerializeLoader& loader, TNoSerializeWrapper<T>&)
+void operator&(ASerializeLoader& loader, TNoSerializeWrapper<T>&) SERIALIZE_LOAD_NOEXCEPT
   {
   }
 
 //TNoSerializePtrWrapper is how we avoid serializing a data member
 template <class T>
-void operator&(ASerializeLoader& loader, TNoSerializePtrWrapper<T>&)
+void operator&(ASerializeLoader& loader, TNoSerializePtrWrapper<T>&) SERIALIZE_LOAD_NOEXCEPT
   {
   }
 
-template <class T>
-void operator & (ASerializeLoader& loader, TSerializedObjectRegistry<T>& reg)
+template <class T, class TStorageCntr>
+void operator & (ASerializeLoader& loader, TSerializedObjectRegistry<T, TStorageCntr>& reg) SERIALIZE_LOAD_NOEXCEPT
   {
-  typedef typename TSerializedObjectRegistry<T>::TStorage TStorage;
+  typedef typename TSerializedObjectRegistry<T, TStorageCntr>::TStorage TStorage;
   TStorage& storage = reg.GetStorage();
 
   assert(!storage.empty()); //storage always has one nul element
@@ -354,21 +721,25 @@ void operator & (ASerializeLoader& loader, TSerializedObjectRegistry<T>& reg)
   LPUSH_INDENT;
   LLOGMSG("Load(TSerializedObjectRegistry)");
   size_t i, size;
-  loader.LoadSizeT(size);
+  loader.LoadLength(size);
   i = storage.size();
   size += i;
   //storage.clear();
-  storage.resize(size);
 #ifdef DEBUG_SERIALIZER
   char buffer[15] = "MI: ";
 #endif
-  for (; i < size; ++i)
+  //storage grows by steps, so corrupted size doesn't allocate memory for data which are not there
+  for (size_t step; (step = loader.GetLoadStep(size - i, 0)) != 0;)
     {
+    storage.resize(i + step);
+    for (size_t end = i + step; i < end && loader.HasError() == false; ++i)
+      {
 #ifdef DEBUG_SERIALIZER
-    itoa(i,buffer+4,10);
-    LLOGMSG(buffer);
+      itoa(i,buffer+4,10);
+      LLOGMSG(buffer);
 #endif
-    loader & storage[i];
+      loader & storage[i];
+      }
     }
   LPOP_INDENT;
   }
@@ -381,67 +752,163 @@ namespace bu = boost::unordered;
 namespace bmi = boost::multi_index;
 
 template <class CharT, class Traits, class Allocator>
-void operator&(ASerializeLoader& loader, bc::basic_string<CharT,Traits,Allocator>& c)
+void operator&(ASerializeLoader& loader, bc::basic_string<CharT,Traits,Allocator>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_CNTR_SEQ_BODY("Load(string)")
 
 template <class T,class Alloc>
-void operator&(ASerializeLoader& loader, bc::vector<T,Alloc>& c)
-  LOAD_CNTR_SEQ_BODY("Load(boost::vector)")
+typename std::enable_if<serialized_raw_layout<T>::value == false>::type
+operator&(ASerializeLoader& loader, bc::vector<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_adaptive_encodable<T>::value && loader.IsAdaptive())
+    LOAD_ADAPTIVE_CNTR_SEQ_BODY("Load(boost::vector)")
+  else if (is_packable_integer<T>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_CNTR_SEQ_BODY("Load(boost::vector)")
+  else if (is_xor_float<T>::value && loader.IsXorFloats())
+    LOAD_XOR_FLOATS_CNTR_SEQ_BODY("Load(boost::vector)")
+  else if (serialized_columnar<T>::value && loader.IsColumnar())
+    LOAD_COLUMNS_CNTR_SEQ_BODY("Load(boost::vector)")
+  else if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(boost::vector)")
+  else
+    LOAD_CNTR_SEQ_BODY("Load(boost::vector)")
+  }
 
 template <class T,class Alloc>
-void operator&(ASerializeLoader& loader, bc::deque<T,Alloc>& c)
-  LOAD_CNTR_SEQ_BODY("Load(boost::deque)")
+typename std::enable_if<serialized_raw_layout<T>::value>::type
+operator&(ASerializeLoader& loader, bc::vector<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (loader.IsRawLayout() && std::is_trivially_copyable<T>::value)
+    LOAD_RAW_LAYOUT_CNTR_SEQ_BODY("Load(boost::vector)")
+  else if (serialized_columnar<T>::value && loader.IsColumnar())
+    LOAD_COLUMNS_CNTR_SEQ_BODY("Load(boost::vector)")
+  else if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(boost::vector)")
+  else
+    LOAD_CNTR_SEQ_BODY("Load(boost::vector)")
+  }
 
 template <class T,class Alloc>
-void operator&(ASerializeLoader& loader, bc::list<T,Alloc>& c)
-  LOAD_LIST_BODY("Load(boost::list)")
+void operator&(ASerializeLoader& loader, bc::deque<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_xor_float<T>::value && loader.IsXorFloats())
+    LOAD_XOR_FLOATS_CNTR_SEQ_BODY("Load(boost::deque)")
+  else if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(boost::deque)")
+  else
+    LOAD_CNTR_SEQ_BODY("Load(boost::deque)")
+  }
+
+template <class T,class Alloc>
+void operator&(ASerializeLoader& loader, bc::list<T,Alloc>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_load_constructible<T>::value)
+    LOAD_CONSTRUCTED_CNTR_SEQ_BODY("Load(boost::list)")
+  else
+    LOAD_LIST_BODY("Load(boost::list)")
+  }
 
 template <class Key, class Compare, class Allocator, class SetOptions>
-void operator&(ASerializeLoader& loader, bc::set<Key,Compare,Allocator,SetOptions>& c)
-  LOAD_SET_BODY("Load(boost::set)")
+void operator&(ASerializeLoader& loader, bc::set<Key,Compare,Allocator,SetOptions>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_SET_BODY("Load(boost::set)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_SET_BODY("Load(boost::set)")
+  else
+    LOAD_SET_BODY("Load(boost::set)")
+  }
 
 template <class Key, class Compare, class Allocator>
-void operator&(ASerializeLoader& loader, bc::flat_set<Key,Compare,Allocator>& c)
-  LOAD_SET_BODY("Load(boost::flat_set)")
+void operator&(ASerializeLoader& loader, bc::flat_set<Key,Compare,Allocator>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_SET_BODY("Load(boost::flat_set)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_SET_BODY("Load(boost::flat_set)")
+  else
+    LOAD_SET_BODY("Load(boost::flat_set)")
+  }
 
 template <class Key, class Compare, class Allocator, class MultiSetOptions>
-void operator&(ASerializeLoader& loader, bc::multiset<Key,Compare,Allocator,MultiSetOptions>& c)
-  LOAD_SET_BODY("Load(boost::multiset)")
+void operator&(ASerializeLoader& loader, bc::multiset<Key,Compare,Allocator,MultiSetOptions>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_SET_BODY("Load(boost::multiset)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_SET_BODY("Load(boost::multiset)")
+  else
+    LOAD_SET_BODY("Load(boost::multiset)")
+  }
 
 template <class Key, class Compare, class Allocator>
-void operator&(ASerializeLoader& loader, bc::flat_multiset<Key,Compare,Allocator>& c)
-  LOAD_SET_BODY("Load(boost::flat_multiset)")
+void operator&(ASerializeLoader& loader, bc::flat_multiset<Key,Compare,Allocator>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_SET_BODY("Load(boost::flat_multiset)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_SET_BODY("Load(boost::flat_multiset)")
+  else
+    LOAD_SET_BODY("Load(boost::flat_multiset)")
+  }
 
 template <class Key, class Value, class Compare, class Allocator, class MapOptions>
-void operator&(ASerializeLoader& loader, bc::map<Key,Value,Compare,Allocator,MapOptions>& c)
-  LOAD_MAP_BODY("Load(boost::map)")
+void operator&(ASerializeLoader& loader, bc::map<Key,Value,Compare,Allocator,MapOptions>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_MAP_BODY("Load(boost::map)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_MAP_BODY("Load(boost::map)")
+  else
+    LOAD_MAP_BODY("Load(boost::map)")
+  }
 
 template <class Key, class Value, class Compare, class Allocator>
-void operator&(ASerializeLoader& loader, bc::flat_map<Key,Value,Compare,Allocator>& c)
-  LOAD_MAP_BODY("Load(boost::flat_map)")
+void operator&(ASerializeLoader& loader, bc::flat_map<Key,Value,Compare,Allocator>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_MAP_BODY("Load(boost::flat_map)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_MAP_BODY("Load(boost::flat_map)")
+  else
+    LOAD_MAP_BODY("Load(boost::flat_map)")
+  }
 
 template <class Key, class Value, class Compare, class Allocator, class MultiMapOptions>
-void operator&(ASerializeLoader& loader, bc::multimap<Key,Value,Compare,Allocator,MultiMapOptions>& c)
-  LOAD_MAP_BODY("Load(boost::multimap)")
+void operator&(ASerializeLoader& loader, bc::multimap<Key,Value,Compare,Allocator,MultiMapOptions>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_MAP_BODY("Load(boost::multimap)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_MAP_BODY("Load(boost::multimap)")
+  else
+    LOAD_MAP_BODY("Load(boost::multimap)")
+  }
 
 template <class Key, class Value, class Compare, class Allocator>
-void operator&(ASerializeLoader& loader, bc::flat_multimap<Key,Value,Compare,Allocator>& c)
-  LOAD_MAP_BODY("Load(boost::flat_multimap)")
+void operator&(ASerializeLoader& loader, bc::flat_multimap<Key,Value,Compare,Allocator>& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (is_packable_integer<Key>::value && loader.IsPackedIntegers())
+    LOAD_PACKED_MAP_BODY("Load(boost::flat_multimap)")
+  else if (std::is_same<Key, std::string>::value && loader.IsFrontCodedStrings())
+    LOAD_FRONT_CODED_MAP_BODY("Load(boost::flat_multimap)")
+  else
+    LOAD_MAP_BODY("Load(boost::flat_multimap)")
+  }
 
 template <class Key, class H, class P, class A>
-void operator&(ASerializeLoader& loader, bu::unordered_set<Key,H,P,A>& c)
+void operator&(ASerializeLoader& loader, bu::unordered_set<Key,H,P,A>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_SET_BODY("Load(boost::unordered_set)")
 
 template <class Key, class H, class P, class A>
-void operator&(ASerializeLoader& loader, bu::unordered_multiset<Key,H,P,A>& c)
+void operator&(ASerializeLoader& loader, bu::unordered_multiset<Key,H,P,A>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_SET_BODY("Load(boost::unordered_multiset)")
 
 template <class Key, class Value, class H, class P, class A>
-void operator&(ASerializeLoader& loader, bu::unordered_map<Key, Value, H, P, A>& c)
+void operator&(ASerializeLoader& loader, bu::unordered_map<Key, Value, H, P, A>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_MAP_BODY("Load(boost::unordered_map)")
 
 template <class Key, class Value, class H, class P, class A>
-void operator&(ASerializeLoader& loader, bu::unordered_multimap<Key, Value, H, P, A>& c)
+void operator&(ASerializeLoader& loader, bu::unordered_multimap<Key, Value, H, P, A>& c) SERIALIZE_LOAD_NOEXCEPT
   LOAD_MAP_BODY("Load(boost::unordered_multimap)")
 
 template <typename TIndex>
@@ -472,22 +939,24 @@ struct has_first_index_reservable_size
         typename TMultiIndexContainer::index_specifier_type_list>::type> {};
 
 template <typename TMultiIndexContainer>
-void Reserve(TMultiIndexContainer& c, size_t size, std::true_type has_reserve)
+void Reserve(TMultiIndexContainer& c, size_t size, std::true_type)
   {
   c.reserve(c.size() + size);
   }
 
 template <typename TMultiIndexContainer>
-void Reserve(TMultiIndexContainer& c, size_t size, std::false_type has_reserve) {}
+void Reserve(TMultiIndexContainer&, size_t, std::false_type) {}
 
 template <typename TMultiIndexContainer>
-void Load(ASerializeLoader& loader, TMultiIndexContainer& c, std::true_type is_sequential)
+void Load(ASerializeLoader& loader, TMultiIndexContainer& c, std::true_type is_sequential) SERIALIZE_LOAD_NOEXCEPT
   {
   size_t size;
-  loader.LoadSizeT(size);
+  loader.LoadLength(size);
   typedef typename TMultiIndexContainer::value_type Value;
-  Reserve(c, size, has_first_index_reservable_size<TMultiIndexContainer>());
-  for (size_t i = 0; i < size; ++i)
+  //size is not trusted, only part of it which may be in input is reserved
+  Reserve(c, loader.GetLoadStep(size, serialized_min_size<Value>::value),
+    has_first_index_reservable_size<TMultiIndexContainer>());
+  for (size_t i = 0; i < size && loader.HasError() == false; ++i)
     {
     Value value;
     loader & value;
@@ -496,14 +965,14 @@ void Load(ASerializeLoader& loader, TMultiIndexContainer& c, std::true_type is_s
   }
 
 template <typename TMultiIndexContainer>
-void Load(ASerializeLoader& loader, TMultiIndexContainer& c, std::false_type is_sequential)
+void Load(ASerializeLoader& loader, TMultiIndexContainer& c, std::false_type is_sequential) SERIALIZE_LOAD_NOEXCEPT
   {
   size_t size;
-  loader.LoadSizeT(size);
+  loader.LoadLength(size);
   typedef typename TMultiIndexContainer::value_type Value;
   if (c.empty())
     {
-    for (size_t i = 0; i < size; ++i)
+    for (size_t i = 0; i < size && loader.HasError() == false; ++i)
       {
       Value value;
       loader & value;
@@ -512,7 +981,7 @@ void Load(ASerializeLoader& loader, TMultiIndexContainer& c, std::false_type is_
     }
   else
     {
-    for (size_t i = 0; i < size; ++i)
+    for (size_t i = 0; i < size && loader.HasError() == false; ++i)
       {
       Value value;
       loader & value;
@@ -522,7 +991,7 @@ void Load(ASerializeLoader& loader, TMultiIndexContainer& c, std::false_type is_
   }
 
 template <typename Value, typename IndexSpecifierList, typename Allocator>
-void operator&(ASerializeLoader& loader, bmi::multi_index_container<Value, IndexSpecifierList, Allocator>& c)
+void operator&(ASerializeLoader& loader, bmi::multi_index_container<Value, IndexSpecifierList, Allocator>& c) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load(boost::multi_index_container)");
@@ -532,3 +1001,44 @@ void operator&(ASerializeLoader& loader, bmi::multi_index_container<Value, Index
   }
 
 #endif // #if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+//-------------- members of generated loading constructors
+
+template <typename TType>
+TType ConstructLoaded(ASerializeLoader& loader, std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  return TType(TLoadTag(), loader);
+  }
+
+//Loaded arithmetic value or enum overwrites all of it, so it is not value-initialized first
+template <typename TType>
+TType ConstructLoadedValue(ASerializeLoader& loader, std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  TType o;
+  loader & o;
+  return o;
+  }
+
+template <typename TType>
+TType ConstructLoadedValue(ASerializeLoader& loader, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  TType o = TType();
+  loader & o;
+  return o;
+  }
+
+template <typename TType>
+TType ConstructLoaded(ASerializeLoader& loader, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  return ConstructLoadedValue<TType>(loader,
+    std::integral_constant<bool, std::is_arithmetic<TType>::value || std::is_enum<TType>::value>());
+  }
+
+/** Returns member loaded by generated loading constructor, defined after all overloads of
+    operator& so that it finds them for types of std namespace.
+*/
+template <typename TType>
+TType ConstructLoaded(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  return ConstructLoaded<TType>(loader, is_load_constructible<TType>());
+  }
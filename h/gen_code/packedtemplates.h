@@ -0,0 +1,166 @@
+///\file packedtemplates.h
+#pragma once
+
+//Support for packed encoding of containers of integers. Vectors, sets and map keys of integers
+//are dumped packed if it is enabled in dumper (see serialize_snapshotheader.h):
+//  count, codec, [first value if delta encoded], payload size, payload (see TPackedIntCodec),
+//  { value } for each map element
+//Signed values are zigzag mapped to unsigned. Keys of sets and maps ordered by std::less are
+//stored as differences from previous key (codec has CODEC_DELTA flag), so dense ids pack
+//to few bits each.
+
+#include <serialize3/h/storage/packedintcodec.h>
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+//Integers of more than one byte (bytes are dumped as they are).
+template <typename TType>
+struct is_packable_integer : public std::integral_constant<bool,
+  std::is_integral<TType>::value && std::is_same<TType, bool>::value == false && (sizeof(TType) > 1)> {};
+
+//Keys ordered by this comparator ascend, so they are delta encoded.
+template <class TCompare, typename TKey>
+struct is_ascending_order : public std::integral_constant<bool,
+  std::is_same<TCompare, std::less<TKey>>::value || std::is_same<TCompare, std::less<void>>::value> {};
+
+template <typename TType>
+typename std::enable_if<std::is_signed<TType>::value, unsigned long long>::type
+ZigZagEncode(TType value)
+  {
+  long long v = value;
+  return (static_cast<unsigned long long>(v) << 1) ^ static_cast<unsigned long long>(v >> 63);
+  }
+
+template <typename TType>
+typename std::enable_if<std::is_signed<TType>::value == false, unsigned long long>::type
+ZigZagEncode(TType value)
+  {
+  return value;
+  }
+
+template <typename TType>
+typename std::enable_if<std::is_signed<TType>::value, TType>::type
+ZigZagDecode(unsigned long long value)
+  {
+  return static_cast<TType>(static_cast<long long>((value >> 1) ^ (~(value & 1) + 1)));
+  }
+
+template <typename TType>
+typename std::enable_if<std::is_signed<TType>::value == false, TType>::type
+ZigZagDecode(unsigned long long value)
+  {
+  return static_cast<TType>(value);
+  }
+
+//Getters of packed integer (or front coded string) from container element.
+struct TPackedElement
+  {
+  template <typename TType>
+  const TType& operator()(const TType& value) const { return value; }
+  };
+
+struct TPackedKey
+  {
+  template <typename TKey, typename TValue>
+  const TKey& operator()(const std::pair<TKey, TValue>& value) const { return value.first; }
+  };
+
+/// Dumps integers got by getter from count elements starting at i (nothing if there are none).
+template <class TIterator, class TGetter>
+void DumpPackedIntegers(ASerializeDumper& dumper, TIterator i, size_t count, bool delta, TGetter get,
+  std::true_type)
+  {
+  if (count == 0)
+    return;
+
+  std::vector<unsigned long long> values(count);
+  unsigned long long base = static_cast<unsigned long long>(get(*i));
+  unsigned long long previous = base;
+  for (size_t n = 0; n < count; ++n, ++i)
+    {
+    //differences are computed modulo 2^64 from sign extended values, so they fit type width
+    unsigned long long value = static_cast<unsigned long long>(get(*i));
+    values[n] = delta ? value - previous : ZigZagEncode(get(*i));
+    previous = value;
+    }
+
+  std::vector<unsigned char> payload;
+  unsigned char codec = TPackedIntCodec::Encode(values.data(), count, payload);
+  if (delta)
+    codec |= TPackedIntCodec::CODEC_DELTA;
+
+  dumper.Dump(codec);
+  if (delta)
+    dumper.Dump(base); //first difference is 0, so first value doesn't widen the rest
+  dumper.DumpSizeT(payload.size());
+  dumper.WriteBuffer(payload.data(), payload.size());
+  }
+
+template <class TIterator, class TGetter>
+void DumpPackedIntegers(ASerializeDumper&, TIterator, size_t, bool, TGetter, std::false_type)
+  {
+  }
+
+template <class TIterator, class TGetter>
+void DumpPackedIntegers(ASerializeDumper& dumper, TIterator i, size_t count, bool delta, TGetter get)
+  {
+  typedef typename std::decay<decltype(get(*i))>::type TValue;
+  DumpPackedIntegers(dumper, i, count, delta, get, is_packable_integer<TValue>());
+  }
+
+/** Loads count packed integers and passes them to insert in dumped order.
+    Nothing is inserted if data are truncated or corrupted.
+*/
+template <typename TType, class TInserter>
+void LoadPackedIntegers(ASerializeLoader& loader, size_t count, TInserter insert,
+  std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (count == 0)
+    return;
+
+  unsigned char codec = 0;
+  unsigned long long previous = 0;
+  size_t size = 0;
+  loader.Load(codec);
+  bool delta = (codec & TPackedIntCodec::CODEC_DELTA) != 0;
+  if (delta)
+    loader.Load(previous);
+  loader.LoadSizeT(size);
+  if (loader.HasError())
+    return;
+
+  //payload is read in steps if loader doesn't know its size, so corrupted size can't allocate it
+  const unsigned char* payload = loader.AcquireLoadedBuffer(size);
+  if (loader.HasError())
+    return;
+  //count is checked against payload before values are allocated
+  if (TPackedIntCodec::IsPlausible(static_cast<TPackedIntCodec::TCodec>(codec), payload, size, count) == false)
+    {
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    return;
+    }
+
+  std::vector<unsigned long long> values(count);
+  if (TPackedIntCodec::Decode(static_cast<TPackedIntCodec::TCodec>(codec), payload, size, count,
+        values.data()) == false)
+    {
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    return;
+    }
+
+  for (size_t n = 0; n < count; ++n)
+    {
+    TType value = delta ? static_cast<TType>(previous + values[n]) : ZigZagDecode<TType>(values[n]);
+    previous = static_cast<unsigned long long>(value);
+    insert(value);
+    }
+  }
+
+template <typename TType, class TInserter>
+void LoadPackedIntegers(ASerializeLoader&, size_t, TInserter, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
@@ -0,0 +1,207 @@
+///\file rawlayouttemplates.h
+#pragma once
+
+//Support for classes dumped as raw memory in snapshots with raw layout (see
+//serialize_snapshotheader.h). Generator marks fixed-size classes without hierarchy and pointers,
+//their generated Dump/Load copy whole object at once if raw layout is enabled in dumper/loader
+//and the class is trivially copyable. Otherwise objects are dumped member by member.
+//Padding bytes of objects are dumped zeroed, so snapshot doesn't contain uninitialized memory.
+//Snapshot dumped by binary with different layout may contain layouts of its classes, objects
+//are then loaded by moving each field from its dumped offset (see TForeignRawLayouts).
+
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/// Primitive member of class with raw layout (nested classes are flattened), in bytes.
+struct TRawLayoutField
+  {
+  unsigned int Offset;
+  unsigned int Size;
+  };
+
+/// Layout of class with raw layout, generated into typeids file as <class>_RAW_LAYOUT.
+struct TRawLayoutDescription
+  {
+  const char*            Name;
+  size_t                 Sizeof;
+  const TRawLayoutField* Fields;
+  size_t                 FieldCount;
+
+  /// Checks if object contains bytes not covered by fields.
+  bool IsPadded() const
+    {
+    size_t size = 0;
+    for (size_t i = 0; i < FieldCount; ++i)
+      size += Fields[i].Size;
+    return size != Sizeof;
+    }
+  };
+
+/// Layouts of all classes with raw layout, generated into typeids file as <prefix>_SNAPSHOT_LAYOUT.
+struct TSnapshotLayout
+  {
+  unsigned long long                  Fingerprint;
+  const TRawLayoutDescription* const* Classes;
+  size_t                              ClassCount;
+  };
+
+//Specialized in generated typeids file for classes with raw layout accessible from namespace
+//scope, so vectors of them can be dumped and loaded at once. Specialization provides
+//static const TRawLayoutDescription& GetDescription().
+template <typename TType>
+struct serialized_raw_layout : public std::false_type {};
+
+/// Layout of class in snapshot loaded from binary with different layout.
+struct TDumpedRawLayout
+  {
+  size_t                       Sizeof;
+  std::vector<TRawLayoutField> Fields;
+  };
+
+//---------- TForeignRawLayouts
+//Layouts of classes read from snapshot header (see LoadSnapshotHeader) when layout fingerprint
+//of snapshot differs from loading binary.
+class TForeignRawLayouts
+  {
+  public:
+    void Add(const std::string& name, TDumpedRawLayout&& layout)
+      {
+      Layouts[name] = std::move(layout);
+      }
+
+    /** Returns dumped layout of the class if its fields can be moved into native layout, else
+        sets LOAD_LAYOUT_MISMATCH and returns nullptr. Dumped size must be the same inside
+        fixed-size objects, whose size was computed from native layout.
+    */
+    const TDumpedRawLayout* Find(ASerializeLoader& loader, const TRawLayoutDescription& native) const
+      {
+      auto found = Layouts.find(native.Name);
+      bool compatible = found != Layouts.end() && found->second.Fields.size() == native.FieldCount &&
+        (loader.IsFixedSizeWindow() == false || found->second.Sizeof == native.Sizeof);
+
+      for (size_t i = 0; compatible && i < native.FieldCount; ++i)
+        compatible = found->second.Fields[i].Size == native.Fields[i].Size;
+
+      if (compatible == false)
+        {
+        loader.SetError(ASerializeLoader::LOAD_LAYOUT_MISMATCH);
+        return nullptr;
+        }
+      return &found->second;
+      }
+
+  /// Class attributes:
+  private:
+    std::unordered_map<std::string, TDumpedRawLayout> Layouts;
+  }; //TForeignRawLayouts
+
+//Size of buffer in which padded objects are zeroed before they are dumped
+const size_t RAW_LAYOUT_BLOCK_SIZE = 4096;
+
+/// Writes objects as raw memory, padding bytes are written as zeros.
+template <typename TType>
+void DumpRawLayoutObjects(ASerializeDumper& dumper, const TType* objects, size_t count,
+  const TRawLayoutDescription& description)
+  {
+  if (description.IsPadded() == false)
+    {
+    dumper.WriteBufferReferenced(reinterpret_cast<const unsigned char*>(objects), count * sizeof(TType));
+    return;
+    }
+
+  //fields are copied into zeroed block, which is copied by dumper
+  unsigned char stackBlock[RAW_LAYOUT_BLOCK_SIZE];
+  std::vector<unsigned char> heapBlock(sizeof(TType) > RAW_LAYOUT_BLOCK_SIZE ? sizeof(TType) : 0);
+  unsigned char* block = heapBlock.empty() ? stackBlock : heapBlock.data();
+  const size_t blockCount = heapBlock.empty() ? RAW_LAYOUT_BLOCK_SIZE / sizeof(TType) : 1;
+
+  for (size_t i = 0; i < count; i += blockCount)
+    {
+    size_t n = std::min(blockCount, count - i);
+    memset(block, 0, n * sizeof(TType));
+    for (size_t j = 0; j < n; ++j)
+      {
+      const unsigned char* object = reinterpret_cast<const unsigned char*>(objects + i + j);
+      for (size_t f = 0; f < description.FieldCount; ++f)
+        {
+        const TRawLayoutField& field = description.Fields[f];
+        memcpy(block + j * sizeof(TType) + field.Offset, object + field.Offset, field.Size);
+        }
+      }
+    dumper.WriteBuffer(block, n * sizeof(TType));
+    }
+  }
+
+/// Reads objects as raw memory, fields are moved from offsets of dumped layout if it differs.
+template <typename TType>
+void LoadRawLayoutObjects(ASerializeLoader& loader, TType* objects, size_t count,
+  const TRawLayoutDescription& description) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (loader.GetForeignRawLayouts() == nullptr)
+    {
+    loader.ReadBuffer(reinterpret_cast<unsigned char*>(objects), count * sizeof(TType));
+    return;
+    }
+
+  const TDumpedRawLayout* dumped = loader.GetForeignRawLayouts()->Find(loader, description);
+  for (size_t i = 0; i < count && dumped != nullptr && loader.HasError() == false; ++i)
+    {
+    const unsigned char* buffer = loader.AcquireBuffer(dumped->Sizeof);
+    unsigned char* object = reinterpret_cast<unsigned char*>(objects + i);
+    for (size_t f = 0; f < description.FieldCount; ++f)
+      memcpy(object + description.Fields[f].Offset, buffer + dumped->Fields[f].Offset, description.Fields[f].Size);
+    }
+  }
+
+/// Appends count objects read as raw memory to vector, it grows as they are read.
+template <typename TCntr>
+void LoadRawLayoutElements(ASerializeLoader& loader, TCntr& c, size_t count) SERIALIZE_LOAD_NOEXCEPT
+  {
+  typedef typename TCntr::value_type TElement;
+  const TRawLayoutDescription& description = serialized_raw_layout<TElement>::GetDescription();
+  size_t dumpedSize = sizeof(TElement);
+
+  if (loader.GetForeignRawLayouts() != nullptr)
+    {
+    const TDumpedRawLayout* dumped = loader.GetForeignRawLayouts()->Find(loader, description);
+    dumpedSize = dumped != nullptr ? dumped->Sizeof : 0;
+    }
+
+  size_t i = c.size();
+  count += i;
+  for (size_t step; dumpedSize != 0 && (step = loader.GetLoadStep(count - i, dumpedSize)) != 0; i += step)
+    {
+    c.resize(i + step);
+    LoadRawLayoutObjects(loader, c.data() + i, step, description);
+    }
+  }
+
+/// Dumps object as raw memory if dumper has raw layout enabled, returns false otherwise.
+template <typename TType>
+bool DumpRawLayout(ASerializeDumper& dumper, const TType& o, const TRawLayoutDescription& description)
+  {
+  if (std::is_trivially_copyable<TType>::value == false || dumper.IsRawLayout() == false)
+    return false;
+
+  DumpRawLayoutObjects(dumper, &o, 1, description);
+  return true;
+  }
+
+/// Loads object as raw memory if loader has raw layout enabled, returns false otherwise.
+template <typename TType>
+bool LoadRawLayout(ASerializeLoader& loader, TType& o, const TRawLayoutDescription& description)
+  SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (std::is_trivially_copyable<TType>::value == false || loader.IsRawLayout() == false)
+    return false;
+
+  LoadRawLayoutObjects(loader, &o, 1, description);
+  return true;
+  }
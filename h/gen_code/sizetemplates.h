@@ -0,0 +1,366 @@
+///\file sizetemplates.h
+#pragma once
+
+//Overloads "operator &" for evaluating serialized size of different serializable objects.
+//Each overload counts exactly the bytes the corresponding overload from dumpertemplates.h
+//would write, so the result may be used to preallocate dump targets.
+//Primitive types and fixed-size classes are counted without touching the object.
+//STL and serialize_utils types are counted via templated overloads (containers of
+//fixed-size elements are counted without iteration).
+//Any other class is redirected to the object's SerializedSize function.
+//All of them describe plain format (ASerializeDumper::IsPlainEncoding), use
+//SerializedSize(o, dumper) for size dumped with encodings of the dumper.
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/storage/sizecountingdumper.h>
+#include <serialize3/h/storage/stringdictionary.h>
+
+#include <type_traits>
+
+/// Accumulator of serialized size, used in generated SerializedSize functions.
+class TSerializedSizeCounter
+  {
+  public:
+    TSerializedSizeCounter() : Size(0) {}
+
+    void Add(size_t size)
+      {
+      Size += size;
+      }
+
+    size_t GetSize() const
+      {
+      return Size;
+      }
+
+  /// Class attributes:
+  private:
+    size_t Size;
+  };
+
+//Serialized size of types having the same size for every object, 0 for others.
+//Generated typeids headers specialize it for fixed-size serializable classes.
+template <typename TType, typename = void>
+struct serialized_fixed_size : public std::integral_constant<size_t, 0> {};
+
+//Unions are dumped as raw memory (see non-class operator& in dumpertemplates.h)
+template <typename TType>
+struct serialized_fixed_size<TType,
+  typename std::enable_if<std::is_arithmetic<TType>::value || std::is_enum<TType>::value ||
+                          std::is_union<TType>::value>::type>
+  : public std::integral_constant<size_t, sizeof(TType)> {};
+
+//long types are always dumped as 8 bytes (see ASerializeDumper::Dump<long>)
+template <>
+struct serialized_fixed_size<long> : public std::integral_constant<size_t, sizeof(long long)> {};
+
+template <>
+struct serialized_fixed_size<unsigned long> : public std::integral_constant<size_t, sizeof(unsigned long long)> {};
+
+template <typename T1, typename T2>
+struct serialized_fixed_size<std::pair<T1, T2>>
+  : public std::integral_constant<size_t,
+      serialized_fixed_size<typename std::remove_const<T1>::type>::value != 0 &&
+      serialized_fixed_size<typename std::remove_const<T2>::type>::value != 0 ?
+        serialized_fixed_size<typename std::remove_const<T1>::type>::value +
+        serialized_fixed_size<typename std::remove_const<T2>::type>::value : 0> {};
+
+template <>
+struct serialized_fixed_size<std::tuple<>> : public std::integral_constant<size_t, 0> {};
+
+template <typename TType, typename... TTypes>
+struct serialized_fixed_size<std::tuple<TType, TTypes...>>
+  : public std::integral_constant<size_t,
+      serialized_fixed_size<TType>::value != 0 &&
+      (sizeof...(TTypes) == 0 || serialized_fixed_size<std::tuple<TTypes...>>::value != 0) ?
+        serialized_fixed_size<TType>::value + serialized_fixed_size<std::tuple<TTypes...>>::value : 0> {};
+
+template <class TType, class TStorageType, class TRegistryType, bool SWIZZLED>
+struct serialized_fixed_size<TSerializePtrWrapper<TType, TStorageType, TRegistryType, SWIZZLED>>
+  : public std::integral_constant<size_t, sizeof(unsigned long long)> {};
+
+template <typename TType, typename = void>
+struct has_serialized_size : public std::false_type {};
+
+template <typename TType>
+struct has_serialized_size<TType, decltype(void(std::declval<const TType&>().SerializedSize()))>
+  : public std::true_type {};
+
+template <typename TType>
+size_t SerializedSize(const TType& o, std::true_type)
+  {
+  return o.SerializedSize();
+  }
+
+//Class without SerializedSize (f.e. MANUALLY_SERIALIZABLE_OBJECT) - count its manual Dump
+template <typename TType>
+size_t SerializedSize(const TType& o, std::false_type)
+  {
+  TSizeCountingDumper dumper;
+  dumper & o;
+  return dumper.GetSize();
+  }
+
+//Catchall for any object type not overloaded.
+template <typename TType>
+typename std::enable_if<std::is_class<TType>::value == false>::type
+operator&(TSerializedSizeCounter& counter, const TType&)
+  {
+  static_assert(serialized_fixed_size<TType>::value != 0, "Unexpected type of variable size");
+  counter.Add(serialized_fixed_size<TType>::value);
+  }
+
+template <typename TType>
+typename std::enable_if<std::is_class<TType>::value>::type
+operator&(TSerializedSizeCounter& counter, const TType& o)
+  {
+  if (serialized_fixed_size<TType>::value != 0)
+    counter.Add(serialized_fixed_size<TType>::value);
+  else
+    counter.Add(SerializedSize(o, has_serialized_size<TType>()));
+  }
+
+//--------------- count stl types
+
+template <class T1, class T2>
+void operator&(TSerializedSizeCounter& counter, const std::pair<T1,T2>& p)
+  {
+  counter & p.first;
+  counter & p.second;
+  }
+
+#if !defined(_MSC_VER) || (_MSC_VER >= 1912)
+template <std::size_t I = 0, typename... TTypes>
+typename std::enable_if<I == sizeof...(TTypes)>::type
+SerializedSize(TSerializedSizeCounter&, const std::tuple<TTypes...>&) {}
+
+template <std::size_t I = 0, typename... TTypes>
+typename std::enable_if<I < sizeof...(TTypes)>::type
+SerializedSize(TSerializedSizeCounter& counter, const std::tuple<TTypes...>& t)
+  {
+  counter & std::get<I>(t);
+  SerializedSize<I + 1>(counter, t);
+  }
+
+template <typename... TTypes>
+void operator&(TSerializedSizeCounter& counter, const std::tuple<TTypes...>& t)
+  {
+  SerializedSize(counter, t);
+  }
+#endif // !defined(_MSC_VER)
+
+template <typename TType>
+void operator&(TSerializedSizeCounter& counter, const std::unique_ptr<TType>& o)
+  {
+  counter & *o;
+  }
+
+template <typename TType>
+void operator&(TSerializedSizeCounter& counter, const std::shared_ptr<TType>& o)
+  {
+  counter & *o;
+  }
+
+inline
+void operator&(TSerializedSizeCounter& counter, const std::string& s)
+  {
+  counter.Add(sizeof(unsigned long long) + s.size());
+  }
+
+template <class TCntr>
+void CountContainer(TSerializedSizeCounter& counter, const TCntr& c)
+  {
+  typedef typename std::remove_const<typename TCntr::value_type>::type TValue;
+  counter.Add(sizeof(unsigned long long));
+  if (serialized_fixed_size<TValue>::value != 0)
+    counter.Add(c.size() * serialized_fixed_size<TValue>::value);
+  else
+    {
+    for (auto& i : c)
+      counter & i;
+    }
+  }
+
+#define COUNT_CNTR_BODY \
+  { \
+  CountContainer(counter, c); \
+  }
+
+template <class T,class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::vector<T,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::deque<T,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::list<T,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class T, class Compare, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::set<T,Compare,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class T, class Compare, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::multiset<T,Compare,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Value, class Compare, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::map<Key,Value,Compare,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Value, class Compare, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::multimap<Key,Value,Compare,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class HashFcn, class EqualKey, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::unordered_set<Key,HashFcn,EqualKey,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class HashFcn, class EqualKey, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::unordered_multiset<Key,HashFcn,EqualKey,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Value, class HashFcn, class EqualKey, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::unordered_map<Key,Value,HashFcn,EqualKey,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Value, class HashFcn, class EqualKey, class Alloc>
+void operator&(TSerializedSizeCounter& counter, const std::unordered_multimap<Key,Value,HashFcn,EqualKey,Alloc>& c)
+  COUNT_CNTR_BODY
+
+//--------------- count serialize_utils types
+
+//TypeId and contents of object (just null TypeId if pointer is null)
+template <class T>
+void operator&(TSerializedSizeCounter& counter, const TSingleRefPtr<T>& ptr)
+  {
+  if (ptr.IsNotNull())
+    counter.Add(ptr->SerializedPointerSize());
+  else
+    counter.Add(sizeof(TTypeId));
+  }
+
+template <class T>
+void operator&(TSerializedSizeCounter& counter, const TNoSerializeWrapper<T>&)
+  {
+  }
+
+template <class T>
+void operator&(TSerializedSizeCounter& counter, const TNoSerializePtrWrapper<T>&)
+  {
+  }
+
+template <class T, class TStorageCntr>
+void operator&(TSerializedSizeCounter& counter, const TSerializedObjectRegistry<T, TStorageCntr>& reg)
+  {
+  typedef typename TSerializedObjectRegistry<T, TStorageCntr>::TStorage TStorage;
+  const TStorage& storage = reg.GetStorage();
+  assert(storage.size() > 0); //storage always has one nul element
+  counter.Add(sizeof(unsigned long long));
+  typename TStorage::const_iterator i = storage.begin();
+  ++i; //skip first element like dump does
+  for (size_t handle = 1; i != storage.end(); ++i, ++handle)
+    {
+    if (reg.GetDumpHandle(handle) != 0)
+      counter & *i;
+    }
+  }
+
+#if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+template <class CharT, class Traits, class Allocator>
+void operator&(TSerializedSizeCounter& counter, const bc::basic_string<CharT, Traits, Allocator>& c)
+  COUNT_CNTR_BODY
+
+template <class T, class Allocator>
+void operator&(TSerializedSizeCounter& counter, const bc::list<T, Allocator>& c)
+  COUNT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(TSerializedSizeCounter& counter, const bc::vector<T,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(TSerializedSizeCounter& counter, const bc::deque<T,Alloc>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Compare, class Allocator, class SetOptions>
+void operator&(TSerializedSizeCounter& counter, const bc::set<Key,Compare,Allocator,SetOptions>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Compare, class Allocator>
+void operator&(TSerializedSizeCounter& counter, const bc::flat_set<Key,Compare,Allocator>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Compare, class Allocator, class MultiSetOptions>
+void operator&(TSerializedSizeCounter& counter, const bc::multiset<Key,Compare,Allocator,MultiSetOptions>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class Compare, class Allocator>
+void operator&(TSerializedSizeCounter& counter, const bc::flat_multiset<Key,Compare,Allocator>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator, class MapOptions>
+void operator&(TSerializedSizeCounter& counter, const bc::map<Key,T,Compare,Allocator,MapOptions>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator>
+void operator&(TSerializedSizeCounter& counter, const bc::flat_map<Key,T,Compare,Allocator>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator, class MultiMapOptions>
+void operator&(TSerializedSizeCounter& counter, const bc::multimap<Key,T,Compare,Allocator,MultiMapOptions>& c)
+  COUNT_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator>
+void operator&(TSerializedSizeCounter& counter, const bc::flat_multimap<Key,T,Compare,Allocator>& c)
+  COUNT_CNTR_BODY
+
+template <class T, class H, class P, class A>
+void operator&(TSerializedSizeCounter& counter, const bu::unordered_set<T,H,P,A>& c)
+  COUNT_CNTR_BODY
+
+template <class T, class H, class P, class A>
+void operator&(TSerializedSizeCounter& counter, const bu::unordered_multiset<T,H,P,A>& c)
+  COUNT_CNTR_BODY
+
+template <class K, class T, class H, class P, class A>
+void operator&(TSerializedSizeCounter& counter, const bu::unordered_map<K, T, H, P, A>& c)
+  COUNT_CNTR_BODY
+
+template <class K, class T, class H, class P, class A>
+void operator&(TSerializedSizeCounter& counter, const bu::unordered_multimap<K, T, H, P, A>& c)
+  COUNT_CNTR_BODY
+
+template<typename Value,typename IndexSpecifierList,typename Allocator>
+void operator&(TSerializedSizeCounter& counter, const bmi::multi_index_container<Value, IndexSpecifierList, Allocator>&c)
+  COUNT_CNTR_BODY
+
+#endif // #if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+/** Exact number of bytes dumper writes for object with its encodings. Plain format is counted
+    by SerializedSize() and serialized_fixed_size. Sizes of encodings (packed integers, XOR floats,
+    adaptive, columnar, front coding, raw layout, string dictionary) depend on values, so they
+    are not computed per codec: object is dumped into TSizeCountingDumper with the same encodings
+    (and copy of string dictionary, so dictionary of dumper is not changed). It costs like the dump
+    itself without its output, payloads of encoders are built and dropped.
+*/
+template <typename TType>
+size_t SerializedSize(const TType& o, const ASerializeDumper& dumper)
+  {
+  if (dumper.IsPlainEncoding())
+    {
+    TSerializedSizeCounter counter;
+    counter & o;
+    return counter.GetSize();
+    }
+
+  TSizeCountingDumper counting;
+  counting.CopyEncodings(dumper);
+  if (dumper.GetStringDictionary() != nullptr)
+    counting.SetStringDictionary(std::make_shared<TDumpStringDictionary>(*dumper.GetStringDictionary()));
+  counting & o;
+  return counting.GetSize();
+  }
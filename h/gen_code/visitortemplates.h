@@ -0,0 +1,391 @@
+///\file visitortemplates.h
+#pragma once
+
+//Overloads "operator &" for visiting handles of TSerializePtrWrapper members reachable from
+//serializable objects (f.e. to remap them after TSerializedObjectRegistry::Compact).
+//Generated VisitHandles functions visit only members which may contain handles.
+//STL and serialize_utils types are visited via templated overloads, objects referenced by
+//TSingleRefPtr via their VisitPointerHandles. Other types are skipped.
+//Note: members of classes with manual Dump are not visited.
+//Note: sets and maps whose keys may contain handles are rebuilt (elements are moved out,
+//      visited and inserted again), so keys may be remapped in any order; keys which become
+//      equal (f.e. released handles remapped to null) are merged in sets and maps without multi.
+
+#include <serialize3/h/gen_code/sizetemplates.h>
+
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// Visitor of handles, used in generated VisitHandles functions.
+class AHandleVisitor
+  {
+  public:
+    virtual ~AHandleVisitor() {}
+
+    /// Called for handle of each visited wrapper, registry is the one resolving the handle.
+    virtual void VisitHandle(const void* registry, size_t& handle) = 0;
+  };
+
+template <typename TType, typename = void>
+struct has_visit_handles : public std::false_type {};
+
+template <typename TType>
+struct has_visit_handles<TType, decltype(void(std::declval<TType&>().VisitHandles(
+  std::declval<AHandleVisitor&>())))> : public std::true_type {};
+
+template <typename TType>
+void VisitHandles(AHandleVisitor& visitor, TType& o, std::true_type)
+  {
+  o.VisitHandles(visitor);
+  }
+
+//Class without VisitHandles (f.e. string or MANUALLY_SERIALIZABLE_OBJECT) has no handles to visit
+template <typename TType>
+void VisitHandles(AHandleVisitor&, TType&, std::false_type)
+  {
+  }
+
+//Catchall for any object type not overloaded.
+template <typename TType>
+typename std::enable_if<std::is_class<TType>::value == false>::type
+operator&(AHandleVisitor&, TType&)
+  {
+  }
+
+template <typename TType>
+typename std::enable_if<std::is_class<TType>::value>::type
+operator&(AHandleVisitor& visitor, TType& o)
+  {
+  VisitHandles(visitor, o, has_visit_handles<TType>());
+  }
+
+//--------------- visit stl types
+
+template <class T1, class T2>
+void operator&(AHandleVisitor& visitor, std::pair<T1,T2>& p)
+  {
+  visitor & const_cast<typename std::remove_const<T1>::type&>(p.first);
+  visitor & p.second;
+  }
+
+#if !defined(_MSC_VER) || (_MSC_VER >= 1912)
+template <std::size_t I = 0, typename... TTypes>
+typename std::enable_if<I == sizeof...(TTypes)>::type
+VisitHandles(AHandleVisitor&, std::tuple<TTypes...>&) {}
+
+template <std::size_t I = 0, typename... TTypes>
+typename std::enable_if<I < sizeof...(TTypes)>::type
+VisitHandles(AHandleVisitor& visitor, std::tuple<TTypes...>& t)
+  {
+  visitor & std::get<I>(t);
+  VisitHandles<I + 1, TTypes...>(visitor, t);
+  }
+
+template <typename... TTypes>
+void operator&(AHandleVisitor& visitor, std::tuple<TTypes...>& t)
+  {
+  VisitHandles(visitor, t);
+  }
+#endif // !defined(_MSC_VER)
+
+template <typename TType>
+void operator&(AHandleVisitor& visitor, std::unique_ptr<TType>& o)
+  {
+  if (o)
+    visitor & *o;
+  }
+
+template <typename TType>
+void operator&(AHandleVisitor& visitor, std::shared_ptr<TType>& o)
+  {
+  if (o)
+    visitor & *o;
+  }
+
+template <class TCntr>
+void VisitContainer(AHandleVisitor& visitor, TCntr& c)
+  {
+  typedef typename std::remove_const<typename TCntr::value_type>::type TValue;
+  for (auto& i : c)
+    visitor & const_cast<TValue&>(i);
+  }
+
+#define VISIT_CNTR_BODY \
+  { \
+  VisitContainer(visitor, c); \
+  }
+
+//Keys of such types are never rewritten by visitor, so containers keyed by them are not rebuilt
+template <typename TType>
+struct may_contain_handles : public std::integral_constant<bool,
+  std::is_arithmetic<TType>::value == false && std::is_enum<TType>::value == false> {};
+
+template <class TChar, class TTraits, class TAlloc>
+struct may_contain_handles<std::basic_string<TChar, TTraits, TAlloc>> : public std::false_type {};
+
+//Element of associative container with modifiable key
+template <typename TValue>
+struct visited_value
+  {
+  typedef TValue type;
+  };
+
+template <typename TKey, typename TValue>
+struct visited_value<std::pair<const TKey, TValue>>
+  {
+  typedef std::pair<TKey, TValue> type;
+  };
+
+template <class TCntr>
+void VisitMappedValues(AHandleVisitor&, TCntr&, std::true_type)
+  {
+  }
+
+template <class TCntr>
+void VisitMappedValues(AHandleVisitor& visitor, TCntr& c, std::false_type)
+  {
+  for (auto& i : c)
+    visitor & i.second;
+  }
+
+/** Visits elements of set or map, whose order or hash depends on keys. If keys may contain
+    handles, elements are moved out (container is cleared without comparing or hashing them),
+    visited and inserted again.
+*/
+template <class TCntr>
+void VisitKeyedContainer(AHandleVisitor& visitor, TCntr& c, std::true_type)
+  {
+  typedef typename visited_value<typename TCntr::value_type>::type TValue;
+  std::vector<TValue> values;
+
+  values.reserve(c.size());
+  for (auto& i : c)
+    values.push_back(std::move(const_cast<typename std::remove_const<typename TCntr::value_type>::type&>(i)));
+  c.clear();
+
+  for (auto& i : values)
+    visitor & i;
+  c.insert(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+  }
+
+//Keys without handles are kept, values of maps are visited in place
+template <class TCntr>
+void VisitKeyedContainer(AHandleVisitor& visitor, TCntr& c, std::false_type)
+  {
+  VisitMappedValues(visitor, c, std::is_same<typename TCntr::key_type, typename TCntr::value_type>());
+  }
+
+#define VISIT_KEYED_CNTR_BODY \
+  { \
+  VisitKeyedContainer(visitor, c, may_contain_handles<typename std::remove_reference<decltype(c)>::type::key_type>()); \
+  }
+
+template <class T,class Alloc>
+void operator&(AHandleVisitor& visitor, std::vector<T,Alloc>& c)
+  VISIT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(AHandleVisitor& visitor, std::deque<T,Alloc>& c)
+  VISIT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(AHandleVisitor& visitor, std::list<T,Alloc>& c)
+  VISIT_CNTR_BODY
+
+template <class T, class Compare, class Alloc>
+void operator&(AHandleVisitor& visitor, std::set<T,Compare,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class T, class Compare, class Alloc>
+void operator&(AHandleVisitor& visitor, std::multiset<T,Compare,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class Value, class Compare, class Alloc>
+void operator&(AHandleVisitor& visitor, std::map<Key,Value,Compare,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class Value, class Compare, class Alloc>
+void operator&(AHandleVisitor& visitor, std::multimap<Key,Value,Compare,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class HashFcn, class EqualKey, class Alloc>
+void operator&(AHandleVisitor& visitor, std::unordered_set<Key,HashFcn,EqualKey,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class HashFcn, class EqualKey, class Alloc>
+void operator&(AHandleVisitor& visitor, std::unordered_multiset<Key,HashFcn,EqualKey,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class Value, class HashFcn, class EqualKey, class Alloc>
+void operator&(AHandleVisitor& visitor, std::unordered_map<Key,Value,HashFcn,EqualKey,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class Value, class HashFcn, class EqualKey, class Alloc>
+void operator&(AHandleVisitor& visitor, std::unordered_multimap<Key,Value,HashFcn,EqualKey,Alloc>& c)
+  VISIT_KEYED_CNTR_BODY
+
+//--------------- visit serialize_utils types
+
+template <class T>
+void operator&(AHandleVisitor& visitor, TSingleRefPtr<T>& ptr)
+  {
+  if (ptr.IsNotNull())
+    ptr->VisitPointerHandles(visitor);
+  }
+
+template <class T>
+void operator&(AHandleVisitor& visitor, TNoSerializeWrapper<T>&)
+  {
+  }
+
+template <class T>
+void operator&(AHandleVisitor& visitor, TNoSerializePtrWrapper<T>&)
+  {
+  }
+
+template <class TType, class TStorageType, class TRegistryType, bool SWIZZLED>
+void operator&(AHandleVisitor& visitor, TSerializePtrWrapper<TType, TStorageType, TRegistryType, SWIZZLED>& w)
+  {
+  size_t handle = w.GetHandle();
+  visitor.VisitHandle(TRegistryType::GetInstance(), handle);
+  if (handle != w.GetHandle())
+    w.SetHandle(handle);
+  }
+
+//Visits objects stored in registry (they may reference each other).
+template <class T, class TStorageCntr>
+void operator&(AHandleVisitor& visitor, TSerializedObjectRegistry<T, TStorageCntr>& reg)
+  {
+  typedef typename TSerializedObjectRegistry<T, TStorageCntr>::TStorage TStorage;
+  TStorage& storage = reg.GetStorage();
+  typename TStorage::iterator i = storage.begin();
+  for (++i; i != storage.end(); ++i)
+    visitor & *i;
+  }
+
+#if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+template <class T, class Allocator>
+void operator&(AHandleVisitor& visitor, bc::list<T, Allocator>& c)
+  VISIT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(AHandleVisitor& visitor, bc::vector<T,Alloc>& c)
+  VISIT_CNTR_BODY
+
+template <class T,class Alloc>
+void operator&(AHandleVisitor& visitor, bc::deque<T,Alloc>& c)
+  VISIT_CNTR_BODY
+
+template <class Key, class Compare, class Allocator, class SetOptions>
+void operator&(AHandleVisitor& visitor, bc::set<Key,Compare,Allocator,SetOptions>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class Compare, class Allocator>
+void operator&(AHandleVisitor& visitor, bc::flat_set<Key,Compare,Allocator>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class Compare, class Allocator, class MultiSetOptions>
+void operator&(AHandleVisitor& visitor, bc::multiset<Key,Compare,Allocator,MultiSetOptions>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class Compare, class Allocator>
+void operator&(AHandleVisitor& visitor, bc::flat_multiset<Key,Compare,Allocator>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator, class MapOptions>
+void operator&(AHandleVisitor& visitor, bc::map<Key,T,Compare,Allocator,MapOptions>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator>
+void operator&(AHandleVisitor& visitor, bc::flat_map<Key,T,Compare,Allocator>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator, class MultiMapOptions>
+void operator&(AHandleVisitor& visitor, bc::multimap<Key,T,Compare,Allocator,MultiMapOptions>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class Key, class T, class Compare, class Allocator>
+void operator&(AHandleVisitor& visitor, bc::flat_multimap<Key,T,Compare,Allocator>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class T, class H, class P, class A>
+void operator&(AHandleVisitor& visitor, bu::unordered_set<T,H,P,A>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class T, class H, class P, class A>
+void operator&(AHandleVisitor& visitor, bu::unordered_multiset<T,H,P,A>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class K, class T, class H, class P, class A>
+void operator&(AHandleVisitor& visitor, bu::unordered_map<K, T, H, P, A>& c)
+  VISIT_KEYED_CNTR_BODY
+
+template <class K, class T, class H, class P, class A>
+void operator&(AHandleVisitor& visitor, bu::unordered_multimap<K, T, H, P, A>& c)
+  VISIT_KEYED_CNTR_BODY
+
+//Indices may be keyed by any part of elements, elements with handles are inserted again
+template<typename Value,typename IndexSpecifierList,typename Allocator>
+void operator&(AHandleVisitor& visitor, bmi::multi_index_container<Value, IndexSpecifierList, Allocator>&c)
+  {
+  if (may_contain_handles<Value>::value)
+    {
+    std::vector<Value> values(c.begin(), c.end());
+    c.clear();
+    for (auto& i : values)
+      {
+      visitor & i;
+      c.insert(c.end(), std::move(i));
+      }
+    }
+  }
+
+#endif // #if defined(SERIALIZABLE_BOOST_CONTAINERS)
+
+//--------------- registry compaction
+
+/// Rewrites handles of one registry by handle map returned from its Compact.
+template <class TRegistry>
+class THandleRemapper : public AHandleVisitor
+  {
+  public:
+    THandleRemapper(const TRegistry& registry, const typename TRegistry::THandleMap& handles) :
+      Registry(registry), Handles(handles) {}
+
+    virtual void VisitHandle(const void* registry, size_t& handle) override
+      {
+      if (registry == &Registry && handle < Handles.size())
+        handle = Handles[handle];
+      }
+
+  /// Class attributes:
+  private:
+    const TRegistry&                      Registry;
+    const typename TRegistry::THandleMap& Handles;
+  };
+
+inline void RemapHandles(AHandleVisitor&) {}
+
+template <class TRoot, class... TRoots>
+void RemapHandles(AHandleVisitor& visitor, TRoot& root, TRoots&... roots)
+  {
+  visitor & root;
+  RemapHandles(visitor, roots...);
+  }
+
+/** Compacts registry and remaps handles in its objects and in all objects reachable from roots.
+    Handles of released objects become null, sets and maps keyed by them are rebuilt (see
+    VisitKeyedContainer), so such keys are merged in containers with unique keys.
+    Registry must be current instance (see GetInstance).
+*/
+template <class TRegistry, class... TRoots>
+void CompactRegistry(TRegistry& registry, TRoots&... roots)
+  {
+  assert(TRegistry::GetInstance() == &registry);
+  typename TRegistry::THandleMap handles(registry.Compact());
+  THandleRemapper<TRegistry> remapper(registry, handles);
+  RemapHandles(remapper, registry, roots...);
+  }
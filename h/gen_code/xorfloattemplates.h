@@ -0,0 +1,90 @@
+///\file xorfloattemplates.h
+#pragma once
+
+//Support for XOR compression of floating point sequences (see TXorFloatCodec). Vectors and
+//deques of float and double are dumped XOR compressed if it is enabled in dumper (see
+//serialize_snapshotheader.h), single containers may be dumped so by DumpXorFloats and
+//LoadXorFloats called from manually written Dump/Load:
+//  count, payload size, payload
+
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+#include <serialize3/h/storage/xorfloatcodec.h>
+
+#include <type_traits>
+#include <vector>
+
+template <typename TType>
+struct is_xor_float : public std::integral_constant<bool,
+  std::is_same<TType, float>::value || std::is_same<TType, double>::value> {};
+
+template <class TContainer>
+void DumpXorFloats(ASerializeDumper& dumper, const TContainer& c, std::true_type)
+  {
+  std::vector<unsigned char> payload;
+
+  dumper.DumpSizeT(c.size());
+  if (c.empty())
+    return;
+
+  TXorFloatCodec<typename TContainer::value_type>::Encode(c.begin(), c.size(), payload);
+  dumper.DumpSizeT(payload.size());
+  dumper.WriteBuffer(payload.data(), payload.size());
+  }
+
+template <class TContainer>
+void DumpXorFloats(ASerializeDumper&, const TContainer&, std::false_type)
+  {
+  }
+
+/// Dumps sequence container of float or double XOR compressed.
+template <class TContainer>
+void DumpXorFloats(ASerializeDumper& dumper, const TContainer& c)
+  {
+  DumpXorFloats(dumper, c, is_xor_float<typename TContainer::value_type>());
+  }
+
+template <class TContainer>
+void LoadXorFloats(ASerializeLoader& loader, TContainer& c, std::true_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  size_t count = 0;
+  size_t size = 0;
+
+  loader.LoadLength(count);
+  if (count == 0)
+    return;
+  loader.LoadSizeT(size);
+  if (loader.HasError())
+    return;
+  if ((count - 1) / 8 > size)
+    {
+    //each value but the first takes at least one bit
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    return;
+    }
+
+  //payload is read in steps if loader doesn't know its size, so corrupted size can't allocate it
+  const unsigned char* payload = loader.AcquireLoadedBuffer(size);
+  if (loader.HasError())
+    return;
+
+  size_t i = c.size();
+  c.resize(i + count);
+  if (TXorFloatCodec<typename TContainer::value_type>::Decode(payload, size, count, c.begin() + i) == false)
+    {
+    c.resize(i);
+    loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+    }
+  }
+
+template <class TContainer>
+void LoadXorFloats(ASerializeLoader&, TContainer&, std::false_type) SERIALIZE_LOAD_NOEXCEPT
+  {
+  }
+
+/// Loads sequence container dumped by DumpXorFloats, loaded values are appended.
+template <class TContainer>
+void LoadXorFloats(ASerializeLoader& loader, TContainer& c) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadXorFloats(loader, c, is_xor_float<typename TContainer::value_type>());
+  }
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/directfileio.h>
+
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+
+//---------- TDirectFileDumper
+//Dumps into file bypassing the page cache, several buffers are written in parallel
+//(see TDirectFileIo). Meant for very large snapshots which would otherwise evict
+//working set of other processes from the page cache.
+class TDirectFileDumper : public ASerializeDumper
+  {
+  public:
+    explicit TDirectFileDumper(const char* fileName, size_t bufferSize = 1 << 20,
+      unsigned queueDepth = 4) :
+      File(fileName, true, bufferSize, queueDepth), Current(0), Used(0), BufferOffset(0),
+      Failed(File.IsOpen() == false), Closed(false) {}
+
+    virtual ~TDirectFileDumper()
+      {
+      Close();
+      }
+
+    /** Writes rest of data and waits for all writes to finish.
+        Returns false if any write failed.
+    */
+    bool Close()
+      {
+      if (Closed)
+        return IsGood();
+      Closed = true;
+
+      if (File.IsOpen() == false)
+        return false;
+
+      //last block is padded, file is truncated to real size afterwards
+      size_t size = BufferOffset + Used;
+      if (Used != 0)
+        {
+        size_t length = (Used + TDirectFileIo::ALIGNMENT - 1) / TDirectFileIo::ALIGNMENT *
+          TDirectFileIo::ALIGNMENT;
+        memset(File.GetRequest(Current).Buffer + Used, 0, length - Used);
+        File.Submit(Current, BufferOffset, length);
+        }
+
+      for (unsigned i = 0; i < File.GetQueueDepth(); ++i)
+        CheckWrite(i);
+
+      if (File.Truncate(size) == false)
+        Failed = true;
+
+      return IsGood();
+      }
+
+    bool IsGood() const
+      {
+      return Failed == false;
+      }
+
+    size_t GetPosition() const
+      {
+      return BufferOffset + Used;
+      }
+
+  /// ASerializeDumper reimplementation:
+    virtual void Log(const char* msg) override
+      {
+      std::cout << std::setw(10);
+      std::cout << GetPosition() << " ";
+      for (int i = IndentLevel; i > 0; --i)
+        std::cout << " ";
+      std::cout << msg << std::endl;
+      }
+
+    virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) override
+      {
+      assert(Closed == false);
+      if (File.IsOpen() == false)
+        return; //buffers may be missing, Failed is set
+
+      size_t bufferSize = File.GetBufferSize();
+
+      while (bufferLen != 0)
+        {
+        size_t length = bufferSize - Used < bufferLen ? bufferSize - Used : bufferLen;
+        memcpy(File.GetRequest(Current).Buffer + Used, buffer, length);
+        Used += length;
+        buffer += length;
+        bufferLen -= length;
+
+        if (Used == bufferSize)
+          {
+          //buffer is full - write it and continue with next one, when it's free
+          File.Submit(Current, BufferOffset, bufferSize);
+          Current = (Current + 1) % File.GetQueueDepth();
+          CheckWrite(Current);
+          BufferOffset += bufferSize;
+          Used = 0;
+          }
+        }
+      }
+
+  private:
+    void CheckWrite(unsigned i)
+      {
+      File.Wait(i);
+      TDirectFileIo::TRequest& request = File.GetRequest(i);
+      if (request.Result != static_cast<long>(request.Length))
+        Failed = true;
+      request.Length = 0;
+      request.Result = 0;
+      }
+
+  /// Class attributes:
+  private:
+    TDirectFileIo File;
+    unsigned      Current;      //index of request being filled
+    size_t        Used;         //used bytes of current buffer
+    size_t        BufferOffset; //file offset of current buffer
+    bool          Failed;
+    bool          Closed;
+  }; //TDirectFileDumper
@@ -0,0 +1,330 @@
+#pragma once
+
+#if !defined(__linux__)
+  #error Direct file I/O is supported on Linux only
+#endif
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//---------- TDirectFileIo
+//Block file I/O bypassing the page cache (O_DIRECT) with several requests in flight via io_uring.
+//Used by TDirectFileDumper and TDirectFileLoader for very large snapshots.
+//If file system doesn't support O_DIRECT, file is opened as buffered. If io_uring is
+//not available (old kernel, seccomp), requests are done synchronously by pread/pwrite.
+//Each request owns one buffer aligned to ALIGNMENT, buffer size is multiple of ALIGNMENT.
+//Short and interrupted transfers are resubmitted till whole request is done, end of file
+//or error.
+class TDirectFileIo
+  {
+  public:
+    static const size_t ALIGNMENT = 4096;
+
+    struct TRequest
+      {
+      unsigned char* Buffer;
+      size_t         Offset;   //file offset of the buffer
+      size_t         Length;   //requested length
+      size_t         Done;     //bytes transferred so far
+      long           Result;   //transferred bytes or -errno, valid if not InFlight
+      bool           InFlight;
+      };
+
+    TDirectFileIo(const char* fileName, bool write, size_t bufferSize, unsigned queueDepth) :
+      Fd(-1), Write(write), Direct(true), BufferSize(RoundUp(bufferSize)),
+      Requests(queueDepth ? queueDepth : 1), RingFd(-1), SqRing(nullptr), CqRing(nullptr),
+      Sqes(nullptr), SqRingSize(0), CqRingSize(0), SqesSize(0)
+      {
+      bool allocated = true;
+      for (TRequest& request : Requests)
+        {
+        request.Buffer = static_cast<unsigned char*>(aligned_alloc(ALIGNMENT, BufferSize));
+        request.Offset = 0;
+        request.Length = 0;
+        request.Done = 0;
+        request.Result = 0;
+        request.InFlight = false;
+        allocated = allocated && request.Buffer != nullptr;
+        }
+      if (allocated == false)
+        return; //file stays closed
+
+      int flags = write ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY;
+      Fd = open(fileName, flags | O_DIRECT, 0644);
+      if (Fd < 0 && errno == EINVAL)
+        {
+        Direct = false;
+        Fd = open(fileName, flags, 0644);
+        }
+
+      if (Fd >= 0)
+        SetupRing(GetQueueDepth());
+      }
+
+    ~TDirectFileIo()
+      {
+      for (unsigned i = 0; i < Requests.size(); ++i)
+        Wait(i);
+      for (TRequest& request : Requests)
+        free(request.Buffer);
+
+      if (Sqes)
+        munmap(Sqes, SqesSize);
+      if (CqRing && CqRing != SqRing)
+        munmap(CqRing, CqRingSize);
+      if (SqRing)
+        munmap(SqRing, SqRingSize);
+      if (RingFd >= 0)
+        close(RingFd);
+      if (Fd >= 0)
+        close(Fd);
+      }
+
+    bool IsOpen() const { return Fd >= 0; }
+    /// Page cache is bypassed.
+    bool IsDirect() const { return Direct; }
+    /// Requests are done by io_uring, else synchronously.
+    bool IsAsync() const { return RingFd >= 0; }
+
+    size_t   GetBufferSize() const { return BufferSize; }
+    unsigned GetQueueDepth() const { return static_cast<unsigned>(Requests.size()); }
+    TRequest& GetRequest(unsigned i) { return Requests[i]; }
+    const TRequest& GetRequest(unsigned i) const { return Requests[i]; }
+
+    size_t GetFileSize() const
+      {
+      struct stat st;
+      return fstat(Fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+      }
+
+    /// Sets final file size (written blocks may be padded behind end of data).
+    bool Truncate(size_t size)
+      {
+      return ftruncate(Fd, static_cast<off_t>(size)) == 0;
+      }
+
+    /** Starts transfer of request's buffer from/to given file offset. Offset and length must be
+        multiples of ALIGNMENT. Request must not be in flight.
+    */
+    void Submit(unsigned i, size_t offset, size_t length)
+      {
+      TRequest& request = Requests[i];
+      request.Offset = offset;
+      request.Length = length;
+      request.Done = 0;
+      request.Result = 0;
+      Start(i);
+      }
+
+    /// Waits till request is finished, its Result is valid then.
+    void Wait(unsigned i)
+      {
+      while (Requests[i].InFlight)
+        {
+        if (ReapCompletions() != 0 ||
+            syscall(__NR_io_uring_enter, RingFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0 ||
+            errno == EINTR || errno == EAGAIN || errno == EBUSY)
+          continue;
+
+        //ring is broken, completion never comes
+        Requests[i].InFlight = false;
+        Requests[i].Result = -errno;
+        }
+      }
+
+  private:
+    /// Starts transfer of the rest of request, synchronously if io_uring doesn't take it.
+    void Start(unsigned i)
+      {
+      TRequest& request = Requests[i];
+      if (IsAsync() == false || Enqueue(i) == false)
+        request.Result = TransferSync(request);
+      }
+
+    /// Passes the rest of request to io_uring, returns false if kernel didn't take it.
+    bool Enqueue(unsigned i)
+      {
+      TRequest& request = Requests[i];
+      unsigned tail = *SqTail;
+      unsigned index = tail & *SqMask;
+      io_uring_sqe* sqe = &Sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = Write ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->fd = Fd;
+      sqe->addr = reinterpret_cast<unsigned long long>(request.Buffer + request.Done);
+      sqe->len = static_cast<unsigned>(request.Length - request.Done);
+      sqe->off = request.Offset + request.Done;
+      sqe->user_data = i;
+      SqArray[index] = index;
+      __atomic_store_n(SqTail, tail + 1, __ATOMIC_RELEASE);
+      request.InFlight = true;
+
+      for (;;)
+        {
+        long result = syscall(__NR_io_uring_enter, RingFd, 1, 0, 0, nullptr, 0);
+        if (result > 0 || __atomic_load_n(SqHead, __ATOMIC_ACQUIRE) != tail)
+          return true; //request was consumed by kernel
+        if (result < 0 && errno == EINTR)
+          continue;
+        //completion queue is full or kernel is short of resources, retry after reaping
+        if (result < 0 && (errno == EAGAIN || errno == EBUSY) && ReapCompletions() != 0)
+          continue;
+        break;
+        }
+
+      //kernel didn't consume the entry, so it may be taken back
+      __atomic_store_n(SqTail, tail, __ATOMIC_RELEASE);
+      request.InFlight = false;
+      return false;
+      }
+
+    static size_t RoundUp(size_t size)
+      {
+      size_t blocks = (size + ALIGNMENT - 1) / ALIGNMENT;
+      return (blocks ? blocks : 1) * ALIGNMENT;
+      }
+
+    void SetupRing(unsigned entries)
+      {
+      io_uring_params params;
+      memset(&params, 0, sizeof(params));
+      int ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+      if (ringFd < 0)
+        return;
+
+      SqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+      if (singleMmap)
+        SqRingSize = CqRingSize = SqRingSize > CqRingSize ? SqRingSize : CqRingSize;
+
+      void* sqRing = mmap(nullptr, SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ringFd, IORING_OFF_SQ_RING);
+      void* cqRing = singleMmap ? sqRing : mmap(nullptr, CqRingSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+      SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+      void* sqes = mmap(nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ringFd, IORING_OFF_SQES);
+
+      if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+        {
+        if (sqes != MAP_FAILED)
+          munmap(sqes, SqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing)
+          munmap(cqRing, CqRingSize);
+        if (sqRing != MAP_FAILED)
+          munmap(sqRing, SqRingSize);
+        close(ringFd);
+        return;
+        }
+
+      unsigned char* sq = static_cast<unsigned char*>(sqRing);
+      unsigned char* cq = static_cast<unsigned char*>(cqRing);
+      SqRing  = sqRing;
+      CqRing  = cqRing;
+      SqHead  = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+      SqTail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      SqMask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      SqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+      CqHead  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      CqTail  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      CqMask  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      Cqes    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+      Sqes    = static_cast<io_uring_sqe*>(sqes);
+      RingFd  = ringFd;
+      }
+
+    unsigned ReapCompletions()
+      {
+      unsigned head = *CqHead;
+      unsigned tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+      unsigned reaped = 0;
+
+      for (; head != tail; ++reaped)
+        {
+        const io_uring_cqe& cqe = Cqes[head & *CqMask];
+        unsigned i = static_cast<unsigned>(cqe.user_data);
+        long result = cqe.res;
+        //entry is released before request may be resubmitted
+        __atomic_store_n(CqHead, ++head, __ATOMIC_RELEASE);
+        Complete(i, result);
+        }
+      return reaped;
+      }
+
+    /// Finishes request by result of its transfer or resubmits its rest.
+    void Complete(unsigned i, long result)
+      {
+      TRequest& request = Requests[i];
+      request.InFlight = false;
+      if (result == -EINTR || result == -EAGAIN)
+        {
+        Start(i);
+        return;
+        }
+      if (result < 0)
+        {
+        request.Result = result;
+        return;
+        }
+
+      request.Done += static_cast<size_t>(result);
+      if (result != 0 && request.Done < request.Length)
+        Start(i); //short transfer
+      else
+        request.Result = static_cast<long>(request.Done); //0 is end of file
+      }
+
+    long TransferSync(const TRequest& request)
+      {
+      size_t done = request.Done;
+      while (done < request.Length)
+        {
+        ssize_t result = Write ?
+          pwrite(Fd, request.Buffer + done, request.Length - done, request.Offset + done) :
+          pread(Fd, request.Buffer + done, request.Length - done, request.Offset + done);
+        if (result < 0 && errno == EINTR)
+          continue;
+        if (result < 0)
+          return -errno;
+        if (result == 0)
+          break; //end of file
+        done += result;
+        }
+      return static_cast<long>(done);
+      }
+
+  /// Class attributes:
+  private:
+    int                   Fd;
+    bool                  Write;
+    bool                  Direct;
+    size_t                BufferSize;
+    std::vector<TRequest> Requests;
+
+    //io_uring, RingFd is -1 if not available
+    int           RingFd;
+    void*         SqRing;
+    void*         CqRing;
+    io_uring_sqe* Sqes;
+    size_t        SqRingSize;
+    size_t        CqRingSize;
+    size_t        SqesSize;
+    unsigned*     SqHead;
+    unsigned*     SqTail;
+    unsigned*     SqMask;
+    unsigned*     SqArray;
+    unsigned*     CqHead;
+    unsigned*     CqTail;
+    unsigned*     CqMask;
+    io_uring_cqe* Cqes;
+  }; //TDirectFileIo
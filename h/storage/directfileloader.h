@@ -0,0 +1,127 @@
+#pragma once
+
+#include <serialize3/h/storage/serializeloader.h>
+#include <serialize3/h/storage/directfileio.h>
+
+#include <iostream>
+#include <iomanip>
+
+//---------- TDirectFileLoader
+//Loads from file bypassing the page cache, following buffers are read ahead in parallel
+//(see TDirectFileIo). Counterpart of TDirectFileDumper, but it can load any dumped file.
+class TDirectFileLoader : public ASerializeLoader
+  {
+  public:
+    explicit TDirectFileLoader(const char* fileName, size_t bufferSize = 1 << 20,
+      unsigned queueDepth = 4) :
+      File(fileName, false, bufferSize, queueDepth), FileSize(0), Current(0), Position(0),
+      Available(0), NextOffset(0)
+      {
+      if (File.IsOpen() == false)
+        return;
+
+      FileSize = File.GetFileSize();
+      for (unsigned i = 0; i < File.GetQueueDepth(); ++i)
+        SubmitNext(i);
+      FinishCurrent();
+      }
+
+    bool IsOpen() const
+      {
+      return File.IsOpen();
+      }
+
+    size_t GetPosition() const
+      {
+      return File.GetRequest(Current).Offset + Position;
+      }
+
+  /// ASerializeLoader reimplementation:
+    virtual void Log(const char* msg) override
+      {
+      std::cout << std::setw(10);
+      std::cout << GetPosition() << " ";
+      for (int i = IndentLevel; i > 0; --i)
+        std::cout << " ";
+      std::cout << msg << std::endl;
+      }
+
+    virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+      {
+      while (bufferLen != 0)
+        {
+        if (Position == Available && NextBuffer() == false)
+          {
+          SetError(LOAD_TRUNCATED_INPUT);
+          memset(buffer, 0, bufferLen);
+          return;
+          }
+
+        size_t length = Available - Position < bufferLen ? Available - Position : bufferLen;
+        memcpy(buffer, File.GetRequest(Current).Buffer + Position, length);
+        Position += length;
+        buffer += length;
+        bufferLen -= length;
+        }
+      }
+
+    virtual const unsigned char* AcquireBuffer(size_t bufferLen) override
+      {
+      if (Available - Position < bufferLen)
+        return ASerializeLoader::AcquireBuffer(bufferLen);
+
+      const unsigned char* buffer = File.GetRequest(Current).Buffer + Position;
+      Position += bufferLen;
+      return buffer;
+      }
+
+    virtual size_t GetAvailableSize() const override
+      {
+      return FileSize - GetPosition();
+      }
+
+  private:
+    /// Starts reading of next not requested part of file into buffer i.
+    void SubmitNext(unsigned i)
+      {
+      TDirectFileIo::TRequest& request = File.GetRequest(i);
+      request.Offset = NextOffset;
+      request.Length = 0;
+      request.Result = 0;
+      if (NextOffset < FileSize)
+        File.Submit(i, NextOffset, File.GetBufferSize());
+      NextOffset += File.GetBufferSize();
+      }
+
+    void FinishCurrent()
+      {
+      File.Wait(Current);
+      const TDirectFileIo::TRequest& request = File.GetRequest(Current);
+      Position = 0;
+      Available = request.Result > 0 ? static_cast<size_t>(request.Result) : 0;
+      if (request.Length != 0 && request.Result < static_cast<long>(request.Length) &&
+          request.Offset + Available < FileSize)
+        SetError(LOAD_TRUNCATED_INPUT); //read failed before end of file
+      }
+
+    /// Reuses consumed buffer for read ahead and switches to the next one.
+    bool NextBuffer()
+      {
+      if (File.GetRequest(Current).Offset + Available >= FileSize)
+        return false;
+
+      SubmitNext(Current);
+      Current = (Current + 1) % File.GetQueueDepth();
+      FinishCurrent();
+      return Available != 0;
+      }
+
+  /// Class attributes:
+  private:
+    TDirectFileIo File;
+    size_t        FileSize;
+    unsigned      Current;    //index of request being consumed
+    size_t        Position;   //read position in current buffer
+    size_t        Available;  //valid bytes in current buffer
+    size_t        NextOffset; //file offset of next buffer to be requested
+  }; //TDirectFileLoader
@@ -0,0 +1,166 @@
+#pragma once
+
+#if defined(_WIN32)
+  #error File descriptor dumper is supported on POSIX systems only
+#endif
+
+#include <serialize3/h/storage/serializedumper.h>
+
+#include <sys/uio.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+//---------- TFdDumper
+//Dumps into file descriptor (file, pipe, Unix socket) by writev. Writes are copied into
+//staging buffer, large contiguous memory of dumped objects (strings, vectors of primitive
+//types, see WriteBufferReferenced) is referenced in place, so big blobs are written without
+//copying and with few syscalls. Dumped objects must not be modified or destroyed until
+//Flush (or destruction of the dumper). File descriptor is not closed, it must be blocking.
+class TFdDumper : public ASerializeDumper
+  {
+  public:
+    /** referenceThreshold - minimal length of buffer passed to WriteBufferReferenced written
+        without copying (it is never less than 64).
+    */
+    explicit TFdDumper(int fd, size_t referenceThreshold = 4096, size_t stagingSize = 1 << 16) :
+      Fd(fd), ReferenceThreshold(referenceThreshold < 64 ? 64 : referenceThreshold),
+      Staging(stagingSize < ReferenceThreshold ? ReferenceThreshold : stagingSize), StagingUsed(0),
+      Written(0), PendingSize(0), Failed(fd < 0) {}
+
+    virtual ~TFdDumper()
+      {
+      Flush();
+      }
+
+    /// Writes all pending data, returns false if any write failed.
+    bool Flush()
+      {
+      WritePending();
+      return IsGood();
+      }
+
+    bool IsGood() const
+      {
+      return Failed == false;
+      }
+
+    size_t GetPosition() const
+      {
+      return Written + PendingSize;
+      }
+
+  /// ASerializeDumper reimplementation:
+    virtual void Log(const char* msg) override
+      {
+      std::cout << std::setw(10);
+      std::cout << GetPosition() << " ";
+      for (int i = IndentLevel; i > 0; --i)
+        std::cout << " ";
+      std::cout << msg << std::endl;
+      }
+
+    /// Buffer may be temporary, it is copied or written before return.
+    virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) override
+      {
+      //staging buffer is referenced by pending iovecs, it can't grow and it is reused
+      //only when they are written, so there must be room for staged data and its iovec
+      if (StagingUsed + bufferLen > Staging.size() || Pending.size() == MAX_BATCH)
+        WritePending();
+
+      if (bufferLen > Staging.size())
+        {
+        AddPending(buffer, bufferLen);
+        WritePending();
+        return;
+        }
+
+      unsigned char* staged = Staging.data() + StagingUsed;
+      memcpy(staged, buffer, bufferLen);
+      StagingUsed += bufferLen;
+
+      //consecutive small writes extend one iovec
+      if (Pending.empty() == false &&
+          static_cast<unsigned char*>(Pending.back().iov_base) + Pending.back().iov_len == staged)
+        {
+        Pending.back().iov_len += bufferLen;
+        PendingSize += bufferLen;
+        }
+      else
+        AddPending(staged, bufferLen);
+      }
+
+    virtual void WriteBufferReferenced(const unsigned char* buffer, size_t bufferLen) override
+      {
+      if (bufferLen < ReferenceThreshold)
+        WriteBuffer(buffer, bufferLen);
+      else
+        AddPending(buffer, bufferLen);
+      }
+
+  private:
+    static const size_t MAX_BATCH = IOV_MAX < 1024 ? IOV_MAX : 1024;
+
+    /// Adds iovec of stable buffer, staged data must have free iovec already.
+    void AddPending(const unsigned char* buffer, size_t bufferLen)
+      {
+      if (Pending.size() == MAX_BATCH)
+        WritePending();
+
+      iovec io;
+      io.iov_base = const_cast<unsigned char*>(buffer);
+      io.iov_len = bufferLen;
+      Pending.push_back(io);
+      PendingSize += bufferLen;
+      }
+
+    /// Writes pending iovecs in batches, continues after partial writes.
+    void WritePending()
+      {
+      iovec* io = Pending.data();
+      size_t count = Pending.size();
+
+      while (count != 0 && Failed == false)
+        {
+        size_t batch = count < MAX_BATCH ? count : static_cast<size_t>(MAX_BATCH);
+        ssize_t result = writev(Fd, io, static_cast<int>(batch));
+        if (result < 0 && errno == EINTR)
+          continue;
+        if (result <= 0)
+          {
+          Failed = true;
+          break;
+          }
+
+        size_t written = static_cast<size_t>(result);
+        Written += written;
+        for (; count != 0 && written >= io->iov_len; ++io, --count)
+          written -= io->iov_len;
+        if (written != 0)
+          {
+          io->iov_base = static_cast<unsigned char*>(io->iov_base) + written;
+          io->iov_len -= written;
+          }
+        }
+
+      Pending.clear();
+      PendingSize = 0;
+      StagingUsed = 0;
+      }
+
+  /// Class attributes:
+  private:
+    int                        Fd;
+    size_t                     ReferenceThreshold;
+    std::vector<unsigned char> Staging;
+    size_t                     StagingUsed;
+    std::vector<iovec>         Pending;     //staged or referenced data waiting for writev
+    size_t                     Written;     //bytes already written to Fd
+    size_t                     PendingSize; //bytes in Pending
+    bool                       Failed;
+  }; //TFdDumper
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <serialize3/h/storage/serializeloader.h>
+
+#include <cassert>
+#include <cstring>
+
+//---------- TFixedSizeLoader
+//Used by generated Load of fixed-size classes (see <Class>_SERIALIZED_SIZE in typeids file).
+//Whole object is acquired from underlying loader at once, so there is just one bounds
+//check per object and members are decoded by unchecked reads from acquired memory.
+//Nested fixed-size objects acquire their part of the buffer via AcquireBuffer. Errors of
+//nested loads (f.e. mismatch of raw layout) are passed to underlying loader at the end.
+class TFixedSizeLoader final : public ASerializeLoader
+  {
+  public:
+    TFixedSizeLoader(ASerializeLoader& loader, size_t size) : Loader(loader)
+      {
+      SetRawLayout(loader.IsRawLayout());
+      SetForeignRawLayouts(loader.GetForeignRawLayouts());
+      SetFixedSizeWindow(true);
+      Position = loader.AcquireBuffer(size);
+#ifndef NDEBUG
+      End = Position + size;
+#endif
+      }
+
+    ~TFixedSizeLoader()
+      {
+      if (HasError())
+        Loader.SetError(GetError());
+      }
+
+    /// Unchecked read of primitive type, long types are stored as 8 bytes.
+    template <class TSimpleDataType>
+    void Read(TSimpleDataType& value)
+      {
+      assert(Position + sizeof(TSimpleDataType) <= End);
+      memcpy(&value, Position, sizeof(TSimpleDataType));
+      Position += sizeof(TSimpleDataType);
+      }
+
+  /// ASerializeLoader reimplementation:
+    virtual void PushIndent() override { Loader.PushIndent(); }
+    virtual void PopIndent() override  { Loader.PopIndent(); }
+    virtual void Log(const char* msg) override { Loader.Log(msg); }
+
+    virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+      {
+      assert(Position + bufferLen <= End);
+      memcpy(buffer, Position, bufferLen);
+      Position += bufferLen;
+      }
+
+    virtual const unsigned char* AcquireBuffer(size_t bufferLen) override
+      {
+      assert(Position + bufferLen <= End);
+      const unsigned char* buffer = Position;
+      Position += bufferLen;
+      return buffer;
+      }
+
+  /// Class attributes:
+  private:
+    ASerializeLoader&    Loader;
+    const unsigned char* Position;
+#ifndef NDEBUG
+    const unsigned char* End;
+#endif
+  }; //TFixedSizeLoader
+
+template <>
+inline void TFixedSizeLoader::Read(long& value)
+  {
+  long long buffer;
+  Read(buffer);
+  value = static_cast<long>(buffer);
+  }
+
+template <>
+inline void TFixedSizeLoader::Read(unsigned long& value)
+  {
+  unsigned long long buffer;
+  Read(buffer);
+  value = static_cast<unsigned long>(buffer);
+  }
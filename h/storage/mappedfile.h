@@ -0,0 +1,67 @@
+#pragma once
+
+#if defined(_WIN32)
+  #error Mapped file is supported on POSIX systems only
+#endif
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+
+//---------- TMappedFile
+//Read-only mapping of whole file (f.e. flat buffer read by TFlatView or snapshot loaded by
+//TMemoryLoader). Pages are loaded on demand by the kernel and shared with page cache,
+//so opening even very large file is instant and uses no heap.
+class TMappedFile
+  {
+  public:
+    explicit TMappedFile(const char* fileName) : Data(nullptr), Size(0)
+      {
+      int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+        return;
+
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED)
+          {
+          Data = static_cast<const unsigned char*>(data);
+          Size = static_cast<size_t>(st.st_size);
+          }
+        }
+
+      close(fd); //mapping keeps the file open
+      }
+
+    ~TMappedFile()
+      {
+      if (Data != nullptr)
+        munmap(const_cast<unsigned char*>(Data), Size);
+      }
+
+    TMappedFile(const TMappedFile&) = delete;
+    TMappedFile& operator=(const TMappedFile&) = delete;
+
+    /// Returns false if file can't be opened or mapped (empty file is not mapped).
+    bool IsOpen() const { return Data != nullptr; }
+
+    /// Mapping is page aligned.
+    const unsigned char* GetData() const { return Data; }
+    size_t GetSize() const { return Size; }
+
+    /// Hints kernel that whole file will be read sequentially (f.e. before TMemoryLoader load).
+    void AdviseSequential() const
+      {
+      if (Data != nullptr)
+        madvise(const_cast<unsigned char*>(Data), Size, MADV_SEQUENTIAL);
+      }
+
+  private:
+    const unsigned char* Data;
+    size_t               Size;
+  };
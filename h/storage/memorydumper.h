@@ -0,0 +1,57 @@
+#pragma once
+
+#include <serialize3/h/storage/serializedumper.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+//---------- TMemoryDumper
+//Dumps into growing memory buffer. Use Reserve together with SerializedSize(o, dumper)
+//to allocate the buffer exactly once.
+class TMemoryDumper : public ASerializeDumper
+  {
+  public:
+    typedef std::vector<unsigned char> TBuffer;
+
+    TMemoryDumper() {}
+    explicit TMemoryDumper(size_t reserveSize)
+      {
+      Buffer.reserve(reserveSize);
+      }
+
+    /// Reserve space for additional size bytes.
+    void Reserve(size_t size)
+      {
+      Buffer.reserve(Buffer.size() + size);
+      }
+
+    const TBuffer& GetBuffer() const
+      {
+      return Buffer;
+      }
+
+    TBuffer& GetBuffer()
+      {
+      return Buffer;
+      }
+
+  /// ASerializeDumper reimplementation:
+    virtual void Log(const char* msg) override
+      {
+      std::cout << std::setw(10);
+      std::cout << Buffer.size() << " ";
+      for (int i = IndentLevel; i > 0; --i)
+        std::cout << " ";
+      std::cout << msg << std::endl;
+      }
+
+    virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) override
+      {
+      Buffer.insert(Buffer.end(), buffer, buffer + bufferLen);
+      }
+
+  /// Class attributes:
+  private:
+    TBuffer Buffer;
+  }; //TMemoryDumper
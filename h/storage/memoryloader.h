@@ -0,0 +1,105 @@
+#pragma once
+
+#include <serialize3/h/storage/serializeloader.h>
+
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+//---------- TMemoryLoader
+//Loads from memory buffer (f.e. filled by TMemoryDumper or mapped file).
+//Buffer is not copied, it must be valid while loading.
+class TMemoryLoader : public ASerializeLoader
+  {
+  public:
+    TMemoryLoader(const unsigned char* buffer, size_t bufferLen) :
+      Begin(buffer), Position(buffer), End(buffer + bufferLen), RequiredSize(0) {}
+
+    size_t GetPosition() const
+      {
+      return Position - Begin;
+      }
+
+    size_t GetRemainingSize() const
+      {
+      return End - Position;
+      }
+
+    /// Minimal size of buffer which would satisfy reads failed with LOAD_TRUNCATED_INPUT.
+    size_t GetRequiredSize() const
+      {
+      return RequiredSize;
+      }
+
+  /// ASerializeLoader reimplementation:
+    virtual void Log(const char* msg) override
+      {
+      std::cout << std::setw(10);
+      std::cout << GetPosition() << " ";
+      for (int i = IndentLevel; i > 0; --i)
+        std::cout << " ";
+      std::cout << msg << std::endl;
+      }
+
+    virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+      {
+      if (bufferLen <= GetRemainingSize())
+        {
+        memcpy(buffer, Position, bufferLen);
+        Position += bufferLen;
+        return;
+        }
+
+      size_t readLen = GetRemainingSize();
+      SetError(LOAD_TRUNCATED_INPUT);
+      SetRequiredSize(GetPosition() + bufferLen);
+      if (readLen != 0) //Position is null for empty buffer
+        memcpy(buffer, Position, readLen);
+      memset(buffer + readLen, 0, bufferLen - readLen);
+      Position = End;
+      }
+
+    /// String is assigned directly from the buffer.
+    virtual void Load(std::string& s) override
+      {
+      size_t length = 0;
+      LoadLength(length);
+      if (length > GetRemainingSize())
+        {
+        SetError(LOAD_TRUNCATED_INPUT);
+        SetRequiredSize(GetPosition() + length);
+        length = 0;
+        }
+      s.assign(reinterpret_cast<const char*>(Position), length);
+      Position += length;
+      }
+
+    virtual size_t GetAvailableSize() const override
+      {
+      return GetRemainingSize();
+      }
+
+    virtual const unsigned char* AcquireBuffer(size_t bufferLen) override
+      {
+      if (bufferLen > GetRemainingSize())
+        return ASerializeLoader::AcquireBuffer(bufferLen);
+
+      const unsigned char* buffer = Position;
+      Position += bufferLen;
+      return buffer;
+      }
+
+  private:
+    void SetRequiredSize(size_t requiredSize)
+      {
+      if (RequiredSize < requiredSize)
+        RequiredSize = requiredSize;
+      }
+
+  /// Class attributes:
+  private:
+    const unsigned char* Begin;
+    const unsigned char* Position;
+    const unsigned char* End;
+    size_t               RequiredSize;
+  }; //TMemoryLoader
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define PACKED_INT_SSE_TARGET __attribute__((target("sse4.1")))
+  #define PACKED_INT_SSE_RUNTIME_CHECK
+#elif defined(_MSC_VER) && defined(__AVX__)
+  #include <immintrin.h>
+  #define PACKED_INT_SSE_TARGET
+#endif
+
+//---------- TPackedIntCodec
+//Codecs of unsigned 64-bit sequences (integers are mapped to them by zigzag or delta, see
+//packedtemplates.h). Encoder picks smaller of:
+//- CODEC_BITPACK: all values packed by the same bit width, LSB first,
+//- CODEC_STREAMVBYTE: 2-bit lengths of 4 values in control byte, followed by 1-4 bytes
+//  of each value (only if all values fit 32 bits). Decoded by SSE4.1 shuffle if CPU has it.
+//Payload: CODEC_BITPACK: width byte (1-64), packed bits
+//         CODEC_STREAMVBYTE: control bytes, data bytes
+class TPackedIntCodec
+  {
+  public:
+    enum TCodec : unsigned char
+      {
+      CODEC_BITPACK     = 1,
+      CODEC_STREAMVBYTE = 2,
+      CODEC_DELTA       = 0x80 //flag: values are differences from previous ones
+      };
+
+    /// Encodes values to payload, returns used codec.
+    static TCodec Encode(const unsigned long long* values, size_t count, std::vector<unsigned char>& payload)
+      {
+      unsigned long long bits = 0;
+      size_t vbyteSize = (count + 3) / 4;
+
+      for (size_t i = 0; i < count; ++i)
+        {
+        bits |= values[i];
+        vbyteSize += GetByteLength(values[i]);
+        }
+
+      //each value takes at least one bit, so count is bounded by payload size when loaded
+      unsigned width = std::max(1u, GetBitWidth(bits));
+      size_t bitpackSize = 1 + (count * width + 7) / 8;
+
+      payload.clear();
+      if (bits <= 0xffffffffULL && vbyteSize < bitpackSize)
+        {
+        EncodeStreamVByte(values, count, payload);
+        return CODEC_STREAMVBYTE;
+        }
+
+      EncodeBitpack(values, count, width, payload);
+      return CODEC_BITPACK;
+      }
+
+    /** Checks that payload of size bytes may contain count values, so buffer for them is
+        not allocated by count from corrupted data.
+    */
+    static bool IsPlausible(TCodec codec, const unsigned char* payload, size_t size, size_t count)
+      {
+      switch (codec & ~CODEC_DELTA)
+        {
+        case CODEC_BITPACK:
+          return size != 0 && payload[0] != 0 && payload[0] <= 64 && IsBitpackSize(size - 1, count, payload[0]);
+        case CODEC_STREAMVBYTE:
+          //each value has 2 control bits and at least one data byte
+          return count / 4 + (count % 4 != 0) <= size && count <= size - (count / 4 + (count % 4 != 0));
+        default:
+          return false;
+        }
+      }
+
+    /// Decodes count values from payload, returns false if payload is corrupted.
+    static bool Decode(TCodec codec, const unsigned char* payload, size_t size, size_t count,
+      unsigned long long* values)
+      {
+      if (IsPlausible(codec, payload, size, count) == false)
+        return false;
+
+      switch (codec & ~CODEC_DELTA)
+        {
+        case CODEC_BITPACK:
+          return DecodeBitpack(payload, size, count, values);
+        case CODEC_STREAMVBYTE:
+          return DecodeStreamVByte(payload, size, count, values);
+        default:
+          return false;
+        }
+      }
+
+  private:
+    static unsigned GetBitWidth(unsigned long long value)
+      {
+      unsigned width = 0;
+      for (; value != 0; value >>= 1)
+        ++width;
+      return width;
+      }
+
+    static unsigned GetByteLength(unsigned long long value)
+      {
+      return value < 0x100 ? 1 : value < 0x10000 ? 2 : value < 0x1000000 ? 3 : 4;
+      }
+
+    //Checks that count values of width bits fit dataSize bytes without overflow
+    static bool IsBitpackSize(size_t dataSize, size_t count, unsigned width)
+      {
+      return count <= (static_cast<size_t>(-1) - 7) / width && (count * width + 7) / 8 <= dataSize;
+      }
+
+    static unsigned long long LoadWord(const unsigned char* data, size_t available)
+      {
+      unsigned long long word = 0;
+      memcpy(&word, data, std::min<size_t>(available, sizeof(word))); //little endian
+      return word;
+      }
+
+    //--------------- bitpack
+
+    static void EncodeBitpack(const unsigned long long* values, size_t count, unsigned width,
+      std::vector<unsigned char>& payload)
+      {
+      payload.resize(1 + (count * width + 7) / 8);
+      payload[0] = static_cast<unsigned char>(width);
+
+      unsigned char* data = payload.data() + 1;
+      size_t bit = 0;
+      for (size_t i = 0; i < count; ++i, bit += width)
+        {
+        //value is written byte by byte from its first bit
+        unsigned long long value = values[i];
+        size_t byte = bit / 8;
+        unsigned shift = bit % 8;
+        data[byte] |= static_cast<unsigned char>(value << shift);
+        for (unsigned written = 8 - shift; written < width; written += 8)
+          data[++byte] |= static_cast<unsigned char>(value >> written);
+        }
+      }
+
+    static bool DecodeBitpack(const unsigned char* payload, size_t size, size_t count, unsigned long long* values)
+      {
+      unsigned width = payload[0];
+      const unsigned char* data = payload + 1;
+      size_t dataSize = size - 1;
+      unsigned long long mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+      size_t bit = 0;
+      for (size_t i = 0; i < count; ++i, bit += width)
+        {
+        size_t byte = bit / 8;
+        unsigned shift = bit % 8;
+        unsigned long long value = LoadWord(data + byte, dataSize - byte) >> shift;
+        if (shift + width > 64)
+          value |= static_cast<unsigned long long>(data[byte + 8]) << (64 - shift);
+        values[i] = value & mask;
+        }
+
+      return true;
+      }
+
+    //--------------- stream vbyte
+
+    static void EncodeStreamVByte(const unsigned long long* values, size_t count, std::vector<unsigned char>& payload)
+      {
+      size_t controlSize = (count + 3) / 4;
+      payload.assign(controlSize, 0);
+
+      for (size_t i = 0; i < count; ++i)
+        {
+        unsigned length = GetByteLength(values[i]);
+        payload[i / 4] |= static_cast<unsigned char>((length - 1) << (i % 4 * 2));
+        for (unsigned b = 0; b < length; ++b)
+          payload.push_back(static_cast<unsigned char>(values[i] >> (b * 8)));
+        }
+      }
+
+    static bool DecodeStreamVByte(const unsigned char* payload, size_t size, size_t count, unsigned long long* values)
+      {
+      size_t controlSize = count / 4 + (count % 4 != 0);
+      const unsigned char* control = payload;
+      const unsigned char* data = payload + controlSize;
+      const unsigned char* end = payload + size;
+      size_t i = 0;
+
+#if defined(PACKED_INT_SSE_TARGET)
+      if (HasSse41())
+        i = DecodeStreamVByteSse(control, data, end, count, values);
+#endif
+
+      for (; i < count; ++i)
+        {
+        unsigned length = ((control[i / 4] >> (i % 4 * 2)) & 3) + 1;
+        if (static_cast<size_t>(end - data) < length)
+          return false;
+
+        unsigned long long value = 0;
+        for (unsigned b = 0; b < length; ++b)
+          value |= static_cast<unsigned long long>(data[b]) << (b * 8);
+        values[i] = value;
+        data += length;
+        }
+
+      return true;
+      }
+
+#if defined(PACKED_INT_SSE_TARGET)
+    static bool HasSse41()
+      {
+#if defined(PACKED_INT_SSE_RUNTIME_CHECK)
+      static const bool hasSse41 = __builtin_cpu_supports("sse4.1") != 0;
+      return hasSse41;
+#else
+      return true;
+#endif
+      }
+
+    struct TShuffleTable
+      {
+      unsigned char Shuffle[256][16]; //moves bytes of 4 values to 32-bit lanes
+      unsigned char Length[256];      //data bytes of 4 values
+
+      TShuffleTable()
+        {
+        for (unsigned control = 0; control < 256; ++control)
+          {
+          unsigned char byte = 0;
+          for (unsigned lane = 0; lane < 4; ++lane)
+            {
+            unsigned length = ((control >> (lane * 2)) & 3) + 1;
+            for (unsigned b = 0; b < 4; ++b)
+              Shuffle[control][lane * 4 + b] = b < length ? byte++ : 0x80; //0x80 clears the byte
+            }
+          Length[control] = byte;
+          }
+        }
+      };
+
+    /// Decodes whole groups of 4 values while 16 bytes can be read, returns number of decoded values.
+    PACKED_INT_SSE_TARGET
+    static size_t DecodeStreamVByteSse(const unsigned char* control, const unsigned char*& data,
+      const unsigned char* end, size_t count, unsigned long long* values)
+      {
+      static const TShuffleTable table;
+      size_t i = 0;
+
+      for (; i + 4 <= count && end - data >= 16; i += 4)
+        {
+        unsigned char c = control[i / 4];
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i lanes = _mm_shuffle_epi8(bytes, _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.Shuffle[c])));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_cvtepu32_epi64(lanes));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + 2), _mm_cvtepu32_epi64(_mm_srli_si128(lanes, 8)));
+        data += table.Length[c];
+        }
+
+      return i;
+      }
+#endif
+  }; //TPackedIntCodec
@@ -2,6 +2,8 @@
 
 #include <serialize3/h/storage/serializeloader.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -20,7 +22,17 @@ class TPrimitiveLoader : public std::ifstream,
                          public ASerializeLoader
   {
   public:
-    explicit TPrimitiveLoader(const char* filename) : std::ifstream(filename,std::ios_base::binary) {}
+    explicit TPrimitiveLoader(const char* filename) : std::ifstream(filename,std::ios_base::binary),
+      Remaining(static_cast<size_t>(-1))
+      {
+      //size of file bounds lengths of loaded containers
+      seekg(0, std::ios_base::end);
+      std::streamoff size = tellg();
+      seekg(0, std::ios_base::beg);
+      if (size >= 0 && good())
+        Remaining = static_cast<size_t>(size);
+      clear();
+      }
     virtual ~TPrimitiveLoader() {}
 
   /// ASerializeLoader reimplementation:
@@ -36,6 +48,20 @@ class TPrimitiveLoader : public std::ifstream,
     virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
       {
       read(reinterpret_cast<char*>(buffer), bufferLen);
+      size_t readLen = static_cast<size_t>(gcount());
+      if (Remaining != static_cast<size_t>(-1))
+        Remaining -= std::min(readLen, Remaining);
+      if (readLen != bufferLen)
+        {
+        SetError(LOAD_TRUNCATED_INPUT);
+        memset(buffer + readLen, 0, bufferLen - readLen);
+        }
       }
 
+    virtual size_t GetAvailableSize() const override { return Remaining; }
+
+  /// Class attributes:
+  private:
+    size_t Remaining; //bytes left in file, -1 if not known
+
   }; //TPrimitiveLoader
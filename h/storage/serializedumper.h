@@ -1,7 +1,10 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
+class TDumpStringDictionary;
+
 /// Base abstract class for all implementations of dumpers used for storing serialization data.
 class ASerializeDumper
   {
@@ -19,22 +22,99 @@ class ASerializeDumper
       Dump(buffer);
       }
 
+    /** Objects of classes with raw layout (see serialized_raw_layout) are stored as raw memory.
+        Enabled by DumpSnapshotHeader, such snapshot can be loaded with different layout only if
+        it contains layouts of classes (see TSnapshotLayout).
+    */
+    void SetRawLayout(bool rawLayout) { RawLayout = rawLayout; }
+    bool IsRawLayout() const { return RawLayout; }
+
+    /** Vectors of classes with columnar encoding (see serialized_columnar) are stored column
+        by column. Enabled by DumpSnapshotHeader, format doesn't depend on layout.
+    */
+    void SetColumnar(bool columnar) { Columnar = columnar; }
+    bool IsColumnar() const { return Columnar; }
+
+    /** Vectors, sets and map keys of integers are stored bit-packed or stream-vbyte encoded
+        (see packedtemplates.h). Enabled by DumpSnapshotHeader, format doesn't depend on layout.
+    */
+    void SetPackedIntegers(bool packedIntegers) { PackedIntegers = packedIntegers; }
+    bool IsPackedIntegers() const { return PackedIntegers; }
+
+    /** Sets and map keys of strings are stored as length of prefix shared with previous key
+        and the rest (see frontcodingtemplates.h). Enabled by DumpSnapshotHeader.
+    */
+    void SetFrontCodedStrings(bool frontCodedStrings) { FrontCodedStrings = frontCodedStrings; }
+    bool IsFrontCodedStrings() const { return FrontCodedStrings; }
+
+    /** Vectors and deques of float and double are stored XOR compressed (see
+        xorfloattemplates.h). Enabled by DumpSnapshotHeader.
+    */
+    void SetXorFloats(bool xorFloats) { XorFloats = xorFloats; }
+    bool IsXorFloats() const { return XorFloats; }
+
+    /** Vectors of primitive types are stored by encoding selected by sample of each vector
+        (see adaptivetemplates.h), it overrides packed integers and XOR floats for them.
+        Enabled by DumpSnapshotHeader.
+    */
+    void SetAdaptive(bool adaptive) { Adaptive = adaptive; }
+    bool IsAdaptive() const { return Adaptive; }
+
+    /** Repeated strings are stored as references to their first occurrence (see
+        stringdictionary.h). Enabled by DumpSnapshotHeader, null dictionary disables it.
+    */
+    void SetStringDictionary(const std::shared_ptr<TDumpStringDictionary>& dictionary)
+      {
+      StringDictionary = dictionary;
+      }
+    TDumpStringDictionary* GetStringDictionary() const { return StringDictionary.get(); }
+
+    /** Checks if data are dumped in plain format (no encoding enabled), described by
+        SerializedSize() and serialized_fixed_size.
+    */
+    bool IsPlainEncoding() const
+      {
+      return RawLayout == false && Columnar == false && PackedIntegers == false && FrontCodedStrings == false &&
+        XorFloats == false && Adaptive == false && StringDictionary == nullptr;
+      }
+
+    /// Dumps following data with the same encodings as other dumper (f.e. nested buffer).
+    void CopyEncodings(const ASerializeDumper& other)
+      {
+      RawLayout = other.RawLayout;
+      Columnar = other.Columnar;
+      PackedIntegers = other.PackedIntegers;
+      FrontCodedStrings = other.FrontCodedStrings;
+      XorFloats = other.XorFloats;
+      Adaptive = other.Adaptive;
+      StringDictionary = other.StringDictionary;
+      }
+
     /// Debug logging support.
     virtual void PushIndent() { ++IndentLevel; }
     virtual void PopIndent()  { --IndentLevel; }
     virtual void Log(const char* msg) = 0;
     /// Common method to dump memory buffer.
     virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) = 0;
+    /** Dumps memory of dumped object, which stays valid and unchanged until dumper is flushed,
+        so dumper may reference it instead of copying (see TFdDumper). Temporary buffers
+        (encoded payloads, copies) must be passed to WriteBuffer.
+    */
+    virtual void WriteBufferReferenced(const unsigned char* buffer, size_t bufferLen)
+      {
+      WriteBuffer(buffer, bufferLen);
+      }
     /// Specialized method to dump string. 
     virtual void Dump(const std::string& s)
       {
       size_t length = s.size();
       DumpSizeT(length);
-      WriteBuffer(reinterpret_cast<const unsigned char *>(s.c_str()), length);
+      WriteBufferReferenced(reinterpret_cast<const unsigned char *>(s.c_str()), length);
       }
 
   protected:
-    ASerializeDumper() : IndentLevel(0) {}
+    ASerializeDumper() : IndentLevel(0), RawLayout(false), Columnar(false), PackedIntegers(false),
+      FrontCodedStrings(false), XorFloats(false), Adaptive(false) {}
     virtual ~ASerializeDumper() {}
 
     template <size_t S>
@@ -61,6 +141,15 @@ class ASerializeDumper
   /// Class attributes:
   protected:
     unsigned int IndentLevel;
+
+  private:
+    bool         RawLayout;
+    bool         Columnar;
+    bool         PackedIntegers;
+    bool         FrontCodedStrings;
+    bool         XorFloats;
+    bool         Adaptive;
+    std::shared_ptr<TDumpStringDictionary> StringDictionary;
   };
 
 template <>
@@ -1,11 +1,32 @@
 #pragma once
 
+#include <serialize3/h/client_code/serialize_macros.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
 #include <string>
+#include <vector>
+
+class TLoadStringDictionary;
+class TForeignRawLayouts;
 
 /// Base abstract class for all implementations of dumpers used for loading serialization data.
 class ASerializeLoader
   {
   public:
+    /// Kinds of load errors, only first one is kept (see SetError).
+    enum TLoadError
+      {
+      LOAD_OK,
+      LOAD_TRUNCATED_INPUT,  //less data than expected
+      LOAD_BAD_TYPE_ID,      //unknown type id of object loaded via pointer
+      LOAD_OVERSIZED_LENGTH, //length of string or container over limit (see SetLengthLimit)
+      LOAD_BAD_HEADER,       //unknown magic or version of snapshot header
+      LOAD_LAYOUT_MISMATCH,  //snapshot with raw layout dumped by binary with different layout
+      LOAD_BAD_ENCODING      //unknown codec or corrupted data of encoded container
+      };
+
     /// Common method for loading all primitive types.
     template <class TSimpleDataType>
     void Load(TSimpleDataType& value)
@@ -20,39 +41,197 @@ class ASerializeLoader
       value = static_cast<size_t>(buffer);
       }
 
-    virtual void Load(std::string& s)
+    /** Loads length of string or container. On error or if length is over the limit,
+        sets the error and returns 0 length, so callers just load nothing.
+    */
+    void LoadLength(size_t& length)
       {
-      //Using local buffer if string is smaller than 1024, else allocate it	 
-      //on the heap. Could be optimized to use alloca instead, if we're comfortable with that.
+      LoadSizeT(length);
+      if (length > LengthLimit)
+        SetError(LOAD_OVERSIZED_LENGTH);
+      if (Error != LOAD_OK)
+        length = 0;
+      }
 
-      const int BUFFER_SIZE = 1024;
-      char buffer[BUFFER_SIZE];
-      char* readBuffer = nullptr;
+    virtual void Load(std::string& s)
+      {
       size_t length = 0;
-      LoadSizeT(length);
-      bool useStackBuffer = (length < BUFFER_SIZE);
-      if(useStackBuffer)
-        readBuffer = buffer;
-      else
-        readBuffer = new char[length + 1];
-      ReadBuffer((unsigned char*)readBuffer, length);
-      *(readBuffer + length) = 0;
-      s = buffer;
-      if(!useStackBuffer)
-        delete[] readBuffer;
+      LoadLength(length);
+      s.clear();
+      //length is not trusted, string grows as its data are read if input size is unknown
+      for (size_t loaded = 0, step; (step = GetLoadStep(length - loaded, 1)) != 0; loaded += step)
+        {
+        s.resize(loaded + step);
+        ReadBuffer(reinterpret_cast<unsigned char*>(&s[loaded]), step);
+        }
+      }
+
+    /** Checks that count elements, each taking at least minSize bytes, may be in available
+        input, else sets LOAD_TRUNCATED_INPUT, so memory is not allocated for data which are
+        not there.
+    */
+    bool CheckLoadCount(size_t count, size_t minSize)
+      {
+      size_t available = GetAvailableSize();
+      if (minSize != 0 && available != static_cast<size_t>(-1) && count > available / minSize)
+        SetError(LOAD_TRUNCATED_INPUT);
+      return Error == LOAD_OK;
+      }
+
+    /** Returns how many of count remaining elements taking at least minSize bytes (0 if it is
+        not known) may be allocated before they are loaded, 0 on error (see CheckLoadCount).
+        If input size is unknown, container grows by LOAD_GROWTH_STEP elements.
+    */
+    size_t GetLoadStep(size_t count, size_t minSize)
+      {
+      if (CheckLoadCount(count, minSize) == false)
+        return 0;
+      size_t available = GetAvailableSize();
+      size_t step = LOAD_GROWTH_STEP;
+      //with known input size, elements of unknown size are limited by its size
+      if (available != static_cast<size_t>(-1))
+        step = minSize != 0 ? count : std::max(available, step);
+      return std::min(count, step);
+      }
+
+    static const size_t LOAD_GROWTH_STEP = 1 << 16;
+
+    /// Error handling support, error is sticky - once set it stays till ClearError.
+    TLoadError GetError() const { return Error; }
+    bool       HasError() const { return Error != LOAD_OK; }
+    void       SetError(TLoadError error)
+      {
+      if (Error == LOAD_OK)
+        Error = error;
+      }
+    void       ClearError() { Error = LOAD_OK; }
+
+    /// Maximal accepted length of loaded strings and containers (unlimited by default).
+    void SetLengthLimit(size_t lengthLimit) { LengthLimit = lengthLimit; }
+    size_t GetLengthLimit() const { return LengthLimit; }
+
+    /** Objects of classes with raw layout (see serialized_raw_layout) are stored as raw memory.
+        Enabled by LoadSnapshotHeader if snapshot was dumped with the same layout fingerprint or
+        with layouts of classes.
+    */
+    void SetRawLayout(bool rawLayout) { RawLayout = rawLayout; }
+    bool IsRawLayout() const { return RawLayout; }
+
+    /** Layouts of classes read from snapshot dumped by binary with different layout (see
+        rawlayouttemplates.h), objects with raw layout are then loaded field by field.
+        Set by LoadSnapshotHeader if snapshot contains them.
+    */
+    void SetForeignRawLayouts(const std::shared_ptr<const TForeignRawLayouts>& layouts)
+      {
+      ForeignRawLayouts = layouts;
+      }
+    const std::shared_ptr<const TForeignRawLayouts>& GetForeignRawLayouts() const { return ForeignRawLayouts; }
+
+    /// Checks if loader reads object of fixed size (see TFixedSizeLoader).
+    bool IsFixedSizeWindow() const { return FixedSizeWindow; }
+
+    /** Vectors of classes with columnar encoding (see serialized_columnar) are stored column
+        by column. Enabled by LoadSnapshotHeader if snapshot was dumped so.
+    */
+    void SetColumnar(bool columnar) { Columnar = columnar; }
+    bool IsColumnar() const { return Columnar; }
+
+    /** Vectors, sets and map keys of integers are stored bit-packed or stream-vbyte encoded
+        (see packedtemplates.h). Enabled by LoadSnapshotHeader if snapshot was dumped so.
+    */
+    void SetPackedIntegers(bool packedIntegers) { PackedIntegers = packedIntegers; }
+    bool IsPackedIntegers() const { return PackedIntegers; }
+
+    /** Sets and map keys of strings are stored as length of prefix shared with previous key
+        and the rest (see frontcodingtemplates.h). Enabled by LoadSnapshotHeader if snapshot
+        was dumped so.
+    */
+    void SetFrontCodedStrings(bool frontCodedStrings) { FrontCodedStrings = frontCodedStrings; }
+    bool IsFrontCodedStrings() const { return FrontCodedStrings; }
+
+    /** Vectors and deques of float and double are stored XOR compressed (see
+        xorfloattemplates.h). Enabled by LoadSnapshotHeader if snapshot was dumped so.
+    */
+    void SetXorFloats(bool xorFloats) { XorFloats = xorFloats; }
+    bool IsXorFloats() const { return XorFloats; }
+
+    /** Vectors of primitive types are stored by encoding selected by sample of each vector
+        (see adaptivetemplates.h), it overrides packed integers and XOR floats for them.
+        Enabled by LoadSnapshotHeader if snapshot was dumped so.
+    */
+    void SetAdaptive(bool adaptive) { Adaptive = adaptive; }
+    bool IsAdaptive() const { return Adaptive; }
+
+    /** Repeated strings are stored as references to their first occurrence (see
+        stringdictionary.h). Enabled by LoadSnapshotHeader if snapshot was dumped so.
+    */
+    void SetStringDictionary(const std::shared_ptr<TLoadStringDictionary>& dictionary)
+      {
+      StringDictionary = dictionary;
+      }
+    TLoadStringDictionary* GetStringDictionary() const { return StringDictionary.get(); }
+
+    /** Checks if data are loaded in plain format (no encoding enabled), described by
+        serialized_fixed_size.
+    */
+    bool IsPlainEncoding() const
+      {
+      return RawLayout == false && Columnar == false && PackedIntegers == false && FrontCodedStrings == false &&
+        XorFloats == false && Adaptive == false && StringDictionary == nullptr;
       }
 
+    /// Number of bytes which are surely available for loading, if known.
+    virtual size_t GetAvailableSize() const { return static_cast<size_t>(-1); }
+
     /// Debug logging support.
     virtual void PushIndent() { ++IndentLevel; }
     virtual void PopIndent()  { --IndentLevel; }
     virtual void Log(const char* msg) = 0;
-    /// Common method to dump memory buffer.
+    /** Common method to load memory buffer. If there is not enough data, implementations
+        must set LOAD_TRUNCATED_INPUT error and fill rest of buffer with zeros.
+    */
     virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) = 0;
+    /** Returns pointer to next bufferLen bytes and skips them, used to load fixed-size objects
+        with one bounds check per object. Returned memory is valid till next call.
+        Default implementation reads them into internal buffer, memory based loaders should
+        return pointer directly to their data.
+    */
+    virtual const unsigned char* AcquireBuffer(size_t bufferLen)
+      {
+      if (AcquiredBuffer.size() < bufferLen)
+        AcquiredBuffer.resize(bufferLen);
+      ReadBuffer(AcquiredBuffer.data(), bufferLen);
+      return AcquiredBuffer.data();
+      }
+
+    /** Returns pointer to next bufferLen bytes whose length was loaded (not trusted), they
+        may be used only if there is no error. If input size is unknown, they are read by
+        LOAD_GROWTH_STEP, so memory is allocated only for data which are there.
+    */
+    const unsigned char* AcquireLoadedBuffer(size_t bufferLen)
+      {
+      if (GetAvailableSize() != static_cast<size_t>(-1))
+        {
+        const unsigned char* buffer = GetLoadStep(bufferLen, 1) == bufferLen ? AcquireBuffer(bufferLen) : nullptr;
+        return Error == LOAD_OK ? buffer : nullptr;
+        }
+      for (size_t loaded = 0, step; (step = GetLoadStep(bufferLen - loaded, 1)) != 0; loaded += step)
+        {
+        if (AcquiredBuffer.size() < loaded + step)
+          AcquiredBuffer.resize(loaded + step);
+        ReadBuffer(AcquiredBuffer.data() + loaded, step);
+        }
+      return Error == LOAD_OK ? AcquiredBuffer.data() : nullptr;
+      }
 
   protected:
-    ASerializeLoader() : IndentLevel(0) {}
+    ASerializeLoader() : IndentLevel(0), Error(LOAD_OK), LengthLimit(static_cast<size_t>(-1)),
+      RawLayout(false), Columnar(false), PackedIntegers(false), FrontCodedStrings(false),
+      XorFloats(false), Adaptive(false), FixedSizeWindow(false) {}
     virtual ~ASerializeLoader() {}
 
+    void SetFixedSizeWindow(bool fixedSizeWindow) { FixedSizeWindow = fixedSizeWindow; }
+
     template <size_t S>
     void LoadSizedBuffer(unsigned char* buffer)
       {
@@ -77,6 +256,20 @@ class ASerializeLoader
   /// Class attributes:
   protected:
     unsigned int IndentLevel;
+
+  private:
+    TLoadError                 Error;
+    size_t                     LengthLimit;
+    bool                       RawLayout;
+    bool                       Columnar;
+    bool                       PackedIntegers;
+    bool                       FrontCodedStrings;
+    bool                       XorFloats;
+    bool                       Adaptive;
+    bool                       FixedSizeWindow;
+    std::shared_ptr<TLoadStringDictionary> StringDictionary;
+    std::shared_ptr<const TForeignRawLayouts> ForeignRawLayouts;
+    std::vector<unsigned char> AcquiredBuffer;
   };
 
 template <>
@@ -123,3 +316,10 @@ inline void ASerializeLoader::LoadSizedBuffer<8>(unsigned char* buffer)
   #define LPUSH_INDENT
   #define LPOP_INDENT
 #endif
+
+//Used in generated LoadPointer functions for unknown type id
+#if defined(SERIALIZE_NOEXCEPT_LOAD)
+  #define LOAD_UNKNOWN_TYPE_ID loader.SetError(ASerializeLoader::LOAD_BAD_TYPE_ID)
+#else
+  #define LOAD_UNKNOWN_TYPE_ID { loader.SetError(ASerializeLoader::LOAD_BAD_TYPE_ID); assert(false); throw 1; }
+#endif
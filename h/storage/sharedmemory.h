@@ -0,0 +1,416 @@
+#pragma once
+
+#if defined(_WIN32)
+  #error Shared memory snapshots are supported on POSIX systems only
+#endif
+
+#include <serialize3/h/storage/serializedumper.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+
+//Snapshot shared by local processes in shared memory segment (shm_open or memfd_create):
+//  header (SHARED_SEGMENT_HEADER_SIZE bytes, see TSharedSegmentHeader), payload
+//Writer dumps payload by TSharedMemoryDumper and commits it, readers map committed segment
+//read-only (TSharedMemorySegment) and load it by TMemoryLoader or read it in place by TFlatView,
+//so the snapshot is loaded from storage once per host. Named versions are published by
+//TSharedSnapshotPublisher and found by TSharedSnapshotReader.
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "Atomics shared between processes must be lock-free");
+
+struct TSharedSegmentHeader
+  {
+  static const unsigned long long MAGIC = 0x314D485333535253ULL; //"SRS3SHM1"
+
+  unsigned long long    Magic;
+  unsigned long long    Generation;
+  unsigned long long    Size;      //payload size, valid when committed
+  std::atomic<unsigned> Committed; //set after payload is written
+  };
+
+/// Payload offset in segment (cache line aligned).
+const size_t SHARED_SEGMENT_HEADER_SIZE = 64;
+
+static_assert(sizeof(TSharedSegmentHeader) <= SHARED_SEGMENT_HEADER_SIZE, "Header doesn't fit");
+
+//---------- TSharedMemoryDumper
+//Dumps into shared memory segment given by file descriptor, segment grows as needed. Nothing
+//is copied on growth, pages stay in segment and only mapping is extended.
+class TSharedMemoryDumper : public ASerializeDumper
+  {
+  public:
+    /// File descriptor is not closed, segment is truncated to initial capacity.
+    TSharedMemoryDumper(int fd, unsigned long long generation, size_t capacity = 1 << 20) :
+      Fd(fd), Mapping(nullptr), Capacity(0), Size(0), Failed(fd < 0)
+      {
+      if (Reserve(capacity < 4096 ? 4096 : capacity))
+        {
+        TSharedSegmentHeader* header = GetHeader();
+        header->Magic = TSharedSegmentHeader::MAGIC;
+        header->Generation = generation;
+        header->Size = 0;
+        header->Committed.store(0, std::memory_order_relaxed);
+        }
+      }
+
+    ~TSharedMemoryDumper()
+      {
+      Unmap();
+      }
+
+    TSharedMemoryDumper(const TSharedMemoryDumper&) = delete;
+    TSharedMemoryDumper& operator=(const TSharedMemoryDumper&) = delete;
+
+    bool IsGood() const
+      {
+      return Failed == false;
+      }
+
+    size_t GetPosition() const
+      {
+      return Size;
+      }
+
+    /** Truncates segment to dumped size and marks it committed, no writes are allowed after it.
+        memfd segments are sealed, so readers may rely on them being immutable.
+    */
+    bool Commit()
+      {
+      if (Failed || Mapping == nullptr)
+        return false;
+
+      TSharedSegmentHeader* header = GetHeader();
+      header->Size = Size;
+      if (ftruncate(Fd, static_cast<off_t>(SHARED_SEGMENT_HEADER_SIZE + Size)) != 0)
+        {
+        Failed = true;
+        return false;
+        }
+      header->Committed.store(1, std::memory_order_release);
+      Unmap();
+#if defined(F_ADD_SEALS)
+      fcntl(Fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL); //fails for shm_open segments
+#endif
+      return true;
+      }
+
+  /// ASerializeDumper reimplementation:
+    virtual void Log(const char* msg) override
+      {
+      std::cout << std::setw(10);
+      std::cout << Size << " ";
+      for (int i = IndentLevel; i > 0; --i)
+        std::cout << " ";
+      std::cout << msg << std::endl;
+      }
+
+    virtual void WriteBuffer(const unsigned char* buffer, size_t bufferLen) override
+      {
+      if (Mapping == nullptr)
+        {
+        Failed = true; //not mapped or already committed
+        return;
+        }
+      if (Size + bufferLen > Capacity && Reserve(Capacity * 2 > Size + bufferLen ? Capacity * 2 : Size + bufferLen) == false)
+        return;
+
+      memcpy(Mapping + SHARED_SEGMENT_HEADER_SIZE + Size, buffer, bufferLen);
+      Size += bufferLen;
+      }
+
+  private:
+    TSharedSegmentHeader* GetHeader()
+      {
+      return reinterpret_cast<TSharedSegmentHeader*>(Mapping);
+      }
+
+    /// Extends segment and its mapping to capacity bytes of payload.
+    bool Reserve(size_t capacity)
+      {
+      if (Failed)
+        return false;
+
+      size_t length = SHARED_SEGMENT_HEADER_SIZE + capacity;
+      void* mapping = MAP_FAILED;
+      if (ftruncate(Fd, static_cast<off_t>(length)) == 0)
+        mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+      if (mapping == MAP_FAILED)
+        {
+        Failed = true;
+        return false;
+        }
+
+      Unmap();
+      Mapping = static_cast<unsigned char*>(mapping);
+      Capacity = capacity;
+      return true;
+      }
+
+    void Unmap()
+      {
+      if (Mapping != nullptr)
+        munmap(Mapping, SHARED_SEGMENT_HEADER_SIZE + Capacity);
+      Mapping = nullptr;
+      }
+
+  /// Class attributes:
+  private:
+    int            Fd;
+    unsigned char* Mapping;
+    size_t         Capacity; //payload capacity
+    size_t         Size;     //dumped payload
+    bool           Failed;
+  }; //TSharedMemoryDumper
+
+//---------- TSharedMemorySegment
+//Read-only mapping of committed segment.
+class TSharedMemorySegment
+  {
+  public:
+    /// File descriptor is not closed (mapping keeps segment alive).
+    explicit TSharedMemorySegment(int fd) : Mapping(nullptr), Length(0), Generation(0)
+      {
+      struct stat st;
+      if (fd < 0 || fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < SHARED_SEGMENT_HEADER_SIZE)
+        return;
+
+      void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+      if (mapping == MAP_FAILED)
+        return;
+
+      Mapping = static_cast<const unsigned char*>(mapping);
+      Length = static_cast<size_t>(st.st_size);
+      const TSharedSegmentHeader* header = reinterpret_cast<const TSharedSegmentHeader*>(Mapping);
+      if (header->Magic != TSharedSegmentHeader::MAGIC || header->Committed.load(std::memory_order_acquire) == 0 ||
+          header->Size > Length - SHARED_SEGMENT_HEADER_SIZE)
+        {
+        Unmap();
+        return;
+        }
+      Generation = header->Generation;
+      }
+
+    ~TSharedMemorySegment()
+      {
+      Unmap();
+      }
+
+    TSharedMemorySegment(const TSharedMemorySegment&) = delete;
+    TSharedMemorySegment& operator=(const TSharedMemorySegment&) = delete;
+
+    /// Returns false if segment can't be mapped or it is not committed.
+    bool IsOpen() const { return Mapping != nullptr; }
+
+    /// Payload, cache line aligned.
+    const unsigned char* GetData() const { return Mapping + SHARED_SEGMENT_HEADER_SIZE; }
+    size_t GetSize() const { return reinterpret_cast<const TSharedSegmentHeader*>(Mapping)->Size; }
+    unsigned long long GetGeneration() const { return Generation; }
+
+  private:
+    void Unmap()
+      {
+      if (Mapping != nullptr)
+        munmap(const_cast<unsigned char*>(Mapping), Length);
+      Mapping = nullptr;
+      }
+
+    const unsigned char* Mapping;
+    size_t               Length;
+    unsigned long long   Generation;
+  }; //TSharedMemorySegment
+
+/// Control segment of named snapshot, holds generation of current version.
+struct TSharedSnapshotControl
+  {
+  static const unsigned long long MAGIC = 0x314C544353535253ULL; //"SRSSCTL1"
+
+  unsigned long long              Magic;
+  std::atomic<unsigned long long> Generation; //0 - nothing published
+  };
+
+/// Name of segment of snapshot version ("/name.generation").
+inline std::string GetSharedSnapshotName(const std::string& name, unsigned long long generation)
+  {
+  return name + "." + std::to_string(generation);
+  }
+
+/** Maps control segment of named snapshot (nullptr on failure). Publisher creates it and maps it
+    writable, readers map it read-only.
+*/
+inline TSharedSnapshotControl* MapSharedSnapshotControl(const std::string& name, bool publisher)
+  {
+  int fd = shm_open(name.c_str(), publisher ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  if (fd < 0)
+    return nullptr;
+
+  //new segment is zero filled, so its generation is 0
+  void* mapping = MAP_FAILED;
+  if (publisher == false || ftruncate(fd, sizeof(TSharedSnapshotControl)) == 0)
+    {
+    mapping = mmap(nullptr, sizeof(TSharedSnapshotControl), publisher ? PROT_READ | PROT_WRITE : PROT_READ,
+                   MAP_SHARED, fd, 0);
+    }
+  close(fd);
+  if (mapping == MAP_FAILED)
+    return nullptr;
+
+  TSharedSnapshotControl* control = static_cast<TSharedSnapshotControl*>(mapping);
+  if (publisher && control->Magic == 0)
+    control->Magic = TSharedSnapshotControl::MAGIC;
+  if (control->Magic != TSharedSnapshotControl::MAGIC)
+    {
+    munmap(mapping, sizeof(TSharedSnapshotControl));
+    return nullptr;
+    }
+  return control;
+  }
+
+//---------- TSharedSnapshotPublisher
+//Publishes versions of named snapshot (name starts with '/', see shm_open). Each version is
+//written to its own segment, which becomes current by atomic store of its generation into
+//control segment. Previous version is unlinked, readers which mapped it keep using it.
+//Only one publisher of the name may run at a time.
+class TSharedSnapshotPublisher
+  {
+  public:
+    explicit TSharedSnapshotPublisher(const char* name) :
+      Name(name), Control(MapSharedSnapshotControl(Name, true)), Fd(-1), Generation(0) {}
+
+    ~TSharedSnapshotPublisher()
+      {
+      Abort();
+      if (Control != nullptr)
+        munmap(Control, sizeof(TSharedSnapshotControl));
+      }
+
+    TSharedSnapshotPublisher(const TSharedSnapshotPublisher&) = delete;
+    TSharedSnapshotPublisher& operator=(const TSharedSnapshotPublisher&) = delete;
+
+    bool IsOpen() const { return Control != nullptr; }
+
+    /// Creates segment of next version, returns dumper writing into it (nullptr on failure).
+    TSharedMemoryDumper* BeginVersion(size_t capacity = 1 << 20)
+      {
+      Abort();
+      if (Control == nullptr)
+        return nullptr;
+
+      Generation = Control->Generation.load(std::memory_order_acquire) + 1;
+      std::string name = GetSharedSnapshotName(Name, Generation);
+      Fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (Fd < 0)
+        return nullptr;
+
+      Dumper.reset(new TSharedMemoryDumper(Fd, Generation, capacity));
+      return Dumper.get();
+      }
+
+    /// Commits dumped version and makes it current.
+    bool Publish()
+      {
+      if (Dumper == nullptr || Dumper->Commit() == false)
+        {
+        Abort();
+        return false;
+        }
+
+      unsigned long long previous = Control->Generation.exchange(Generation, std::memory_order_acq_rel);
+      if (previous != 0)
+        shm_unlink(GetSharedSnapshotName(Name, previous).c_str());
+      Dumper.reset();
+      close(Fd);
+      Fd = -1;
+      return true;
+      }
+
+    /// Generation of current version (0 if nothing is published).
+    unsigned long long GetGeneration() const
+      {
+      return Control != nullptr ? Control->Generation.load(std::memory_order_acquire) : 0;
+      }
+
+  private:
+    /// Removes unpublished version.
+    void Abort()
+      {
+      if (Fd < 0)
+        return;
+
+      Dumper.reset();
+      close(Fd);
+      Fd = -1;
+      shm_unlink(GetSharedSnapshotName(Name, Generation).c_str());
+      }
+
+  /// Class attributes:
+  private:
+    std::string                          Name;
+    TSharedSnapshotControl*              Control;
+    int                                  Fd;      //segment of version being dumped
+    unsigned long long                   Generation;
+    std::unique_ptr<TSharedMemoryDumper> Dumper;
+  }; //TSharedSnapshotPublisher
+
+//---------- TSharedSnapshotReader
+//Maps current version of named snapshot. Mapped version is shared, so objects loaded or
+//views read from it stay valid while its segment is held, even after newer version is mapped.
+class TSharedSnapshotReader
+  {
+  public:
+    explicit TSharedSnapshotReader(const char* name) : Name(name), Control(nullptr) {}
+
+    ~TSharedSnapshotReader()
+      {
+      if (Control != nullptr)
+        munmap(Control, sizeof(TSharedSnapshotControl));
+      }
+
+    TSharedSnapshotReader(const TSharedSnapshotReader&) = delete;
+    TSharedSnapshotReader& operator=(const TSharedSnapshotReader&) = delete;
+
+    /// Maps current version if it is newer than mapped one, returns true if it was mapped.
+    bool Refresh()
+      {
+      if (Control == nullptr && (Control = MapSharedSnapshotControl(Name, false)) == nullptr)
+        return false;
+
+      //version may be superseded and unlinked before it is opened, then the newer one is tried
+      for (int attempt = 0; attempt < 8; ++attempt)
+        {
+        unsigned long long generation = Control->Generation.load(std::memory_order_acquire);
+        if (generation == 0 || (Segment && Segment->GetGeneration() == generation))
+          return false;
+
+        int fd = shm_open(GetSharedSnapshotName(Name, generation).c_str(), O_RDONLY, 0);
+        if (fd < 0)
+          continue;
+        std::shared_ptr<const TSharedMemorySegment> segment(new TSharedMemorySegment(fd));
+        close(fd);
+        if (segment->IsOpen() && segment->GetGeneration() == generation)
+          {
+          Segment = segment;
+          return true;
+          }
+        }
+      return false;
+      }
+
+    /// Mapped version, nullptr before first successful Refresh.
+    std::shared_ptr<const TSharedMemorySegment> GetSegment() const { return Segment; }
+
+  /// Class attributes:
+  private:
+    std::string                                 Name;
+    TSharedSnapshotControl*                     Control;
+    std::shared_ptr<const TSharedMemorySegment> Segment;
+  }; //TSharedSnapshotReader
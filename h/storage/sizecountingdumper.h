@@ -0,0 +1,29 @@
+#pragma once
+
+#include <serialize3/h/storage/serializedumper.h>
+
+//---------- TSizeCountingDumper
+//Nothing is stored, only number of bytes passed to WriteBuffer is counted.
+//Used to evaluate serialized size of manually serialized classes.
+class TSizeCountingDumper : public ASerializeDumper
+  {
+  public:
+    TSizeCountingDumper() : Size(0) {}
+
+    size_t GetSize() const
+      {
+      return Size;
+      }
+
+  /// ASerializeDumper reimplementation:
+    virtual void Log(const char*) override {}
+
+    virtual void WriteBuffer(const unsigned char*, size_t bufferLen) override
+      {
+      Size += bufferLen;
+      }
+
+  /// Class attributes:
+  private:
+    size_t Size;
+  }; //TSizeCountingDumper
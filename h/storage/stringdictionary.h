@@ -0,0 +1,88 @@
+#pragma once
+
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+#include <serialize3/h/storage/varuint.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//String dictionary of snapshot: first occurrence of string is dumped in full and added to
+//dictionary, later occurrences are dumped as index to it. Loader builds the same dictionary
+//while loading, so both sides must see strings in the same order:
+//  code (variable length), string if code is 0, else index + 1 of previous string
+//Strings longer than MAX_LENGTH are never added, so dictionary memory stays bounded by
+//number of distinct short strings.
+
+const size_t STRING_DICTIONARY_MAX_LENGTH = 1024;
+
+//---------- TDumpStringDictionary
+//Indexes of strings dumped so far. Shared by dumpers of nested buffers (f.e. columns) of one
+//snapshot.
+class TDumpStringDictionary
+  {
+  public:
+    /// Dumps string or reference to its previous occurrence.
+    void Dump(ASerializeDumper& dumper, const std::string& s)
+      {
+      if (s.size() <= STRING_DICTIONARY_MAX_LENGTH)
+        {
+        auto inserted = Indexes.emplace(s, Indexes.size());
+        if (inserted.second == false)
+          {
+          DumpVarUInt(dumper, inserted.first->second + 1);
+          return;
+          }
+        }
+
+      DumpVarUInt(dumper, 0);
+      dumper.Dump(s);
+      }
+
+    size_t GetSize() const { return Indexes.size(); }
+
+  private:
+    std::unordered_map<std::string, size_t> Indexes;
+  }; //TDumpStringDictionary
+
+//---------- TLoadStringDictionary
+//Strings loaded so far, std::shared_ptr<const std::string> members loaded from the same
+//dictionary entry share one string.
+class TLoadStringDictionary
+  {
+  public:
+    typedef std::shared_ptr<const std::string> TString;
+
+    /// Loads string or reference to its previous occurrence, returns nullptr on error.
+    TString Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+      {
+      unsigned long long code = 0;
+      LoadVarUInt(loader, code);
+      if (loader.HasError())
+        return nullptr;
+
+      if (code == 0)
+        {
+        std::shared_ptr<std::string> s = std::make_shared<std::string>();
+        loader.Load(*s);
+        if (loader.HasError() == false && s->size() <= STRING_DICTIONARY_MAX_LENGTH)
+          Strings.push_back(s);
+        return s;
+        }
+
+      if (code > Strings.size())
+        {
+        loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+        return nullptr;
+        }
+
+      return Strings[static_cast<size_t>(code - 1)];
+      }
+
+    size_t GetSize() const { return Strings.size(); }
+
+  private:
+    std::vector<TString> Strings;
+  }; //TLoadStringDictionary
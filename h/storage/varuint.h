@@ -0,0 +1,31 @@
+#pragma once
+
+#include <serialize3/h/storage/serializedumper.h>
+#include <serialize3/h/storage/serializeloader.h>
+
+//Variable length unsigned integers used by encodings of strings (1 byte for values below 128).
+
+/// Writes value by 7 bits, lowest first, high bit marks continuation.
+inline void DumpVarUInt(ASerializeDumper& dumper, unsigned long long value)
+  {
+  unsigned char buffer[10];
+  size_t length = 0;
+  for (; value >= 0x80; value >>= 7)
+    buffer[length++] = static_cast<unsigned char>(value | 0x80);
+  buffer[length++] = static_cast<unsigned char>(value);
+  dumper.WriteBuffer(buffer, length);
+  }
+
+inline void LoadVarUInt(ASerializeLoader& loader, unsigned long long& value) SERIALIZE_LOAD_NOEXCEPT
+  {
+  value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+    unsigned char byte = 0;
+    loader.Load(byte);
+    value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0 || loader.HasError())
+      return;
+    }
+  loader.SetError(ASerializeLoader::LOAD_BAD_ENCODING);
+  }
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+//---------- TBitWriter
+//Appends bits to byte buffer, most significant bit first.
+class TBitWriter
+  {
+  public:
+    explicit TBitWriter(std::vector<unsigned char>& buffer) : Buffer(buffer), Bits(0), Used(0) {}
+
+    /// Writes lowest count bits of value (count <= 64).
+    void Write(unsigned long long value, unsigned count)
+      {
+      while (count != 0)
+        {
+        unsigned free = 64 - Used;
+        unsigned n = count < free ? count : free;
+        Bits |= ((value >> (count - n)) & Mask(n)) << (free - n);
+        Used += n;
+        count -= n;
+        if (Used == 64)
+          Flush(8);
+        }
+      }
+
+    /// Writes remaining bits padded by zeros to whole byte.
+    void Finish()
+      {
+      Flush((Used + 7) / 8);
+      }
+
+    static unsigned long long Mask(unsigned count)
+      {
+      return count >= 64 ? ~0ULL : (1ULL << count) - 1;
+      }
+
+  private:
+    void Flush(unsigned bytes)
+      {
+      for (unsigned i = 0; i < bytes; ++i)
+        Buffer.push_back(static_cast<unsigned char>(Bits >> (56 - i * 8)));
+      Bits = 0;
+      Used = 0;
+      }
+
+    std::vector<unsigned char>& Buffer;
+    unsigned long long          Bits;
+    unsigned                    Used;
+  }; //TBitWriter
+
+//---------- TBitReader
+//Reads bits written by TBitWriter, 64 bits are loaded at once.
+class TBitReader
+  {
+  public:
+    TBitReader(const unsigned char* data, size_t size) : Data(data), End(data + size), Bits(0), Available(0) {}
+
+    /// Reads count bits (count <= 64), returns false at the end of data.
+    bool Read(unsigned count, unsigned long long& value)
+      {
+      value = 0;
+      while (count != 0)
+        {
+        if (Available == 0 && Refill() == false)
+          return false;
+
+        unsigned n = count < Available ? count : Available;
+        value = n == 64 ? Bits : (value << n) | (Bits >> (64 - n));
+        Bits = n == 64 ? 0 : Bits << n;
+        Available -= n;
+        count -= n;
+        }
+      return true;
+      }
+
+    bool ReadBit(bool& bit)
+      {
+      unsigned long long value;
+      bool read = Read(1, value);
+      bit = value != 0;
+      return read;
+      }
+
+  private:
+    bool Refill()
+      {
+      size_t bytes = static_cast<size_t>(End - Data) < 8 ? static_cast<size_t>(End - Data) : 8;
+      if (bytes == 0)
+        return false;
+
+      Bits = 0;
+      for (size_t i = 0; i < bytes; ++i)
+        Bits |= static_cast<unsigned long long>(Data[i]) << (56 - i * 8);
+      Data += bytes;
+      Available = static_cast<unsigned>(bytes * 8);
+      return true;
+      }
+
+    const unsigned char* Data;
+    const unsigned char* End;
+    unsigned long long   Bits;
+    unsigned             Available;
+  }; //TBitReader
+
+//---------- TXorFloatCodec
+//Lossless compression of float or double sequences (Gorilla time series encoding). First value
+//is stored as is, each next one as XOR with previous value:
+//  '0'                                   - the same value
+//  '10', meaningful bits                 - XOR fits window of leading and trailing zeros
+//                                          of previous stored XOR
+//  '11', leading zeros (5 bits), length - 1 (6 bits for double, 5 for float), meaningful bits
+//Slowly changing values share sign, exponent and high mantissa bits, so XOR has few
+//meaningful bits.
+template <typename TFloat>
+class TXorFloatCodec
+  {
+  static_assert(std::is_same<TFloat, float>::value || std::is_same<TFloat, double>::value,
+    "Only float and double are supported");
+
+  public:
+    static const unsigned BITS = sizeof(TFloat) * 8;
+    static const unsigned LENGTH_BITS = sizeof(TFloat) == 8 ? 6 : 5;
+    static const unsigned MAX_LEADING = 31;
+
+    /// Encodes count values starting at i.
+    template <class TIterator>
+    static void Encode(TIterator i, size_t count, std::vector<unsigned char>& payload)
+      {
+      TBitWriter writer(payload);
+      unsigned long long previous = 0;
+      unsigned previousLeading = BITS; //no window yet
+      unsigned previousTrailing = 0;
+
+      for (size_t n = 0; n < count; ++n, ++i)
+        {
+        unsigned long long value = ToBits(*i);
+        unsigned long long x = value ^ previous;
+        previous = value;
+
+        if (n == 0)
+          writer.Write(value, BITS);
+        else if (x == 0)
+          writer.Write(0, 1);
+        else
+          {
+          unsigned leading = CountLeadingZeros(x) - (64 - BITS);
+          unsigned trailing = CountTrailingZeros(x);
+          if (leading > MAX_LEADING)
+            leading = MAX_LEADING;
+
+          if (leading >= previousLeading && trailing >= previousTrailing)
+            {
+            writer.Write(2, 2);
+            writer.Write(x >> previousTrailing, BITS - previousLeading - previousTrailing);
+            }
+          else
+            {
+            unsigned length = BITS - leading - trailing;
+            writer.Write(3, 2);
+            writer.Write(leading, 5);
+            writer.Write(length - 1, LENGTH_BITS);
+            writer.Write(x >> trailing, length);
+            previousLeading = leading;
+            previousTrailing = trailing;
+            }
+          }
+        }
+
+      writer.Finish();
+      }
+
+    /// Decodes count values to out, returns false if payload is corrupted.
+    template <class TOutputIterator>
+    static bool Decode(const unsigned char* payload, size_t size, size_t count, TOutputIterator out)
+      {
+      TBitReader reader(payload, size);
+      unsigned long long value = 0;
+      unsigned leading = 0;
+      unsigned length = 0;
+      bool hasWindow = false;
+
+      for (size_t n = 0; n < count; ++n, ++out)
+        {
+        bool bit;
+        unsigned long long x = 0;
+        if (n == 0)
+          {
+          if (reader.Read(BITS, value) == false)
+            return false;
+          }
+        else if (reader.ReadBit(bit) == false)
+          return false;
+        else if (bit)
+          {
+          if (reader.ReadBit(bit) == false)
+            return false;
+          if (bit)
+            {
+            unsigned long long l;
+            if (reader.Read(5, l) == false || reader.Read(LENGTH_BITS, x) == false)
+              return false;
+            leading = static_cast<unsigned>(l);
+            length = static_cast<unsigned>(x) + 1;
+            if (leading + length > BITS)
+              return false;
+            hasWindow = true;
+            }
+          else if (hasWindow == false)
+            return false;
+
+          if (reader.Read(length, x) == false)
+            return false;
+          value ^= x << (BITS - leading - length);
+          }
+
+        *out = FromBits(value);
+        }
+
+      return true;
+      }
+
+  private:
+    typedef typename std::conditional<sizeof(TFloat) == 8, unsigned long long, unsigned int>::type TBits;
+
+    static unsigned long long ToBits(TFloat value)
+      {
+      TBits bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return bits;
+      }
+
+    static TFloat FromBits(unsigned long long value)
+      {
+      TBits bits = static_cast<TBits>(value);
+      TFloat result;
+      memcpy(&result, &bits, sizeof(bits));
+      return result;
+      }
+
+    //x is not zero
+    static unsigned CountLeadingZeros(unsigned long long x)
+      {
+#if defined(__GNUC__)
+      return static_cast<unsigned>(__builtin_clzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanReverse64(&index, x);
+      return 63 - index;
+#else
+      unsigned count = 0;
+      for (; (x & (1ULL << 63)) == 0; x <<= 1)
+        ++count;
+      return count;
+#endif
+      }
+
+    static unsigned CountTrailingZeros(unsigned long long x)
+      {
+#if defined(__GNUC__)
+      return static_cast<unsigned>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanForward64(&index, x);
+      return index;
+#else
+      unsigned count = 0;
+      for (; (x & 1) == 0; x >>= 1)
+        ++count;
+      return count;
+#endif
+      }
+  }; //TXorFloatCodec
@@ -7,6 +7,7 @@
 #include <fstream>
 #include <string>
 #include <algorithm>
+#include <cctype>
 #include <stdlib.h> 
 #include <limits.h>
 #include <iostream>
@@ -38,6 +39,7 @@ TSerializableMap::TSerializableMap(const TClasses& classes, const TEnums& enums,
   ParsedHeaderTypeIdsFileName.replace_extension(".hpp");
   InjectedFunctionsFileName = working_dir / (output_prefix + "_injected");
   InjectedFunctionsFileName.replace_extension(".cpp");
+  OutputPrefix = output_prefix;
 
   Indent = std::string(indent, ' ');
   Indent2 = std::string(indent * 2, ' ');
@@ -84,6 +86,10 @@ bool TSerializableMap::WriteParsedHeaderInjectedFunctions()
 
   CodeGenerator.AddSystemInclude("serialize3/h/gen_code/dumpertemplates.h");
   CodeGenerator.AddSystemInclude("serialize3/h/gen_code/loadertemplates.h");
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/sizetemplates.h");
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/visitortemplates.h");
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/flattemplates.h");
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/difftemplates.h");
   CodeGenerator.AddInclude(ParsedHeaderTypeIdsFileName.generic_string().c_str());
   //add 'register macro' safeguard
   CodeGenerator.Out << "#ifndef REGISTER_OBJECT" << std::endl;
@@ -124,7 +130,8 @@ bool TSerializableMap::WriteParsedHeaderTypeIds()
     }
 
   if (CodeGenerator.Open(ParsedHeaderTypeIdsFileName.generic_string().c_str(),
-      "Defines type ids for classes serializable via a pointer (Note: could be directly added to injected file)") == false)
+      "Defines type ids for classes serializable via a pointer, sizes of fixed-size classes, layout fingerprint and flat views "
+      "(Note: could be directly added to injected file)") == false)
     {
     LOG_INFO("... FAILED!");
     return false;
@@ -132,12 +139,37 @@ bool TSerializableMap::WriteParsedHeaderTypeIds()
 
   CodeGenerator.StartHeaderSentinel();
 
+  //templates specialized below (serialized_fixed_size, serialized_columnar, layouts, flat views)
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/columntemplates.h");
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/flattemplates.h");
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/rawlayouttemplates.h");
+  CodeGenerator.AddSystemInclude("serialize3/h/gen_code/sizetemplates.h");
+  CodeGenerator.Out << std::endl;
+
   for (auto _class : Classes)
     {
     if (_class->IsAbstract() == false && _class->IsPartOfHierarchy())
       WriteTypeIdDeclaration(*_class);
     }
 
+  for (auto _class : Classes)
+    {
+    if (_class->NeedGenerateSerializeCode() && _class->IsDumpNeeded() && _class->GetName().empty() == false &&
+        GetFixedSerializedSize(*_class) > 0)
+      WriteFixedSizeDeclaration(*_class);
+    }
+
+  for (auto _class : Classes)
+    {
+    //vectors of such classes are stored by columns in columnar snapshots
+    if (_class->NeedGenerateSerializeCode() && IsColumnar(*_class))
+      CodeGenerator.Out << "template <> struct serialized_columnar<" << _class->GetFullName()
+                        << "> : public std::true_type {};" << std::endl;
+    }
+
+  WriteLayoutFingerprintDeclaration();
+  WriteFlatViewDeclarations();
+
   CodeGenerator.EndHeaderSentinel();
   CodeGenerator.Close();
 
@@ -159,6 +191,203 @@ void TSerializableMap::WriteTypeIdDeclaration(const TClass& _class)
                     << _class.GetTypeId() << ';' << std::endl;
   }
 
+void TSerializableMap::WriteFixedSizeDeclaration(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+  std::string fixedSizeName(GetFixedSizeName(_class));
+
+  out << "constexpr size_t " << fixedSizeName << " = " << GetFixedSerializedSize(_class) << ';' << std::endl;
+
+  //let templates know the size of whole containers without iterating them
+  //(not for unions, they are counted by templates as raw memory)
+  if (_class.GetTypeKind() != TType::TypeUnion && IsAccessibleFromNamespace(_class))
+    {
+    out << "template <> struct serialized_fixed_size<" << _class.GetFullName()
+        << "> : public std::integral_constant<size_t, " << fixedSizeName << "> {};" << std::endl;
+    }
+
+  if (IsRawLayout(_class))
+    {
+    //fields let dumper zero padding and binary with different layout load objects field by field
+    TRawLayoutFields fields;
+    std::string layoutName(GetRawLayoutName(_class));
+
+    GetRawLayoutFields(&_class, 0, fields);
+    out << "constexpr TRawLayoutField " << layoutName << "_FIELDS[] = {";
+    for (size_t i = 0; i < fields.size(); ++i)
+      out << (i == 0 ? " " : ", ") << "{ " << fields[i].first << ", " << fields[i].second << " }";
+    out << " };" << std::endl;
+    out << "constexpr TRawLayoutDescription " << layoutName << " = { \"" << _class.GetFullName() << "\", "
+        << _class.GetSizeof() << ", " << layoutName << "_FIELDS, " << fields.size() << " };" << std::endl;
+
+    //containers of such objects are dumped and loaded at once in snapshots with raw layout
+    if (IsAccessibleFromNamespace(_class))
+      {
+      out << "template <> struct serialized_raw_layout<" << _class.GetFullName() << "> : public std::true_type"
+          << " { static const TRawLayoutDescription& GetDescription() { return " << layoutName << "; } };" << std::endl;
+      }
+    }
+  else if (GetFixedSerializedSize(_class, true) != GetFixedSerializedSize(_class))
+    {
+    //some members are dumped as raw memory in snapshots with raw layout
+    out << "constexpr size_t " << GetRawSizeName(_class) << " = " << GetFixedSerializedSize(_class, true)
+        << ';' << std::endl;
+    }
+  }
+
+void TSerializableMap::WriteLayoutFingerprintDeclaration()
+  {
+  //FNV-1a hash of layouts of all classes dumped as raw memory, snapshot with raw layout
+  //can be loaded only by binary with the same fingerprint (see serialize_snapshotheader.h)
+  unsigned long long fingerprint = 14695981039346656037ULL;
+
+  for (auto _class : Classes)
+    {
+    if (_class->NeedGenerateSerializeCode() == false || IsRawLayout(*_class) == false)
+      continue;
+
+    for (unsigned char c : GetLayoutDescription(_class))
+      {
+      fingerprint ^= c;
+      fingerprint *= 1099511628211ULL;
+      }
+    }
+
+  std::string prefixName(OutputPrefix + '_');
+  std::replace_if(prefixName.begin(), prefixName.end(),
+    [](char c) { return isalnum(static_cast<unsigned char>(c)) == 0; }, '_');
+  std::string fingerprintName(prefixName + "LAYOUT_FINGERPRINT");
+
+  CodeGenerator.Out << "constexpr unsigned long long " << fingerprintName << " = 0x" << std::hex << fingerprint
+                    << std::dec << "ULL;" << std::endl;
+
+  //layouts written into snapshot header, so snapshot can be loaded by binary with different layout
+  std::string layouts;
+  size_t layoutCount = 0;
+
+  for (auto _class : Classes)
+    {
+    if (_class->NeedGenerateSerializeCode() && _class->IsDumpNeeded() && _class->GetName().empty() == false &&
+        IsRawLayout(*_class))
+      {
+      layouts += std::string(layoutCount == 0 ? " " : ", ") + '&' + GetRawLayoutName(*_class);
+      ++layoutCount;
+      }
+    }
+
+  if (layoutCount != 0)
+    {
+    CodeGenerator.Out << "constexpr const TRawLayoutDescription* " << prefixName << "RAW_LAYOUTS[] = {"
+                      << layouts << " };" << std::endl;
+    }
+  CodeGenerator.Out << "constexpr TSnapshotLayout " << prefixName << "SNAPSHOT_LAYOUT = { " << fingerprintName
+                    << ", " << (layoutCount != 0 ? prefixName + "RAW_LAYOUTS" : std::string("nullptr"))
+                    << ", " << layoutCount << " };" << std::endl;
+  }
+
+void TSerializableMap::WriteFlatViewDeclarations()
+  {
+  std::ofstream& out = CodeGenerator.Out;
+  TClassSet viewsWritten;
+
+  //views may refer to each other by vectors, so all of them are marked first (see flattemplates.h)
+  for (auto _class : Classes)
+    {
+    if (HasFlatView(*_class))
+      out << "template <> struct is_flat_table<" << _class->GetFullName() << "> : public std::true_type {};" << std::endl;
+    }
+
+  for (auto _class : Classes)
+    {
+    if (HasFlatView(*_class))
+      WriteFlatView(*_class, viewsWritten);
+    }
+  }
+
+void TSerializableMap::WriteFlatView(const TClass& _class, TClassSet& viewsWritten)
+  {
+  if (viewsWritten.insert(&_class).second == false)
+    return;
+
+  std::ofstream& out = CodeGenerator.Out;
+  std::string className(_class.GetFullName());
+  std::vector<const TClassMember*> members;
+
+  _class.ForEachMember([this, &members, &viewsWritten](const TClassMember& member)
+    {
+    const TClass* memberClass = GetMemberClass(member.GetType());
+
+    if (memberClass && memberClass->IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+      return;
+
+    //tables of members are stored inline, their size must be known first
+    if (memberClass && HasFlatView(*memberClass))
+      WriteFlatView(*memberClass, viewsWritten);
+
+    members.push_back(&member);
+    });
+
+  out << std::endl;
+  out << "template <> class TFlatView<" << className << "> : public AFlatView" << std::endl;
+  out << Indent << '{' << std::endl;
+  out << Indent << "public:" << std::endl;
+
+  //offset of each field follows the previous one
+  std::string end("0");
+
+  out << Indent2 << "enum : size_t" << std::endl;
+  out << Indent3 << '{' << std::endl;
+  for (auto member : members)
+    {
+    std::string field("decltype(" + className + "::" + member->GetName() + ')');
+    std::string offset(member->GetName() + "_OFFSET");
+
+    out << Indent3 << offset << " = FlatFieldOffset<" << field << ">(" << end << ")," << std::endl;
+    end = offset + " + flat_traits<" + field + ">::SIZE";
+    }
+  out << Indent3 << "SIZE = FlatTableSize(" << end << ')' << std::endl;
+  out << Indent3 << "};" << std::endl;
+  out << std::endl;
+
+  out << Indent2 << "explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}" << std::endl;
+
+  //accessors and builder are templates, so types of fields are checked only if they are used
+  for (auto member : members)
+    {
+    out << std::endl;
+    out << Indent2 << "template <class TField = decltype(" << className << "::" << member->GetName() << ")>" << std::endl;
+    out << Indent2 << "flat_view_t<TField> " << member->GetName() << "() const { return flat_traits<TField>::Get("
+        << "AFlatView::Table + " << member->GetName() << "_OFFSET); }" << std::endl;
+    }
+
+  out << std::endl;
+  out << Indent2 << "template <class TBuilder>" << std::endl;
+  out << Indent2 << "static void Build(TBuilder& builder, size_t table, const " << className << "& o)" << std::endl;
+  out << Indent3 << '{' << std::endl;
+  for (auto member : members)
+    {
+    out << Indent3 << "builder.WriteField(table + " << member->GetName() << "_OFFSET, o."
+        << member->GetName() << ");" << std::endl;
+    }
+  out << Indent3 << '}' << std::endl;
+
+  //references of fields are checked against buffer before the view is used (see GetFlatRoot)
+  out << std::endl;
+  out << Indent2 << "template <class TVerifier>" << std::endl;
+  out << Indent2 << "static bool Verify(TVerifier& verifier, size_t table)" << std::endl;
+  out << Indent3 << '{' << std::endl;
+  if (members.empty())
+    out << Indent3 << "return true;" << std::endl;
+  for (size_t i = 0; i < members.size(); ++i)
+    {
+    out << (i == 0 ? Indent3 + "return " : Indent3 + Indent) << "verifier.template VerifyField<decltype(" << className
+        << "::" << members[i]->GetName() << ")>(table + " << members[i]->GetName() << "_OFFSET)"
+        << (i + 1 == members.size() ? ";" : " &&") << std::endl;
+    }
+  out << Indent3 << '}' << std::endl;
+  out << Indent << "};" << std::endl;
+  }
+
 #if defined(GENERATE_ENUM_OPERATORS)
 void TSerializableMap::WriteOperatorsForEnums()
   {
@@ -416,11 +645,28 @@ void TSerializableMap::WriteMethodsForClass(const TClass& _class)
 
   WriteDumpObjectFunction(_class);
   WriteLoadObjectFunction(_class);
+  WriteLoadConstructor(_class);
+  if (_class.HasDiff())
+    {
+    WriteHasDiffFunction(_class);
+    WriteDumpDiffFunction(_class);
+    WriteLoadPatchFunction(_class);
+    }
+  WriteSerializedSizeFunction(_class);
+  WriteVisitHandlesFunction(_class);
+
+  if (IsColumnar(_class))
+    {
+    WriteDumpColumnsFunction(_class);
+    WriteLoadColumnsFunction(_class);
+    }
 
   if (_class.IsPointerSerializable())
     {
     WriteTypeIdFunction(_class);
     WriteDumpObjectPointerFunction(_class);
+    WriteSerializedPointerSizeFunction(_class);
+    WriteVisitPointerHandlesFunction(_class);
     WriteLoadObjectPointerFunction(_class);
     }
   else
@@ -464,6 +710,11 @@ void TSerializableMap::WriteDumpObjectFunction(const TClass& _class)
       out << "template <> ";
     out << "void " << CurrentClassName << "::Dump(ASerializeDumper& dumper) const" << std::endl;
     out << Indent << "{" << std::endl;
+    if (IsRawLayout(_class))
+      {
+      out << Indent << "if (DumpRawLayout(dumper, *this, " << GetRawLayoutName(_class) << "))" << std::endl;
+      out << Indent2 << "return;" << std::endl;
+      }
     out << Indent << "DPUSH_INDENT;" << std::endl;
     std::string logMsg("Dump " + CurrentClassFullName);
     CodeGenerator.AddLogMacro(logMsg.c_str(), "DLOGMSG");
@@ -502,8 +753,30 @@ void TSerializableMap::WriteLoadObjectFunction(const TClass& _class)
 
     if (_class.IsTemplate())
       out << "template <> ";
-    out << "void " << CurrentClassName << "::Load(ASerializeLoader& loader)" << std::endl;
-    out << Indent << "{" << std::endl;
+    if (GetFixedSerializedSize(_class) > 0)
+      {
+      //Whole object is checked at once, members are loaded by unchecked reads
+      out << "void " << CurrentClassName << "::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT" << std::endl;
+      out << Indent << "{" << std::endl;
+      if (IsRawLayout(_class))
+        {
+        out << Indent << "if (LoadRawLayout(_loader, *this, " << GetRawLayoutName(_class) << "))" << std::endl;
+        out << Indent2 << "return;" << std::endl;
+        out << Indent << "TFixedSizeLoader loader(_loader, " << GetFixedSizeName(_class) << ");" << std::endl;
+        }
+      else if (GetFixedSerializedSize(_class, true) != GetFixedSerializedSize(_class))
+        {
+        out << Indent << "TFixedSizeLoader loader(_loader, _loader.IsRawLayout() ? " << GetRawSizeName(_class)
+            << " : " << GetFixedSizeName(_class) << ");" << std::endl;
+        }
+      else
+        out << Indent << "TFixedSizeLoader loader(_loader, " << GetFixedSizeName(_class) << ");" << std::endl;
+      }
+    else
+      {
+      out << "void " << CurrentClassName << "::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT" << std::endl;
+      out << Indent << "{" << std::endl;
+      }
     out << Indent << "LPUSH_INDENT;" << std::endl;
     std::string logMsg("Load " + CurrentClassFullName);
     CodeGenerator.AddLogMacro(logMsg.c_str(),"LLOGMSG");
@@ -534,296 +807,1112 @@ void TSerializableMap::WriteLoadObjectFunction(const TClass& _class)
     }
   }
 
-void TSerializableMap::WriteTypeIdFunction(const TClass& _class)
+void TSerializableMap::WriteLoadConstructor(const TClass& _class)
   {
+  if (_class.HasLoadConstructor() == false || _class.IsLoadNeeded() == false)
+    return;
+
   std::ofstream& out = CodeGenerator.Out;
+  std::string name(_class.GetName().substr(0, _class.GetName().find('<')));
 
-  //TYPEID_TYPE ClassName::GetTypeId() const { return ClassName_TYPE_ID; }
   if (_class.IsTemplate())
     out << "template <> ";
-  out << "TTypeId " << CurrentClassName << "::GetTypeId() const { return "
-      << CurrentTypeIdName << "; }" << std::endl;
-  }
+  out << CurrentClassName << "::" << name << "(TLoadTag, ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT"
+      << std::endl;
 
-void TSerializableMap::WriteDumpObjectPointerFunction(const TClass& _class)
-  {
-  if (_class.IsDumpPointerNeeded())
+  if (IsLoadConstructible(_class) == false)
     {
-    std::ofstream& out = CodeGenerator.Out;
-
-    if (_class.IsTemplate())
-      out << "template <> ";
-    out << "void " << CurrentClassName << "::DumpPointer(ASerializeDumper& dumper) const" << std::endl;
+    if (IsRawLayout(_class) == false)
+      LOG_NOTE(_class.GetFullName() << " members are default initialized by loading constructor");
     out << Indent << "{" << std::endl;
-    std::string logMsg("Dump " + CurrentClassFullName + " pointer");
-    CodeGenerator.AddLogMacro(logMsg.c_str(),"DLOGMSG");
-    out << Indent << "dumper.Dump(GetTypeId());" << std::endl;
-    out << Indent << "dumper & *this;" << std::endl;
+    out << Indent << "Load(loader);" << std::endl;
     out << Indent << "}" << std::endl;
+    return;
     }
-  }
 
-void TSerializableMap::WriteLoadObjectPointerFunction(const TClass& _class)
-  {
-  if (_class.IsLoadPointerNeeded())
+  //Fixed-size object is acquired at once like by Load, members are constructed from the window
+  //by delegated constructor (the window lives till it returns)
+  if (GetFixedSerializedSize(_class) > 0)
     {
-    std::ofstream& out = CodeGenerator.Out;
+    out << Indent << ": " << name << "(TLoadTag(), TFixedSizeLoader(loader, ";
+    if (GetFixedSerializedSize(_class, true) != GetFixedSerializedSize(_class))
+      out << "loader.IsRawLayout() ? " << GetRawSizeName(_class) << " : ";
+    out << GetFixedSizeName(_class) << "))" << std::endl;
+    out << Indent << "{" << std::endl;
+    out << Indent << "}" << std::endl;
 
     if (_class.IsTemplate())
       out << "template <> ";
-    out << "void* " << CurrentClassName << "::LoadPointer(ASerializeLoader& loader)" << std::endl;
-    out << Indent << "{" << std::endl;
-    std::string logMsg("Load " + CurrentClassFullName + " pointer");
-    CodeGenerator.AddLogMacro(logMsg.c_str(), "LLOGMSG");
-    out << Indent << "TTypeId objectTypeId;" << std::endl
-        << Indent << "loader.Load(objectTypeId);" << std::endl
-        << Indent << CurrentClassFullName << "* o;" << std::endl;
-    out << Indent << "switch(objectTypeId)" << std::endl;
-    out << Indent2 << "{" << std::endl;
-    out << Indent2 << "case NULL_TYPE_ID:" << std::endl;
-    out << Indent3 << "o = 0;" << std::endl;
-    out << Indent3 << "break;" << std::endl;
+    out << CurrentClassName << "::" << name << "(TLoadTag, TFixedSizeLoader&& loader) SERIALIZE_LOAD_NOEXCEPT"
+        << std::endl;
+    }
 
-    TClassSet classCasesWritten; //keeps track of cases written to avoid duplicate cases
-    WriteCasesForDerived(_class, classCasesWritten);
+  //Construct bases:   TBase(TLoadTag(), loader)
+  //Construct fields:  F1(TLoadTag(), loader) or F1(ConstructLoaded<decltype(F1)>(loader))
+  std::vector<std::string> initializers;
 
-    out << Indent2 << "default:" << std::endl;
-    out << Indent3 << "assert(false);" << std::endl;
-    out << Indent3 << "o = 0;" << std::endl;
-    out << Indent3 << "throw 1;" << std::endl;
-    out << Indent2 << "} //end switch" << std::endl;
-    out << Indent << "return o;" << std::endl;
-    out << Indent << "} //end LoadPointer" << std::endl;
+  _class.ForEachBase([&initializers](const TClass& base)
+    {
+    if (base.NeedGenerateSerializeCode())
+      initializers.push_back(base.GetFullName() + "(TLoadTag(), loader)");
+    });
+
+  _class.ForEachMember([this, &initializers](const TClassMember& member)
+    {
+    const TClass* memberClass = GetMemberClass(member.GetType());
+    const std::string& memberName = member.GetName();
+
+    if (memberClass && memberClass->IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+      return;
+
+    if (memberClass && memberClass->HasLoadConstructor() && memberClass->IsLoadNeeded())
+      initializers.push_back(memberName + "(TLoadTag(), loader)");
+    else
+      initializers.push_back(memberName + "(ConstructLoaded<decltype(" + memberName + ")>(loader))");
+    });
+
+  for (size_t i = 0; i < initializers.size(); ++i)
+    {
+    out << Indent << (i == 0 ? ": " : "  ") << initializers[i] << (i + 1 < initializers.size() ? "," : "")
+        << std::endl;
     }
+  out << Indent << "{" << std::endl;
+  out << Indent << "}" << std::endl;
   }
 
-void TSerializableMap::WriteTypeIdCase(const TClass& _class)
+void TSerializableMap::WriteHasDiffFunction(const TClass& _class)
   {
   std::ofstream& out = CodeGenerator.Out;
-  std::string fullName(_class.GetFullName());
 
-  out << Indent2 << "case " << GetTypeIdName(_class) << ":" << std::endl;
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "bool " << CurrentClassName << "::HasDiff(const " << CurrentClassName << "& base) const" << std::endl;
+  out << Indent << "{" << std::endl;
 
-  if (_class.IsVirtuallyDerived())
-    {
-    out << Indent3 << "{" << std::endl;
-    out << Indent3 << fullName << "* d = (" << fullName << "*)" << fullName;
-    if (_class.IsBuildForSerializerWithLoader())
-      out << "::BuildForSerializer(loader);";
-    else
-      out << "::BuildForSerializer();";
-    out << std::endl;
-    out << Indent3 << "loader & *d;" << std::endl;
-    out << Indent3 << "o = d;" << std::endl;
-    out << Indent3 << "}" << std::endl;
-    }
+  bool diffable = IsDiffable(_class);
+  std::vector<std::string> fields = diffable ? GetDiffFields(_class, std::string(), true) : std::vector<std::string>();
+  std::vector<std::string> baseFields = diffable ? GetDiffFields(_class, "base", true) : std::vector<std::string>();
+
+  if (diffable == false)
+    out << Indent << "return IsDiffChangedValue(*this, base);" << std::endl;
+  else if (fields.empty())
+    out << Indent << "return false;" << std::endl;
   else
     {
-    out    << Indent3 << "o = (" << fullName << "*)" << fullName;
-    if (_class.IsBuildForSerializerWithLoader())
-      out << "::BuildForSerializer(loader);";
-    else
-      out << "::BuildForSerializer();";
-    out << std::endl;
-    out << Indent3 << "loader & (" << fullName << "&)*o;" << std::endl;
+    out << Indent << "TDiffComparer comparer;" << std::endl;
+    for (size_t i = 0; i < fields.size(); ++i)
+      {
+      out << (i == 0 ? Indent + "return " : Indent2) << "IsDiffChanged(" << fields[i] << ", " << baseFields[i]
+          << ", comparer)" << (i + 1 < fields.size() ? " ||" : ";") << std::endl;
+      }
     }
-  out << Indent3 << "break;" << std::endl;
+  out << Indent << "}" << std::endl;
   }
 
-void TSerializableMap::WriteCasesForDerived(const TClass& _class, TClassSet& classCasesWritten)
+void TSerializableMap::WriteDumpDiffFunction(const TClass& _class)
   {
-  if (_class.NeedGenerateSerializeCode() == false)
-    return;
+  std::ofstream& out = CodeGenerator.Out;
 
-  auto insertInfo = classCasesWritten.insert(&_class);
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "void " << CurrentClassName << "::DumpDiff(const " << CurrentClassName
+      << "& base, ASerializeDumper& dumper) const" << std::endl;
+  out << Indent << "{" << std::endl;
 
-  //Avoid duplicate case if already written (can happen in multiple-base hierarchies)
-  if (insertInfo.second == false)
+  if (IsDiffable(_class) == false)
+    {
+    //whole object is the only field
+    out << Indent << "TDiffFields<1> changed;" << std::endl;
+    out << Indent << "changed.Set(0, HasDiff(base));" << std::endl;
+    out << Indent << "changed.Dump(dumper);" << std::endl;
+    out << Indent << "if (changed[0])" << std::endl;
+    out << Indent2 << "DumpDiffWhole(dumper, *this);" << std::endl;
+    out << Indent << "}" << std::endl;
     return;
+    }
 
-  if (_class.IsAbstract() == false)
-    WriteTypeIdCase(_class);
-
-  //case for each derived type
-  _class.ForEachDerived([this,&classCasesWritten](const TClass& derived)
+  std::vector<std::string> fields = GetDiffFields(_class, std::string(), true);
+  std::vector<std::string> baseFields = GetDiffFields(_class, "base", true);
+
+  //changes found by comparison are passed to DumpDiffField, so fields are compared once
+  if (fields.empty() == false)
+    out << Indent << "TDiffComparer comparer;" << std::endl;
+  for (size_t i = 0; i < fields.size(); ++i)
+    out << Indent << "auto change" << i << " = GetDiffChange(" << fields[i] << ", " << baseFields[i] << ", comparer);"
+        << std::endl;
+  out << Indent << "TDiffFields<" << fields.size() << "> changed;" << std::endl;
+  for (size_t i = 0; i < fields.size(); ++i)
+    out << Indent << "changed.Set(" << i << ", change" << i << ".Changed);" << std::endl;
+  out << Indent << "changed.Dump(dumper);" << std::endl;
+  for (size_t i = 0; i < fields.size(); ++i)
     {
-    WriteCasesForDerived(derived, classCasesWritten);
-    });
+    out << Indent << "if (changed[" << i << "])" << std::endl;
+    out << Indent2 << "DumpDiffField(dumper, " << fields[i] << ", " << baseFields[i] << ", change" << i << ");"
+        << std::endl;
+    }
+  out << Indent << "}" << std::endl;
   }
 
-bool TSerializableMap::HandleArray(std::ofstream& out, std::string& indent, std::string iterator,
-  std::string& reference, const TArrayType& arrayType, const TType** type)
+void TSerializableMap::WriteLoadPatchFunction(const TClass& _class)
   {
-  int size = arrayType.GetSize();
-  out << indent << "for (int " << iterator << " = 0; " << iterator << " < " << size
-    << "; ++" << iterator << ")" << std::endl;
-  reference += '[' + iterator + ']';
-  indent += Indent;
-
-  const TType* elemType = arrayType.GetElemType();
+  std::ofstream& out = CodeGenerator.Out;
 
-  if (elemType->GetTypeKind() == TType::TypeArray)
-    {
-    iterator += 'i';
-    const TArrayType* arrayType = static_cast<const TArrayType*>(elemType);
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "void " << CurrentClassName << "::LoadPatch(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT" << std::endl;
+  out << Indent << "{" << std::endl;
 
-    return HandleArray(out, indent, iterator, reference, *arrayType, type);
-    }
+  bool diffable = IsDiffable(_class);
+  std::vector<std::string> fields = diffable ? GetDiffFields(_class, std::string(), false) : std::vector<std::string>();
 
-  *type = elemType;
+  out << Indent << "TDiffFields<" << (diffable ? fields.size() : 1) << "> changed;" << std::endl;
+  out << Indent << "if (changed.Load(loader) == false)" << std::endl;
+  out << Indent2 << "return;" << std::endl;
 
-  return true;
+  if (diffable == false)
+    {
+    out << Indent << "if (changed[0])" << std::endl;
+    out << Indent2 << "LoadDiffWhole(loader, *this);" << std::endl;
+    }
+  for (size_t i = 0; i < fields.size(); ++i)
+    {
+    out << Indent << "if (changed[" << i << "])" << std::endl;
+    out << Indent2 << "LoadPatchField(loader, " << fields[i] << ");" << std::endl;
+    }
+  out << Indent << "}" << std::endl;
   }
 
-template <bool DUMP_CALL>
-void TSerializableMap::WriteCall(const TClassMember& member, const std::string& prefix,
-  const std::string& _indent)
+void TSerializableMap::WriteSerializedSizeFunction(const TClass& _class)
   {
   std::ofstream& out = CodeGenerator.Out;
-  const TType* type = member.GetType();
-  assert(type == nullptr || type->IsTypedef() == false);
-  std::string indent(_indent);
-  std::string reference(prefix + member.GetName());
-  bool is_array = false;
-  const char* dumper_loader = DUMP_CALL ? "dumper & " : "loader & ";
-
-  if (type)
-    {
-    TType::TTypeKind typeKind = type->GetTypeKind();
 
-    if (typeKind == TType::TypeArray)
-      {
-      std::string iterator("i");
-      const TArrayType* arrayType = static_cast<const TArrayType*>(type);
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "size_t " << CurrentClassName << "::SerializedSize() const";
 
-      if (HandleArray(out, indent, iterator, reference, *arrayType, &type) == false)
+  if (_class.IsDumpNeeded() == false)
+    {
+    //Dump defined manually, so just count what it writes
+    out << std::endl;
+    out << Indent << "{" << std::endl;
+    out << Indent << "TSizeCountingDumper dumper;" << std::endl;
+    out << Indent << "Dump(dumper);" << std::endl;
+    out << Indent << "return dumper.GetSize();" << std::endl;
+    out << Indent << "}" << std::endl;
+    }
+  else if (GetFixedSerializedSize(_class) > 0)
+    {
+    out << " { return " << GetFixedSizeName(_class) << "; }" << std::endl;
+    }
+  else
+    {
+    out << std::endl;
+    out << Indent << "{" << std::endl;
+    out << Indent << "TSerializedSizeCounter counter;" << std::endl;
+
+    if (_class.GetTypeKind() == TType::TypeUnion)
+      {
+      WriteSizeInplaceUnion(_class, Indent);
+      }
+    else
+      {
+      //Count bases:   counter & (const TBase&)*this;
+      _class.ForEachBase([this, &out](const TClass& base)
+        {
+        if (base.NeedGenerateSerializeCode())
+          out << Indent << "counter & static_cast<const " << base.GetFullName() << "&>(*this);" << std::endl;
+        });
+
+      //Count fields:
+      _class.ForEachMember([this](const TClassMember& member)
+        {
+        WriteSizeCall(member);
+        });
+      }
+
+    out << Indent << "return counter.GetSize();" << std::endl;
+    out << Indent << "}" << std::endl;
+    }
+  }
+
+void TSerializableMap::WriteVisitHandlesFunction(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "void " << CurrentClassName << "::VisitHandles(AHandleVisitor&";
+
+  //members of manually dumped classes are unknown, unions have no known active member
+  if (MayContainHandles(_class) == false)
+    {
+    out << ") {}" << std::endl;
+    return;
+    }
+
+  out << " visitor)" << std::endl;
+  out << Indent << "{" << std::endl;
+
+  //Visit bases:   visitor & (TBase&)*this;
+  _class.ForEachBase([this, &out](const TClass& base)
+    {
+    if (base.NeedGenerateSerializeCode() && MayContainHandles(base))
+      out << Indent << "visitor & static_cast<" << base.GetFullName() << "&>(*this);" << std::endl;
+    });
+
+  //Visit fields:
+  _class.ForEachMember([this](const TClassMember& member)
+    {
+    WriteVisitCall(member);
+    });
+
+  out << Indent << "}" << std::endl;
+  }
+
+void TSerializableMap::WriteDumpColumnsFunction(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "void " << CurrentClassName << "::DumpColumns(ASerializeDumper& dumper, size_t count) const" << std::endl;
+  out << Indent << "{" << std::endl;
+
+  //Dump columns:   DumpColumn(dumper, this, count, &TClass::member);
+  _class.ForEachMember([this, &out](const TClassMember& member)
+    {
+    const TClass* memberClass = GetMemberClass(member.GetType());
+
+    if (memberClass == nullptr || memberClass->IsSerializable() != TYPE_DO_NOT_SERIALIZE)
+      out << Indent << "DumpColumn(dumper, this, count, &" << CurrentClassName << "::" << member.GetName() << ");" << std::endl;
+    });
+
+  out << Indent << "}" << std::endl;
+  }
+
+void TSerializableMap::WriteLoadColumnsFunction(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+  int column = 0;
+
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "void " << CurrentClassName << "::LoadColumns(ASerializeLoader& loader, size_t count, int column) "
+      << "SERIALIZE_LOAD_NOEXCEPT" << std::endl;
+  out << Indent << "{" << std::endl;
+
+  //Load columns:   LoadColumn(loader, this, count, &TClass::member, column < 0 || column == index);
+  _class.ForEachMember([this, &out, &column](const TClassMember& member)
+    {
+    const TClass* memberClass = GetMemberClass(member.GetType());
+
+    if (memberClass == nullptr || memberClass->IsSerializable() != TYPE_DO_NOT_SERIALIZE)
+      {
+      out << Indent << "LoadColumn(loader, this, count, &" << CurrentClassName << "::" << member.GetName()
+          << ", column < 0 || column == " << column++ << ");" << std::endl;
+      }
+    });
+
+  out << Indent << "}" << std::endl;
+  }
+
+void TSerializableMap::WriteTypeIdFunction(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+
+  //TYPEID_TYPE ClassName::GetTypeId() const { return ClassName_TYPE_ID; }
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "TTypeId " << CurrentClassName << "::GetTypeId() const { return "
+      << CurrentTypeIdName << "; }" << std::endl;
+  }
+
+void TSerializableMap::WriteDumpObjectPointerFunction(const TClass& _class)
+  {
+  if (_class.IsDumpPointerNeeded())
+    {
+    std::ofstream& out = CodeGenerator.Out;
+
+    if (_class.IsTemplate())
+      out << "template <> ";
+    out << "void " << CurrentClassName << "::DumpPointer(ASerializeDumper& dumper) const" << std::endl;
+    out << Indent << "{" << std::endl;
+    std::string logMsg("Dump " + CurrentClassFullName + " pointer");
+    CodeGenerator.AddLogMacro(logMsg.c_str(),"DLOGMSG");
+    out << Indent << "dumper.Dump(GetTypeId());" << std::endl;
+    out << Indent << "dumper & *this;" << std::endl;
+    out << Indent << "}" << std::endl;
+    }
+  }
+
+void TSerializableMap::WriteSerializedPointerSizeFunction(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "size_t " << CurrentClassName << "::SerializedPointerSize() const";
+
+  if (_class.IsDumpPointerNeeded())
+    out << " { return sizeof(TTypeId) + SerializedSize(); }" << std::endl;
+  else
+    {
+    //DumpPointer defined manually, so just count what it writes
+    out << std::endl;
+    out << Indent << "{" << std::endl;
+    out << Indent << "TSizeCountingDumper dumper;" << std::endl;
+    out << Indent << "DumpPointer(dumper);" << std::endl;
+    out << Indent << "return dumper.GetSize();" << std::endl;
+    out << Indent << "}" << std::endl;
+    }
+  }
+
+void TSerializableMap::WriteVisitPointerHandlesFunction(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+
+  if (_class.IsTemplate())
+    out << "template <> ";
+  out << "void " << CurrentClassName << "::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }"
+      << std::endl;
+  }
+
+void TSerializableMap::WriteLoadObjectPointerFunction(const TClass& _class)
+  {
+  if (_class.IsLoadPointerNeeded())
+    {
+    std::ofstream& out = CodeGenerator.Out;
+
+    if (_class.IsTemplate())
+      out << "template <> ";
+    out << "void* " << CurrentClassName << "::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT" << std::endl;
+    out << Indent << "{" << std::endl;
+    std::string logMsg("Load " + CurrentClassFullName + " pointer");
+    CodeGenerator.AddLogMacro(logMsg.c_str(), "LLOGMSG");
+    out << Indent << "TTypeId objectTypeId;" << std::endl
+        << Indent << "loader.Load(objectTypeId);" << std::endl
+        << Indent << CurrentClassFullName << "* o;" << std::endl;
+    out << Indent << "switch(objectTypeId)" << std::endl;
+    out << Indent2 << "{" << std::endl;
+    out << Indent2 << "case NULL_TYPE_ID:" << std::endl;
+    out << Indent3 << "o = 0;" << std::endl;
+    out << Indent3 << "break;" << std::endl;
+
+    TClassSet classCasesWritten; //keeps track of cases written to avoid duplicate cases
+    WriteCasesForDerived(_class, classCasesWritten);
+
+    out << Indent2 << "default:" << std::endl;
+    out << Indent3 << "o = 0;" << std::endl;
+    out << Indent3 << "LOAD_UNKNOWN_TYPE_ID;" << std::endl;
+    out << Indent2 << "} //end switch" << std::endl;
+    out << Indent << "return o;" << std::endl;
+    out << Indent << "} //end LoadPointer" << std::endl;
+    }
+  }
+
+void TSerializableMap::WriteTypeIdCase(const TClass& _class)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+  std::string fullName(_class.GetFullName());
+
+  out << Indent2 << "case " << GetTypeIdName(_class) << ":" << std::endl;
+
+  if (_class.HasLoadConstructor() && _class.IsLoadNeeded() && _class.IsBuildPointerNeeded())
+    {
+    //object is constructed from loader instead of BuildForSerializer followed by Load
+    out << Indent3 << "{" << std::endl;
+    out << Indent3 << fullName << "* d = new " << fullName << "(TLoadTag(), loader);" << std::endl;
+    out << Indent3 << "REGISTER_OBJECT((WRAP(" << fullName << ")), d);" << std::endl;
+    out << Indent3 << "o = d;" << std::endl;
+    out << Indent3 << "}" << std::endl;
+    }
+  else if (_class.IsVirtuallyDerived())
+    {
+    out << Indent3 << "{" << std::endl;
+    out << Indent3 << fullName << "* d = (" << fullName << "*)" << fullName;
+    if (_class.IsBuildForSerializerWithLoader())
+      out << "::BuildForSerializer(loader);";
+    else
+      out << "::BuildForSerializer();";
+    out << std::endl;
+    out << Indent3 << "loader & *d;" << std::endl;
+    out << Indent3 << "o = d;" << std::endl;
+    out << Indent3 << "}" << std::endl;
+    }
+  else
+    {
+    out    << Indent3 << "o = (" << fullName << "*)" << fullName;
+    if (_class.IsBuildForSerializerWithLoader())
+      out << "::BuildForSerializer(loader);";
+    else
+      out << "::BuildForSerializer();";
+    out << std::endl;
+    out << Indent3 << "loader & (" << fullName << "&)*o;" << std::endl;
+    }
+  out << Indent3 << "break;" << std::endl;
+  }
+
+void TSerializableMap::WriteCasesForDerived(const TClass& _class, TClassSet& classCasesWritten)
+  {
+  if (_class.NeedGenerateSerializeCode() == false)
+    return;
+
+  auto insertInfo = classCasesWritten.insert(&_class);
+
+  //Avoid duplicate case if already written (can happen in multiple-base hierarchies)
+  if (insertInfo.second == false)
+    return;
+
+  if (_class.IsAbstract() == false)
+    WriteTypeIdCase(_class);
+
+  //case for each derived type
+  _class.ForEachDerived([this,&classCasesWritten](const TClass& derived)
+    {
+    WriteCasesForDerived(derived, classCasesWritten);
+    });
+  }
+
+bool TSerializableMap::HandleArray(std::ofstream& out, std::string& indent, std::string iterator,
+  std::string& reference, const TArrayType& arrayType, const TType** type)
+  {
+  int size = arrayType.GetSize();
+  out << indent << "for (int " << iterator << " = 0; " << iterator << " < " << size
+    << "; ++" << iterator << ")" << std::endl;
+  reference += '[' + iterator + ']';
+  indent += Indent;
+
+  const TType* elemType = arrayType.GetElemType();
+
+  if (elemType->GetTypeKind() == TType::TypeArray)
+    {
+    iterator += 'i';
+    const TArrayType* arrayType = static_cast<const TArrayType*>(elemType);
+
+    return HandleArray(out, indent, iterator, reference, *arrayType, type);
+    }
+
+  *type = elemType;
+
+  return true;
+  }
+
+template <TSerializableMap::TCallKind CALL_KIND>
+void TSerializableMap::WriteCall(const TClassMember& member, const std::string& prefix,
+  const std::string& _indent)
+  {
+  std::ofstream& out = CodeGenerator.Out;
+  const TType* type = member.GetType();
+  assert(type == nullptr || type->IsTypedef() == false);
+  std::string indent(_indent);
+  std::string reference(prefix + member.GetName());
+  bool is_array = false;
+  const char* dumper_loader = GetCallTarget(CALL_KIND);
+
+  if (CALL_KIND == CALL_VISIT && MayContainHandles(type) == false)
+    return;
+
+  if (type)
+    {
+    TType::TTypeKind typeKind = type->GetTypeKind();
+
+    if (typeKind == TType::TypeArray)
+      {
+      std::string iterator("i");
+      const TArrayType* arrayType = static_cast<const TArrayType*>(type);
+
+      if (HandleArray(out, indent, iterator, reference, *arrayType, &type) == false)
         return;
 
-      is_array = true;
+      is_array = true;
+      }
+
+    if (CALL_KIND == CALL_LOAD && member.IsBitfield())
+      {
+      out << indent << '{' << std::endl;
+      out << indent << type->GetFullName() << " dummy;" << std::endl;
+      out << indent << "loader & dummy;" << std::endl;
+      out << indent << reference << " = dummy;" << std::endl;
+      out << indent << '}' << std::endl;
+      return;
+      }
+    }
+
+  if (type->GetName().empty() == false)
+    {
+    switch (type->GetTypeKind())
+      {
+      case TType::TypeClass:
+      case TType::TypeStruct:
+      case TType::TypeUnion:
+        if (static_cast<const TClass*>(type)->IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+          return;
+
+      default:
+        break;
+      }
+
+    // class, struct, enum, fundamental
+    out << indent << dumper_loader << reference << ";" << std::endl;
+    return;
+    }
+
+  const TClass* _class = static_cast<const TClass*>(type);
+  auto typeKind = type->GetTypeKind();
+  bool complex_type =
+    (typeKind == TType::TypeClass || typeKind == TType::TypeStruct || typeKind == TType::TypeUnion);
+
+  if (complex_type && is_array)
+    out << indent << '{' << std::endl;
+
+  if (reference.empty() == false)
+    reference += '.';
+
+  switch (type->GetTypeKind())
+    {
+    case TType::TypeClass:
+    case TType::TypeStruct:
+      WriteInplaceStruct<CALL_KIND>(*_class, reference, indent);
+      break;
+
+    case TType::TypeUnion:
+      WriteInplaceUnion<CALL_KIND>(*_class, reference);
+      break;
+
+    default:
+      LOG_ERROR("cannot generate code for member: " << member.GetName() << " of unnamed type");
+      ++Errors;
+      break;
+    }
+
+  if (complex_type && is_array)
+    out << indent << '}' << std::endl;
+  }
+
+template <TSerializableMap::TCallKind CALL_KIND>
+void TSerializableMap::WriteInplaceStruct(const TClass& _class, const std::string& prefix,
+  const std::string& indent)
+  {
+  if (_class.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+    return;
+
+  _class.ForEachBase([this, &_class, &prefix, &indent] (const TClass& base)
+    {
+    if (base.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+      return;
+
+    if (base.IsSerializable() == TYPE_NOT_MARKED)
+      {
+      LOG_ERROR("cannot generate code for inplace struct with non-serializable base: "
+                << (_class.GetName().empty() ? _class.GetId() : _class.GetFullName()));
+      ++Errors;
+      return;
+      }
+
+    if (prefix.empty())
+      {
+      LOG_ERROR("cannot generate code for inplace unnamed struct with base: "
+                << (_class.GetName().empty() ? _class.GetId() : _class.GetFullName()));
+      ++Errors;
+      return;
+      }
+
+    if (CALL_KIND == CALL_VISIT && MayContainHandles(base) == false)
+      return;
+
+    std::string name(prefix);
+    name.pop_back();
+
+    bool modifying = CALL_KIND == CALL_LOAD || CALL_KIND == CALL_VISIT;
+    CodeGenerator.Out << indent << GetCallTarget(CALL_KIND) << "static_cast<"
+                      << (modifying ? "" : "const ") << base.GetFullName()
+                      << "&>(" << name << ");" << std::endl;
+    });
+
+  _class.ForEachMember([this, &prefix, &indent](const TClassMember& member)
+    {
+    if (member.IsPublicAccess() == false)
+      {
+      LOG_ERROR("cannot generate code for non-public struct member: "
+                << (member.GetName().empty() ? member.GetId() : member.GetFullName()));
+      ++Errors;
+      return;
+      }
+
+    WriteCall<CALL_KIND>(member, prefix, indent);
+    });
+  }
+
+template <TSerializableMap::TCallKind CALL_KIND>
+void TSerializableMap::WriteInplaceUnion(const TClass& _class, const std::string& prefix)
+  {
+  if (_class.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+    return;
+
+  const TClassMember* biggestMember = _class.GetBiggestUnionMember();
+  if (biggestMember)
+    WriteCall<CALL_KIND>(*biggestMember, prefix);
+  }
+
+const char* TSerializableMap::GetCallTarget(TCallKind callKind)
+  {
+  switch (callKind)
+    {
+    case CALL_DUMP:
+      return "dumper & ";
+    case CALL_LOAD:
+      return "loader & ";
+    case CALL_SIZE:
+      return "counter & ";
+    case CALL_VISIT:
+      return "visitor & ";
+    }
+
+  assert(false && "Unknown call kind!");
+  return "";
+  }
+
+int TSerializableMap::GetFixedSerializedSize(const TType* type, bool rawLayout)
+  {
+  if (type == nullptr)
+    return -1;
+
+  switch (type->GetTypeKind())
+    {
+    case TType::TypeFundamental:
+      //long types are always dumped as 8 bytes (see ASerializeDumper::Dump<long>)
+      if (type->GetName() == "long int" || type->GetName() == "long unsigned int")
+        return 8;
+      return type->GetSizeof() > 0 ? type->GetSizeof() : -1;
+
+    case TType::TypeEnum:
+      return type->GetSizeof() > 0 ? type->GetSizeof() : -1;
+
+    case TType::TypeArray:
+      {
+      const TArrayType* arrayType = static_cast<const TArrayType*>(type);
+      int elemSize = GetFixedSerializedSize(arrayType->GetElemType(), rawLayout);
+      return elemSize < 0 ? -1 : elemSize * arrayType->GetSize();
+      }
+
+    case TType::TypeUnion:
+      //named unions are dumped by dumpertemplates as raw memory, inplace ones via the biggest member
+      if (type->GetName().empty() == false)
+        return type->GetSizeof() > 0 ? type->GetSizeof() : -1;
+      return GetFixedSerializedSize(*static_cast<const TClass*>(type), rawLayout);
+
+    case TType::TypeClass:
+    case TType::TypeStruct:
+      return GetFixedSerializedSize(*static_cast<const TClass*>(type), rawLayout);
+
+    default:
+      return -1;
+    }
+  }
+
+int TSerializableMap::GetFixedSerializedSize(const TClass& _class, bool rawLayout)
+  {
+  if (rawLayout && IsRawLayout(_class))
+    return _class.GetSizeof();
+
+  TClassSizes& sizes = rawLayout ? RawSizes : FixedSizes;
+  auto found = sizes.find(&_class);
+
+  if (found != sizes.end())
+    return found->second;
+
+  int size = -1;
+
+  if (_class.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+    size = 0;
+  // named classes are dumped by generated Dump only if automatically serialized, unnamed inplace
+  else if (_class.GetName().empty() || _class.IsDumpNeeded())
+    {
+    if (_class.GetTypeKind() == TType::TypeUnion)
+      {
+      const TClassMember* biggestMember = _class.GetBiggestUnionMember();
+      size = biggestMember ? GetFixedSerializedSize(biggestMember->GetType(), rawLayout) : 0;
+      }
+    else
+      {
+      size = 0;
+
+      _class.ForEachBase([this, &_class, &size, rawLayout](const TClass& base)
+        {
+        bool dumped = _class.GetName().empty() ?
+          base.IsSerializable() != TYPE_DO_NOT_SERIALIZE : base.NeedGenerateSerializeCode();
+
+        if (size < 0 || dumped == false)
+          return;
+
+        int baseSize = GetFixedSerializedSize(base, rawLayout);
+        size = baseSize < 0 ? -1 : size + baseSize;
+        });
+
+      _class.ForEachMember([this, &size, rawLayout](const TClassMember& member)
+        {
+        if (size < 0)
+          return;
+
+        int memberSize = GetFixedSerializedSize(member.GetType(), rawLayout);
+        size = memberSize < 0 ? -1 : size + memberSize;
+        });
       }
+    }
+
+  sizes[&_class] = size;
+
+  return size;
+  }
+
+bool TSerializableMap::IsRawLayout(const TClass& _class)
+  {
+  auto found = RawLayouts.find(&_class);
+
+  if (found != RawLayouts.end())
+    return found->second;
+
+  //raw copy of base subobject could overwrite members of derived class placed in its tail padding
+  bool rawLayout = _class.GetName().empty() == false && _class.IsDumpNeeded() && _class.IsLoadNeeded() &&
+    _class.IsPointerSerializable() == false && _class.IsPartOfHierarchy() == false &&
+    _class.GetTypeKind() != TType::TypeUnion && _class.GetSizeof() > 0 && GetFixedSerializedSize(_class) > 0;
+
+  _class.ForEachMember([this, &rawLayout](const TClassMember& member)
+    {
+    rawLayout = rawLayout && member.GetOffset() >= 0 && IsRawLayoutCompatible(member.GetType());
+    });
+
+  RawLayouts[&_class] = rawLayout;
+
+  return rawLayout;
+  }
+
+bool TSerializableMap::IsRawLayoutCompatible(const TType* type)
+  {
+  if (type == nullptr)
+    return false;
+
+  switch (type->GetTypeKind())
+    {
+    case TType::TypeFundamental:
+    case TType::TypeEnum:
+      return type->GetSizeof() > 0;
+
+    case TType::TypeArray:
+      return IsRawLayoutCompatible(static_cast<const TArrayType*>(type)->GetElemType());
 
-    if (DUMP_CALL == false && member.IsBitfield())
+    case TType::TypeUnion:
+    case TType::TypeClass:
+    case TType::TypeStruct:
       {
-      out << indent << '{' << std::endl;
-      out << indent << type->GetFullName() << " dummy;" << std::endl;
-      out << indent << "loader & dummy;" << std::endl;
-      out << indent << reference << " = dummy;" << std::endl;
-      out << indent << '}' << std::endl;
-      return;
+      const TClass& _class = *static_cast<const TClass*>(type);
+
+      //named unions are dumped as raw memory already, unnamed classes are dumped inplace
+      if (_class.GetName().empty() == false && type->GetTypeKind() != TType::TypeUnion)
+        return IsRawLayout(_class);
+
+      bool compatible = _class.IsSerializable() != TYPE_DO_NOT_SERIALIZE && _class.HasBases() == false;
+
+      _class.ForEachMember([this, &compatible](const TClassMember& member)
+        {
+        compatible = compatible && IsRawLayoutCompatible(member.GetType());
+        });
+
+      return compatible;
       }
+
+    default:
+      return false;
     }
+  }
 
-  if (type->GetName().empty() == false)
+unsigned TSerializableMap::GetRawLayoutFields(const TType* type, unsigned offset, TRawLayoutFields& fields)
+  {
+  switch (type->GetTypeKind())
     {
-    switch (type->GetTypeKind())
+    case TType::TypeArray:
       {
-      case TType::TypeClass:
-      case TType::TypeStruct:
-      case TType::TypeUnion:
-        if (static_cast<const TClass*>(type)->IsSerializable() == TYPE_DO_NOT_SERIALIZE)
-          return;
+      //size of array type is count of elements
+      const TArrayType* arrayType = static_cast<const TArrayType*>(type);
+      TRawLayoutFields elemFields;
+      unsigned elemSize = GetRawLayoutFields(arrayType->GetElemType(), 0, elemFields);
 
-      default:
-        break;
+      //elements without padding are one field
+      if (elemFields.size() == 1 && elemFields[0].second == elemSize)
+        fields.emplace_back(offset, elemSize * arrayType->GetSize());
+      else
+        {
+        for (int i = 0; i < arrayType->GetSize(); ++i)
+          GetRawLayoutFields(arrayType->GetElemType(), offset + i * elemSize, fields);
+        }
+      return elemSize * arrayType->GetSize();
       }
 
-    // class, struct, enum, fundamental
-    out << indent << dumper_loader << reference << ";" << std::endl;
-    return;
-    }
+    case TType::TypeClass:
+    case TType::TypeStruct:
+      static_cast<const TClass*>(type)->ForEachMember([this, offset, &fields](const TClassMember& member)
+        {
+        unsigned memberOffset = offset + member.GetOffset() / CHAR_BIT;
 
-  const TClass* _class = static_cast<const TClass*>(type);
-  auto typeKind = type->GetTypeKind();
-  bool complex_type =
-    (typeKind == TType::TypeClass || typeKind == TType::TypeStruct || TType::TypeUnion);
+        //bitfields are moved by whole storage unit of their type
+        if (member.IsBitfield())
+          {
+          unsigned size = member.GetType()->GetSizeof();
+          memberOffset = offset + member.GetOffset() / (size * CHAR_BIT) * size;
+          if (fields.empty() == false && fields.back().first == memberOffset)
+            return;
+          }
+        GetRawLayoutFields(member.GetType(), memberOffset, fields);
+        });
+      return type->GetSizeof();
 
-  if (complex_type && is_array)
-    out << indent << '{' << std::endl;
+    default:
+      //primitive types and unions are moved as a whole
+      fields.emplace_back(offset, type->GetSizeof());
+      return type->GetSizeof();
+    }
+  }
 
-  if (reference.empty() == false)
-    reference += '.';
+std::string TSerializableMap::GetLayoutDescription(const TType* type)
+  {
+  if (type == nullptr)
+    return "?";
 
   switch (type->GetTypeKind())
     {
+    case TType::TypeArray:
+      {
+      const TArrayType* arrayType = static_cast<const TArrayType*>(type);
+      return GetLayoutDescription(arrayType->GetElemType()) + '[' + std::to_string(arrayType->GetSize()) + ']';
+      }
+
+    case TType::TypeUnion:
     case TType::TypeClass:
     case TType::TypeStruct:
-      WriteInplaceStruct<DUMP_CALL>(*_class, reference, indent);
-      break;
+      {
+      //name{sizeof;member@offset=type;...}
+      std::string result(type->GetFullName() + '{' + std::to_string(type->GetSizeof()));
 
-    case TType::TypeUnion:
-      WriteInplaceUnion<DUMP_CALL>(*_class, reference);
-      break;
+      static_cast<const TClass*>(type)->ForEachMember([this, &result](const TClassMember& member)
+        {
+        result += ';' + member.GetName() + '@' + std::to_string(member.GetOffset());
+        if (member.IsBitfield())
+          result += ':' + std::to_string(member.IsBitfield());
+        result += '=' + GetLayoutDescription(member.GetType());
+        });
+
+      return result + '}';
+      }
 
     default:
-      LOG_ERROR("cannot generate code for member: " << member.GetName() << " of unnamed type");
-      ++Errors;
-      break;
+      return type->GetFullName() + '/' + std::to_string(type->GetSizeof());
     }
+  }
 
-  if (complex_type && is_array)
-    out << indent << '}' << std::endl;
+bool TSerializableMap::HasFlatView(const TClass& _class)
+  {
+  auto found = FlatViews.find(&_class);
+
+  if (found != FlatViews.end())
+    return found->second;
+
+  bool flatView = _class.GetName().empty() == false && _class.NeedGenerateSerializeCode() &&
+    _class.IsDumpNeeded() && _class.IsPartOfHierarchy() == false && _class.GetTypeKind() != TType::TypeUnion &&
+    IsAccessibleFromNamespace(_class);
+
+  //fields are named by members, unnamed classes can't be named by decltype in accessors
+  _class.ForEachMember([&flatView](const TClassMember& member)
+    {
+    const TType* type = member.GetType();
+
+    while (type && type->GetTypeKind() == TType::TypeArray)
+      type = static_cast<const TArrayType*>(type)->GetElemType();
+
+    flatView = flatView && member.GetName().empty() == false && type &&
+      (type->GetName().empty() == false || type->GetTypeKind() == TType::TypeFundamental);
+    });
+
+  FlatViews[&_class] = flatView;
+
+  return flatView;
   }
 
-template <bool DUMP_LOAD> // true for DUMP, false for LOAD
-void TSerializableMap::WriteInplaceStruct(const TClass& _class, const std::string& prefix,
-  const std::string& indent)
+bool TSerializableMap::IsColumnar(const TClass& _class)
   {
-  if (_class.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
-    return;
+  auto found = Columnars.find(&_class);
 
-  _class.ForEachBase([this, &_class, &prefix, &indent] (const TClass& base)
+  if (found != Columnars.end())
+    return found->second;
+
+  bool columnar = _class.GetName().empty() == false && _class.IsDumpNeeded() && _class.IsLoadNeeded() &&
+    _class.IsPointerSerializable() == false && _class.IsPartOfHierarchy() == false &&
+    _class.GetTypeKind() != TType::TypeUnion && _class.HasMembers() && IsAccessibleFromNamespace(_class);
+
+  //columns are addressed by pointers to members
+  _class.ForEachMember([&columnar](const TClassMember& member)
     {
-    if (base.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
-      return;
+    const TType* type = member.GetType();
 
-    if (base.IsSerializable() == TYPE_NOT_MARKED)
-      {
-      LOG_ERROR("cannot generate code for inplace struct with non-serializable base: "
-                << (_class.GetName().empty() ? _class.GetId() : _class.GetFullName()));
-      ++Errors;
-      return;
-      }
+    while (type && type->GetTypeKind() == TType::TypeArray)
+      type = static_cast<const TArrayType*>(type)->GetElemType();
 
-    if (prefix.empty())
-      {
-      LOG_ERROR("cannot generate code for inplace unnamed struct with base: "
-                << (_class.GetName().empty() ? _class.GetId() : _class.GetFullName()));
-      ++Errors;
-      return;
-      }
+    columnar = columnar && member.GetName().empty() == false && member.IsBitfield() == 0 && type &&
+      (type->GetName().empty() == false || type->GetTypeKind() == TType::TypeFundamental);
+    });
 
-    std::string name(prefix);
-    name.pop_back();
+  Columnars[&_class] = columnar;
 
-    const char* loader_dumper =
-      DUMP_LOAD ? "dumper & static_cast<const " : "loader & static_cast<";
+  return columnar;
+  }
+
+bool TSerializableMap::IsLoadConstructible(const TClass& _class)
+  {
+  //raw layout may be read at once by Load
+  bool constructible = _class.HasLoadConstructor() && _class.IsLoadNeeded() &&
+    _class.GetTypeKind() != TType::TypeUnion && IsRawLayout(_class) == false;
 
-    CodeGenerator.Out << indent << loader_dumper << base.GetFullName() << "&>(" << name << ");" << std::endl;
+  _class.ForEachBase([&constructible](const TClass& base)
+    {
+    constructible = constructible &&
+      (base.NeedGenerateSerializeCode() == false || (base.HasLoadConstructor() && base.IsLoadNeeded()));
     });
 
-  _class.ForEachMember([this, &prefix, &indent](const TClassMember& member)
+  //members are initialized in declaration order by values returned from loader
+  _class.ForEachMember([&constructible](const TClassMember& member)
     {
-    if (member.IsPublicAccess() == false)
+    const TType* type = member.GetType();
+
+    constructible = constructible && member.GetName().empty() == false && member.IsBitfield() == 0 && type &&
+      type->GetTypeKind() != TType::TypeArray &&
+      (type->GetName().empty() == false || type->GetTypeKind() == TType::TypeFundamental);
+    });
+
+  return constructible;
+  }
+
+bool TSerializableMap::IsDiffable(const TClass& _class)
+  {
+  bool diffable = _class.IsDumpNeeded() && _class.IsLoadNeeded() && _class.GetTypeKind() != TType::TypeUnion;
+
+  _class.ForEachMember([&diffable](const TClassMember& member)
+    {
+    const TType* type = member.GetType();
+
+    while (type && type->GetTypeKind() == TType::TypeArray)
+      type = static_cast<const TArrayType*>(type)->GetElemType();
+
+    diffable = diffable && member.GetName().empty() == false && member.IsBitfield() == 0 && type &&
+      (type->GetName().empty() == false || type->GetTypeKind() == TType::TypeFundamental);
+    });
+
+  return diffable;
+  }
+
+std::vector<std::string> TSerializableMap::GetDiffFields(const TClass& _class, const std::string& object,
+  bool constant)
+  {
+  std::vector<std::string> fields;
+
+  _class.ForEachBase([&fields, &object, constant](const TClass& base)
+    {
+    if (base.NeedGenerateSerializeCode())
       {
-      LOG_ERROR("cannot generate code for non-public struct member: "
-                << (member.GetName().empty() ? member.GetId() : member.GetFullName()));
-      ++Errors;
-      return;
+      fields.push_back("static_cast<" + std::string(constant ? "const " : "") + base.GetFullName() + "&>(" +
+        (object.empty() ? "*this" : object) + ")");
       }
+    });
+
+  _class.ForEachMember([&fields, &object](const TClassMember& member)
+    {
+    const TClass* memberClass = GetMemberClass(member.GetType());
 
-    WriteCall<DUMP_LOAD>(member, prefix, indent);
+    if (memberClass == nullptr || memberClass->IsSerializable() != TYPE_DO_NOT_SERIALIZE)
+      fields.push_back(object.empty() ? member.GetName() : object + "." + member.GetName());
     });
+
+  return fields;
   }
 
-template <bool DUMP_LOAD> // true for DUMP, false for LOAD
-void TSerializableMap::WriteInplaceUnion(const TClass& _class, const std::string& prefix)
+const TClass* TSerializableMap::GetMemberClass(const TType* type)
   {
-  if (_class.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
-    return;
+  while (type && type->GetTypeKind() == TType::TypeArray)
+    type = static_cast<const TArrayType*>(type)->GetElemType();
 
-  const TClassMember* biggestMember = _class.GetBiggestUnionMember();
-  if (biggestMember)
-    WriteCall<DUMP_LOAD>(*biggestMember);
+  if (type == nullptr || type->GetName().empty())
+    return nullptr;
+
+  switch (type->GetTypeKind())
+    {
+    case TType::TypeUnion:
+    case TType::TypeClass:
+    case TType::TypeStruct:
+      return static_cast<const TClass*>(type);
+
+    default:
+      return nullptr;
+    }
+  }
+
+bool TSerializableMap::MayContainHandles(const TType* type)
+  {
+  if (type == nullptr)
+    return true;
+
+  switch (type->GetTypeKind())
+    {
+    case TType::TypeFundamental:
+    case TType::TypeEnum:
+    case TType::TypePointer:
+    case TType::TypeUnion:
+      return false;
+
+    case TType::TypeArray:
+      return MayContainHandles(static_cast<const TArrayType*>(type)->GetElemType());
+
+    case TType::TypeClass:
+    case TType::TypeStruct:
+      {
+      const TClass& _class = *static_cast<const TClass*>(type);
+
+      if (_class.IsSerializable() == TYPE_DO_NOT_SERIALIZE)
+        return false;
+      //f.e. containers, strings, TSerializePtrWrapper itself
+      if (_class.GetName().empty() == false && _class.IsSerializable() == TYPE_NOT_MARKED)
+        return true;
+
+      return MayContainHandles(_class);
+      }
+
+    default:
+      return true;
+    }
+  }
+
+bool TSerializableMap::MayContainHandles(const TClass& _class)
+  {
+  auto found = HandleClasses.find(&_class);
+
+  if (found != HandleClasses.end())
+    return found->second;
+
+  bool handles = false;
+
+  if ((_class.GetName().empty() || _class.IsDumpNeeded()) && _class.GetTypeKind() != TType::TypeUnion)
+    {
+    _class.ForEachBase([this, &handles](const TClass& base)
+      {
+      handles = handles || (base.IsSerializable() != TYPE_DO_NOT_SERIALIZE && MayContainHandles(base));
+      });
+
+    _class.ForEachMember([this, &handles](const TClassMember& member)
+      {
+      handles = handles || MayContainHandles(member.GetType());
+      });
+    }
+
+  HandleClasses[&_class] = handles;
+
+  return handles;
   }
 
 #if defined(GENERATE_ENUM_OPERATORS)
@@ -872,11 +1961,8 @@ void TSerializableMap::CloseNamespaces()
   CurrentOpenedNamespaces.clear();
   }
 
-std::string TSerializableMap::GetTypeIdName(const TClass& _class)
+std::string TSerializableMap::GetIdentifierName(const TClass& _class)
   {
-  if (_class.IsAbstract() || _class.IsPartOfHierarchy() == false)
-    return "-1";
-
   std::string result(_class.GetFullName());
   const char* illegal_chars = ":<>, *&";
 
@@ -886,5 +1972,42 @@ std::string TSerializableMap::GetTypeIdName(const TClass& _class)
     result[pos] = '_';
     }
 
-  return result + "_TYPE_ID";
+  return result;
+  }
+
+std::string TSerializableMap::GetTypeIdName(const TClass& _class)
+  {
+  if (_class.IsAbstract() || _class.IsPartOfHierarchy() == false)
+    return "-1";
+
+  return GetIdentifierName(_class) + "_TYPE_ID";
+  }
+
+std::string TSerializableMap::GetFixedSizeName(const TClass& _class)
+  {
+  return GetIdentifierName(_class) + "_SERIALIZED_SIZE";
+  }
+
+std::string TSerializableMap::GetRawSizeName(const TClass& _class)
+  {
+  return GetIdentifierName(_class) + "_RAW_SERIALIZED_SIZE";
+  }
+
+std::string TSerializableMap::GetRawLayoutName(const TClass& _class)
+  {
+  return GetIdentifierName(_class) + "_RAW_LAYOUT";
+  }
+
+bool TSerializableMap::IsAccessibleFromNamespace(const TClass& _class)
+  {
+  for (const AXmlElement* element = &_class; element; element = element->GetParent())
+    {
+    if (element->GetElemKind() == AXmlElement::TypeNamespace)
+      break;
+
+    if (element->IsPublicAccess() == false)
+      return false;
+    }
+
+  return true;
   }
@@ -9,6 +9,7 @@
 
 #include <boost/filesystem.hpp>
 
+#include <map>
 #include <string>
 
 /// Main class responsible for serialization code generation based on objects created while xml analysis.
@@ -19,8 +20,20 @@ class TSerializableMap
     typedef AApplication::TClasses TClasses;
     typedef boost::filesystem::path path;
     typedef std::set<const TClass*> TClassSet;
+    typedef std::map<const TClass*, int> TClassSizes;
+    typedef std::map<const TClass*, bool> TClassFlags;
+    typedef std::vector<std::pair<unsigned, unsigned>> TRawLayoutFields; //offset and size in bytes
     typedef const std::vector<std::string> TStringCntr;
 
+    /// Kind of generated function body, selects object used at the left side of operator '&'.
+    enum TCallKind
+      {
+      CALL_DUMP,
+      CALL_LOAD,
+      CALL_SIZE,
+      CALL_VISIT
+      };
+
   public:
     TSerializableMap(const TClasses& classes, const TEnums& enums, TLogger& logger,
       const std::vector<path>& inputs, const path& working_dir, const std::string& output_prefix,
@@ -36,6 +49,10 @@ class TSerializableMap
     bool WriteParsedHeaderTypeIds();
 
     void WriteTypeIdDeclaration(const TClass& _class);
+    void WriteFixedSizeDeclaration(const TClass& _class);
+    void WriteLayoutFingerprintDeclaration();
+    void WriteFlatViewDeclarations();
+    void WriteFlatView(const TClass& _class, TClassSet& viewsWritten);
 
 #if defined(GENERATE_ENUM_OPERATORS)
     void WriteOperatorsForEnums();
@@ -52,33 +69,52 @@ class TSerializableMap
     void WriteBuildForSerializerFunction(const TClass& _class);
     void WriteDumpObjectFunction(const TClass& _class);
     void WriteLoadObjectFunction(const TClass& _class);
+    void WriteLoadConstructor(const TClass& _class);
+    void WriteHasDiffFunction(const TClass& _class);
+    void WriteDumpDiffFunction(const TClass& _class);
+    void WriteLoadPatchFunction(const TClass& _class);
+    void WriteSerializedSizeFunction(const TClass& _class);
+    void WriteVisitHandlesFunction(const TClass& _class);
+    void WriteDumpColumnsFunction(const TClass& _class);
+    void WriteLoadColumnsFunction(const TClass& _class);
     void WriteTypeIdFunction(const TClass& _class);
     void WriteDumpObjectPointerFunction(const TClass& _class);
+    void WriteSerializedPointerSizeFunction(const TClass& _class);
+    void WriteVisitPointerHandlesFunction(const TClass& _class);
     void WriteLoadObjectPointerFunction(const TClass& _class);
     void WriteTypeIdCase(const TClass& _class);
     void WriteCasesForDerived(const TClass& _class, TClassSet& classCasesWritten);
 
-    template <bool DUMP_LOAD> // true for DUMP, false for LOAD
+    template <TCallKind CALL_KIND>
     void WriteCall(const TClassMember& member, const std::string& prefix = "",
                    const std::string& _indent = Indent);
     void WriteDumpCall(const TClassMember& member)
-      { WriteCall<true>(member); }
+      { WriteCall<CALL_DUMP>(member); }
     void WriteLoadCall(const TClassMember& member)
-      { WriteCall<false>(member); }
+      { WriteCall<CALL_LOAD>(member); }
+    void WriteSizeCall(const TClassMember& member)
+      { WriteCall<CALL_SIZE>(member); }
+    void WriteVisitCall(const TClassMember& member)
+      { WriteCall<CALL_VISIT>(member); }
 
-    template <bool DUMP_LOAD> // true for DUMP, false for LOAD
+    template <TCallKind CALL_KIND>
     void WriteInplaceStruct(const TClass& _class, const std::string& prefix, const std::string& indent);
     void WriteDumpInplaceStruct(const TClass& _class, const std::string& prefix, const std::string& indent)
-      { WriteInplaceStruct<true>(_class, prefix, indent); }
+      { WriteInplaceStruct<CALL_DUMP>(_class, prefix, indent); }
     void WriteLoadInplaceStruct(const TClass& _class, const std::string& prefix, const std::string& indent)
-      { WriteInplaceStruct<false>(_class, prefix, indent); }
+      { WriteInplaceStruct<CALL_LOAD>(_class, prefix, indent); }
 
-    template <bool DUMP_LOAD> // true for DUMP, false for LOAD
+    template <TCallKind CALL_KIND>
     void WriteInplaceUnion(const TClass& _class, const std::string& prefix);
     void WriteDumpInplaceUnion(const TClass& _class, const std::string& prefix)
-      { WriteInplaceUnion<true>(_class, prefix); }
+      { WriteInplaceUnion<CALL_DUMP>(_class, prefix); }
     void WriteLoadInplaceUnion(const TClass& _class, const std::string& prefix)
-      { WriteInplaceUnion<false>(_class, prefix); }
+      { WriteInplaceUnion<CALL_LOAD>(_class, prefix); }
+    void WriteSizeInplaceUnion(const TClass& _class, const std::string& prefix)
+      { WriteInplaceUnion<CALL_SIZE>(_class, prefix); }
+
+    /// Left side of operator '&' in generated code f.e. "dumper & ".
+    static const char* GetCallTarget(TCallKind callKind);
 
     bool HandleArray(std::ofstream& out, std::string& indent, std::string iterator,
                      std::string& reference, const TArrayType& arrayType, const TType** type);
@@ -87,15 +123,76 @@ class TSerializableMap
     std::string GetTypeEnumCast(const TEnum& _enum, bool dump);
 #endif
 
+    /** Returns serialized size of type if it is the same for every object (no containers, strings
+        or manually serialized classes at any depth), -1 otherwise.
+    */
+    int GetFixedSerializedSize(const TType* type, bool rawLayout = false);
+    int GetFixedSerializedSize(const TClass& _class, bool rawLayout = false);
+
+    /** Checks if trivially copyable object of the class may be dumped as raw memory (all members
+        at any depth are primitive types, enums or such classes, no hierarchy and no pointers).
+        Serialized size is then sizeof of the class in snapshots with raw layout.
+    */
+    bool IsRawLayout(const TClass& _class);
+    bool IsRawLayoutCompatible(const TType* type);
+    /// Sizes, offsets and types of members used to compute layout fingerprint.
+    std::string GetLayoutDescription(const TType* type);
+    /** Appends offsets and sizes in bytes of primitive fields of raw layout type (nested classes
+        flattened, arrays without padding as one field), returns size of the type in bytes.
+    */
+    unsigned GetRawLayoutFields(const TType* type, unsigned offset, TRawLayoutFields& fields);
+
+    /** Checks if objects of type may contain handles of TSerializePtrWrapper, which are visited
+        by generated VisitHandles (other members are skipped there).
+    */
+    bool MayContainHandles(const TType* type);
+    bool MayContainHandles(const TClass& _class);
+
+    /** Checks if TFlatView accessor is generated for the class (named class without hierarchy
+        accessible from namespace, all members named). Types of members are checked by flat_traits
+        when the view is used.
+    */
+    bool HasFlatView(const TClass& _class);
+    /** Checks if DumpColumns/LoadColumns are generated for the class, so its vectors may be
+        stored by columns (named object-serializable class without hierarchy accessible from
+        namespace, all members named and not bitfields).
+    */
+    bool IsColumnar(const TClass& _class);
+    /** Checks if generated loading constructor initializes members directly from loader (all
+        members named and not arrays or bitfields, serializable bases with loading constructor,
+        no raw layout). Otherwise it default initializes them and calls Load.
+    */
+    bool IsLoadConstructible(const TClass& _class);
+    /** Checks if generated DumpDiff/LoadPatch diff the class by fields (generated Dump and Load,
+        not union, all members named and not bitfields). Otherwise the object is one field.
+    */
+    bool IsDiffable(const TClass& _class);
+    /// Fields of DumpDiff/LoadPatch of object (this if empty): serializable bases first, then members.
+    std::vector<std::string> GetDiffFields(const TClass& _class, const std::string& object, bool constant);
+    /// Named class of member type (arrays unwrapped), nullptr for other types.
+    static const TClass* GetMemberClass(const TType* type);
+
     void OpenNamespaces(TNamespaces&& namespaces);
     void CloseNamespaces();
 
+    static std::string GetIdentifierName(const TClass& _class);
     static std::string GetTypeIdName(const TClass& _class);
+    static std::string GetFixedSizeName(const TClass& _class);
+    static std::string GetRawSizeName(const TClass& _class);
+    static std::string GetRawLayoutName(const TClass& _class);
+    /// Checks if class name can be used outside of class scope (f.e. in template specialization).
+    static bool IsAccessibleFromNamespace(const TClass& _class);
 
   private:
     const TClasses&     Classes; //contains both auto and manually serialized classes
     const TEnums&       Enums;
     int                 TypeIdCounter = 1;
+    TClassSizes         FixedSizes; //cache for GetFixedSerializedSize
+    TClassSizes         RawSizes;   //cache for GetFixedSerializedSize with raw layout
+    TClassFlags         RawLayouts; //cache for IsRawLayout
+    TClassFlags         HandleClasses; //cache for MayContainHandles
+    TClassFlags         FlatViews;  //cache for HasFlatView
+    TClassFlags         Columnars;  //cache for IsColumnar
     TLogger&            Logger;
     bool                CheckForChanges = false;
 
@@ -113,6 +210,7 @@ class TSerializableMap
     //output file names
     path                ParsedHeaderTypeIdsFileName;
     path                InjectedFunctionsFileName;
+    std::string         OutputPrefix;
 
     TNamespaces         CurrentOpenedNamespaces;
     std::string         CurrentClassName;
@@ -3,6 +3,7 @@
 
 #include <functional>
 #include <cstring>
+#include <string>
 
 namespace std
 {
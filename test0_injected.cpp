@@ -5,6 +5,10 @@
 #include "test0.hpp"
 #include <serialize3/h/gen_code/dumpertemplates.h>
 #include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+#include <serialize3/h/gen_code/visitortemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/difftemplates.h>
 #include "test0_typeids.hpp"
 #ifndef REGISTER_OBJECT
   #define REGISTER_OBJECT(_class_,_ptr_)
@@ -29,8 +33,9 @@ void TClass::Dump(ASerializeDumper& dumper) const
     dumper & m3[i];
   DPOP_INDENT;
   }
-void TClass::Load(ASerializeLoader& loader)
+void TClass::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, TClass_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load TClass");
   loader & m1;
@@ -39,6 +44,8 @@ void TClass::Load(ASerializeLoader& loader)
     loader & m3[i];
   LPOP_INDENT;
   }
+size_t TClass::SerializedSize() const { return TClass_SERIALIZED_SIZE; }
+void TClass::VisitHandles(AHandleVisitor&) {}
 TTypeId TClass::GetTypeId() const { return -1; }
 void TClass::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -46,7 +53,9 @@ void TClass::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* TClass::LoadPointer(ASerializeLoader& loader)
+size_t TClass::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void TClass::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* TClass::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load TClass pointer");
   TTypeId objectTypeId;
@@ -62,9 +71,8 @@ void* TClass::LoadPointer(ASerializeLoader& loader)
       loader & (TClass&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -1,4 +1,53 @@
 //Auto-generated by serialize3.exe
-//Defines type ids for classes serializable via a pointer (Note: could be directly added to injected file)
+//Defines type ids for classes serializable via a pointer, sizes of fixed-size classes, layout fingerprint and flat views (Note: could be directly added to injected file)
 #pragma once
 
+#include <serialize3/h/gen_code/columntemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/rawlayouttemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+
+constexpr size_t TClass_SERIALIZED_SIZE = 20;
+template <> struct serialized_fixed_size<TClass> : public std::integral_constant<size_t, TClass_SERIALIZED_SIZE> {};
+constexpr unsigned long long test0_LAYOUT_FINGERPRINT = 0xcbf29ce484222325ULL;
+constexpr TSnapshotLayout test0_SNAPSHOT_LAYOUT = { test0_LAYOUT_FINGERPRINT, nullptr, 0 };
+template <> struct is_flat_table<TClass> : public std::true_type {};
+
+template <> class TFlatView<TClass> : public AFlatView
+  {
+  public:
+    enum : size_t
+      {
+      m1_OFFSET = FlatFieldOffset<decltype(TClass::m1)>(0),
+      m2_OFFSET = FlatFieldOffset<decltype(TClass::m2)>(m1_OFFSET + flat_traits<decltype(TClass::m1)>::SIZE),
+      m3_OFFSET = FlatFieldOffset<decltype(TClass::m3)>(m2_OFFSET + flat_traits<decltype(TClass::m2)>::SIZE),
+      SIZE = FlatTableSize(m3_OFFSET + flat_traits<decltype(TClass::m3)>::SIZE)
+      };
+
+    explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}
+
+    template <class TField = decltype(TClass::m1)>
+    flat_view_t<TField> m1() const { return flat_traits<TField>::Get(AFlatView::Table + m1_OFFSET); }
+
+    template <class TField = decltype(TClass::m2)>
+    flat_view_t<TField> m2() const { return flat_traits<TField>::Get(AFlatView::Table + m2_OFFSET); }
+
+    template <class TField = decltype(TClass::m3)>
+    flat_view_t<TField> m3() const { return flat_traits<TField>::Get(AFlatView::Table + m3_OFFSET); }
+
+    template <class TBuilder>
+    static void Build(TBuilder& builder, size_t table, const TClass& o)
+      {
+      builder.WriteField(table + m1_OFFSET, o.m1);
+      builder.WriteField(table + m2_OFFSET, o.m2);
+      builder.WriteField(table + m3_OFFSET, o.m3);
+      }
+
+    template <class TVerifier>
+    static bool Verify(TVerifier& verifier, size_t table)
+      {
+      return verifier.template VerifyField<decltype(TClass::m1)>(table + m1_OFFSET) &&
+        verifier.template VerifyField<decltype(TClass::m2)>(table + m2_OFFSET) &&
+        verifier.template VerifyField<decltype(TClass::m3)>(table + m3_OFFSET);
+      }
+  };
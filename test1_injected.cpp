@@ -5,6 +5,10 @@
 #include "test1.hpp"
 #include <serialize3/h/gen_code/dumpertemplates.h>
 #include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+#include <serialize3/h/gen_code/visitortemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/difftemplates.h>
 #include "test1_typeids.hpp"
 #ifndef REGISTER_OBJECT
   #define REGISTER_OBJECT(_class_,_ptr_)
@@ -52,8 +56,9 @@ void ABase::Dump(ASerializeDumper& dumper) const
       dumper & m4[i][ii];
   DPOP_INDENT;
   }
-void ABase::Load(ASerializeLoader& loader)
+void ABase::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, xtd__ABase_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load xtd::ABase");
   loader & m1;
@@ -64,6 +69,8 @@ void ABase::Load(ASerializeLoader& loader)
       loader & m4[i][ii];
   LPOP_INDENT;
   }
+size_t ABase::SerializedSize() const { return xtd__ABase_SERIALIZED_SIZE; }
+void ABase::VisitHandles(AHandleVisitor&) {}
 TTypeId ABase::GetTypeId() const { return -1; }
 void ABase::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -71,7 +78,9 @@ void ABase::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* ABase::LoadPointer(ASerializeLoader& loader)
+size_t ABase::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void ABase::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* ABase::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load xtd::ABase pointer");
   TTypeId objectTypeId;
@@ -94,9 +103,8 @@ void* ABase::LoadPointer(ASerializeLoader& loader)
       loader & (xtd::TMyClass1&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -112,7 +120,7 @@ void TMyClass::Dump(ASerializeDumper& dumper) const
   dumper & M4;
   DPOP_INDENT;
   }
-void TMyClass::Load(ASerializeLoader& loader)
+void TMyClass::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load xtd::TMyClass");
@@ -124,6 +132,24 @@ void TMyClass::Load(ASerializeLoader& loader)
   loader & M4;
   LPOP_INDENT;
   }
+size_t TMyClass::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & static_cast<const xtd::ABase&>(*this);
+  counter & mm1;
+  counter & M1;
+  counter & M2;
+  counter & M3;
+  counter & M4;
+  return counter.GetSize();
+  }
+void TMyClass::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & M1;
+  visitor & M2;
+  visitor & M3;
+  visitor & M4;
+  }
 TTypeId TMyClass::GetTypeId() const { return xtd__TMyClass_TYPE_ID; }
 void TMyClass::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -131,7 +157,9 @@ void TMyClass::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* TMyClass::LoadPointer(ASerializeLoader& loader)
+size_t TMyClass::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void TMyClass::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* TMyClass::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load xtd::TMyClass pointer");
   TTypeId objectTypeId;
@@ -154,9 +182,8 @@ void* TMyClass::LoadPointer(ASerializeLoader& loader)
       loader & (xtd::TMyClass1&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -168,7 +195,7 @@ template <> void TTemplate<int>::Dump(ASerializeDumper& dumper) const
   dumper & m2;
   DPOP_INDENT;
   }
-template <> void TTemplate<int>::Load(ASerializeLoader& loader)
+template <> void TTemplate<int>::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load xtd::TTemplate<int>");
@@ -176,6 +203,17 @@ template <> void TTemplate<int>::Load(ASerializeLoader& loader)
   loader & m2;
   LPOP_INDENT;
   }
+template <> size_t TTemplate<int>::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & m1;
+  counter & m2;
+  return counter.GetSize();
+  }
+template <> void TTemplate<int>::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & m2;
+  }
 template <> TTypeId TTemplate<int>::GetTypeId() const { return -1; }
 template <> void TTemplate<int>::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -183,7 +221,9 @@ template <> void TTemplate<int>::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-template <> void* TTemplate<int>::LoadPointer(ASerializeLoader& loader)
+template <> size_t TTemplate<int>::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+template <> void TTemplate<int>::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+template <> void* TTemplate<int>::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load xtd::TTemplate<int> pointer");
   TTypeId objectTypeId;
@@ -199,9 +239,8 @@ template <> void* TTemplate<int>::LoadPointer(ASerializeLoader& loader)
       loader & (xtd::TTemplate<int>&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -213,7 +252,7 @@ template <> void TTemplate<xtd::TMyClass>::Dump(ASerializeDumper& dumper) const
   dumper & m2;
   DPOP_INDENT;
   }
-template <> void TTemplate<xtd::TMyClass>::Load(ASerializeLoader& loader)
+template <> void TTemplate<xtd::TMyClass>::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load xtd::TTemplate<xtd::TMyClass>");
@@ -221,6 +260,18 @@ template <> void TTemplate<xtd::TMyClass>::Load(ASerializeLoader& loader)
   loader & m2;
   LPOP_INDENT;
   }
+template <> size_t TTemplate<xtd::TMyClass>::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & m1;
+  counter & m2;
+  return counter.GetSize();
+  }
+template <> void TTemplate<xtd::TMyClass>::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & m1;
+  visitor & m2;
+  }
 template <> TTypeId TTemplate<xtd::TMyClass>::GetTypeId() const { return -1; }
 template <> void TTemplate<xtd::TMyClass>::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -228,7 +279,9 @@ template <> void TTemplate<xtd::TMyClass>::DumpPointer(ASerializeDumper& dumper)
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-template <> void* TTemplate<xtd::TMyClass>::LoadPointer(ASerializeLoader& loader)
+template <> size_t TTemplate<xtd::TMyClass>::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+template <> void TTemplate<xtd::TMyClass>::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+template <> void* TTemplate<xtd::TMyClass>::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load xtd::TTemplate<xtd::TMyClass> pointer");
   TTypeId objectTypeId;
@@ -244,9 +297,8 @@ template <> void* TTemplate<xtd::TMyClass>::LoadPointer(ASerializeLoader& loader
       loader & (xtd::TTemplate<xtd::TMyClass>&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -275,7 +327,7 @@ void TMyClass1::Dump(ASerializeDumper& dumper) const
   dumper & M15;
   DPOP_INDENT;
   }
-void TMyClass1::Load(ASerializeLoader& loader)
+void TMyClass1::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load xtd::TMyClass1");
@@ -300,6 +352,52 @@ void TMyClass1::Load(ASerializeLoader& loader)
   loader & M15;
   LPOP_INDENT;
   }
+size_t TMyClass1::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & static_cast<const xtd::TMyClass&>(*this);
+  counter & mm1;
+  counter & mm2;
+  counter & mm3;
+  counter & M1;
+  counter & M2;
+  counter & M3;
+  counter & M4;
+  counter & M5;
+  counter & M6;
+  counter & M7;
+  counter & M8;
+  counter & M9;
+  counter & M10;
+  counter & M11;
+  counter & M12;
+  counter & M13;
+  counter & M14;
+  counter & M15;
+  return counter.GetSize();
+  }
+void TMyClass1::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & static_cast<xtd::TMyClass&>(*this);
+  visitor & mm1;
+  visitor & mm2;
+  visitor & mm3;
+  visitor & M1;
+  visitor & M2;
+  visitor & M3;
+  visitor & M4;
+  visitor & M5;
+  visitor & M6;
+  visitor & M7;
+  visitor & M8;
+  visitor & M9;
+  visitor & M10;
+  visitor & M11;
+  visitor & M12;
+  visitor & M13;
+  visitor & M14;
+  visitor & M15;
+  }
 TTypeId TMyClass1::GetTypeId() const { return xtd__TMyClass1_TYPE_ID; }
 void TMyClass1::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -307,7 +405,9 @@ void TMyClass1::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* TMyClass1::LoadPointer(ASerializeLoader& loader)
+size_t TMyClass1::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void TMyClass1::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* TMyClass1::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load xtd::TMyClass1 pointer");
   TTypeId objectTypeId;
@@ -323,9 +423,8 @@ void* TMyClass1::LoadPointer(ASerializeLoader& loader)
       loader & (xtd::TMyClass1&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
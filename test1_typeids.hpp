@@ -1,6 +1,83 @@
 //Auto-generated by serialize3.exe
-//Defines type ids for classes serializable via a pointer (Note: could be directly added to injected file)
+//Defines type ids for classes serializable via a pointer, sizes of fixed-size classes, layout fingerprint and flat views (Note: could be directly added to injected file)
 #pragma once
 
+#include <serialize3/h/gen_code/columntemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/rawlayouttemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+
 const TTypeId xtd__TMyClass_TYPE_ID = 1;
 const TTypeId xtd__TMyClass1_TYPE_ID = 2;
+constexpr size_t xtd__ABase_SERIALIZED_SIZE = 64;
+template <> struct serialized_fixed_size<xtd::ABase> : public std::integral_constant<size_t, xtd__ABase_SERIALIZED_SIZE> {};
+constexpr unsigned long long test1_LAYOUT_FINGERPRINT = 0xcbf29ce484222325ULL;
+constexpr TSnapshotLayout test1_SNAPSHOT_LAYOUT = { test1_LAYOUT_FINGERPRINT, nullptr, 0 };
+template <> struct is_flat_table<xtd::TTemplate<int>> : public std::true_type {};
+template <> struct is_flat_table<xtd::TTemplate<xtd::TMyClass>> : public std::true_type {};
+
+template <> class TFlatView<xtd::TTemplate<int>> : public AFlatView
+  {
+  public:
+    enum : size_t
+      {
+      m1_OFFSET = FlatFieldOffset<decltype(xtd::TTemplate<int>::m1)>(0),
+      m2_OFFSET = FlatFieldOffset<decltype(xtd::TTemplate<int>::m2)>(m1_OFFSET + flat_traits<decltype(xtd::TTemplate<int>::m1)>::SIZE),
+      SIZE = FlatTableSize(m2_OFFSET + flat_traits<decltype(xtd::TTemplate<int>::m2)>::SIZE)
+      };
+
+    explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}
+
+    template <class TField = decltype(xtd::TTemplate<int>::m1)>
+    flat_view_t<TField> m1() const { return flat_traits<TField>::Get(AFlatView::Table + m1_OFFSET); }
+
+    template <class TField = decltype(xtd::TTemplate<int>::m2)>
+    flat_view_t<TField> m2() const { return flat_traits<TField>::Get(AFlatView::Table + m2_OFFSET); }
+
+    template <class TBuilder>
+    static void Build(TBuilder& builder, size_t table, const xtd::TTemplate<int>& o)
+      {
+      builder.WriteField(table + m1_OFFSET, o.m1);
+      builder.WriteField(table + m2_OFFSET, o.m2);
+      }
+
+    template <class TVerifier>
+    static bool Verify(TVerifier& verifier, size_t table)
+      {
+      return verifier.template VerifyField<decltype(xtd::TTemplate<int>::m1)>(table + m1_OFFSET) &&
+        verifier.template VerifyField<decltype(xtd::TTemplate<int>::m2)>(table + m2_OFFSET);
+      }
+  };
+
+template <> class TFlatView<xtd::TTemplate<xtd::TMyClass>> : public AFlatView
+  {
+  public:
+    enum : size_t
+      {
+      m1_OFFSET = FlatFieldOffset<decltype(xtd::TTemplate<xtd::TMyClass>::m1)>(0),
+      m2_OFFSET = FlatFieldOffset<decltype(xtd::TTemplate<xtd::TMyClass>::m2)>(m1_OFFSET + flat_traits<decltype(xtd::TTemplate<xtd::TMyClass>::m1)>::SIZE),
+      SIZE = FlatTableSize(m2_OFFSET + flat_traits<decltype(xtd::TTemplate<xtd::TMyClass>::m2)>::SIZE)
+      };
+
+    explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}
+
+    template <class TField = decltype(xtd::TTemplate<xtd::TMyClass>::m1)>
+    flat_view_t<TField> m1() const { return flat_traits<TField>::Get(AFlatView::Table + m1_OFFSET); }
+
+    template <class TField = decltype(xtd::TTemplate<xtd::TMyClass>::m2)>
+    flat_view_t<TField> m2() const { return flat_traits<TField>::Get(AFlatView::Table + m2_OFFSET); }
+
+    template <class TBuilder>
+    static void Build(TBuilder& builder, size_t table, const xtd::TTemplate<xtd::TMyClass>& o)
+      {
+      builder.WriteField(table + m1_OFFSET, o.m1);
+      builder.WriteField(table + m2_OFFSET, o.m2);
+      }
+
+    template <class TVerifier>
+    static bool Verify(TVerifier& verifier, size_t table)
+      {
+      return verifier.template VerifyField<decltype(xtd::TTemplate<xtd::TMyClass>::m1)>(table + m1_OFFSET) &&
+        verifier.template VerifyField<decltype(xtd::TTemplate<xtd::TMyClass>::m2)>(table + m2_OFFSET);
+      }
+  };
@@ -5,6 +5,10 @@
 #include "test2.hpp"
 #include <serialize3/h/gen_code/dumpertemplates.h>
 #include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+#include <serialize3/h/gen_code/visitortemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/difftemplates.h>
 #include "test2_typeids.hpp"
 #ifndef REGISTER_OBJECT
   #define REGISTER_OBJECT(_class_,_ptr_)
@@ -35,7 +39,7 @@ void ABase::Dump(ASerializeDumper& dumper) const
   dumper & m1;
   dumper & m2;
   dumper & m3;
-  dumper & m3;
+  dumper & m4.m3;
   dumper & m13;
   dumper & m5.m1;
   dumper & m5.m2;
@@ -49,14 +53,15 @@ void ABase::Dump(ASerializeDumper& dumper) const
   dumper & m7.m3;
   DPOP_INDENT;
   }
-void ABase::Load(ASerializeLoader& loader)
+void ABase::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, itd__ABase_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load itd::ABase");
   loader & m1;
   loader & m2;
   loader & m3;
-  loader & m3;
+  loader & m4.m3;
   loader & m13;
   loader & m5.m1;
   loader & m5.m2;
@@ -70,6 +75,8 @@ void ABase::Load(ASerializeLoader& loader)
   loader & m7.m3;
   LPOP_INDENT;
   }
+size_t ABase::SerializedSize() const { return itd__ABase_SERIALIZED_SIZE; }
+void ABase::VisitHandles(AHandleVisitor&) {}
 TTypeId ABase::GetTypeId() const { return -1; }
 void ABase::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -77,7 +84,9 @@ void ABase::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* ABase::LoadPointer(ASerializeLoader& loader)
+size_t ABase::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void ABase::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* ABase::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load itd::ABase pointer");
   TTypeId objectTypeId;
@@ -100,9 +109,8 @@ void* ABase::LoadPointer(ASerializeLoader& loader)
       loader & (itd::TClass&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -115,7 +123,7 @@ void TBase::Dump(ASerializeDumper& dumper) const
   dumper & m102;
   DPOP_INDENT;
   }
-void TBase::Load(ASerializeLoader& loader)
+void TBase::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load itd::TBase");
@@ -124,6 +132,19 @@ void TBase::Load(ASerializeLoader& loader)
   loader & m102;
   LPOP_INDENT;
   }
+size_t TBase::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & static_cast<const itd::ABase&>(*this);
+  counter & m101;
+  counter & m102;
+  return counter.GetSize();
+  }
+void TBase::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & m101;
+  visitor & m102;
+  }
 TTypeId TBase::GetTypeId() const { return itd__TBase_TYPE_ID; }
 void TBase::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -131,7 +152,9 @@ void TBase::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* TBase::LoadPointer(ASerializeLoader& loader)
+size_t TBase::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void TBase::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* TBase::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load itd::TBase pointer");
   TTypeId objectTypeId;
@@ -154,9 +177,8 @@ void* TBase::LoadPointer(ASerializeLoader& loader)
       loader & (itd::TClass&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -171,7 +193,7 @@ void TStruct::Dump(ASerializeDumper& dumper) const
   dumper & m5;
   DPOP_INDENT;
   }
-void TStruct::Load(ASerializeLoader& loader)
+void TStruct::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load itd::TStruct");
@@ -182,6 +204,37 @@ void TStruct::Load(ASerializeLoader& loader)
   loader & m5;
   LPOP_INDENT;
   }
+size_t TStruct::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & m1;
+  counter & m2;
+  counter & m3;
+  counter & m4;
+  counter & m5;
+  return counter.GetSize();
+  }
+void TStruct::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & m4;
+  visitor & m5;
+  }
+void TStruct::DumpColumns(ASerializeDumper& dumper, size_t count) const
+  {
+  DumpColumn(dumper, this, count, &TStruct::m1);
+  DumpColumn(dumper, this, count, &TStruct::m2);
+  DumpColumn(dumper, this, count, &TStruct::m3);
+  DumpColumn(dumper, this, count, &TStruct::m4);
+  DumpColumn(dumper, this, count, &TStruct::m5);
+  }
+void TStruct::LoadColumns(ASerializeLoader& loader, size_t count, int column) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadColumn(loader, this, count, &TStruct::m1, column < 0 || column == 0);
+  LoadColumn(loader, this, count, &TStruct::m2, column < 0 || column == 1);
+  LoadColumn(loader, this, count, &TStruct::m3, column < 0 || column == 2);
+  LoadColumn(loader, this, count, &TStruct::m4, column < 0 || column == 3);
+  LoadColumn(loader, this, count, &TStruct::m5, column < 0 || column == 4);
+  }
 void TClass::Dump(ASerializeDumper& dumper) const
   {
   DPUSH_INDENT;
@@ -190,7 +243,7 @@ void TClass::Dump(ASerializeDumper& dumper) const
   dumper & mm;
   DPOP_INDENT;
   }
-void TClass::Load(ASerializeLoader& loader)
+void TClass::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LPUSH_INDENT;
   LLOGMSG("Load itd::TClass");
@@ -198,6 +251,18 @@ void TClass::Load(ASerializeLoader& loader)
   loader & mm;
   LPOP_INDENT;
   }
+size_t TClass::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & static_cast<const itd::TBase&>(*this);
+  counter & mm;
+  return counter.GetSize();
+  }
+void TClass::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & static_cast<itd::TBase&>(*this);
+  visitor & mm;
+  }
 TTypeId TClass::GetTypeId() const { return itd__TClass_TYPE_ID; }
 void TClass::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -205,7 +270,9 @@ void TClass::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* TClass::LoadPointer(ASerializeLoader& loader)
+size_t TClass::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void TClass::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* TClass::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load itd::TClass pointer");
   TTypeId objectTypeId;
@@ -221,9 +288,8 @@ void* TClass::LoadPointer(ASerializeLoader& loader)
       loader & (itd::TClass&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -236,8 +302,9 @@ void ABase::TStruct::Dump(ASerializeDumper& dumper) const
   dumper & m03;
   DPOP_INDENT;
   }
-void ABase::TStruct::Load(ASerializeLoader& loader)
+void ABase::TStruct::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, itd__ABase__TStruct_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load itd::ABase::TStruct");
   loader & m01;
@@ -245,4 +312,6 @@ void ABase::TStruct::Load(ASerializeLoader& loader)
   loader & m03;
   LPOP_INDENT;
   }
+size_t ABase::TStruct::SerializedSize() const { return itd__ABase__TStruct_SERIALIZED_SIZE; }
+void ABase::TStruct::VisitHandles(AHandleVisitor&) {}
 } // namespace itd
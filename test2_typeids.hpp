@@ -1,7 +1,70 @@
 //Auto-generated by serialize3.exe
-//Defines type ids for classes serializable via a pointer (Note: could be directly added to injected file)
+//Defines type ids for classes serializable via a pointer, sizes of fixed-size classes, layout fingerprint and flat views (Note: could be directly added to injected file)
 #pragma once
 
+#include <serialize3/h/gen_code/columntemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/rawlayouttemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+
 const TTypeId itd__TBase_TYPE_ID = 1;
 const TTypeId itd__TClass_TYPE_ID = 2;
 const TTypeId itd__ABase__TStruct_TYPE_ID = 3;
+constexpr size_t itd__ABase_SERIALIZED_SIZE = 79;
+template <> struct serialized_fixed_size<itd::ABase> : public std::integral_constant<size_t, itd__ABase_SERIALIZED_SIZE> {};
+constexpr size_t itd__ABase__TStruct_SERIALIZED_SIZE = 13;
+template <> struct serialized_columnar<itd::TStruct> : public std::true_type {};
+constexpr unsigned long long test2_LAYOUT_FINGERPRINT = 0xcbf29ce484222325ULL;
+constexpr TSnapshotLayout test2_SNAPSHOT_LAYOUT = { test2_LAYOUT_FINGERPRINT, nullptr, 0 };
+template <> struct is_flat_table<itd::TStruct> : public std::true_type {};
+
+template <> class TFlatView<itd::TStruct> : public AFlatView
+  {
+  public:
+    enum : size_t
+      {
+      m1_OFFSET = FlatFieldOffset<decltype(itd::TStruct::m1)>(0),
+      m2_OFFSET = FlatFieldOffset<decltype(itd::TStruct::m2)>(m1_OFFSET + flat_traits<decltype(itd::TStruct::m1)>::SIZE),
+      m3_OFFSET = FlatFieldOffset<decltype(itd::TStruct::m3)>(m2_OFFSET + flat_traits<decltype(itd::TStruct::m2)>::SIZE),
+      m4_OFFSET = FlatFieldOffset<decltype(itd::TStruct::m4)>(m3_OFFSET + flat_traits<decltype(itd::TStruct::m3)>::SIZE),
+      m5_OFFSET = FlatFieldOffset<decltype(itd::TStruct::m5)>(m4_OFFSET + flat_traits<decltype(itd::TStruct::m4)>::SIZE),
+      SIZE = FlatTableSize(m5_OFFSET + flat_traits<decltype(itd::TStruct::m5)>::SIZE)
+      };
+
+    explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}
+
+    template <class TField = decltype(itd::TStruct::m1)>
+    flat_view_t<TField> m1() const { return flat_traits<TField>::Get(AFlatView::Table + m1_OFFSET); }
+
+    template <class TField = decltype(itd::TStruct::m2)>
+    flat_view_t<TField> m2() const { return flat_traits<TField>::Get(AFlatView::Table + m2_OFFSET); }
+
+    template <class TField = decltype(itd::TStruct::m3)>
+    flat_view_t<TField> m3() const { return flat_traits<TField>::Get(AFlatView::Table + m3_OFFSET); }
+
+    template <class TField = decltype(itd::TStruct::m4)>
+    flat_view_t<TField> m4() const { return flat_traits<TField>::Get(AFlatView::Table + m4_OFFSET); }
+
+    template <class TField = decltype(itd::TStruct::m5)>
+    flat_view_t<TField> m5() const { return flat_traits<TField>::Get(AFlatView::Table + m5_OFFSET); }
+
+    template <class TBuilder>
+    static void Build(TBuilder& builder, size_t table, const itd::TStruct& o)
+      {
+      builder.WriteField(table + m1_OFFSET, o.m1);
+      builder.WriteField(table + m2_OFFSET, o.m2);
+      builder.WriteField(table + m3_OFFSET, o.m3);
+      builder.WriteField(table + m4_OFFSET, o.m4);
+      builder.WriteField(table + m5_OFFSET, o.m5);
+      }
+
+    template <class TVerifier>
+    static bool Verify(TVerifier& verifier, size_t table)
+      {
+      return verifier.template VerifyField<decltype(itd::TStruct::m1)>(table + m1_OFFSET) &&
+        verifier.template VerifyField<decltype(itd::TStruct::m2)>(table + m2_OFFSET) &&
+        verifier.template VerifyField<decltype(itd::TStruct::m3)>(table + m3_OFFSET) &&
+        verifier.template VerifyField<decltype(itd::TStruct::m4)>(table + m4_OFFSET) &&
+        verifier.template VerifyField<decltype(itd::TStruct::m5)>(table + m5_OFFSET);
+      }
+  };
@@ -12,6 +12,8 @@
 
 #include <serialize3/h/client_code/serialize_macros.h>
 
+#include <vector>
+
 enum class TEnum1 : char
   {
   VALUE1, VALUE2
@@ -69,6 +71,8 @@ struct TClass1
   {
   private:
     SERIALIZABLE;
+    SERIALIZABLE_LOAD_CONSTRUCTOR(TClass1);
+    SERIALIZABLE_DIFF(TClass1);
 
   public:
     TClass1() = default;
@@ -135,4 +139,26 @@ class TUnion
 
   private:
     TClass1 m;
+  };
+
+/// Trivially copyable record, stored as raw memory in snapshots with raw layout.
+struct TRecord
+  {
+  private:
+    SERIALIZABLE_OBJECT;
+
+  public:
+    int       m1;
+    TEnum1    m2;
+    double    m3;
+  };
+
+struct TRecords
+  {
+  private:
+    SERIALIZABLE_OBJECT;
+    SERIALIZABLE_DIFF(TRecords);
+
+  public:
+    std::vector<TRecord> m1;
   };
\ No newline at end of file
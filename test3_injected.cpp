@@ -5,6 +5,10 @@
 #include "test3.hpp"
 #include <serialize3/h/gen_code/dumpertemplates.h>
 #include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+#include <serialize3/h/gen_code/visitortemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/difftemplates.h>
 #include "test3_typeids.hpp"
 #ifndef REGISTER_OBJECT
   #define REGISTER_OBJECT(_class_,_ptr_)
@@ -31,24 +35,30 @@ void TUnion1::Dump(ASerializeDumper& dumper) const
   DLOGMSG("Dump TUnion1");
   dumper & m5;
   }
-void TUnion1::Load(ASerializeLoader& loader)
+void TUnion1::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, TUnion1_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load TUnion1");
   loader & m5;
   }
+size_t TUnion1::SerializedSize() const { return TUnion1_SERIALIZED_SIZE; }
+void TUnion1::VisitHandles(AHandleVisitor&) {}
 void TUnion2::Dump(ASerializeDumper& dumper) const
   {
   DPUSH_INDENT;
   DLOGMSG("Dump TUnion2");
   dumper & m2;
   }
-void TUnion2::Load(ASerializeLoader& loader)
+void TUnion2::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, TUnion2_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load TUnion2");
   loader & m2;
   }
+size_t TUnion2::SerializedSize() const { return TUnion2_SERIALIZED_SIZE; }
+void TUnion2::VisitHandles(AHandleVisitor&) {}
 void TClass1::Dump(ASerializeDumper& dumper) const
   {
   DPUSH_INDENT;
@@ -57,14 +67,56 @@ void TClass1::Dump(ASerializeDumper& dumper) const
   dumper & m2;
   DPOP_INDENT;
   }
-void TClass1::Load(ASerializeLoader& loader)
+void TClass1::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, TClass1_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load TClass1");
   loader & m1;
   loader & m2;
   LPOP_INDENT;
   }
+TClass1::TClass1(TLoadTag, ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  : TClass1(TLoadTag(), TFixedSizeLoader(loader, TClass1_SERIALIZED_SIZE))
+  {
+  }
+TClass1::TClass1(TLoadTag, TFixedSizeLoader&& loader) SERIALIZE_LOAD_NOEXCEPT
+  : m1(ConstructLoaded<decltype(m1)>(loader)),
+    m2(ConstructLoaded<decltype(m2)>(loader))
+  {
+  }
+bool TClass1::HasDiff(const TClass1& base) const
+  {
+  TDiffComparer comparer;
+  return IsDiffChanged(m1, base.m1, comparer) ||
+    IsDiffChanged(m2, base.m2, comparer);
+  }
+void TClass1::DumpDiff(const TClass1& base, ASerializeDumper& dumper) const
+  {
+  TDiffComparer comparer;
+  auto change0 = GetDiffChange(m1, base.m1, comparer);
+  auto change1 = GetDiffChange(m2, base.m2, comparer);
+  TDiffFields<2> changed;
+  changed.Set(0, change0.Changed);
+  changed.Set(1, change1.Changed);
+  changed.Dump(dumper);
+  if (changed[0])
+    DumpDiffField(dumper, m1, base.m1, change0);
+  if (changed[1])
+    DumpDiffField(dumper, m2, base.m2, change1);
+  }
+void TClass1::LoadPatch(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  TDiffFields<2> changed;
+  if (changed.Load(loader) == false)
+    return;
+  if (changed[0])
+    LoadPatchField(loader, m1);
+  if (changed[1])
+    LoadPatchField(loader, m2);
+  }
+size_t TClass1::SerializedSize() const { return TClass1_SERIALIZED_SIZE; }
+void TClass1::VisitHandles(AHandleVisitor&) {}
 TTypeId TClass1::GetTypeId() const { return -1; }
 void TClass1::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -72,7 +124,9 @@ void TClass1::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* TClass1::LoadPointer(ASerializeLoader& loader)
+size_t TClass1::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void TClass1::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* TClass1::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load TClass1 pointer");
   TTypeId objectTypeId;
@@ -84,13 +138,15 @@ void* TClass1::LoadPointer(ASerializeLoader& loader)
       o = 0;
       break;
     case -1:
-      o = (TClass1*)TClass1::BuildForSerializer();
-      loader & (TClass1&)*o;
+      {
+      TClass1* d = new TClass1(TLoadTag(), loader);
+      REGISTER_OBJECT((WRAP(TClass1)), d);
+      o = d;
+      }
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
@@ -100,7 +156,7 @@ void TClass2::Dump(ASerializeDumper& dumper) const
   DLOGMSG("Dump TClass2");
   dumper & m;
   dumper & m1;
-  dumper & m1;
+  dumper & m3.m1;
   dumper & m4;
   dumper & m5;
   dumper & m6;
@@ -115,13 +171,14 @@ void TClass2::Dump(ASerializeDumper& dumper) const
       }
   DPOP_INDENT;
   }
-void TClass2::Load(ASerializeLoader& loader)
+void TClass2::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
   {
+  TFixedSizeLoader loader(_loader, TClass2_SERIALIZED_SIZE);
   LPUSH_INDENT;
   LLOGMSG("Load TClass2");
   loader & m;
   loader & m1;
-  loader & m1;
+  loader & m3.m1;
   loader & m4;
   loader & m5;
   loader & m6;
@@ -136,6 +193,8 @@ void TClass2::Load(ASerializeLoader& loader)
       }
   LPOP_INDENT;
   }
+size_t TClass2::SerializedSize() const { return TClass2_SERIALIZED_SIZE; }
+void TClass2::VisitHandles(AHandleVisitor&) {}
 TTypeId TClass2::GetTypeId() const { return -1; }
 void TClass2::DumpPointer(ASerializeDumper& dumper) const
   {
@@ -143,7 +202,9 @@ void TClass2::DumpPointer(ASerializeDumper& dumper) const
   dumper.Dump(GetTypeId());
   dumper & *this;
   }
-void* TClass2::LoadPointer(ASerializeLoader& loader)
+size_t TClass2::SerializedPointerSize() const { return sizeof(TTypeId) + SerializedSize(); }
+void TClass2::VisitPointerHandles(AHandleVisitor& visitor) { VisitHandles(visitor); }
+void* TClass2::LoadPointer(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
   {
   LLOGMSG("Load TClass2 pointer");
   TTypeId objectTypeId;
@@ -159,9 +220,100 @@ void* TClass2::LoadPointer(ASerializeLoader& loader)
       loader & (TClass2&)*o;
       break;
     default:
-      assert(false);
       o = 0;
-      throw 1;
+      LOAD_UNKNOWN_TYPE_ID;
     } //end switch
   return o;
   } //end LoadPointer
+void TRecord::Dump(ASerializeDumper& dumper) const
+  {
+  if (DumpRawLayout(dumper, *this, TRecord_RAW_LAYOUT))
+    return;
+  DPUSH_INDENT;
+  DLOGMSG("Dump TRecord");
+  dumper & m1;
+  dumper & m2;
+  dumper & m3;
+  DPOP_INDENT;
+  }
+void TRecord::Load(ASerializeLoader& _loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  if (LoadRawLayout(_loader, *this, TRecord_RAW_LAYOUT))
+    return;
+  TFixedSizeLoader loader(_loader, TRecord_SERIALIZED_SIZE);
+  LPUSH_INDENT;
+  LLOGMSG("Load TRecord");
+  loader & m1;
+  loader & m2;
+  loader & m3;
+  LPOP_INDENT;
+  }
+size_t TRecord::SerializedSize() const { return TRecord_SERIALIZED_SIZE; }
+void TRecord::VisitHandles(AHandleVisitor&) {}
+void TRecord::DumpColumns(ASerializeDumper& dumper, size_t count) const
+  {
+  DumpColumn(dumper, this, count, &TRecord::m1);
+  DumpColumn(dumper, this, count, &TRecord::m2);
+  DumpColumn(dumper, this, count, &TRecord::m3);
+  }
+void TRecord::LoadColumns(ASerializeLoader& loader, size_t count, int column) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadColumn(loader, this, count, &TRecord::m1, column < 0 || column == 0);
+  LoadColumn(loader, this, count, &TRecord::m2, column < 0 || column == 1);
+  LoadColumn(loader, this, count, &TRecord::m3, column < 0 || column == 2);
+  }
+void TRecords::Dump(ASerializeDumper& dumper) const
+  {
+  DPUSH_INDENT;
+  DLOGMSG("Dump TRecords");
+  dumper & m1;
+  DPOP_INDENT;
+  }
+void TRecords::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LPUSH_INDENT;
+  LLOGMSG("Load TRecords");
+  loader & m1;
+  LPOP_INDENT;
+  }
+bool TRecords::HasDiff(const TRecords& base) const
+  {
+  TDiffComparer comparer;
+  return IsDiffChanged(m1, base.m1, comparer);
+  }
+void TRecords::DumpDiff(const TRecords& base, ASerializeDumper& dumper) const
+  {
+  TDiffComparer comparer;
+  auto change0 = GetDiffChange(m1, base.m1, comparer);
+  TDiffFields<1> changed;
+  changed.Set(0, change0.Changed);
+  changed.Dump(dumper);
+  if (changed[0])
+    DumpDiffField(dumper, m1, base.m1, change0);
+  }
+void TRecords::LoadPatch(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  TDiffFields<1> changed;
+  if (changed.Load(loader) == false)
+    return;
+  if (changed[0])
+    LoadPatchField(loader, m1);
+  }
+size_t TRecords::SerializedSize() const
+  {
+  TSerializedSizeCounter counter;
+  counter & m1;
+  return counter.GetSize();
+  }
+void TRecords::VisitHandles(AHandleVisitor& visitor)
+  {
+  visitor & m1;
+  }
+void TRecords::DumpColumns(ASerializeDumper& dumper, size_t count) const
+  {
+  DumpColumn(dumper, this, count, &TRecords::m1);
+  }
+void TRecords::LoadColumns(ASerializeLoader& loader, size_t count, int column) SERIALIZE_LOAD_NOEXCEPT
+  {
+  LoadColumn(loader, this, count, &TRecords::m1, column < 0 || column == 0);
+  }
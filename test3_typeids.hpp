@@ -1,4 +1,127 @@
 //Auto-generated by serialize3.exe
-//Defines type ids for classes serializable via a pointer (Note: could be directly added to injected file)
+//Defines type ids for classes serializable via a pointer, sizes of fixed-size classes, layout fingerprint and flat views (Note: could be directly added to injected file)
 #pragma once
 
+#include <serialize3/h/gen_code/columntemplates.h>
+#include <serialize3/h/gen_code/flattemplates.h>
+#include <serialize3/h/gen_code/rawlayouttemplates.h>
+#include <serialize3/h/gen_code/sizetemplates.h>
+
+constexpr size_t TUnion1_SERIALIZED_SIZE = 8;
+constexpr size_t TUnion2_SERIALIZED_SIZE = 2;
+constexpr size_t TClass1_SERIALIZED_SIZE = 16;
+template <> struct serialized_fixed_size<TClass1> : public std::integral_constant<size_t, TClass1_SERIALIZED_SIZE> {};
+constexpr size_t TClass2_SERIALIZED_SIZE = 136;
+template <> struct serialized_fixed_size<TClass2> : public std::integral_constant<size_t, TClass2_SERIALIZED_SIZE> {};
+constexpr size_t TRecord_SERIALIZED_SIZE = 13;
+template <> struct serialized_fixed_size<TRecord> : public std::integral_constant<size_t, TRecord_SERIALIZED_SIZE> {};
+constexpr TRawLayoutField TRecord_RAW_LAYOUT_FIELDS[] = { { 0, 4 }, { 4, 1 }, { 8, 8 } };
+constexpr TRawLayoutDescription TRecord_RAW_LAYOUT = { "TRecord", 16, TRecord_RAW_LAYOUT_FIELDS, 3 };
+template <> struct serialized_raw_layout<TRecord> : public std::true_type { static const TRawLayoutDescription& GetDescription() { return TRecord_RAW_LAYOUT; } };
+template <> struct serialized_columnar<TRecord> : public std::true_type {};
+template <> struct serialized_columnar<TRecords> : public std::true_type {};
+constexpr unsigned long long test3_LAYOUT_FINGERPRINT = 0x243a8d3ac30a706bULL;
+constexpr const TRawLayoutDescription* test3_RAW_LAYOUTS[] = { &TRecord_RAW_LAYOUT };
+constexpr TSnapshotLayout test3_SNAPSHOT_LAYOUT = { test3_LAYOUT_FINGERPRINT, test3_RAW_LAYOUTS, 1 };
+template <> struct is_flat_table<TClass1> : public std::true_type {};
+template <> struct is_flat_table<TRecord> : public std::true_type {};
+template <> struct is_flat_table<TRecords> : public std::true_type {};
+
+template <> class TFlatView<TClass1> : public AFlatView
+  {
+  public:
+    enum : size_t
+      {
+      m1_OFFSET = FlatFieldOffset<decltype(TClass1::m1)>(0),
+      m2_OFFSET = FlatFieldOffset<decltype(TClass1::m2)>(m1_OFFSET + flat_traits<decltype(TClass1::m1)>::SIZE),
+      SIZE = FlatTableSize(m2_OFFSET + flat_traits<decltype(TClass1::m2)>::SIZE)
+      };
+
+    explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}
+
+    template <class TField = decltype(TClass1::m1)>
+    flat_view_t<TField> m1() const { return flat_traits<TField>::Get(AFlatView::Table + m1_OFFSET); }
+
+    template <class TField = decltype(TClass1::m2)>
+    flat_view_t<TField> m2() const { return flat_traits<TField>::Get(AFlatView::Table + m2_OFFSET); }
+
+    template <class TBuilder>
+    static void Build(TBuilder& builder, size_t table, const TClass1& o)
+      {
+      builder.WriteField(table + m1_OFFSET, o.m1);
+      builder.WriteField(table + m2_OFFSET, o.m2);
+      }
+
+    template <class TVerifier>
+    static bool Verify(TVerifier& verifier, size_t table)
+      {
+      return verifier.template VerifyField<decltype(TClass1::m1)>(table + m1_OFFSET) &&
+        verifier.template VerifyField<decltype(TClass1::m2)>(table + m2_OFFSET);
+      }
+  };
+
+template <> class TFlatView<TRecord> : public AFlatView
+  {
+  public:
+    enum : size_t
+      {
+      m1_OFFSET = FlatFieldOffset<decltype(TRecord::m1)>(0),
+      m2_OFFSET = FlatFieldOffset<decltype(TRecord::m2)>(m1_OFFSET + flat_traits<decltype(TRecord::m1)>::SIZE),
+      m3_OFFSET = FlatFieldOffset<decltype(TRecord::m3)>(m2_OFFSET + flat_traits<decltype(TRecord::m2)>::SIZE),
+      SIZE = FlatTableSize(m3_OFFSET + flat_traits<decltype(TRecord::m3)>::SIZE)
+      };
+
+    explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}
+
+    template <class TField = decltype(TRecord::m1)>
+    flat_view_t<TField> m1() const { return flat_traits<TField>::Get(AFlatView::Table + m1_OFFSET); }
+
+    template <class TField = decltype(TRecord::m2)>
+    flat_view_t<TField> m2() const { return flat_traits<TField>::Get(AFlatView::Table + m2_OFFSET); }
+
+    template <class TField = decltype(TRecord::m3)>
+    flat_view_t<TField> m3() const { return flat_traits<TField>::Get(AFlatView::Table + m3_OFFSET); }
+
+    template <class TBuilder>
+    static void Build(TBuilder& builder, size_t table, const TRecord& o)
+      {
+      builder.WriteField(table + m1_OFFSET, o.m1);
+      builder.WriteField(table + m2_OFFSET, o.m2);
+      builder.WriteField(table + m3_OFFSET, o.m3);
+      }
+
+    template <class TVerifier>
+    static bool Verify(TVerifier& verifier, size_t table)
+      {
+      return verifier.template VerifyField<decltype(TRecord::m1)>(table + m1_OFFSET) &&
+        verifier.template VerifyField<decltype(TRecord::m2)>(table + m2_OFFSET) &&
+        verifier.template VerifyField<decltype(TRecord::m3)>(table + m3_OFFSET);
+      }
+  };
+
+template <> class TFlatView<TRecords> : public AFlatView
+  {
+  public:
+    enum : size_t
+      {
+      m1_OFFSET = FlatFieldOffset<decltype(TRecords::m1)>(0),
+      SIZE = FlatTableSize(m1_OFFSET + flat_traits<decltype(TRecords::m1)>::SIZE)
+      };
+
+    explicit TFlatView(const unsigned char* table = nullptr) : AFlatView(table) {}
+
+    template <class TField = decltype(TRecords::m1)>
+    flat_view_t<TField> m1() const { return flat_traits<TField>::Get(AFlatView::Table + m1_OFFSET); }
+
+    template <class TBuilder>
+    static void Build(TBuilder& builder, size_t table, const TRecords& o)
+      {
+      builder.WriteField(table + m1_OFFSET, o.m1);
+      }
+
+    template <class TVerifier>
+    static bool Verify(TVerifier& verifier, size_t table)
+      {
+      return verifier.template VerifyField<decltype(TRecords::m1)>(table + m1_OFFSET);
+      }
+  };
@@ -0,0 +1,141 @@
+//Regression test of adaptive encoding: round trip by each encoding, corrupted counts and tags
+//are rejected without allocating memory for values which are not in input.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/client_code/serialize_pushloader.h>
+#include <serialize3/h/client_code/serialize_snapshotheader.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+const size_t COUNT = 1000;
+const size_t HUGE_COUNT = static_cast<size_t>(1) << 36;
+
+/// Dumps vector by adaptive encoding, headerSize is offset of its count.
+template <class TVector>
+static std::vector<unsigned char> DumpAdaptiveVector(const TVector& values, size_t& headerSize)
+  {
+  TMemoryDumper dumper;
+  DumpSnapshotHeader(dumper, test3_LAYOUT_FINGERPRINT, TSnapshotHeader::SNAPSHOT_ADAPTIVE);
+  headerSize = dumper.GetBuffer().size();
+  dumper & values;
+  return dumper.GetBuffer();
+  }
+
+template <class TVector>
+static ASerializeLoader::TLoadError LoadAdaptiveVector(const std::vector<unsigned char>& buffer, TVector& values)
+  {
+  TMemoryLoader loader(buffer.data(), buffer.size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  loader & values;
+  if (loader.HasError() == false && loader.GetAvailableSize() != 0)
+    return ASerializeLoader::LOAD_BAD_ENCODING;
+  return loader.GetError();
+  }
+
+template <class TVector>
+static bool IsRoundTrip(const TVector& values, unsigned char tag)
+  {
+  size_t headerSize = 0;
+  std::vector<unsigned char> buffer = DumpAdaptiveVector(values, headerSize);
+  TVector loaded;
+  return buffer[headerSize + 8] == tag && LoadAdaptiveVector(buffer, loaded) == ASerializeLoader::LOAD_OK &&
+    loaded.size() == COUNT && memcmp(loaded.data(), values.data(), COUNT * sizeof(values[0])) == 0;
+  }
+
+static bool TestRoundTrip()
+  {
+  std::vector<int> raw, runs(COUNT, 42), sorted, small;
+  std::vector<double> series;
+  unsigned random = 1;
+  double value = 10;
+  for (size_t i = 0; i < COUNT; ++i)
+    {
+    random = random * 1103515245 + 12345;
+    raw.push_back(static_cast<int>(random));
+    sorted.push_back(static_cast<int>(i * 3 + random % 3));
+    small.push_back(static_cast<int>(random >> 16) % 16 - 8);
+    if (random % 3 == 0)
+      value += 0.5;
+    series.push_back(value);
+    }
+  return IsRoundTrip(raw, 0) && IsRoundTrip(runs, 1) && IsRoundTrip(sorted, 2) &&
+    IsRoundTrip(small, 3) && IsRoundTrip(series, 4);
+  }
+
+/// Count of values is set over input size for each encoding tag.
+static bool TestCorruptedCount()
+  {
+  std::vector<double> values(COUNT, 1.5);
+  size_t headerSize = 0;
+  std::vector<unsigned char> dumped = DumpAdaptiveVector(values, headerSize);
+  for (unsigned char tag = 0; tag <= 5; ++tag)
+    {
+    std::vector<unsigned char> buffer = dumped;
+    memcpy(buffer.data() + headerSize, &HUGE_COUNT, sizeof(HUGE_COUNT));
+    buffer[headerSize + 8] = tag;
+    std::vector<double> loaded;
+    if (LoadAdaptiveVector(buffer, loaded) == ASerializeLoader::LOAD_OK || loaded.empty() == false)
+      return false;
+    }
+  return true;
+  }
+
+static bool TestLengthLimit()
+  {
+  std::vector<int> values(COUNT, 42);
+  size_t headerSize = 0;
+  std::vector<unsigned char> buffer = DumpAdaptiveVector(values, headerSize);
+  TMemoryLoader loader(buffer.data(), buffer.size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  loader.SetLengthLimit(COUNT - 1);
+  std::vector<int> loaded;
+  loader & loaded;
+  return loader.GetError() == ASerializeLoader::LOAD_OVERSIZED_LENGTH && loaded.empty();
+  }
+
+//Stream loader does not know input size, so only pushed data may be allocated
+static bool TestStreamedCount()
+  {
+  for (unsigned char tag = 0; tag <= 4; ++tag)
+    {
+    unsigned char input[73];
+    memset(input, 0xff, sizeof(input));
+    memcpy(input, &HUGE_COUNT, sizeof(HUGE_COUNT));
+    input[8] = tag;
+    std::vector<double> loaded;
+    TObjectPushLoader<std::vector<double>> pushLoader(loaded);
+    pushLoader.GetLoader().SetAdaptive(true);
+    if (pushLoader.Push(input, sizeof(input)) == APushLoader::PUSH_LOAD_DONE)
+      return false;
+    }
+  return true;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "corrupted count", &TestCorruptedCount },
+      { "length limit", &TestLengthLimit },
+      { "streamed count", &TestStreamedCount }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,139 @@
+//Regression test of columnar encoding: boost vectors are encoded like std vectors, corrupted
+//element count and column sizes are rejected.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static std::vector<TRecord> MakeRecords()
+  {
+  std::vector<TRecord> records;
+  for (int i = 0; i < 100; ++i)
+    {
+    TRecord record;
+    record.m1 = i;
+    record.m2 = i % 2 != 0 ? TEnum1::VALUE2 : TEnum1::VALUE1;
+    record.m3 = i * 1.5;
+    records.push_back(record);
+    }
+  return records;
+  }
+
+template <class TVector>
+static bool IsSame(const std::vector<TRecord>& a, const TVector& b)
+  {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i)
+    {
+    if (a[i].m1 != b[i].m1 || a[i].m2 != b[i].m2 || a[i].m3 != b[i].m3)
+      return false;
+    }
+  return true;
+  }
+
+static std::vector<unsigned char> DumpColumnar(const std::vector<TRecord>& records)
+  {
+  TMemoryDumper dumper;
+  dumper.SetColumnar(true);
+  dumper & records;
+  return dumper.GetBuffer();
+  }
+
+static bool TestBoostVector()
+  {
+  std::vector<TRecord> records = MakeRecords();
+  bc::vector<TRecord> boostRecords(records.begin(), records.end());
+  const bool encodings[][2] = { { false, false }, { false, true }, { true, false }, { true, true } };
+
+  for (const auto& encoding : encodings)
+    {
+    TMemoryDumper dumper, boostDumper;
+    dumper.SetRawLayout(encoding[0]);
+    dumper.SetColumnar(encoding[1]);
+    boostDumper.SetRawLayout(encoding[0]);
+    boostDumper.SetColumnar(encoding[1]);
+    dumper & records;
+    boostDumper & boostRecords;
+
+    bc::vector<TRecord> loaded;
+    TMemoryLoader loader(boostDumper.GetBuffer().data(), boostDumper.GetBuffer().size());
+    loader.SetRawLayout(encoding[0]);
+    loader.SetColumnar(encoding[1]);
+    loader & loaded;
+    if (dumper.GetBuffer() != boostDumper.GetBuffer() || loader.HasError() || loader.GetAvailableSize() != 0 ||
+        IsSame(records, loaded) == false)
+      return false;
+    }
+  return true;
+  }
+
+/// Loads columnar dump whose size at offset is replaced, column < 0 loads all of them.
+static ASerializeLoader::TLoadError LoadCorrupted(size_t offset, unsigned long long size, int column = -1)
+  {
+  std::vector<unsigned char> dump = DumpColumnar(MakeRecords());
+  memcpy(dump.data() + offset, &size, sizeof(size));
+
+  std::vector<TRecord> loaded;
+  TMemoryLoader loader(dump.data(), dump.size());
+  loader.SetColumnar(true);
+  if (column < 0)
+    loader & loaded;
+  else
+    LoadVectorColumn(loader, loaded, column);
+  return loader.GetError();
+  }
+
+static bool TestCorruptedLengths()
+  {
+  const unsigned long long huge = static_cast<unsigned long long>(1) << 60;
+  const size_t count = 0, firstColumn = 8;
+  return LoadCorrupted(count, 100) == ASerializeLoader::LOAD_OK &&
+    LoadCorrupted(count, huge) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadCorrupted(firstColumn, 100 * sizeof(int) - 1) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadCorrupted(firstColumn, huge) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadCorrupted(firstColumn, huge, 2) == ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  }
+
+static bool TestColumn()
+  {
+  std::vector<TRecord> records = MakeRecords(), loaded;
+  std::vector<unsigned char> dump = DumpColumnar(records);
+  TMemoryLoader loader(dump.data(), dump.size());
+  loader.SetColumnar(true);
+  LoadVectorColumn(loader, loaded, 2);
+  if (loader.HasError() || loader.GetAvailableSize() != 0 || loaded.size() != records.size())
+    return false;
+  for (size_t i = 0; i < loaded.size(); ++i)
+    if (loaded[i].m3 != records[i].m3)
+      return false;
+  return true;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "boost vector", &TestBoostVector },
+      { "corrupted lengths", &TestCorruptedLengths },
+      { "column", &TestColumn }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,136 @@
+//Regression test of registry compaction: handles in registry users are remapped, released ones
+//become null and merge in sets keyed by them, compact dump loads like dump of compacted registry.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/gen_code/visitortemplates.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+
+//generated for APtrWrapper in client modules
+void APtrWrapper::Dump(ASerializeDumper& dumper) const
+  {
+  dumper & Handle;
+  }
+
+void APtrWrapper::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  loader & Handle;
+  }
+
+typedef TSerializedObjectRegistry<long long> TRegistry;
+typedef TSerializePtrWrapper<long long, long long, TRegistry> TPtr;
+
+struct TByHandle
+  {
+  bool operator()(const TPtr& a, const TPtr& b) const { return a.GetHandle() < b.GetHandle(); }
+  };
+
+/// Registers values 0, 10, ..., 90 and releases 20 and 50 (handles 3 and 6).
+static std::vector<TPtr> MakeObjects(TRegistry& registry)
+  {
+  std::vector<TPtr> ptrs;
+  for (long long i = 0; i < 10; ++i)
+    ptrs.push_back(TPtr::WrapNewObject(i * 10));
+  registry.ReleaseHandle(ptrs[2].GetHandle());
+  registry.ReleaseHandle(ptrs[5].GetHandle());
+  return ptrs;
+  }
+
+/// Checks that live pointers keep their values, released ones are null.
+static bool IsRemapped(const std::vector<TPtr>& ptrs)
+  {
+  for (size_t i = 0; i < ptrs.size(); ++i)
+    {
+    bool released = i == 2 || i == 5;
+    if (released != (ptrs[i].GetHandle() == 0) || (released == false && *ptrs[i] != static_cast<long long>(i * 10)))
+      return false;
+    }
+  return true;
+  }
+
+static bool TestCompact()
+  {
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  TRegistry::TContext context(registry);
+  std::vector<TPtr> ptrs = MakeObjects(registry);
+  std::set<TPtr, TByHandle> keys(ptrs.begin(), ptrs.end());
+  std::map<TPtr, long long, TByHandle> values;
+  for (size_t i = 0; i < ptrs.size(); ++i)
+    values[ptrs[i]] = static_cast<long long>(i);
+
+  CompactRegistry(registry, ptrs, keys, values);
+  if (registry.GetStorage().size() != 9 || IsRemapped(ptrs) == false || keys.size() != 9 || values.size() != 9)
+    return false;
+
+  //sets are ordered by remapped handles, released ones merged into null
+  size_t expected = 0;
+  for (const TPtr& key : keys)
+    {
+    if (key.GetHandle() != expected++)
+      return false;
+    }
+  for (const auto& value : values)
+    {
+    if (value.first.GetHandle() != 0 && *value.first != value.second * 10)
+      return false;
+    }
+  return TPtr::WrapNewObject(100).GetHandle() == 9;
+  }
+
+static bool TestCompactDump()
+  {
+  std::vector<TPtr> ptrs, loaded;
+  TMemoryDumper dumper;
+    {
+    TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+    TRegistry::TContext context(registry);
+    ptrs = MakeObjects(registry);
+    registry.SetCompactDump(true);
+    dumper & registry;
+    dumper & ptrs;
+    registry.SetCompactDump(false);
+    //dumped registry is not changed
+    if (registry.GetStorage().size() != 11 || registry.GetNextHandle() != ptrs[5].GetHandle())
+      return false;
+    }
+
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  TRegistry::TContext context(registry);
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader & registry;
+  loader & loaded;
+  return loader.HasError() == false && loader.GetAvailableSize() == 0 && registry.GetStorage().size() == 9 &&
+    IsRemapped(loaded);
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "compact", &TestCompact },
+      { "compact dump", &TestCompactDump }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
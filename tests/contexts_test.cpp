@@ -0,0 +1,147 @@
+//Regression test of registry contexts: context registry is used only by thread it is bound to,
+//threads load independent snapshots in parallel, load offset of context is per thread.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+//generated for APtrWrapper in client modules
+void APtrWrapper::Dump(ASerializeDumper& dumper) const
+  {
+  dumper & Handle;
+  }
+
+void APtrWrapper::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  loader & Handle;
+  }
+
+typedef TSerializedObjectRegistry<long long> TRegistry;
+typedef TSerializePtrWrapper<long long, long long, TRegistry> TPtr;
+
+const size_t THREADS = 4;
+
+static bool TestBinding()
+  {
+  TRegistry global;
+  TRegistry first(TRegistry::CONTEXT_INSTANCE), second(TRegistry::CONTEXT_INSTANCE);
+  if (TRegistry::GetInstance() != &global)
+    return false;
+
+  bool bound = true;
+    {
+    TRegistry::TContext context(first);
+    bound = TRegistry::GetInstance() == &first;
+      {
+      TRegistry::TContext nested(second);
+      bound = bound && TRegistry::GetInstance() == &second;
+      }
+    bound = bound && TRegistry::GetInstance() == &first;
+
+    //other threads still see global instance
+    std::thread other([&global, &bound]() { bound = bound && TRegistry::GetInstance() == &global; });
+    other.join();
+    }
+  return bound && TRegistry::GetInstance() == &global;
+  }
+
+static bool TestConcurrentLoads()
+  {
+  TRegistry global;
+  TPtr::WrapNewObject(-1);
+
+  std::vector<std::vector<unsigned char>> dumps(THREADS);
+  for (size_t t = 0; t < THREADS; ++t)
+    {
+    TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+    TRegistry::TContext context(registry);
+    std::vector<TPtr> ptrs;
+    for (long long i = 0; i < 1000; ++i)
+      ptrs.push_back(TPtr::WrapNewObject(static_cast<long long>(t * 1000) + i));
+    TMemoryDumper dumper;
+    dumper & registry;
+    dumper & ptrs;
+    dumps[t] = dumper.GetBuffer();
+    }
+
+  std::atomic<bool> good(true);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREADS; ++t)
+    threads.emplace_back([&dumps, &good, t]()
+      {
+      TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+      TRegistry::TContext context(registry);
+      std::vector<TPtr> loaded;
+      TMemoryLoader loader(dumps[t].data(), dumps[t].size());
+      loader & registry;
+      loader & loaded;
+      if (loader.HasError() || loaded.size() != 1000 || registry.GetStorage().size() != 1001)
+        good.store(false);
+      for (size_t i = 0; i < loaded.size(); ++i)
+        if (*loaded[i] != static_cast<long long>(t * 1000 + i))
+          good.store(false);
+      });
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return good.load() && global.GetStorage().size() == 2 && global.GetStorage()[1] == -1;
+  }
+
+static bool TestLoadOffset()
+  {
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  registry.SetLoadOffset(2);
+  TMemoryDumper dumper;
+  size_t handle = 1; //dumped like wrapper
+  dumper & handle;
+
+  size_t otherHandle = 0;
+  std::thread other([&registry, &dumper, &otherHandle]()
+    {
+    TRegistry::TContext context(registry, 10);
+    TPtr ptr;
+    TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+    loader & ptr;
+    otherHandle = ptr.GetHandle();
+    });
+  other.join();
+
+  TRegistry::TContext context(registry);
+  TPtr ptr;
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader & ptr;
+  return otherHandle == 11 && ptr.GetHandle() == 3 && registry.GetLoadOffset() == 2;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "binding", &TestBinding },
+      { "concurrent loads", &TestConcurrentLoads },
+      { "load offset", &TestLoadOffset }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,80 @@
+//Regression test of TLoadCursor: vectors of classes with raw layout are streamed object by
+//object in snapshots with raw layout, also when they are columnar.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/client_code/serialize_cursor.h>
+#include <serialize3/h/client_code/serialize_snapshotheader.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <vector>
+
+static_assert(serialized_raw_layout<TRecord>::value && serialized_columnar<TRecord>::value,
+  "TRecord must have raw layout and columnar encoding");
+
+/// Returns LOAD_OK if cursor streams the records and positions loader after them.
+static int Check(const std::vector<TRecord>& records, unsigned short flags)
+  {
+  TMemoryDumper dumper;
+  DumpSnapshotHeader(dumper, test3_LAYOUT_FINGERPRINT, flags);
+  dumper & records;
+  int tail = 12345;
+  dumper & tail;
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  TLoadCursor<std::vector<TRecord>> cursor(loader);
+  size_t i = 0;
+  for (const TRecord& record : cursor)
+    {
+    if (i >= records.size() || record.m1 != records[i].m1 || record.m2 != records[i].m2 ||
+        record.m3 != records[i].m3)
+      return -1;
+    ++i;
+    }
+  if (cursor.HasError())
+    return loader.GetError();
+
+  int loadedTail = 0;
+  loader & loadedTail;
+  return i == records.size() && loadedTail == tail && loader.GetAvailableSize() == 0 ? 0 : -1;
+  }
+
+int main()
+  {
+  std::vector<TRecord> records;
+  for (int i = 0; i < 1000; ++i)
+    {
+    TRecord record;
+    record.m1 = i;
+    record.m2 = i % 2 != 0 ? TEnum1::VALUE2 : TEnum1::VALUE1;
+    record.m3 = i * 1.5;
+    records.push_back(record);
+    }
+
+  struct
+    {
+    unsigned short Flags;
+    int            Expected;
+    } cases[] =
+    {
+      { 0, ASerializeLoader::LOAD_OK },
+      { TSnapshotHeader::SNAPSHOT_RAW_LAYOUT, ASerializeLoader::LOAD_OK },
+      { TSnapshotHeader::SNAPSHOT_RAW_LAYOUT | TSnapshotHeader::SNAPSHOT_COLUMNAR, ASerializeLoader::LOAD_OK },
+      { TSnapshotHeader::SNAPSHOT_COLUMNAR, ASerializeLoader::LOAD_BAD_ENCODING }
+    };
+
+  int failed = 0;
+  for (const auto& c : cases)
+    {
+    int result = Check(records, c.Flags);
+    if (result != c.Expected)
+      {
+      printf("failed: flags %u result %d expected %d\n", c.Flags, result, c.Expected);
+      ++failed;
+      }
+    }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,176 @@
+//Regression test of delta replication: patches by index of changed elements compared once,
+//elements without operator == compared by dumped bytes, corrupted patches are rejected.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static TRecords MakeRecords(size_t count)
+  {
+  TRecords records;
+  for (size_t i = 0; i < count; ++i)
+    {
+    TRecord record;
+    record.m1 = static_cast<int>(i);
+    record.m2 = i % 2 != 0 ? TEnum1::VALUE2 : TEnum1::VALUE1;
+    record.m3 = i * 1.5;
+    records.m1.push_back(record);
+    }
+  return records;
+  }
+
+static bool IsSame(const TRecords& a, const TRecords& b)
+  {
+  if (a.m1.size() != b.m1.size())
+    return false;
+  for (size_t i = 0; i < a.m1.size(); ++i)
+    {
+    if (a.m1[i].m1 != b.m1[i].m1 || a.m1[i].m2 != b.m1[i].m2 || a.m1[i].m3 != b.m1[i].m3)
+      return false;
+    }
+  return true;
+  }
+
+static std::vector<unsigned char> DumpDiff(const TRecords& records, const TRecords& base)
+  {
+  TMemoryDumper dumper;
+  records.DumpDiff(base, dumper);
+  return dumper.GetBuffer();
+  }
+
+/// Applies diff to copy of base, returns loader error.
+static ASerializeLoader::TLoadError LoadPatch(const std::vector<unsigned char>& diff, const TRecords& base,
+  TRecords& patched)
+  {
+  patched = base;
+  TMemoryLoader loader(diff.data(), diff.size());
+  patched.LoadPatch(loader);
+  if (loader.HasError() == false && loader.GetAvailableSize() != 0)
+    return ASerializeLoader::LOAD_BAD_ENCODING;
+  return loader.GetError();
+  }
+
+static bool TestUnchanged()
+  {
+  TRecords base = MakeRecords(100);
+  TRecords records = base, patched;
+  std::vector<unsigned char> diff = DumpDiff(records, base);
+  return records.HasDiff(base) == false && diff.size() == 1 && diff[0] == 0 &&
+    LoadPatch(diff, base, patched) == ASerializeLoader::LOAD_OK && IsSame(patched, base);
+  }
+
+static bool TestIndexPatch()
+  {
+  TRecords base = MakeRecords(100);
+  TRecords records = base, patched;
+  records.m1[3].m3 = -1;
+  records.m1[70].m1 = -1;
+  records.m1.push_back(records.m1[0]);
+  std::vector<unsigned char> diff = DumpDiff(records, base);
+
+  //bitmap, mode, size, count, 2 indexed elements and 1 appended
+  size_t expected = 1 + 1 + 3 * sizeof(unsigned long long) + 3 * sizeof(TRecord) +
+    2 * sizeof(unsigned long long);
+  return records.HasDiff(base) && diff.size() <= expected &&
+    LoadPatch(diff, base, patched) == ASerializeLoader::LOAD_OK && IsSame(patched, records);
+  }
+
+static bool TestWholePatch()
+  {
+  TRecords base = MakeRecords(100);
+  TRecords records = base, patched;
+  for (size_t i = 0; i < 60; ++i)
+    records.m1[i].m2 = TEnum1::VALUE2;
+  records.m1.resize(90);
+  return LoadPatch(DumpDiff(records, base), base, patched) == ASerializeLoader::LOAD_OK &&
+    IsSame(patched, records) && LoadPatch(DumpDiff(base, records), records, patched) == ASerializeLoader::LOAD_OK &&
+    IsSame(patched, base);
+  }
+
+static bool TestNestedContainers()
+  {
+  std::vector<std::vector<std::string>> base(10, std::vector<std::string>(10, "value"));
+  std::vector<std::vector<std::string>> strings = base;
+  strings[2][5] = "changed";
+  strings[9].push_back("appended");
+
+  TDiffComparer comparer;
+  TDiffChange<std::vector<std::vector<std::string>>> change = GetDiffChange(strings, base, comparer);
+  if (change.Changed == false || change.Elements.size() != 2 || change.Elements[0].first != 2 ||
+      change.Elements[0].second.Elements.size() != 1 || change.Elements[0].second.Elements[0].first != 5)
+    return false;
+
+  TMemoryDumper dumper;
+  DumpDiffField(dumper, strings, base, change);
+  std::vector<std::vector<std::string>> patched = base;
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  LoadPatchField(loader, patched);
+  return loader.HasError() == false && loader.GetAvailableSize() == 0 && patched == strings;
+  }
+
+static bool TestComparer()
+  {
+  TRecords base = MakeRecords(10);
+  TRecords longer = MakeRecords(11);
+  TDiffComparer comparer;
+  return comparer.IsChanged(base.m1[1], base.m1[1]) == false && comparer.IsChanged(base.m1[1], base.m1[2]) &&
+    IsDiffChangedValue(base, base) == false && IsDiffChangedValue(longer, base) &&
+    IsDiffChangedValue(base, longer) && IsDiffChangedValue(base, base, comparer) == false;
+  }
+
+static bool TestCorrupted()
+  {
+  TRecords base = MakeRecords(100);
+  TRecords records = base, patched;
+  records.m1[3].m3 = -1;
+  std::vector<unsigned char> diff = DumpDiff(records, base);
+
+  //bitmap, mode, size, count, index of changed element
+  const size_t indexOffset = 1 + 1 + 2 * sizeof(unsigned long long);
+  std::vector<unsigned char> badIndex = diff;
+  unsigned long long index = 100;
+  memcpy(badIndex.data() + indexOffset, &index, sizeof(index));
+  std::vector<unsigned char> badMode = diff;
+  badMode[1] = 7;
+  std::vector<unsigned char> truncated(diff.begin(), diff.end() - 1);
+  std::vector<unsigned char> hugeSize = diff;
+  unsigned long long size = static_cast<unsigned long long>(1) << 60;
+  memcpy(hugeSize.data() + 2, &size, sizeof(size));
+
+  return LoadPatch(badIndex, base, patched) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadPatch(badMode, base, patched) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadPatch(truncated, base, patched) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadPatch(hugeSize, base, patched) != ASerializeLoader::LOAD_OK;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "unchanged", &TestUnchanged },
+      { "index patch", &TestIndexPatch },
+      { "whole patch", &TestWholePatch },
+      { "nested containers", &TestNestedContainers },
+      { "comparer", &TestComparer },
+      { "corrupted", &TestCorrupted }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
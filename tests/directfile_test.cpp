@@ -0,0 +1,156 @@
+//Regression test of direct file dumper and loader: file has exact dumped size and content across
+//several buffers, loaded data match, truncated or missing file is reported.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/directfiledumper.h>
+#include <serialize3/h/storage/directfileloader.h>
+#include <serialize3/h/storage/memorydumper.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//small buffers, so data span many of them and all requests of queue are reused
+const size_t BUFFER_SIZE = 4096;
+const unsigned QUEUE_DEPTH = 3;
+
+struct TData
+  {
+  std::vector<int>         Integers;
+  std::vector<std::string> Strings;
+  };
+
+static TData MakeData()
+  {
+  TData data;
+  for (int i = 0; i < 100000; ++i)
+    data.Integers.push_back(i * 7);
+  for (int i = 0; i < 1000; ++i)
+    data.Strings.push_back(std::string(static_cast<size_t>(i % 50), static_cast<char>('a' + i % 26)));
+  return data;
+  }
+
+template <class TDumper>
+static void DumpData(TDumper& dumper, const TData& data)
+  {
+  dumper & data.Integers;
+  dumper & data.Strings;
+  }
+
+/// Creates unique file in working directory (tmpfs usually rejects O_DIRECT).
+static std::string MakeFileName()
+  {
+  char fileName[] = "directfile_testXXXXXX";
+  int fd = mkstemp(fileName);
+  if (fd >= 0)
+    close(fd);
+  return fileName;
+  }
+
+static std::vector<unsigned char> ReadFile(const std::string& fileName)
+  {
+  std::vector<unsigned char> content;
+  FILE* file = fopen(fileName.c_str(), "rb");
+  if (file == nullptr)
+    return content;
+  unsigned char buffer[4096];
+  for (size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) != 0;)
+    content.insert(content.end(), buffer, buffer + read);
+  fclose(file);
+  return content;
+  }
+
+static bool TestRoundTrip()
+  {
+  TData data = MakeData(), loaded;
+  TMemoryDumper memoryDumper;
+  DumpData(memoryDumper, data);
+
+  std::string fileName = MakeFileName();
+  TDirectFileDumper dumper(fileName.c_str(), BUFFER_SIZE, QUEUE_DEPTH);
+  DumpData(dumper, data);
+  bool closed = dumper.Close() && dumper.GetPosition() == memoryDumper.GetBuffer().size();
+
+  TDirectFileLoader loader(fileName.c_str(), BUFFER_SIZE, QUEUE_DEPTH);
+  loader & loaded.Integers;
+  loader & loaded.Strings;
+  bool same = ReadFile(fileName) == memoryDumper.GetBuffer();
+  unlink(fileName.c_str());
+
+  return closed && same && loader.IsOpen() && loader.HasError() == false && loader.GetAvailableSize() == 0 &&
+    loaded.Integers == data.Integers && loaded.Strings == data.Strings;
+  }
+
+static bool TestTruncated()
+  {
+  TData data = MakeData(), loaded;
+  std::string fileName = MakeFileName();
+    {
+    TDirectFileDumper dumper(fileName.c_str(), BUFFER_SIZE, QUEUE_DEPTH);
+    DumpData(dumper, data);
+    }
+  //cut inside of integers, so strings are missing too
+  bool truncated = truncate(fileName.c_str(), 10 * BUFFER_SIZE + 100) == 0;
+
+  TDirectFileLoader loader(fileName.c_str(), BUFFER_SIZE, QUEUE_DEPTH);
+  loader & loaded.Integers;
+  loader & loaded.Strings;
+  unlink(fileName.c_str());
+  return truncated && loader.GetError() == ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  }
+
+static bool TestMissingFile()
+  {
+  TDirectFileDumper dumper("missing_directory/directfile_test", BUFFER_SIZE, QUEUE_DEPTH);
+  int value = 1;
+  dumper & value;
+
+  TDirectFileLoader loader("missing_directory/directfile_test", BUFFER_SIZE, QUEUE_DEPTH);
+  loader & value;
+  return dumper.Close() == false && dumper.IsGood() == false && loader.IsOpen() == false &&
+    loader.GetError() == ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  }
+
+static bool TestEmpty()
+  {
+  std::string fileName = MakeFileName();
+  bool closed = TDirectFileDumper(fileName.c_str(), BUFFER_SIZE, QUEUE_DEPTH).Close();
+  bool empty = closed && ReadFile(fileName).empty();
+
+  int value = 1;
+  TDirectFileLoader loader(fileName.c_str(), BUFFER_SIZE, QUEUE_DEPTH);
+  loader & value;
+  unlink(fileName.c_str());
+  return empty && loader.IsOpen() && loader.GetError() == ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "truncated", &TestTruncated },
+      { "missing file", &TestMissingFile },
+      { "empty", &TestEmpty }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
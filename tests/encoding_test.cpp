@@ -0,0 +1,114 @@
+//Regression test of snapshot encodings: data round trip with each encoding flag and with all of
+//them, SerializedSize(o, dumper) is exact number of bytes dumped with encodings of dumper.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/client_code/serialize_snapshotheader.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+struct TData
+  {
+  std::vector<int>                Integers;
+  std::vector<double>             Doubles;
+  std::vector<std::string>        Strings;
+  std::set<std::string>           Keys;
+  std::map<std::string, unsigned> Map;
+  TRecords                        Records;
+  };
+
+static TData MakeData()
+  {
+  TData data;
+  for (int i = 0; i < 500; ++i)
+    {
+    data.Integers.push_back(i * 5 + i % 3);
+    data.Doubles.push_back(100.0 + (i / 4) * 0.25);
+    data.Strings.push_back("string " + std::to_string(i % 20));
+    data.Keys.insert("key/" + std::to_string(i));
+    data.Map["map/" + std::to_string(i * 3)] = static_cast<unsigned>(i);
+
+    TRecord record;
+    record.m1 = i;
+    record.m2 = i % 2 != 0 ? TEnum1::VALUE2 : TEnum1::VALUE1;
+    record.m3 = i * 1.5;
+    data.Records.m1.push_back(record);
+    }
+  return data;
+  }
+
+template <class TType>
+static bool DumpCounted(TMemoryDumper& dumper, const TType& o)
+  {
+  size_t size = SerializedSize(o, dumper);
+  size_t start = dumper.GetBuffer().size();
+  dumper & o;
+  return dumper.GetBuffer().size() - start == size;
+  }
+
+static bool IsSame(const TData& a, const TData& b)
+  {
+  if (a.Integers != b.Integers || a.Doubles != b.Doubles || a.Strings != b.Strings || a.Keys != b.Keys ||
+      a.Map != b.Map || a.Records.m1.size() != b.Records.m1.size())
+    return false;
+  for (size_t i = 0; i < a.Records.m1.size(); ++i)
+    {
+    const TRecord& x = a.Records.m1[i];
+    const TRecord& y = b.Records.m1[i];
+    if (x.m1 != y.m1 || x.m2 != y.m2 || x.m3 != y.m3)
+      return false;
+    }
+  return true;
+  }
+
+static bool Check(const TData& data, unsigned short flags)
+  {
+  TMemoryDumper dumper;
+  DumpSnapshotHeader(dumper, test3_SNAPSHOT_LAYOUT, flags);
+  bool counted = DumpCounted(dumper, data.Integers) && DumpCounted(dumper, data.Doubles) &&
+    DumpCounted(dumper, data.Strings) && DumpCounted(dumper, data.Keys) && DumpCounted(dumper, data.Map) &&
+    DumpCounted(dumper, data.Records);
+
+  TData loaded;
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  loader & loaded.Integers;
+  loader & loaded.Doubles;
+  loader & loaded.Strings;
+  loader & loaded.Keys;
+  loader & loaded.Map;
+  loader & loaded.Records;
+  return counted && loader.HasError() == false && loader.GetAvailableSize() == 0 && IsSame(loaded, data);
+  }
+
+int main()
+  {
+  TData data = MakeData();
+  const unsigned short flags[] =
+    {
+      0,
+      TSnapshotHeader::SNAPSHOT_RAW_LAYOUT,
+      TSnapshotHeader::SNAPSHOT_RAW_LAYOUT | TSnapshotHeader::SNAPSHOT_COLUMNAR,
+      TSnapshotHeader::SNAPSHOT_PACKED_INTEGERS,
+      TSnapshotHeader::SNAPSHOT_STRING_DICTIONARY,
+      TSnapshotHeader::SNAPSHOT_FRONT_CODED_STRINGS,
+      TSnapshotHeader::SNAPSHOT_XOR_FLOATS,
+      TSnapshotHeader::SNAPSHOT_ADAPTIVE,
+      TSnapshotHeader::SNAPSHOT_KNOWN_FLAGS
+    };
+
+  int failed = 0;
+  for (unsigned short f : flags)
+    if (Check(data, f) == false)
+      {
+      printf("failed: flags %u\n", f);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,78 @@
+//Regression test of TFdDumper: more iovecs than one writev batch, staged and referenced
+//writes mixed, temporary payloads of encoders.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/storage/fddumper.h>
+#include <serialize3/h/storage/memorydumper.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct TData
+  {
+  std::vector<std::string> Strings;
+  std::vector<int>         Integers;
+  };
+
+static void DumpData(ASerializeDumper& dumper, const TData& data)
+  {
+  dumper & data.Strings;
+  dumper & data.Integers;
+  dumper & data.Strings;
+  }
+
+static bool Check(const TData& data, bool packed, size_t referenceThreshold, size_t stagingSize)
+  {
+  TMemoryDumper expected;
+  expected.SetPackedIntegers(packed);
+  DumpData(expected, data);
+
+  char fileName[] = "/tmp/fddumper_test_XXXXXX";
+  int fd = mkstemp(fileName);
+  if (fd < 0)
+    return false;
+  unlink(fileName);
+
+  bool good;
+    {
+    TFdDumper dumper(fd, referenceThreshold, stagingSize);
+    dumper.SetPackedIntegers(packed);
+    DumpData(dumper, data);
+    good = dumper.Flush() && dumper.GetPosition() == expected.GetBuffer().size();
+    }
+
+  std::vector<unsigned char> written(expected.GetBuffer().size() + 1);
+  ssize_t size = pread(fd, written.data(), written.size(), 0);
+  close(fd);
+  written.resize(size < 0 ? 0 : static_cast<size_t>(size));
+  return good && written == expected.GetBuffer();
+  }
+
+int main()
+  {
+  TData data;
+  //each string is staged length followed by referenced or staged content
+  for (size_t i = 0; i < 3000; ++i)
+    data.Strings.push_back(std::string(i % 3 == 0 ? 5000 + i : i % 100, static_cast<char>('a' + i % 26)));
+  for (int i = 0; i < 100000; ++i)
+    data.Integers.push_back(i * 7);
+
+  int failed = 0;
+  for (bool packed : { false, true })
+    for (size_t threshold : { 64, 4096 })
+      for (size_t staging : { 64, 1 << 16 })
+        if (Check(data, packed, threshold, staging) == false)
+          {
+          printf("failed: packed %d threshold %zu staging %zu\n", packed, threshold, staging);
+          ++failed;
+          }
+  return failed == 0 ? 0 : 1;
+  }
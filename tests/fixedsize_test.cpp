@@ -0,0 +1,150 @@
+//Regression test of fixed-size loading: object is read from underlying loader at once, nested
+//objects take their part of it, truncated input is reported at any cut.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/// Loader which doesn't know its size, counts reads.
+class TStreamLoader : public ASerializeLoader
+  {
+  public:
+    explicit TStreamLoader(const std::vector<unsigned char>& data) : Data(data), Position(0), Reads(0) {}
+
+    size_t GetReads() const { return Reads; }
+
+    virtual void Log(const char*) override {}
+
+    virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+      {
+      size_t size = std::min(bufferLen, Data.size() - Position);
+      if (size != 0)
+        memcpy(buffer, Data.data() + Position, size);
+      memset(buffer + size, 0, bufferLen - size);
+      Position += size;
+      ++Reads;
+      if (size < bufferLen)
+        SetError(LOAD_TRUNCATED_INPUT);
+      }
+
+  private:
+    const std::vector<unsigned char>& Data;
+    size_t                            Position;
+    size_t                            Reads;
+  };
+
+static std::vector<TRecord> MakeRecords()
+  {
+  std::vector<TRecord> records;
+  for (int i = 0; i < 100; ++i)
+    {
+    TRecord record;
+    record.m1 = i;
+    record.m2 = i % 2 != 0 ? TEnum1::VALUE2 : TEnum1::VALUE1;
+    record.m3 = i * 1.5;
+    records.push_back(record);
+    }
+  return records;
+  }
+
+static bool IsSame(const std::vector<TRecord>& a, const std::vector<TRecord>& b)
+  {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i)
+    {
+    if (a[i].m1 != b[i].m1 || a[i].m2 != b[i].m2 || a[i].m3 != b[i].m3)
+      return false;
+    }
+  return true;
+  }
+
+static bool TestRecords()
+  {
+  std::vector<TRecord> records = MakeRecords(), loaded, streamLoaded;
+  TMemoryDumper dumper;
+  dumper & records[0];
+  if (dumper.GetBuffer().size() != TRecord_SERIALIZED_SIZE)
+    return false;
+  dumper.GetBuffer().clear();
+  dumper & records;
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader & loaded;
+  TStreamLoader streamLoader(dumper.GetBuffer());
+  streamLoader & streamLoaded;
+  return loader.HasError() == false && loader.GetAvailableSize() == 0 && IsSame(records, loaded) &&
+    streamLoader.HasError() == false && IsSame(records, streamLoaded);
+  }
+
+/// Nested fixed-size objects (TClass1 in TClass2) are read by single read of whole object.
+static bool TestNested()
+  {
+  std::vector<unsigned char> dump(TClass2_SERIALIZED_SIZE);
+  for (size_t i = 0; i < dump.size(); ++i)
+    dump[i] = static_cast<unsigned char>(i * 7);
+
+  TClass2 o, streamLoaded;
+  TMemoryLoader loader(dump.data(), dump.size());
+  loader & o;
+  TStreamLoader streamLoader(dump);
+  streamLoader & streamLoaded;
+
+  TMemoryDumper dumper, streamDumper;
+  dumper & o;
+  streamDumper & streamLoaded;
+  return loader.HasError() == false && loader.GetAvailableSize() == 0 && dumper.GetBuffer() == dump &&
+    streamLoader.HasError() == false && streamLoader.GetReads() == 1 && streamDumper.GetBuffer() == dump;
+  }
+
+static bool TestTruncated()
+  {
+  std::vector<TRecord> records = MakeRecords();
+  records.resize(3);
+  TMemoryDumper dumper;
+  dumper & records;
+
+  //every cut, so objects are cut at each of their members
+  for (size_t size = 0; size < dumper.GetBuffer().size(); ++size)
+    {
+    std::vector<unsigned char> dump(dumper.GetBuffer().begin(), dumper.GetBuffer().begin() + size);
+    std::vector<TRecord> loaded, streamLoaded;
+    TMemoryLoader loader(dump.data(), dump.size());
+    loader & loaded;
+    TStreamLoader streamLoader(dump);
+    streamLoader & streamLoaded;
+    if (loader.GetError() != ASerializeLoader::LOAD_TRUNCATED_INPUT ||
+        streamLoader.GetError() != ASerializeLoader::LOAD_TRUNCATED_INPUT)
+      return false;
+    }
+  return true;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "records", &TestRecords },
+      { "nested", &TestNested },
+      { "truncated", &TestTruncated }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,162 @@
+//Regression test of flat format: views read built buffer, buffer streamed to dumper in sections
+//is the same, corrupted references and unterminated strings are rejected by verification.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/storage/mappedfile.h>
+#include <serialize3/h/storage/memorydumper.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static TRecords MakeRecords(size_t count)
+  {
+  TRecords records;
+  for (size_t i = 0; i < count; ++i)
+    {
+    TRecord record;
+    record.m1 = static_cast<int>(i);
+    record.m2 = i % 2 != 0 ? TEnum1::VALUE2 : TEnum1::VALUE1;
+    record.m3 = i * 1.5;
+    records.m1.push_back(record);
+    }
+  return records;
+  }
+
+static bool IsSame(const TRecords& records, TFlatView<TRecords> view)
+  {
+  if (view.IsNull() || view.m1().size() != records.m1.size())
+    return false;
+  for (size_t i = 0; i < records.m1.size(); ++i)
+    {
+    TFlatView<TRecord> record = view.m1()[i];
+    if (record.m1() != records.m1[i].m1 || record.m2() != records.m1[i].m2 || record.m3() != records.m1[i].m3)
+      return false;
+    }
+  return true;
+  }
+
+static std::vector<unsigned char> BuildFlat(const TRecords& records)
+  {
+  TFlatBuilder builder;
+  builder.Build(records);
+  return builder.GetBuffer();
+  }
+
+static bool TestRoundTrip()
+  {
+  TRecords records = MakeRecords(1000), empty;
+  std::vector<unsigned char> buffer = BuildFlat(records), emptyBuffer = BuildFlat(empty);
+  return IsSame(records, GetFlatRoot<TRecords>(buffer.data(), buffer.size())) &&
+    IsSame(empty, GetFlatRoot<TRecords>(emptyBuffer.data(), emptyBuffer.size()));
+  }
+
+static bool TestSections()
+  {
+  TRecords records = MakeRecords(1000);
+  std::vector<unsigned char> buffer = BuildFlat(records);
+  TMemoryDumper dumper;
+  TFlatBuilder builder(&dumper, 256);
+  builder.Build(records);
+  if (dumper.GetBuffer() != buffer || builder.GetBuffer().size() >= buffer.size())
+    return false;
+
+  DumpFlat(dumper, records);
+  return dumper.GetBuffer().size() == 2 * buffer.size() &&
+    memcmp(dumper.GetBuffer().data() + buffer.size(), buffer.data(), buffer.size()) == 0;
+  }
+
+static bool TestMappedFile()
+  {
+  TRecords records = MakeRecords(1000);
+  std::vector<unsigned char> buffer = BuildFlat(records);
+  char fileName[] = "/tmp/flat_testXXXXXX";
+  int fd = mkstemp(fileName);
+  if (fd < 0)
+    return false;
+  bool written = write(fd, buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+  close(fd);
+
+  TMappedFile file(fileName);
+  unlink(fileName);
+  return written && file.IsOpen() && IsSame(records, GetFlatRoot<TRecords>(file.GetData(), file.GetSize()));
+  }
+
+/// Returns true if buffer with value at offset replaced is rejected.
+static bool IsRejected(size_t offset, unsigned long long value)
+  {
+  std::vector<unsigned char> buffer = BuildFlat(MakeRecords(10));
+  memcpy(buffer.data() + offset, &value, sizeof(value));
+  return GetFlatRoot<TRecords>(buffer.data(), buffer.size()).IsNull();
+  }
+
+static bool TestCorrupted()
+  {
+  std::vector<unsigned char> buffer = BuildFlat(MakeRecords(10));
+  const size_t root = sizeof(TFlatHeader), count = root + offsetof(TFlatRef, Count);
+  const unsigned long long huge = static_cast<unsigned long long>(1) << 60;
+
+  //aligned copy shifted by one byte
+  std::vector<unsigned long long> aligned(buffer.size() / 8 + 1);
+  unsigned char* unaligned = reinterpret_cast<unsigned char*>(aligned.data()) + 1;
+  memcpy(unaligned, buffer.data(), buffer.size());
+
+  return GetFlatRoot<TRecords>(buffer.data(), buffer.size() - 1).IsNull() &&
+    GetFlatRoot<TRecords>(unaligned, buffer.size()).IsNull() &&
+    IsRejected(offsetof(TFlatHeader, Size), 8) &&
+    IsRejected(offsetof(TFlatHeader, RootOffset), buffer.size()) &&
+    IsRejected(root, huge) && IsRejected(root, 4) && IsRejected(count, 11) && IsRejected(count, huge) &&
+    IsRejected(count, huge / TFlatView<TRecord>::SIZE + 1) && IsRejected(count, 10) == false;
+  }
+
+/// Verifies string built alone, replaces its terminator and length at first.
+static bool IsStringValid(const std::string& s, char terminator, unsigned long long length)
+  {
+  TFlatBuilder builder;
+  size_t slot = builder.Allocate(sizeof(TFlatRef), 8);
+  builder.WriteField(slot, s);
+  std::vector<unsigned char> buffer = builder.GetBuffer();
+  buffer.back() = static_cast<unsigned char>(terminator);
+  memcpy(buffer.data() + slot + offsetof(TFlatRef, Count), &length, sizeof(length));
+
+  TFlatVerifier verifier(buffer.data(), buffer.size());
+  return verifier.VerifyField<std::string>(slot) &&
+    flat_traits<std::string>::Get(buffer.data() + slot) == s.substr(0, static_cast<size_t>(length));
+  }
+
+static bool TestStrings()
+  {
+  return IsStringValid("flat", 0, 4) && IsStringValid("", 0, 0) && IsStringValid("flat", 'x', 4) == false &&
+    IsStringValid("flat", 0, 5) == false && IsStringValid("flat", 0, 3) == false &&
+    IsStringValid("flat", 0, static_cast<unsigned long long>(-1)) == false;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "sections", &TestSections },
+      { "mapped file", &TestMappedFile },
+      { "corrupted", &TestCorrupted },
+      { "strings", &TestStrings }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
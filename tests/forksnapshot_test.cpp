@@ -0,0 +1,116 @@
+//Regression test of TForkSnapshot: child dumps state frozen at fork while parent modifies it,
+//failed snapshots leave neither snapshot nor temporary file.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/client_code/serialize_forksnapshot.h>
+#include <serialize3/h/storage/memorydumper.h>
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::string MakeDirectory()
+  {
+  char directory[] = "/tmp/forksnapshot_test_XXXXXX";
+  return mkdtemp(directory) != nullptr ? directory : std::string();
+  }
+
+static bool Exists(const std::string& fileName)
+  {
+  struct stat st;
+  return stat(fileName.c_str(), &st) == 0;
+  }
+
+static std::vector<unsigned char> ReadFile(const std::string& fileName)
+  {
+  std::vector<unsigned char> data;
+  FILE* file = fopen(fileName.c_str(), "rb");
+  if (file == nullptr)
+    return data;
+  unsigned char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) != 0)
+    data.insert(data.end(), buffer, buffer + size);
+  fclose(file);
+  return data;
+  }
+
+static bool TestFrozenState()
+  {
+  std::string directory = MakeDirectory();
+  std::string fileName = directory + "/snapshot.bin";
+  std::vector<int> state(1 << 20, 1);
+  TMemoryDumper expected;
+  expected & state;
+
+  TForkSnapshot snapshot(4096);
+  auto dump = [&state] (ASerializeDumper& dumper) { dumper & state; };
+  if (directory.empty() || snapshot.Start(fileName.c_str(), dump) == false || snapshot.GetChildPid() <= 0 ||
+      snapshot.Start(fileName.c_str(), dump))
+    return false;
+
+  //pages modified by parent are copied, child still sees values from the moment of fork
+  for (int& value : state)
+    value = 2;
+  snapshot.Poll();
+  bool good = snapshot.Wait() == TForkSnapshot::SNAPSHOT_SUCCEEDED &&
+    snapshot.GetWritten() == expected.GetBuffer().size() && ReadFile(fileName) == expected.GetBuffer() &&
+    Exists(fileName + ".tmp") == false;
+  unlink(fileName.c_str());
+  rmdir(directory.c_str());
+  return good;
+  }
+
+static bool TestFailures()
+  {
+  std::string directory = MakeDirectory();
+  std::string fileName = directory + "/snapshot.bin";
+  TForkSnapshot snapshot;
+
+  //exception thrown by dump doesn't reach code of parent in child
+  bool thrown = snapshot.Start(fileName.c_str(), [] (ASerializeDumper& dumper)
+    {
+    dumper.Dump(1);
+    throw std::runtime_error("dump failed");
+    }) && snapshot.Wait() == TForkSnapshot::SNAPSHOT_FAILED;
+
+  std::string missing = directory + "/missing/snapshot.bin";
+  bool unwritable = snapshot.Start(missing.c_str(), [] (ASerializeDumper& dumper) { dumper.Dump(1); }) &&
+    snapshot.Wait() == TForkSnapshot::SNAPSHOT_FAILED;
+
+  bool good = directory.empty() == false && thrown && unwritable && Exists(fileName) == false &&
+    Exists(fileName + ".tmp") == false;
+  rmdir(directory.c_str());
+  return good;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "frozen state", &TestFrozenState },
+      { "failures", &TestFailures }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
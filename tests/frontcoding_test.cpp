@@ -0,0 +1,98 @@
+//Regression test of front coded strings: round trip of sets and maps, corrupted prefix and
+//suffix lengths are rejected without allocating memory for them.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+#include <serialize3/h/storage/varuint.h>
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+static std::set<std::string> MakeKeys()
+  {
+  std::set<std::string> keys;
+  for (int i = 0; i < 100; ++i)
+    keys.insert("key/" + std::to_string(i * 7) + (i % 3 == 0 ? "/long suffix" : ""));
+  keys.insert("");
+  return keys;
+  }
+
+static bool TestRoundTrip()
+  {
+  std::set<std::string> keys = MakeKeys(), loadedKeys;
+  std::map<std::string, int> map, loadedMap;
+  for (const std::string& key : keys)
+    map[key] = static_cast<int>(key.size());
+
+  TMemoryDumper dumper;
+  dumper.SetFrontCodedStrings(true);
+  dumper & keys;
+  dumper & map;
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader.SetFrontCodedStrings(true);
+  loader & loadedKeys;
+  loader & loadedMap;
+  return loader.HasError() == false && loader.GetAvailableSize() == 0 && loadedKeys == keys && loadedMap == map;
+  }
+
+/// Loads set of one key dumped as { prefix }, suffix length, suffix "abc".
+static ASerializeLoader::TLoadError LoadKeys(unsigned long long interval, unsigned long long prefix,
+  unsigned long long suffix, size_t lengthLimit = static_cast<size_t>(-1))
+  {
+  TMemoryDumper dumper;
+  dumper.DumpSizeT(2);
+  DumpVarUInt(dumper, interval);
+  DumpVarUInt(dumper, 1);
+  dumper.WriteBuffer(reinterpret_cast<const unsigned char*>("a"), 1);
+  DumpVarUInt(dumper, prefix);
+  DumpVarUInt(dumper, suffix);
+  dumper.WriteBuffer(reinterpret_cast<const unsigned char*>("abc"), 3);
+
+  std::set<std::string> keys;
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader.SetFrontCodedStrings(true);
+  loader.SetLengthLimit(lengthLimit);
+  loader & keys;
+  return loader.GetError();
+  }
+
+static bool TestCorruptedLengths()
+  {
+  return LoadKeys(16, 1, 3) == ASerializeLoader::LOAD_OK &&
+    LoadKeys(0, 1, 3) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadKeys(16, 2, 3) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadKeys(16, 1, static_cast<unsigned long long>(1) << 60) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadKeys(16, 1, 3, 3) == ASerializeLoader::LOAD_OVERSIZED_LENGTH;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "corrupted lengths", &TestCorruptedLengths }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,158 @@
+//Regression test of in-place loading of lists and maps: elements are not copied or moved,
+//values of keys present already are read but kept, with packed and front coded keys too.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+/// Counts copies and moves of values.
+struct TValue
+  {
+  static size_t Transfers;
+
+  TValue(const std::string& data = std::string()) : Data(data) {}
+  TValue(const TValue& other) : Data(other.Data) { ++Transfers; }
+  TValue(TValue&& other) : Data(std::move(other.Data)) { ++Transfers; }
+  TValue& operator=(const TValue& other) { Data = other.Data; ++Transfers; return *this; }
+  TValue& operator=(TValue&& other) { Data = std::move(other.Data); ++Transfers; return *this; }
+
+  bool operator==(const TValue& other) const { return Data == other.Data; }
+
+  std::string Data;
+  };
+
+size_t TValue::Transfers = 0;
+
+void operator&(ASerializeDumper& dumper, const TValue& v)
+  {
+  dumper & v.Data;
+  }
+
+void operator&(ASerializeLoader& loader, TValue& v) SERIALIZE_LOAD_NOEXCEPT
+  {
+  loader & v.Data;
+  }
+
+/// Dumps source and loads it into target with keys encoded as given, returns false on error.
+template <class TSource, class TTarget>
+static bool DumpLoad(const TSource& source, TTarget& target, bool encoded = false)
+  {
+  TMemoryDumper dumper;
+  dumper.SetPackedIntegers(encoded);
+  dumper.SetFrontCodedStrings(encoded);
+  dumper & source;
+
+  TValue::Transfers = 0;
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader.SetPackedIntegers(encoded);
+  loader.SetFrontCodedStrings(encoded);
+  loader & target;
+  return loader.HasError() == false && loader.GetAvailableSize() == 0;
+  }
+
+static bool TestList()
+  {
+  std::list<TValue> list, loaded;
+  for (int i = 0; i < 100; ++i)
+    list.emplace_back(std::to_string(i));
+  return DumpLoad(list, loaded) && TValue::Transfers == 0 && loaded == list;
+  }
+
+template <class TMap>
+static bool IsMapLoaded(bool encoded)
+  {
+  TMap map, loaded;
+  for (int i = 0; i < 100; ++i)
+    map.emplace(static_cast<typename TMap::key_type>(i * 3), TValue(std::to_string(i)));
+  return DumpLoad(map, loaded, encoded) && TValue::Transfers == 0 && loaded == map;
+  }
+
+static bool TestMaps()
+  {
+  return IsMapLoaded<std::map<int, TValue>>(false) && IsMapLoaded<std::map<int, TValue>>(true) &&
+    IsMapLoaded<std::map<long long, TValue>>(true) && IsMapLoaded<std::unordered_map<int, TValue>>(false) &&
+    IsMapLoaded<std::multimap<int, TValue>>(true);
+  }
+
+static bool TestStringKeys()
+  {
+  std::map<std::string, TValue> map;
+  for (int i = 0; i < 100; ++i)
+    map.emplace("key " + std::to_string(i), TValue(std::to_string(i)));
+
+  std::map<std::string, TValue> loaded, loadedCoded;
+  return DumpLoad(map, loaded) && TValue::Transfers == 0 && loaded == map &&
+    DumpLoad(map, loadedCoded, true) && TValue::Transfers == 0 && loadedCoded == map;
+  }
+
+/// Loads keys 1 and 2 into map with key 1, multimap gets both values of key 1.
+template <class TMap>
+static bool IsExistingKept(bool encoded, size_t expectedSize)
+  {
+  TMap map, loaded;
+  map.emplace(1, TValue("new"));
+  map.emplace(2, TValue("b"));
+  loaded.emplace(1, TValue("old"));
+  if (DumpLoad(map, loaded, encoded) == false || loaded.size() != expectedSize)
+    return false;
+
+  auto range = loaded.equal_range(1);
+  return range.first->second.Data == "old" && loaded.find(2)->second.Data == "b" &&
+    (expectedSize == 2 || std::next(range.first)->second.Data == "new");
+  }
+
+static bool TestExistingKeys()
+  {
+  return IsExistingKept<std::map<int, TValue>>(false, 2) && IsExistingKept<std::map<int, TValue>>(true, 2) &&
+    IsExistingKept<std::unordered_map<int, TValue>>(false, 2) &&
+    IsExistingKept<std::multimap<int, TValue>>(false, 3) && IsExistingKept<std::multimap<int, TValue>>(true, 3);
+  }
+
+static bool TestTruncated()
+  {
+  std::map<int, TValue> map, loaded;
+  for (int i = 0; i < 100; ++i)
+    map.emplace(i, TValue(std::to_string(i)));
+  TMemoryDumper dumper;
+  dumper & map;
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size() / 2);
+  loader & loaded;
+  return loader.GetError() == ASerializeLoader::LOAD_TRUNCATED_INPUT && loaded.size() < map.size();
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "list", &TestList },
+      { "maps", &TestMaps },
+      { "string keys", &TestStringKeys },
+      { "existing keys", &TestExistingKeys },
+      { "truncated", &TestTruncated }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,89 @@
+//Regression test of generated loading constructors: fixed-size object is acquired at once like by
+//Load, errors of its window reach the loader, objects match those loaded by Load.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+/// Counts reads of members, which are not expected from window of fixed-size object.
+class TCountingLoader : public TMemoryLoader
+  {
+  public:
+    TCountingLoader(const unsigned char* data, size_t size) : TMemoryLoader(data, size), Reads(0), Acquires(0) {}
+
+    virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+      {
+      ++Reads;
+      TMemoryLoader::ReadBuffer(buffer, bufferLen);
+      }
+
+    virtual const unsigned char* AcquireBuffer(size_t bufferLen) override
+      {
+      ++Acquires;
+      return TMemoryLoader::AcquireBuffer(bufferLen);
+      }
+
+    size_t Reads;
+    size_t Acquires;
+  };
+
+static std::vector<unsigned char> MakeInput()
+  {
+  std::vector<unsigned char> input(TClass1_SERIALIZED_SIZE);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<unsigned char>(i + 1);
+  return input;
+  }
+
+static bool TestWindow()
+  {
+  std::vector<unsigned char> input = MakeInput();
+  TCountingLoader loader(input.data(), input.size());
+  TClass1 constructed = ConstructLoaded<TClass1>(loader);
+
+  TClass1 loaded;
+  TMemoryLoader plainLoader(input.data(), input.size());
+  plainLoader & loaded;
+
+  TMemoryDumper constructedDump, loadedDump;
+  constructedDump & constructed;
+  loadedDump & loaded;
+  return loader.HasError() == false && loader.GetAvailableSize() == 0 && loader.Acquires == 1 &&
+    loader.Reads == 0 && constructedDump.GetBuffer() == loadedDump.GetBuffer();
+  }
+
+static bool TestTruncated()
+  {
+  std::vector<unsigned char> input = MakeInput();
+  input.pop_back();
+  TMemoryLoader loader(input.data(), input.size());
+  std::unique_ptr<TClass1> constructed(NewLoaded<TClass1>(loader, is_load_constructible<TClass1>()));
+  return loader.GetError() == ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "window", &TestWindow },
+      { "truncated", &TestTruncated }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
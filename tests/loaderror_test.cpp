@@ -0,0 +1,105 @@
+//Regression test of load errors: corrupted lengths of containers are rejected before memory is
+//allocated for them, first error is kept, length limit.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/random_access_index.hpp>
+#include <boost/multi_index_container.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef boost::multi_index_container<int,
+  bmi::indexed_by<bmi::random_access<>, bmi::ordered_non_unique<bmi::identity<int>>>> TIndexed;
+
+const unsigned long long HUGE_LENGTH = static_cast<unsigned long long>(1) << 60;
+
+/// Loads object from its dump whose leading length is replaced by HUGE_LENGTH.
+template <class TObject>
+static ASerializeLoader::TLoadError LoadHugeLength(const TObject& object, TObject& loaded)
+  {
+  TMemoryDumper dumper;
+  dumper & object;
+  std::vector<unsigned char> buffer = dumper.GetBuffer();
+  memcpy(buffer.data(), &HUGE_LENGTH, sizeof(HUGE_LENGTH));
+
+  TMemoryLoader loader(buffer.data(), buffer.size());
+  loader & loaded;
+  return loader.GetError();
+  }
+
+static bool TestHugeLength()
+  {
+  std::vector<int> vector(10, 1), loadedVector;
+  std::string string(10, 'a'), loadedString;
+  std::map<int, int> map = { { 1, 2 }, { 3, 4 } }, loadedMap;
+  TIndexed indexed, loadedIndexed;
+  for (int i = 0; i < 10; ++i)
+    indexed.push_back(i);
+
+  return LoadHugeLength(vector, loadedVector) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadHugeLength(string, loadedString) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadHugeLength(map, loadedMap) != ASerializeLoader::LOAD_OK &&
+    LoadHugeLength(indexed, loadedIndexed) == ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  }
+
+static bool TestIndexedRoundTrip()
+  {
+  TIndexed indexed, loaded;
+  for (int i = 0; i < 100; ++i)
+    indexed.push_back(100 - i);
+  TMemoryDumper dumper;
+  dumper & indexed;
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader & loaded;
+  return loader.HasError() == false && loaded.size() == indexed.size() &&
+    std::equal(loaded.begin(), loaded.end(), indexed.begin());
+  }
+
+static bool TestFirstErrorKept()
+  {
+  std::vector<int> vector(10, 1), loaded;
+  TMemoryDumper dumper;
+  dumper & vector;
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader.SetLengthLimit(5);
+  loader & loaded;
+  loader & loaded; //reads past end
+  return loader.GetError() == ASerializeLoader::LOAD_OVERSIZED_LENGTH && loaded.empty();
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "huge length", &TestHugeLength },
+      { "indexed round trip", &TestIndexedRoundTrip },
+      { "first error kept", &TestFirstErrorKept }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,147 @@
+//Regression test of MergeLoadSnapshots: handle ranges of merged snapshots, corrupted registry
+//sizes are rejected before storage is resized, storage gets its size back on failure.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/client_code/serialize_mergeload.h>
+#include <serialize3/h/storage/memorydumper.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+typedef TSerializedObjectRegistry<long long> TRegistry;
+
+const size_t SNAPSHOTS = 3;
+
+/// Snapshot i holds registry of (i + 1) * 100 values followed by their handles.
+static std::vector<unsigned char> MakeSnapshot(size_t i)
+  {
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  std::vector<TRegistry::THandle> handles;
+  for (size_t j = 0; j < (i + 1) * 100; ++j)
+    handles.push_back(registry.AddToRegistry(static_cast<long long>(i * 1000 + j)));
+
+  TMemoryDumper dumper;
+  dumper & registry;
+  dumper & handles;
+  return dumper.GetBuffer();
+  }
+
+static bool WriteFile(std::string& fileName, const std::vector<unsigned char>& content)
+  {
+  char name[] = "/tmp/mergeload_test_XXXXXX";
+  int fd = mkstemp(name);
+  if (fd < 0)
+    return false;
+  fileName = name;
+  bool good = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+  close(fd);
+  return good;
+  }
+
+/// Merges snapshots, corrupt may change content of the last one.
+static ASerializeLoader::TLoadError MergeLoad(TRegistry& registry,
+  void (*corrupt)(std::vector<unsigned char>&), std::vector<std::vector<TRegistry::THandle>>& handles)
+  {
+  std::vector<std::string> fileNames(SNAPSHOTS);
+  bool written = true;
+  for (size_t i = 0; i < SNAPSHOTS; ++i)
+    {
+    std::vector<unsigned char> snapshot = MakeSnapshot(i);
+    if (corrupt != nullptr && i == SNAPSHOTS - 1)
+      corrupt(snapshot);
+    written = WriteFile(fileNames[i], snapshot) && written;
+    }
+
+  handles.assign(SNAPSHOTS, std::vector<TRegistry::THandle>());
+  ASerializeLoader::TLoadError error = ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  if (written)
+    error = MergeLoadSnapshots(registry, fileNames,
+      [&handles](ASerializeLoader& loader, size_t i) { loader & handles[i]; }, 2);
+  for (const std::string& fileName : fileNames)
+    unlink(fileName.c_str());
+  return error;
+  }
+
+static bool TestMerge()
+  {
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  registry.AddToRegistry(-1);
+  std::vector<std::vector<TRegistry::THandle>> handles;
+  if (MergeLoad(registry, nullptr, handles) != ASerializeLoader::LOAD_OK ||
+      registry.GetStorage().size() != 2 + 100 + 200 + 300 || registry.GetStorage()[1] != -1)
+    return false;
+
+  //snapshots get handle ranges in their order after existing objects
+  size_t offset = 1;
+  for (size_t i = 0; i < SNAPSHOTS; ++i)
+    {
+    if (handles[i].size() != (i + 1) * 100)
+      return false;
+    for (size_t j = 0; j < handles[i].size(); ++j)
+      if (registry.GetStorage()[offset + handles[i][j]] != static_cast<long long>(i * 1000 + j))
+        return false;
+    offset += handles[i].size();
+    }
+  return true;
+  }
+
+static void SetHugeSize(std::vector<unsigned char>& snapshot)
+  {
+  unsigned long long size = static_cast<unsigned long long>(1) << 60;
+  memcpy(snapshot.data(), &size, sizeof(size));
+  }
+
+static void Truncate(std::vector<unsigned char>& snapshot)
+  {
+  snapshot.resize(snapshot.size() / 2);
+  }
+
+static bool TestHugeSize()
+  {
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  registry.AddToRegistry(-1);
+  std::vector<std::vector<TRegistry::THandle>> handles;
+  return MergeLoad(registry, &SetHugeSize, handles) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    registry.GetStorage().size() == 2;
+  }
+
+static bool TestTruncated()
+  {
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  registry.AddToRegistry(-1);
+  std::vector<std::vector<TRegistry::THandle>> handles;
+  return MergeLoad(registry, &Truncate, handles) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    registry.GetStorage().size() == 2 && registry.GetStorage()[1] == -1;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "merge", &TestMerge },
+      { "huge size", &TestHugeSize },
+      { "truncated", &TestTruncated }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
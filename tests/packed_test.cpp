@@ -0,0 +1,128 @@
+//Regression test of packed integers: round trip of vectors, sets and maps, corrupted payload
+//sizes are rejected without allocating memory for them, also when input size is unknown.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+//---------- TStreamLoader
+//Loader which doesn't know size of its input, like loaders of pipes and sockets.
+class TStreamLoader : public ASerializeLoader
+  {
+  public:
+    explicit TStreamLoader(const std::vector<unsigned char>& data) : Data(data), Position(0) {}
+
+    virtual void Log(const char*) override {}
+
+    virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+      {
+      size_t size = std::min(bufferLen, Data.size() - Position);
+      memcpy(buffer, Data.data() + Position, size);
+      memset(buffer + size, 0, bufferLen - size);
+      Position += size;
+      if (size < bufferLen)
+        SetError(LOAD_TRUNCATED_INPUT);
+      }
+
+  private:
+    const std::vector<unsigned char>& Data;
+    size_t                            Position;
+  };
+
+static bool TestRoundTrip()
+  {
+  std::vector<int> integers, loadedIntegers;
+  std::set<long long> keys, loadedKeys;
+  std::map<unsigned short, int> map, loadedMap;
+  for (int i = 0; i < 1000; ++i)
+    {
+    integers.push_back(i % 2 != 0 ? -i : i * 1000);
+    keys.insert(static_cast<long long>(i) * 3 - 1500);
+    map[static_cast<unsigned short>(i * 60)] = i;
+    }
+
+  TMemoryDumper dumper, unpacked;
+  dumper.SetPackedIntegers(true);
+  dumper & integers;
+  dumper & keys;
+  dumper & map;
+  unpacked & integers;
+  unpacked & keys;
+  unpacked & map;
+
+  TStreamLoader loader(dumper.GetBuffer());
+  loader.SetPackedIntegers(true);
+  loader & loadedIntegers;
+  loader & loadedKeys;
+  loader & loadedMap;
+  return loader.HasError() == false && loadedIntegers == integers && loadedKeys == keys && loadedMap == map &&
+    dumper.GetBuffer().size() < unpacked.GetBuffer().size() / 2;
+  }
+
+/// Loads packed vector whose payload size is replaced, nothing may be loaded on error.
+template <class TLoader>
+static ASerializeLoader::TLoadError LoadCorrupted(unsigned long long size)
+  {
+  std::vector<int> integers(100, 1000), loaded;
+  TMemoryDumper dumper;
+  dumper.SetPackedIntegers(true);
+  dumper & integers;
+
+  //count, codec, payload size
+  std::vector<unsigned char> dump = dumper.GetBuffer();
+  memcpy(dump.data() + sizeof(unsigned long long) + 1, &size, sizeof(size));
+  TLoader loader(dump);
+  loader.SetPackedIntegers(true);
+  loader & loaded;
+  return loaded.empty() ? loader.GetError() : ASerializeLoader::LOAD_OK;
+  }
+
+//---------- TBufferLoader
+//Memory loader constructed like TStreamLoader.
+class TBufferLoader : public TMemoryLoader
+  {
+  public:
+    explicit TBufferLoader(const std::vector<unsigned char>& data) : TMemoryLoader(data.data(), data.size()) {}
+  };
+
+static bool TestCorruptedLengths()
+  {
+  const unsigned long long huge = static_cast<unsigned long long>(1) << 60;
+  return LoadCorrupted<TBufferLoader>(huge) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadCorrupted<TStreamLoader>(huge) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadCorrupted<TBufferLoader>(1) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadCorrupted<TStreamLoader>(1) == ASerializeLoader::LOAD_BAD_ENCODING;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "corrupted lengths", &TestCorruptedLengths }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
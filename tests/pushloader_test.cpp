@@ -0,0 +1,137 @@
+//Regression test of push loaders: input pushed byte by byte, containers encoded as a whole are
+//rejected, overflow of coroutine stack hits guard page.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/client_code/serialize_pushloader.h>
+#include <serialize3/h/storage/memorydumper.h>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/// Pushes dump byte by byte, returns final status.
+static APushLoader::TStatus PushBytes(APushLoader& pushLoader, const std::vector<unsigned char>& dump)
+  {
+  APushLoader::TStatus status = APushLoader::PUSH_LOAD_NEED_MORE;
+  for (size_t i = 0; i < dump.size() && status == APushLoader::PUSH_LOAD_NEED_MORE; ++i)
+    status = pushLoader.Push(&dump[i], 1);
+  return status;
+  }
+
+static bool TestChunks()
+  {
+  std::map<std::string, int> map, loaded;
+  for (int i = 0; i < 100; ++i)
+    map["key " + std::to_string(i)] = i;
+  TMemoryDumper dumper;
+  dumper & map;
+
+  TContainerPushLoader<std::map<std::string, int>> pushLoader(loaded);
+  return PushBytes(pushLoader, dumper.GetBuffer()) == APushLoader::PUSH_LOAD_DONE && loaded == map;
+  }
+
+static bool TestEncoded()
+  {
+  std::vector<int> integers(100, 7), loadedIntegers;
+  std::set<std::string> keys = { "a", "ab", "abc" }, loadedKeys;
+  std::vector<std::string> strings(10, "x"), loadedStrings;
+  TMemoryDumper dumper, stringsDumper;
+  dumper.SetPackedIntegers(true);
+  dumper.SetFrontCodedStrings(true);
+  dumper & integers;
+  dumper & keys;
+  stringsDumper.SetPackedIntegers(true);
+  stringsDumper.SetFrontCodedStrings(true);
+  stringsDumper & strings;
+
+  TContainerPushLoader<std::vector<int>> integersLoader(loadedIntegers);
+  integersLoader.GetLoader().SetPackedIntegers(true);
+  TContainerPushLoader<std::set<std::string>> keysLoader(loadedKeys);
+  keysLoader.GetLoader().SetFrontCodedStrings(true);
+  TContainerPushLoader<std::vector<std::string>> stringsLoader(loadedStrings);
+  stringsLoader.GetLoader().SetPackedIntegers(true);
+  stringsLoader.GetLoader().SetFrontCodedStrings(true);
+
+  return PushBytes(integersLoader, dumper.GetBuffer()) == APushLoader::PUSH_LOAD_FAILED &&
+    integersLoader.GetError() == ASerializeLoader::LOAD_BAD_ENCODING && loadedIntegers.empty() &&
+    PushBytes(keysLoader, dumper.GetBuffer()) == APushLoader::PUSH_LOAD_FAILED &&
+    keysLoader.GetError() == ASerializeLoader::LOAD_BAD_ENCODING && loadedKeys.empty() &&
+    PushBytes(stringsLoader, stringsDumper.GetBuffer()) == APushLoader::PUSH_LOAD_DONE && loadedStrings == strings;
+  }
+
+/// Recurses till stack of coroutine overflows.
+class TRecursingLoader : public APushLoader
+  {
+  public:
+    TRecursingLoader() : APushLoader(64 * 1024) {}
+
+    ~TRecursingLoader()
+      {
+      Cancel();
+      }
+
+  protected:
+    virtual void LoadStream(ASerializeLoader&) override
+      {
+      Recurse(0);
+      }
+
+  private:
+    static size_t Recurse(size_t depth)
+      {
+      volatile unsigned char frame[256];
+      frame[0] = static_cast<unsigned char>(depth);
+      if (depth == static_cast<size_t>(-1))
+        return 0;
+      return Recurse(depth + 1) + frame[0];
+      }
+  };
+
+static bool TestStackOverflow()
+  {
+  pid_t child = fork();
+  if (child == 0)
+    {
+    TRecursingLoader pushLoader;
+    unsigned char byte = 0;
+    pushLoader.Push(&byte, 1);
+    _exit(0);
+    }
+
+  int status = 0;
+  return child > 0 && waitpid(child, &status, 0) == child && WIFSIGNALED(status) &&
+    (WTERMSIG(status) == SIGSEGV || WTERMSIG(status) == SIGBUS);
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "chunks", &TestChunks },
+      { "encoded", &TestEncoded },
+      { "stack overflow", &TestStackOverflow }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
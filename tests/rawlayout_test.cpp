@@ -0,0 +1,156 @@
+//Regression test of raw layout snapshots: round trip, objects moved field by field from
+//foreign layout, errors of nested fixed-size windows reach outer loader, unknown header flags.
+
+#include "test3_injected.cpp"
+
+#include <serialize3/h/client_code/serialize_snapshotheader.h>
+#include <serialize3/h/storage/fixedsizeloader.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//TRecord dumped by binary where m3 comes first: { m3, m1, m2, padding }
+const TRawLayoutField FOREIGN_FIELDS[] = { { 8, 4 }, { 12, 1 }, { 0, 8 } };
+const TRawLayoutDescription FOREIGN_RECORD = { "TRecord", 24, FOREIGN_FIELDS, 3 };
+const TRawLayoutDescription* const FOREIGN_CLASSES[] = { &FOREIGN_RECORD };
+const TSnapshotLayout FOREIGN_LAYOUT = { test3_LAYOUT_FINGERPRINT + 1, FOREIGN_CLASSES, 1 };
+
+static std::vector<TRecord> MakeRecords()
+  {
+  std::vector<TRecord> records;
+  for (int i = 0; i < 100; ++i)
+    {
+    TRecord record;
+    record.m1 = i;
+    record.m2 = i % 2 != 0 ? TEnum1::VALUE2 : TEnum1::VALUE1;
+    record.m3 = i * 1.5;
+    records.push_back(record);
+    }
+  return records;
+  }
+
+static bool IsSame(const std::vector<TRecord>& a, const std::vector<TRecord>& b)
+  {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i)
+    {
+    if (a[i].m1 != b[i].m1 || a[i].m2 != b[i].m2 || a[i].m3 != b[i].m3)
+      return false;
+    }
+  return true;
+  }
+
+/// Writes records in foreign layout after its header.
+static void DumpForeign(TMemoryDumper& dumper, const std::vector<TRecord>& records, bool asVector)
+  {
+  DumpSnapshotHeader(dumper, FOREIGN_LAYOUT, TSnapshotHeader::SNAPSHOT_RAW_LAYOUT);
+  if (asVector)
+    dumper.DumpSizeT(records.size());
+  for (const TRecord& record : records)
+    {
+    unsigned char object[24] = {};
+    memcpy(object, &record.m3, 8);
+    memcpy(object + 8, &record.m1, 4);
+    memcpy(object + 12, &record.m2, 1);
+    dumper.WriteBuffer(object, sizeof(object));
+    }
+  }
+
+static bool TestRoundTrip()
+  {
+  std::vector<TRecord> records = MakeRecords();
+  TMemoryDumper dumper;
+  DumpSnapshotHeader(dumper, test3_SNAPSHOT_LAYOUT, TSnapshotHeader::SNAPSHOT_RAW_LAYOUT);
+  size_t headerSize = dumper.GetBuffer().size();
+  dumper & records;
+
+  //count, then raw objects with zeroed padding
+  bool zeroed = dumper.GetBuffer().size() == headerSize + 8 + records.size() * sizeof(TRecord);
+  for (size_t i = 0; i < records.size() && zeroed; ++i)
+    {
+    const unsigned char* object = dumper.GetBuffer().data() + headerSize + 8 + i * sizeof(TRecord);
+    zeroed = object[5] == 0 && object[6] == 0 && object[7] == 0;
+    }
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  std::vector<TRecord> loaded;
+  loader & loaded;
+  return zeroed && loader.IsRawLayout() && loader.GetForeignRawLayouts() == nullptr &&
+    loader.GetError() == ASerializeLoader::LOAD_OK && IsSame(loaded, records);
+  }
+
+static bool TestForeignLayout()
+  {
+  std::vector<TRecord> records = MakeRecords();
+  TMemoryDumper dumper;
+  DumpForeign(dumper, records, true);
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  std::vector<TRecord> loaded;
+  loader & loaded;
+  return loader.GetForeignRawLayouts() != nullptr && loader.GetError() == ASerializeLoader::LOAD_OK &&
+    loader.GetAvailableSize() == 0 && IsSame(loaded, records);
+  }
+
+//Object of foreign size can't be moved inside fixed-size object, whose size is native
+static bool TestNestedMismatch()
+  {
+  std::vector<TRecord> records = MakeRecords();
+  records.resize(1);
+  TMemoryDumper dumper;
+  DumpForeign(dumper, records, false);
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  TRecord loaded;
+  loaded.m1 = -1;
+    {
+    TFixedSizeLoader window(loader, sizeof(TRecord));
+    window & loaded;
+    }
+  return loader.GetError() == ASerializeLoader::LOAD_LAYOUT_MISMATCH;
+  }
+
+static bool TestUnknownFlag()
+  {
+  TMemoryDumper dumper;
+  DumpSnapshotHeader(dumper, test3_LAYOUT_FINGERPRINT, 0);
+  std::vector<unsigned char> buffer = dumper.GetBuffer();
+  TSnapshotHeader header;
+  unsigned short flags = 0x100;
+  memcpy(buffer.data() + sizeof(header.Magic) + sizeof(header.Version), &flags, sizeof(flags));
+
+  TMemoryLoader loader(buffer.data(), buffer.size());
+  LoadSnapshotHeader(loader, test3_LAYOUT_FINGERPRINT);
+  return loader.GetError() == ASerializeLoader::LOAD_BAD_HEADER;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "foreign layout", &TestForeignLayout },
+      { "nested mismatch", &TestNestedMismatch },
+      { "unknown flag", &TestUnknownFlag }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,90 @@
+//Regression test of TSegmentedStorage: concurrent appends keep their values, size() covers only
+//assigned elements, resize resets elements behind new end.
+
+#include <serialize3/h/client_code/serialize_segmentedstorage.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+typedef TSegmentedStorage<long long, 16> TStorage;
+
+const size_t THREADS = 4;
+const size_t APPENDS = 20000;
+
+static bool TestConcurrentAppends()
+  {
+  TStorage storage;
+  std::atomic<bool> done(false);
+  std::atomic<bool> good(true);
+
+  //values are never zero, so reader sees default element only if size() covers unassigned one
+  std::thread reader([&storage, &done, &good]()
+    {
+    while (done.load() == false)
+      {
+      size_t size = storage.size();
+      for (size_t i = size > 100 ? size - 100 : 0; i < size; ++i)
+        if (storage[i] == 0)
+          good.store(false);
+      }
+    });
+
+  std::vector<std::thread> writers;
+  std::vector<std::vector<size_t>> indices(THREADS);
+  for (size_t t = 0; t < THREADS; ++t)
+    writers.emplace_back([&storage, &indices, t]()
+      {
+      for (size_t i = 0; i < APPENDS; ++i)
+        indices[t].push_back(storage.push_back(static_cast<long long>(t * APPENDS + i + 1)));
+      });
+  for (std::thread& writer : writers)
+    writer.join();
+  done.store(true);
+  reader.join();
+
+  if (good.load() == false || storage.size() != THREADS * APPENDS)
+    return false;
+  for (size_t t = 0; t < THREADS; ++t)
+    for (size_t i = 0; i < APPENDS; ++i)
+      if (storage[indices[t][i]] != static_cast<long long>(t * APPENDS + i + 1))
+        return false;
+  return true;
+  }
+
+static bool TestResize()
+  {
+  TStorage storage(10);
+  for (size_t i = 0; i < storage.size(); ++i)
+    storage[i] = static_cast<long long>(i + 1);
+  storage.resize(5);
+  if (storage.push_back(100) != 5 || storage.size() != 6)
+    return false;
+  storage.resize(50);
+  if (storage.size() != 50 || storage[4] != 5 || storage[5] != 100 || storage[6] != 0 || storage[49] != 0)
+    return false;
+  return storage.push_back(7) == 50 && storage.size() == 51 && storage[50] == 7;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "concurrent appends", &TestConcurrentAppends },
+      { "resize", &TestResize }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
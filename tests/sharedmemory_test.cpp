@@ -0,0 +1,131 @@
+//Regression test of shared memory snapshots: published versions are loaded by readers in other
+//processes, mapped versions outlive newer ones, uncommitted or corrupted segments are rejected.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/memoryloader.h>
+#include <serialize3/h/storage/sharedmemory.h>
+
+#include <sys/wait.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static std::string GetName()
+  {
+  return "/serialize3_test_" + std::to_string(static_cast<long long>(getpid()));
+  }
+
+static std::vector<std::string> MakeStrings(size_t generation)
+  {
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < 10000; ++i)
+    strings.push_back("version " + std::to_string(generation) + " string " + std::to_string(i));
+  return strings;
+  }
+
+static bool Publish(TSharedSnapshotPublisher& publisher, size_t generation)
+  {
+  //small capacity, so the segment grows many times
+  TSharedMemoryDumper* dumper = publisher.BeginVersion(4096);
+  if (dumper == nullptr)
+    return false;
+  *dumper & MakeStrings(generation);
+  return dumper->IsGood() && publisher.Publish();
+  }
+
+static bool IsLoaded(const TSharedMemorySegment& segment, size_t generation)
+  {
+  std::vector<std::string> strings;
+  TMemoryLoader loader(segment.GetData(), segment.GetSize());
+  loader & strings;
+  return loader.HasError() == false && loader.GetAvailableSize() == 0 && strings == MakeStrings(generation);
+  }
+
+static bool TestVersions()
+  {
+  std::string name = GetName();
+  TSharedSnapshotPublisher publisher(name.c_str());
+  TSharedSnapshotReader reader(name.c_str());
+  if (publisher.IsOpen() == false || reader.Refresh() || Publish(publisher, 1) == false || reader.Refresh() == false)
+    return false;
+
+  std::shared_ptr<const TSharedMemorySegment> first = reader.GetSegment();
+  if (first->GetGeneration() != 1 || IsLoaded(*first, 1) == false || reader.Refresh())
+    return false;
+
+  //first version is unlinked by publisher, its mapping stays valid
+  if (Publish(publisher, 2) == false || reader.Refresh() == false || reader.GetSegment()->GetGeneration() != 2 ||
+      IsLoaded(*reader.GetSegment(), 2) == false || IsLoaded(*first, 1) == false)
+    return false;
+
+  pid_t child = fork();
+  if (child == 0)
+    {
+    TSharedSnapshotReader childReader(name.c_str());
+    _exit(childReader.Refresh() && IsLoaded(*childReader.GetSegment(), 2) ? 0 : 1);
+    }
+  int status = 0;
+  bool good = child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+  shm_unlink(GetSharedSnapshotName(name, publisher.GetGeneration()).c_str());
+  shm_unlink(name.c_str());
+  return good;
+  }
+
+/// Opens segment written by dumper, committed or not, or with payload size replaced.
+static bool OpenSegment(bool commit, unsigned long long size = 0)
+  {
+  std::string name = GetName() + ".segment";
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  shm_unlink(name.c_str());
+  if (fd < 0)
+    return false;
+
+  bool committed;
+    {
+    TSharedMemoryDumper dumper(fd, 1);
+    dumper & MakeStrings(1);
+    committed = commit && dumper.Commit();
+    }
+  if (size != 0)
+    pwrite(fd, &size, sizeof(size), offsetof(TSharedSegmentHeader, Size));
+
+  TSharedMemorySegment segment(fd);
+  close(fd);
+  return segment.IsOpen() && committed && IsLoaded(segment, 1);
+  }
+
+static bool TestSegments()
+  {
+  return OpenSegment(true) && OpenSegment(false) == false &&
+    OpenSegment(true, static_cast<unsigned long long>(1) << 60) == false;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "versions", &TestVersions },
+      { "segments", &TestSegments }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
@@ -0,0 +1,116 @@
+//Regression test of string dictionary: repeated strings are dumped once and loaded shared, long
+//strings stay out of both dictionaries, corrupted references and lengths are rejected.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/client_code/serialize_snapshotheader.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef std::shared_ptr<const std::string> TSharedString;
+
+static bool TestRoundTrip()
+  {
+  std::vector<std::string> strings, loadedStrings;
+  std::map<std::string, std::string> map, loadedMap;
+  std::vector<TSharedString> shared, loadedShared;
+  std::string longString(STRING_DICTIONARY_MAX_LENGTH + 1, 'x');
+  for (int i = 0; i < 1000; ++i)
+    {
+    strings.push_back("repeated value " + std::to_string(i % 10));
+    map["key " + std::to_string(i % 100)] = strings.back();
+    shared.push_back(std::make_shared<const std::string>(i % 100 == 99 ? longString : strings.back()));
+    }
+
+  TMemoryDumper dumper, plain;
+  SetSnapshotEncodings(dumper, TSnapshotHeader::SNAPSHOT_STRING_DICTIONARY);
+  dumper & strings;
+  dumper & map;
+  dumper & shared;
+  plain & strings;
+  plain & map;
+  plain & shared;
+
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  std::shared_ptr<TLoadStringDictionary> dictionary = std::make_shared<TLoadStringDictionary>();
+  loader.SetStringDictionary(dictionary);
+  loader & loadedStrings;
+  loader & loadedMap;
+  loader & loadedShared;
+  if (loader.HasError() || loader.GetAvailableSize() != 0 || loadedStrings != strings || loadedMap != map ||
+      loadedShared.size() != shared.size() || dictionary->GetSize() != dumper.GetStringDictionary()->GetSize() ||
+      dictionary->GetSize() != 110 || dumper.GetBuffer().size() > plain.GetBuffer().size() / 4)
+    return false;
+
+  for (size_t i = 0; i < shared.size(); ++i)
+    {
+    //short strings are shared with their first occurrence, long ones are loaded each time
+    bool isLong = i % 100 == 99;
+    if (loadedShared[i] == nullptr || *loadedShared[i] != *shared[i] ||
+        (isLong == false && loadedShared[i] != loadedShared[i % 10]) ||
+        (isLong && i != 99 && loadedShared[i] == loadedShared[99]))
+      return false;
+    }
+  return true;
+  }
+
+/// Loads vector of strings "a", "b", code with string length if code is 0.
+static ASerializeLoader::TLoadError LoadStrings(unsigned long long code, unsigned long long length = 0)
+  {
+  TMemoryDumper dumper;
+  dumper.DumpSizeT(3);
+  DumpVarUInt(dumper, 0);
+  dumper.Dump(std::string("a"));
+  DumpVarUInt(dumper, 0);
+  dumper.Dump(std::string("b"));
+  DumpVarUInt(dumper, code);
+  if (code == 0)
+    dumper.DumpSizeT(length);
+
+  std::vector<std::string> strings;
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader.SetStringDictionary(std::make_shared<TLoadStringDictionary>());
+  loader & strings;
+  return loader.GetError();
+  }
+
+static bool TestCorrupted()
+  {
+  return LoadStrings(2) == ASerializeLoader::LOAD_OK &&
+    LoadStrings(3) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadStrings(static_cast<unsigned long long>(-1)) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadStrings(0, 0) == ASerializeLoader::LOAD_OK &&
+    LoadStrings(0, static_cast<unsigned long long>(1) << 60) == ASerializeLoader::LOAD_TRUNCATED_INPUT;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "corrupted", &TestCorrupted }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
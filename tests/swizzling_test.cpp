@@ -0,0 +1,121 @@
+//Regression test of swizzled TSerializePtrWrapper: pointers resolved by Swizzle or during load
+//are dropped when registry objects may move, wrappers which are not swizzled keep only handle.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/client_code/serialize_segmentedstorage.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cstdio>
+#include <vector>
+
+//generated for APtrWrapper in client modules
+void APtrWrapper::Dump(ASerializeDumper& dumper) const
+  {
+  dumper & Handle;
+  }
+
+void APtrWrapper::Load(ASerializeLoader& loader) SERIALIZE_LOAD_NOEXCEPT
+  {
+  loader & Handle;
+  }
+
+typedef TSerializedObjectRegistry<long long> TRegistry;
+typedef TSerializedObjectRegistry<long long, TSegmentedStorage<long long>> TSegmentedRegistry;
+typedef TSerializePtrWrapper<long long, long long, TRegistry, true> TSwizzledPtr;
+typedef TSerializePtrWrapper<long long, long long, TSegmentedRegistry, true> TSegmentedSwizzledPtr;
+
+static bool TestSize()
+  {
+  return sizeof(TSerializePtrWrapper<long long, long long, TRegistry>) == sizeof(APtrWrapper) &&
+    sizeof(TSwizzledPtr) > sizeof(APtrWrapper);
+  }
+
+static bool TestReallocation()
+  {
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  TRegistry::TContext context(registry);
+  TSwizzledPtr ptr = TSwizzledPtr::WrapNewObject(1);
+  ptr.Swizzle();
+  if (ptr.IsSwizzled() == false || *ptr != 1)
+    return false;
+
+  //vector storage moves objects while it grows
+  for (long long i = 2; i < 1000; ++i)
+    TSwizzledPtr::WrapNewObject(i);
+  registry.GetStorage()[1] = 5;
+  return ptr.IsSwizzled() == false && *ptr == 5;
+  }
+
+static bool TestStableStorage()
+  {
+  TSegmentedRegistry registry(TSegmentedRegistry::CONTEXT_INSTANCE);
+  TSegmentedRegistry::TContext context(registry);
+  TSegmentedSwizzledPtr ptr = TSegmentedSwizzledPtr::WrapNewObject(1);
+  ptr.Swizzle();
+  for (long long i = 2; i < 5000; ++i)
+    TSegmentedSwizzledPtr::WrapNewObject(i);
+  if (ptr.IsSwizzled() == false || *ptr != 1)
+    return false;
+
+  registry.Compact();
+  return ptr.IsSwizzled() == false && *ptr == 1;
+  }
+
+static bool TestSwizzleOnLoad()
+  {
+  std::vector<TSwizzledPtr> ptrs, loaded;
+  TMemoryDumper dumper;
+    {
+    TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+    TRegistry::TContext context(registry);
+    for (long long i = 0; i < 10; ++i)
+      ptrs.push_back(TSwizzledPtr::WrapNewObject(i * 10));
+    dumper & registry;
+    dumper & ptrs;
+    }
+
+  TRegistry registry(TRegistry::CONTEXT_INSTANCE);
+  TRegistry::TContext context(registry);
+  registry.SetSwizzleOnLoad(true);
+  TMemoryLoader loader(dumper.GetBuffer().data(), dumper.GetBuffer().size());
+  loader & registry;
+  loader & loaded;
+  if (loader.HasError() || loaded.size() != ptrs.size())
+    return false;
+  for (size_t i = 0; i < loaded.size(); ++i)
+    if (loaded[i].IsSwizzled() == false || *loaded[i] != static_cast<long long>(i * 10))
+      return false;
+
+  registry.ReleaseHandle(loaded[0].GetHandle());
+  return loaded[1].IsSwizzled() == false && *loaded[1] == 10;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "size", &TestSize },
+      { "reallocation", &TestReallocation },
+      { "stable storage", &TestStableStorage },
+      { "swizzle on load", &TestSwizzleOnLoad }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
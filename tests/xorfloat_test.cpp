@@ -0,0 +1,143 @@
+//Regression test of XOR compressed floats: round trip of vectors and deques including special
+//values, corrupted payload sizes are rejected without allocating memory for them.
+
+#include "vpi_api.h"
+
+#define OWNER_API VPI_API
+
+#include <serialize3/h/gen_code/dumpertemplates.h>
+#include <serialize3/h/gen_code/loadertemplates.h>
+#include <serialize3/h/storage/memorydumper.h>
+#include <serialize3/h/storage/memoryloader.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <vector>
+
+//---------- TStreamLoader
+//Loader which doesn't know size of its input, like loaders of pipes and sockets.
+class TStreamLoader : public ASerializeLoader
+  {
+  public:
+    explicit TStreamLoader(const std::vector<unsigned char>& data) : Data(data), Position(0) {}
+
+    virtual void Log(const char*) override {}
+
+    virtual void ReadBuffer(unsigned char* buffer, size_t bufferLen) override
+      {
+      size_t size = std::min(bufferLen, Data.size() - Position);
+      memcpy(buffer, Data.data() + Position, size);
+      memset(buffer + size, 0, bufferLen - size);
+      Position += size;
+      if (size < bufferLen)
+        SetError(LOAD_TRUNCATED_INPUT);
+      }
+
+  private:
+    const std::vector<unsigned char>& Data;
+    size_t                            Position;
+  };
+
+//---------- TBufferLoader
+//Memory loader constructed like TStreamLoader.
+class TBufferLoader : public TMemoryLoader
+  {
+  public:
+    explicit TBufferLoader(const std::vector<unsigned char>& data) : TMemoryLoader(data.data(), data.size()) {}
+  };
+
+static std::vector<double> MakeValues()
+  {
+  std::vector<double> values;
+  for (int i = 0; i < 1000; ++i)
+    values.push_back(100.0 + (i % 10) * 0.25);
+  values.push_back(std::numeric_limits<double>::infinity());
+  values.push_back(-0.0);
+  values.push_back(std::numeric_limits<double>::denorm_min());
+  return values;
+  }
+
+template <typename TType>
+static bool IsSameBits(const TType& a, const TType& b)
+  {
+  return a.size() == b.size() && (a.empty() || memcmp(&a[0], &b[0], a.size() * sizeof(a[0])) == 0);
+  }
+
+static bool TestRoundTrip()
+  {
+  std::vector<double> values = MakeValues(), loadedValues;
+  std::deque<float> floats(values.begin(), values.end()), loadedFloats;
+  std::vector<double> empty, loadedEmpty;
+
+  TMemoryDumper dumper, plain;
+  dumper.SetXorFloats(true);
+  dumper & values;
+  dumper & floats;
+  dumper & empty;
+  plain & values;
+  plain & floats;
+
+  TStreamLoader loader(dumper.GetBuffer());
+  loader.SetXorFloats(true);
+  loader & loadedValues;
+  loader & loadedFloats;
+  loader & loadedEmpty;
+  std::vector<float> floatValues(floats.begin(), floats.end());
+  std::vector<float> loadedFloatValues(loadedFloats.begin(), loadedFloats.end());
+  return loader.HasError() == false && IsSameBits(values, loadedValues) &&
+    IsSameBits(floatValues, loadedFloatValues) && loadedEmpty.empty() &&
+    dumper.GetBuffer().size() < plain.GetBuffer().size() / 2;
+  }
+
+/// Loads XOR compressed vector whose payload size is replaced, nothing may be loaded on error.
+template <class TLoader>
+static ASerializeLoader::TLoadError LoadCorrupted(unsigned long long size)
+  {
+  std::vector<double> values = MakeValues(), loaded;
+  TMemoryDumper dumper;
+  dumper.SetXorFloats(true);
+  dumper & values;
+
+  //count, payload size
+  std::vector<unsigned char> dump = dumper.GetBuffer();
+  memcpy(dump.data() + sizeof(unsigned long long), &size, sizeof(size));
+  TLoader loader(dump);
+  loader.SetXorFloats(true);
+  loader & loaded;
+  return loaded.empty() ? loader.GetError() : ASerializeLoader::LOAD_OK;
+  }
+
+static bool TestCorruptedLengths()
+  {
+  const unsigned long long huge = static_cast<unsigned long long>(1) << 60;
+  return LoadCorrupted<TBufferLoader>(huge) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadCorrupted<TStreamLoader>(huge) == ASerializeLoader::LOAD_TRUNCATED_INPUT &&
+    LoadCorrupted<TBufferLoader>(1) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadCorrupted<TStreamLoader>(1) == ASerializeLoader::LOAD_BAD_ENCODING &&
+    LoadCorrupted<TBufferLoader>(200) == ASerializeLoader::LOAD_BAD_ENCODING;
+  }
+
+int main()
+  {
+  struct
+    {
+    const char* Name;
+    bool        (*Test)();
+    } tests[] =
+    {
+      { "round trip", &TestRoundTrip },
+      { "corrupted lengths", &TestCorruptedLengths }
+    };
+
+  int failed = 0;
+  for (const auto& test : tests)
+    if (test.Test() == false)
+      {
+      printf("failed: %s\n", test.Name);
+      ++failed;
+      }
+  return failed == 0 ? 0 : 1;
+  }
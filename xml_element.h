@@ -136,8 +136,9 @@ class TArrayType final : public TType
 class TClassMember final : public AXmlElement
   {
   public:
-    explicit TClassMember(const std::string& name, const std::string& id, bool publicAccess, int bitfield)
-      : AXmlElement(name, id, TAG_FIELD), Bitfield(bitfield)
+    explicit TClassMember(const std::string& name, const std::string& id, bool publicAccess, int bitfield,
+      int offset)
+      : AXmlElement(name, id, TAG_FIELD), Bitfield(bitfield), Offset(offset)
       { PublicAccess = publicAccess; }
 
     void SetType(const TType* _type) { Type = _type; }
@@ -146,9 +147,13 @@ class TClassMember final : public AXmlElement
 
     int IsBitfield() const { return Bitfield; }
 
+    /// Offset in bits within the class, -1 if unknown.
+    int GetOffset() const { return Offset; }
+
   private:
     const TType*  Type = nullptr;
     int           Bitfield = 0;
+    int           Offset = -1;
   };
 
 class TClass final : public TType
@@ -191,6 +196,13 @@ class TClass final : public TType
     void SetVirtuallyDerived() { VirtuallyDerived = true; }
     bool IsVirtuallyDerived() const { return VirtuallyDerived; }
 
+    /// Loading constructor is declared by SERIALIZABLE_LOAD_CONSTRUCTOR.
+    void SetLoadConstructor() { LoadConstructor = true; }
+    bool HasLoadConstructor() const { return LoadConstructor; }
+    /// DumpDiff and LoadPatch are declared by SERIALIZABLE_DIFF.
+    void SetDiff() { Diff = true; }
+    bool HasDiff() const { return Diff; }
+
     void SetOrdered() const { Ordered = true; }
     bool IsOrdered() const { return Ordered; }
 
@@ -258,6 +270,8 @@ class TClass final : public TType
     mutable int                 TypeId = -1;
     bool                        Abstract = false;
     bool                        VirtuallyDerived = false;
+    bool                        LoadConstructor = false;
+    bool                        Diff = false;
     mutable bool                Ordered = false;
   };
 
@@ -302,9 +316,10 @@ class TXmlElementsFactory final
       return result;
       }
 
-    TClassMember* CreateClassMember(const std::string& name, const std::string& id, bool publicAccess, int bitfield)
+    TClassMember* CreateClassMember(const std::string& name, const std::string& id, bool publicAccess, int bitfield,
+      int offset)
       {
-      TClassMember* result = new TClassMember(name, id, publicAccess, bitfield);
+      TClassMember* result = new TClassMember(name, id, publicAccess, bitfield, offset);
       Elements.push_front(result);
       return result;
       }
@@ -137,6 +137,13 @@ class TFieldWrapper : public AXmlItemWrapper
       const std::string& bitfield = get_attr_value(ATTRIBUTE_BITS);
       return bitfield.empty() ? 0 : std::stoi(bitfield);
       }
+
+    // offset in bits, -1 if not present
+    int GetOffset() const
+      {
+      const std::string& offset = get_attr_value(ATTRIBUTE_OFFSET);
+      return offset.empty() ? -1 : std::stoi(offset);
+      }
   };
 
 class TEnumWrapper : public AXmlItemWrapper